@@ -238,6 +238,8 @@ src/complex_trig.cpp \
 src/string.cpp \
 src/bitset.cpp \
 src/allocators.cpp \
+src/sort_pool.cpp \
+src/string_search.cpp \
 src/c_locale.c \
 src/cxa.c"
 
@@ -32,6 +32,8 @@
 
 #include <crystax/id.h>
 
+#include <stddef.h>
+
 namespace crystax
 {
 
@@ -51,9 +53,11 @@ namespace fileio
 
 bool is_normalized(const char *path);
 char *normalize(const char *path);
+bool normalize(const char *path, char *buf, size_t bufsize, size_t *length);
 
 bool is_absolute(const char *path);
 char *absolutize(const char *path);
+bool absolutize(const char *path, char *buf, size_t bufsize, size_t *length);
 
 bool is_subpath(const char *root, const char *path);
 char *relpath(const char *root, const char *path);
@@ -179,6 +179,114 @@ T jcast(abspath_t const &p)
     return ::crystax::jni::details::jcast_helper<T, const char *>::cast(p.c_str());
 }
 
+/*
+ * Non-owning counterparts of path_t and abspath_t. They never touch heap: if source
+ * string is normalized already, view refers to it directly, otherwise result is built
+ * in caller-provided buffer. Use them on hot paths where path is needed only for
+ * the duration of the call.
+ */
+class path_view_t
+{
+    typedef void (path_view_t::*safe_bool_type)() const;
+    void non_empty_path() const {}
+public:
+    path_view_t()
+        :p(0), len(0)
+    {}
+
+    path_view_t(const char *path, size_t length)
+        :p(path), len(length)
+    {}
+
+    path_view_t(details::path_t const &path)
+        :p(path.c_str()), len(path.length())
+    {}
+
+    path_view_t(const char *path, char *buf, size_t bufsize)
+        :p(0), len(0)
+    {
+        if (!path)
+            return;
+
+        if (is_normalized(path))
+        {
+            p = path;
+            len = ::strlen(path);
+        }
+        else if (normalize(path, buf, bufsize, &len))
+            p = buf;
+    }
+
+    bool operator!() const {return !p;}
+    operator safe_bool_type () const
+    {
+        return !p ? 0 : &path_view_t::non_empty_path;
+    }
+
+    bool empty() const {return len == 0;}
+
+    const char *c_str() const {return p;}
+    size_t length() const {return len;}
+
+protected:
+    const char *p;
+    size_t len;
+};
+
+inline
+bool operator==(path_view_t const &a, path_view_t const &b)
+{
+    if (!a || !b)
+        return a.c_str() == b.c_str();
+    return a.length() == b.length() && ::memcmp(a.c_str(), b.c_str(), a.length()) == 0;
+}
+
+inline
+bool operator!=(path_view_t const &a, path_view_t const &b)
+{
+    return !(a == b);
+}
+
+class abspath_view_t : public path_view_t
+{
+public:
+    abspath_view_t()
+    {}
+
+    abspath_view_t(const char *path, size_t length)
+        :path_view_t(path, length)
+    {}
+
+    abspath_view_t(abspath_t const &path)
+        :path_view_t(path)
+    {}
+
+    abspath_view_t(const char *path, char *buf, size_t bufsize)
+    {
+        if (!path)
+            return;
+
+        if (is_absolute(path) && is_normalized(path))
+        {
+            p = path;
+            len = ::strlen(path);
+        }
+        else if (absolutize(path, buf, bufsize, &len))
+            p = buf;
+    }
+
+    // Same as is_subpath(), but both paths are known to be absolute and normalized
+    bool subpath(abspath_view_t const &root) const
+    {
+        if (!p || !root.p)
+            return false;
+        if (root.len == 1 && *root.p == '/')
+            return true;
+        return len >= root.len && ::memcmp(p, root.p, root.len) == 0 &&
+            (len == root.len || p[root.len] == '/');
+    }
+};
+
 } // namespace fileio
 } // namespace crystax
 
@@ -29,83 +29,202 @@
 
 #include <crystax/localeimpl.h>
 #include <errno.h>
-#include <pthread.h>
+
+/* Set to 0 to build without BZip2; tables generated with --codec=bzip2 couldn't be loaded then */
+#ifndef CRYSTAX_LOCALE_BZIP2
+#define CRYSTAX_LOCALE_BZIP2 1
+#endif
+
+#if CRYSTAX_LOCALE_BZIP2
 #include <bzlib.h>
+#endif
 
-static pthread_mutex_t dmtx = PTHREAD_MUTEX_INITIALIZER;
+static int lz4_length(const uint8_t **ip, const uint8_t *iend, size_t *len)
+{
+    unsigned b;
+    do
+    {
+        if (*ip >= iend)
+            return -1;
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+    return 0;
+}
 
-static int decompress(__crystax_locale_blob_t *blob)
+/*
+ * Decoder of LZ4 block format. Input is trusted (it's generated together with
+ * libcrystax), but it's cheap to stay within bounds anyway.
+ */
+static int lz4_decode(const uint8_t *src, size_t srclen, uint8_t *dst, size_t dstlen)
 {
-    int rc;
-    char *dst = NULL;
-    unsigned dstlen = 0;
+    const uint8_t *ip = src;
+    const uint8_t *iend = src + srclen;
+    uint8_t *op = dst;
+    uint8_t *oend = dst + dstlen;
 
-    if (blob->compressed == 0)
-        return 0;
+    for (;;)
+    {
+        unsigned token;
+        size_t len, off;
+        const uint8_t *match;
+
+        if (ip >= iend)
+            return -1;
+        token = *ip++;
+
+        len = token >> 4;
+        if (len == 15 && lz4_length(&ip, iend, &len) < 0)
+            return -1;
+        if ((size_t)(iend - ip) < len || (size_t)(oend - op) < len)
+            return -1;
+        memcpy(op, ip, len);
+        op += len;
+        ip += len;
+
+        /* Last sequence has literals only */
+        if (ip == iend)
+            break;
+
+        if (iend - ip < 2)
+            return -1;
+        off = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (off == 0 || off > (size_t)(op - dst))
+            return -1;
+
+        len = token & 15;
+        if (len == 15 && lz4_length(&ip, iend, &len) < 0)
+            return -1;
+        len += 4;
+        if ((size_t)(oend - op) < len)
+            return -1;
 
-    if (pthread_mutex_lock(&dmtx) != 0)
-        abort();
+        /* Match could overlap bytes being written */
+        match = op - off;
+        if (off >= len)
+        {
+            memcpy(op, match, len);
+            op += len;
+        }
+        else
+            while (len--)
+                *op++ = *match++;
+    }
+
+    return op == oend ? 0 : -1;
+}
 
-    if (blob->compressed)
+/*
+ * Decode blob in one pass into exactly sized buffer.
+ */
+static void *decode(const __crystax_locale_table_t *t, const __crystax_locale_blob_t *blob)
+{
+    const uint8_t *src = t->blobs + blob->offset;
+    uint8_t *dst;
+    int rc = -1;
+
+    if ((dst = (uint8_t*)malloc(blob->usize ? blob->usize : 1)) == NULL)
     {
-        for (dstlen = blob->size * 2 + 1024;; dstlen += blob->size + 1024)
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    switch (blob->codec)
+    {
+    case __CRYSTAX_LOCALE_LZ4:
+        rc = lz4_decode(src, blob->size, dst, blob->usize);
+        break;
+#if CRYSTAX_LOCALE_BZIP2
+    case __CRYSTAX_LOCALE_BZIP2:
         {
-            dst = (char*)reallocf(dst, dstlen);
-            if (dst == NULL)
-            {
-                errno = ENOMEM;
-                goto err;
-            }
-
-            rc = BZ2_bzBuffToBuffDecompress(dst, &dstlen, (char*)blob->data, (unsigned)blob->size, 0, 0);
-            if (rc == BZ_OUTBUFF_FULL)
-                continue;
-            if (rc == BZ_OK)
-                break;
-            errno = EFAULT;
-            goto err;
+            unsigned dstlen = blob->usize;
+            if (BZ2_bzBuffToBuffDecompress((char*)dst, &dstlen, (char*)src, blob->size, 0, 0) == BZ_OK &&
+                dstlen == blob->usize)
+                rc = 0;
         }
-        blob->data = (uint8_t*)dst;
-        blob->size = (size_t)dstlen;
-        blob->compressed = 0;
+        break;
+#endif
+    default:
+        break;
+    }
+
+    if (rc < 0)
+    {
+        free(dst);
+        errno = EFAULT;
+        return NULL;
     }
 
-    rc = 0;
-    goto success;
+    return dst;
+}
+
+/*
+ * Blobs are decoded without any locks: each thread which finds blob not decoded
+ * yet does it on its own and tries to publish result; the first one wins and the
+ * rest free their copies. So loading of unrelated locales never serializes, and
+ * blob published once is never changed or freed.
+ */
+static int decompress(const __crystax_locale_table_t *t, size_t idx, void **buf, size_t *bufsize)
+{
+    const __crystax_locale_blob_t *blob = &t->blob[idx];
+    void *data;
+    void *prev = NULL;
+
+    *bufsize = blob->usize;
 
-err:
-    rc = -1;
+    if (blob->codec == __CRYSTAX_LOCALE_STORED)
+    {
+        *buf = (void*)(t->blobs + blob->offset);
+        return 0;
+    }
+
+    if ((*buf = __atomic_load_n(&t->cache[idx], __ATOMIC_ACQUIRE)) != NULL)
+        return 0;
+
+    if ((data = decode(t, blob)) == NULL)
+        return -1;
 
-success:
-    if (pthread_mutex_unlock(&dmtx) != 0)
-        abort();
+    if (!__atomic_compare_exchange_n(&t->cache[idx], &prev, data, 0, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+    {
+        free(data);
+        data = prev;
+    }
 
-    return rc;
+    *buf = data;
+    return 0;
 }
 
-static __crystax_locale_data_t *lookup(const char *encoding)
+static const __crystax_locale_data_t *lookup(const __crystax_locale_table_t *t, const char *encoding)
 {
-    __crystax_locale_data_t *d;
-    size_t i, lim;
+    const __crystax_locale_data_t *d;
+    int idx;
 
     if (encoding == NULL || *encoding == '\0')
         return NULL;
 
-    for (i = 0, lim = __crystax_locale_table_size(); i < lim; ++i)
-    {
-        d = __crystax_locale_data(i);
-        if (d && d->encoding && strcmp(d->encoding, encoding) == 0)
-            return d;
-    }
-    return NULL;
+    idx = t->slots[__crystax_locale_hash(encoding, t->seeds[__crystax_locale_hash(encoding, 0) % t->nseeds]) % t->nslots];
+    if (idx < 0)
+        return NULL;
+
+    d = &t->data[idx];
+    if (strcmp(t->names + d->name, encoding) != 0)
+        return NULL;
+    return d;
 }
 
-int __crystax_locale_load(const char *encoding, int type, void **buf, size_t *bufsize)
+/* Locale data is static now; kept for compatibility */
+int __crystax_locale_init()
 {
-    __crystax_locale_data_t *ld;
+    return 0;
+}
 
-    if (__crystax_locale_init() != 0)
-        return -1;
+int __crystax_locale_load(const char *encoding, int type, void **buf, size_t *bufsize)
+{
+    const __crystax_locale_table_t *t = __crystax_locale_table();
+    const __crystax_locale_data_t *ld;
+    void *data = NULL;
+    size_t size = 0;
 
     if (type < 0 || type >= _LC_LAST)
     {
@@ -113,20 +232,17 @@ int __crystax_locale_load(const char *encoding, int type, void **buf, size_t *bu
         return -1;
     }
 
-    if ((ld = lookup(encoding)) == NULL)
+    if ((ld = lookup(t, encoding)) == NULL)
     {
         errno = ENOENT;
         return -1;
     }
 
-    if (ld->data[type].alias)
-        return __crystax_locale_load(ld->data[type].alias, type, buf, bufsize);
-
-    if (decompress(&(ld->data[type].blob)) < 0)
+    if (ld->blob[type] != 0 && decompress(t, ld->blob[type] - 1, &data, &size) < 0)
         return -1;
 
-    if (buf) *buf = ld->data[type].blob.data;
-    if (bufsize) *bufsize = ld->data[type].blob.size;
+    if (buf) *buf = data;
+    if (bufsize) *bufsize = size;
     return 0;
 }
 
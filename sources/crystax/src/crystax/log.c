@@ -34,6 +34,7 @@
 
 #define CRYSTAX_LOG_SINK_STDOUT 0
 #define CRYSTAX_LOG_SINK_LOGCAT 1
+#define CRYSTAX_LOG_SINK_ASYNC  2
 
 #ifndef CRYSTAX_LOG_SINK
 #define CRYSTAX_LOG_SINK CRYSTAX_LOG_SINK_STDOUT
@@ -72,6 +73,313 @@ static int __crystax_vlogcat(int prio, const char *tag, const char *fmt, va_list
 }
 #endif /* CRYSTAX_LOG_SINK_LOGCAT */
 
+#if CRYSTAX_LOG_SINK == CRYSTAX_LOG_SINK_ASYNC
+
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+/* Number of records in ring; must be power of two */
+#ifndef CRYSTAX_LOG_RING_SIZE
+#define CRYSTAX_LOG_RING_SIZE 1024
+#endif
+
+/* Longer messages are truncated */
+#ifndef CRYSTAX_LOG_RECORD_SIZE
+#define CRYSTAX_LOG_RECORD_SIZE 256
+#endif
+
+/* Sustained number of records per second let through; 0 means no limit */
+#ifndef CRYSTAX_LOG_RATE
+#define CRYSTAX_LOG_RATE 20000
+#endif
+
+/* Number of records which could come at once above the rate */
+#ifndef CRYSTAX_LOG_BURST
+#define CRYSTAX_LOG_BURST 1000
+#endif
+
+/*
+ * Records are formatted on caller's thread into its own (stack) buffer and pushed
+ * into bounded multi-producer/single-consumer ring: each slot has sequence number
+ * telling whether it's free for producer of given round or filled for consumer,
+ * so producers only contend on one CAS of 'tail' and never block. Sequence is
+ * kept relative to slot index, so zeroed ring is valid and needs no initialization. Background
+ * writer drains the ring and writes records in batches. If ring is full or rate
+ * is exceeded, record is dropped and counted; writer reports such losses.
+ *
+ * Fatal records are written synchronously, since process is about to abort.
+ */
+
+typedef struct {
+    unsigned seq;   /* minus slot index */
+    int prio;
+    int len;
+    char text[CRYSTAX_LOG_RECORD_SIZE];
+} log_record_t;
+
+static log_record_t log_ring[CRYSTAX_LOG_RING_SIZE];
+static unsigned log_tail = 0;
+static unsigned log_head = 0;
+
+static unsigned long log_dropped_full = 0;
+static unsigned long log_dropped_rate = 0;
+
+static int log_writer_state = 0; /* 0 - not started, 1 - starting, 2 - running, 3 - stopped */
+static int log_writer_sleeping = 0;
+static int log_writer_stopping = 0;
+static int log_hooks_installed = 0;
+static pthread_t log_writer;
+static sem_t log_wakeup;
+
+#if CRYSTAX_LOG_RATE > 0
+/* GCRA: theoretical arrival time of next record, in nanoseconds */
+static uint64_t log_tat = 0;
+
+static uint64_t log_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+static int log_rate_allowed()
+{
+#if CRYSTAX_LOG_RATE > 0
+    const uint64_t interval = 1000000000ULL / CRYSTAX_LOG_RATE;
+    const uint64_t tolerance = interval * CRYSTAX_LOG_BURST;
+    uint64_t now = log_now();
+    uint64_t tat = __atomic_load_n(&log_tat, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        uint64_t next = (tat > now ? tat : now) + interval;
+        if (next - now > tolerance)
+            return 0;
+        if (__atomic_compare_exchange_n(&log_tat, &tat, next, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            return 1;
+    }
+#else
+    return 1;
+#endif
+}
+
+static int log_push(int prio, const char *text, int len)
+{
+    unsigned pos = __atomic_load_n(&log_tail, __ATOMIC_RELAXED);
+    log_record_t *r;
+
+    for (;;)
+    {
+        unsigned idx = pos & (CRYSTAX_LOG_RING_SIZE - 1);
+        int diff;
+        r = &log_ring[idx];
+        diff = (int)(__atomic_load_n(&r->seq, __ATOMIC_ACQUIRE) + idx - pos);
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&log_tail, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (diff < 0)
+            return -1;
+        else
+            pos = __atomic_load_n(&log_tail, __ATOMIC_RELAXED);
+    }
+
+    r->prio = prio;
+    r->len = len;
+    memcpy(r->text, text, len);
+    __atomic_store_n(&r->seq, pos + 1 - (pos & (CRYSTAX_LOG_RING_SIZE - 1)), __ATOMIC_RELEASE);
+    return 0;
+}
+
+static int log_pop(log_record_t *out)
+{
+    unsigned idx = log_head & (CRYSTAX_LOG_RING_SIZE - 1);
+    log_record_t *r = &log_ring[idx];
+    if (__atomic_load_n(&r->seq, __ATOMIC_ACQUIRE) + idx != log_head + 1)
+        return 0;
+
+    out->prio = r->prio;
+    out->len = r->len;
+    memcpy(out->text, r->text, r->len);
+    __atomic_store_n(&r->seq, log_head + CRYSTAX_LOG_RING_SIZE - idx, __ATOMIC_RELEASE);
+    /* Only writer changes it, but others may look how far it got */
+    __atomic_store_n(&log_head, log_head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+static void log_write(int prio, const char *text, int len)
+{
+    fwrite(text, 1, len, prio < CRYSTAX_LOGLEVEL_WARN ? stdout : stderr);
+}
+
+static void log_report_drops(unsigned long *full, unsigned long *rate)
+{
+    unsigned long f = __atomic_load_n(&log_dropped_full, __ATOMIC_RELAXED);
+    unsigned long r = __atomic_load_n(&log_dropped_rate, __ATOMIC_RELAXED);
+    if (f == *full && r == *rate)
+        return;
+
+    fprintf(stderr, "CRYSTAX_WARN: log records dropped: %lu (ring full), %lu (rate limit)\n",
+        f - *full, r - *rate);
+    *full = f;
+    *rate = r;
+}
+
+/* Return number of records written */
+static int log_drain(unsigned long *full, unsigned long *rate)
+{
+    log_record_t rec;
+    int n;
+
+    for (n = 0; log_pop(&rec); ++n)
+        log_write(rec.prio, rec.text, rec.len);
+    log_report_drops(full, rate);
+    if (n > 0)
+    {
+        fflush(stdout);
+        fflush(stderr);
+    }
+    return n;
+}
+
+static void *log_writer_run(void *arg)
+{
+    unsigned long full = 0, rate = 0;
+
+    (void)arg;
+
+    for (;;)
+    {
+        if (log_drain(&full, &rate) > 0)
+            continue;
+
+        if (__atomic_load_n(&log_writer_stopping, __ATOMIC_ACQUIRE))
+            break;
+
+        /* Announce we're going to sleep, then check again so no wakeup is lost */
+        __atomic_store_n(&log_writer_sleeping, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (log_drain(&full, &rate) > 0 || __atomic_load_n(&log_writer_stopping, __ATOMIC_SEQ_CST))
+        {
+            __atomic_store_n(&log_writer_sleeping, 0, __ATOMIC_RELAXED);
+            continue;
+        }
+        while (sem_wait(&log_wakeup) != 0 && errno == EINTR);
+    }
+
+    return NULL;
+}
+
+static void log_wake_writer()
+{
+    /* Pairs with fence in writer: either it sees our record or we see it sleeping */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&log_writer_sleeping, __ATOMIC_SEQ_CST) &&
+        __atomic_exchange_n(&log_writer_sleeping, 0, __ATOMIC_SEQ_CST))
+        sem_post(&log_wakeup);
+}
+
+static void log_stop_writer()
+{
+    if (__atomic_load_n(&log_writer_state, __ATOMIC_ACQUIRE) != 2)
+        return;
+
+    __atomic_store_n(&log_writer_stopping, 1, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&log_writer_sleeping, 0, __ATOMIC_SEQ_CST);
+    sem_post(&log_wakeup);
+    pthread_join(log_writer, NULL);
+
+    /* Anything logged from now on is written synchronously */
+    __atomic_store_n(&log_writer_state, 3, __ATOMIC_RELEASE);
+}
+
+static void log_forget_writer()
+{
+    unsigned i;
+
+    /*
+     * Writer thread doesn't survive fork; child starts its own on demand. Records
+     * still in ring are parent's to write, and slots other threads were filling
+     * at fork would never be completed, so child starts with empty ring.
+     */
+    for (i = 0; i < CRYSTAX_LOG_RING_SIZE; ++i)
+        log_ring[i].seq = 0;
+    log_head = 0;
+    log_tail = 0;
+    log_dropped_full = 0;
+    log_dropped_rate = 0;
+#if CRYSTAX_LOG_RATE > 0
+    log_tat = 0;
+#endif
+
+    log_writer_state = 0;
+    log_writer_sleeping = 0;
+    log_writer_stopping = 0;
+}
+
+static void log_start_writer()
+{
+    int state = 0;
+    if (__atomic_load_n(&log_writer_state, __ATOMIC_ACQUIRE) != 0)
+        return;
+    /* Not pthread_once: starting thread could log itself, which must not deadlock */
+    if (!__atomic_compare_exchange_n(&log_writer_state, &state, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return;
+
+    if (sem_init(&log_wakeup, 0, 0) != 0 || pthread_create(&log_writer, NULL, &log_writer_run, NULL) != 0)
+    {
+        fprintf(stderr, "CRYSTAX_PANI: can't start log writer\n");
+        abort();
+    }
+
+    if (!log_hooks_installed)
+    {
+        log_hooks_installed = 1;
+        atexit(&log_stop_writer);
+        pthread_atfork(NULL, NULL, &log_forget_writer);
+    }
+    __atomic_store_n(&log_writer_state, 2, __ATOMIC_RELEASE);
+}
+
+static int __crystax_vlog_async(int prio, const char *tag, const char *fmt, va_list ap)
+{
+    char buf[CRYSTAX_LOG_RECORD_SIZE];
+    int len, rc;
+
+    len = snprintf(buf, sizeof(buf), "%s: ", tag);
+    if (len < 0 || len >= (int)sizeof(buf) - 1)
+        len = 0;
+    rc = vsnprintf(buf + len, sizeof(buf) - len - 1, fmt, ap);
+    if (rc < 0)
+        return rc;
+    len += rc < (int)(sizeof(buf) - len - 1) ? rc : (int)(sizeof(buf) - len - 2);
+    buf[len++] = '\n';
+
+    if (prio >= CRYSTAX_LOGLEVEL_PANI || __atomic_load_n(&log_writer_state, __ATOMIC_ACQUIRE) == 3)
+    {
+        log_write(prio, buf, len);
+        fflush(prio < CRYSTAX_LOGLEVEL_WARN ? stdout : stderr);
+        return len;
+    }
+
+    if (prio < CRYSTAX_LOGLEVEL_WARN && !log_rate_allowed())
+    {
+        __atomic_add_fetch(&log_dropped_rate, 1, __ATOMIC_RELAXED);
+        return len;
+    }
+
+    if (log_push(prio, buf, len) < 0)
+        __atomic_add_fetch(&log_dropped_full, 1, __ATOMIC_RELAXED);
+
+    log_start_writer();
+    log_wake_writer();
+    return len;
+}
+#endif /* CRYSTAX_LOG_SINK_ASYNC */
+
 const char *__crystax_log_short_file(const char *f)
 {
     int const MAXLEN = 25;
@@ -118,6 +426,8 @@ int __crystax_log(int prio, const char *tag,  const char *fmt, ...)
     va_start(ap, fmt);
 #if CRYSTAX_LOG_SINK == CRYSTAX_LOG_SINK_LOGCAT
     rc = __crystax_vlogcat(prio, tag, fmt, ap);
+#elif CRYSTAX_LOG_SINK == CRYSTAX_LOG_SINK_ASYNC
+    rc = __crystax_vlog_async(prio, tag, fmt, ap);
 #elif CRYSTAX_LOG_SINK == CRYSTAX_LOG_SINK_STDOUT
     rc = vfprintf(prio < CRYSTAX_LOGLEVEL_WARN ? stdout : stderr, newfmt, ap);
     fflush(prio < CRYSTAX_LOGLEVEL_WARN ? stdout : stderr);
@@ -37,24 +37,69 @@
 
 __BEGIN_DECLS
 
+/*
+ * Locale data is generated by bin/gen-locales into constant tables, so it lives
+ * in .rodata entirely: it needs no initialization or relocations at load time,
+ * and pages of locales nobody uses are never touched.
+ */
+
+/* Blob encodings, chosen by bin/gen-locales --codec */
+enum {
+    __CRYSTAX_LOCALE_STORED = 0,
+    __CRYSTAX_LOCALE_BZIP2  = 1,
+    __CRYSTAX_LOCALE_LZ4    = 2     /* LZ4 block format, no frame */
+};
+
 typedef struct {
-    uint8_t *data;
-    size_t size;
-    int compressed;
+    uint32_t offset;        /* in __crystax_locale_table_t::blobs */
+    uint32_t size;
+    uint32_t usize;         /* size after decoding */
+    uint32_t codec;
 } __crystax_locale_blob_t;
 
 typedef struct {
-    const char *encoding;
-    struct {
-        const char *alias;
-        __crystax_locale_blob_t blob;
-    } data[_LC_LAST];
+    uint32_t name;              /* in __crystax_locale_table_t::names */
+    /* Index of blob plus one, or 0 if there is no data. Aliases are resolved by generator already */
+    uint16_t blob[_LC_LAST];
 } __crystax_locale_data_t;
 
-int __crystax_locale_init();
+typedef struct {
+    const uint8_t *blobs;
+    const __crystax_locale_blob_t *blob;
+    void **cache;           /* decoded copies of blobs, published once and never freed */
+    size_t nblobs;
 
-size_t __crystax_locale_table_size();
-__crystax_locale_data_t * __crystax_locale_data(size_t idx);
+    const char *names;
+    const __crystax_locale_data_t *data;
+    size_t size;
+
+    /*
+     * Perfect hash of encoding names: name goes to bucket
+     * __crystax_locale_hash(name, 0) % nseeds, then to slot
+     * __crystax_locale_hash(name, seeds[bucket]) % nslots, which holds index
+     * in 'data' or -1. Names not in table still have to be checked by strcmp.
+     */
+    const uint16_t *seeds;
+    size_t nseeds;
+    const int16_t *slots;
+    size_t nslots;
+} __crystax_locale_table_t;
+
+/* FNV-1a; must match one used by bin/gen-locales */
+static __inline__ uint32_t __crystax_locale_hash(const char *s, uint32_t seed)
+{
+    uint32_t h = 2166136261U ^ seed;
+    for (; *s; ++s)
+    {
+        h ^= (uint8_t)*s;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+const __crystax_locale_table_t *__crystax_locale_table();
+
+int __crystax_locale_init();
 
 int __crystax_locale_load(const char *encoding, int type, void **buf, size_t *bufsize);
 int __crystax_locale_loads(const char *encoding, const char *type, void **buf, size_t *bufsize);
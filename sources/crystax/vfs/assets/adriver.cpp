@@ -28,6 +28,7 @@
  */
 
 #include "assets/driver.hpp"
+#include "system/driver.hpp"
 
 #define METADATA_V1 1
 
@@ -86,7 +87,8 @@ static void dump_stat(struct stat const &st)
 }
 #endif
 
-static void fill_stat(JNIEnv *env, jhobject const &objContext, fileio::driver_t *d, struct stat *st)
+static void fill_stat(JNIEnv *env, jhobject const &objContext, fileio::driver_t *d, struct stat *st,
+    abspath_t *apkpath, bool *splits)
 {
     jmethodID midContextGetPackageName = get_method_id(
         env, objContext, "getPackageName", "()Ljava/lang/String;");
@@ -121,6 +123,31 @@ static void fill_stat(JNIEnv *env, jhobject const &objContext, fileio::driver_t
     JCHECK;
     DBG("datadir=%s", datadir.c_str());
 
+    jfieldID fidAppInfoSourceDir = get_field_id(
+        env, objApplicationInfo, "sourceDir", "Ljava/lang/String;");
+    JCHECK;
+    jhstring objSourceDir((jstring)env->GetObjectField(objApplicationInfo.get(), fidAppInfoSourceDir));
+    JCHECK;
+
+    apkpath->reset(jcast<const char *>(objSourceDir));
+    JCHECK;
+    DBG("apkpath=%s", apkpath->c_str());
+
+    // There is no such field before Lollipop
+    *splits = false;
+    jfieldID fidAppInfoSplitSourceDirs = get_field_id(
+        env, objApplicationInfo, "splitSourceDirs", "[Ljava/lang/String;");
+    if (env->ExceptionCheck())
+        env->ExceptionClear();
+    else if (fidAppInfoSplitSourceDirs)
+    {
+        jhobjectArray objSplits((jobjectArray)env->GetObjectField(objApplicationInfo.get(),
+            fidAppInfoSplitSourceDirs));
+        JCHECK;
+        *splits = objSplits && env->GetArrayLength(objSplits.get()) > 0;
+    }
+    DBG("splits=%s", *splits ? "yes" : "no");
+
     char *s = (char *)::malloc(datadir.length() + 5);
     ::strcpy(s, datadir.c_str());
     ::strcat(s, "/lib");
@@ -184,6 +211,54 @@ void driver_t::init_jni(JNIEnv *env, jhobject const &objContext)
     JCHECK;
 }
 
+/*
+ * Add 'content' of assets directory 'dir' (relative, empty for root) to builder,
+ * recursively. That's one AssetManager.list() call per entry, so it's used only if
+ * APK can't be indexed directly. Sizes of files are left unknown: they're requested
+ * on first stat().
+ */
+CRYSTAX_LOCAL
+bool driver_t::list_assets(JNIEnv *env, dir_tree_t::builder_t &builder, const char *dir,
+    jhobjectArray const &content)
+{
+    if (!content)
+        return true;
+
+    size_t dirlen = ::strlen(dir);
+    jsize count = env->GetArrayLength(content.get());
+    for (jsize i = 0; i != count; ++i)
+    {
+        jhstring objName((jstring)env->GetObjectArrayElement(content.get(), i));
+        JCHECK;
+        scope_c_ptr_t<const char> name(jcast<const char *>(objName));
+        size_t namelen = ::strlen(name.get());
+
+        scope_c_ptr_t<char> path((char *)::malloc(dirlen + namelen + 2));
+        size_t len = 0;
+        if (dirlen > 0)
+        {
+            ::memcpy(path.get(), dir, dirlen);
+            path[dirlen] = '/';
+            len = dirlen + 1;
+        }
+        ::memcpy(path.get() + len, name.get(), namelen + 1);
+        len += namelen;
+
+        // list() of file gives empty array
+        jhobjectArray objArray = jni::call_method<jhobjectArray>(env, objAssetManager, midAmList,
+            jni::jcast<jhstring>((const char *)path.get()));
+        env->ExceptionClear();
+        bool isdir = objArray && env->GetArrayLength(objArray.get()) > 0;
+
+        if (!builder.add(path.get(), len, isdir ? DT_DIR : DT_REG))
+            return false;
+        if (isdir && !list_assets(env, builder, path.get(), objArray))
+            return false;
+    }
+
+    return true;
+}
+
 CRYSTAX_LOCAL
 bool driver_t::read_metadata_entry(int fd, abspath_t *abspath, bool *removed)
 {
@@ -332,7 +407,8 @@ bool driver_t::metadata_comparator(metadata_entry_t const &e, const char *path)
 
 CRYSTAX_LOCAL
 driver_t::driver_t(const char *root, jobject obj, fileio::driver_t *d)
-    :fileio::driver_t(root, d)
+    :fileio::driver_t(root, d), apk(NULL), tree(NULL),
+    prefetch_started(false), prefetch_stopping(false), spare_buffer(NULL)
 {
     pthread_mutexattr_t attr;
     if (::pthread_mutexattr_init(&attr) != 0)
@@ -347,9 +423,47 @@ driver_t::driver_t(const char *root, jobject obj, fileio::driver_t *d)
     JNIEnv *env = jnienv();
 
     jhobject objContext(obj);
-    fill_stat(env, objContext, underlying(), &sst);
+    abspath_t apkpath;
+    bool splits;
+    fill_stat(env, objContext, underlying(), &sst, &apkpath, &splits);
     init_jni(env, objContext);
 
+    // Read assets straight from APK when possible: it's much cheaper than going through
+    // JNI, and seeking inside of deflated entries is backed by checkpoint indexes
+    apk = zip::package_t::open(apkpath.c_str());
+    if (!apk)
+        DBG("can't map %s, use AssetManager", apkpath.c_str());
+
+    // Assets of split APKs are overlaid by AssetManager, so central directory of base
+    // APK is enough only if there are no splits
+    if (apk && !splits)
+        tree = apk->tree("assets", 6);
+    if (!tree)
+    {
+        dir_tree_t::builder_t builder;
+        jhobjectArray objArray = jni::call_method<jhobjectArray>(env, objAssetManager, midAmList,
+            jni::jcast<jhstring>(""));
+        env->ExceptionClear();
+        if (list_assets(env, builder, "", objArray))
+            tree = builder.build();
+    }
+    if (!tree)
+    {
+        ERR("can't build metadata of assets");
+        ::abort();
+    }
+    DBG("%u assets metadata entries", (unsigned)tree->count());
+
+    if (::pthread_mutex_init(&tree_mutex, &attr) != 0)
+        ::abort();
+
+    if (::pthread_mutex_init(&copy_mutex, NULL) != 0)
+        ::abort();
+    if (::pthread_cond_init(&copy_cond, NULL) != 0)
+        ::abort();
+    if (::pthread_cond_init(&prefetch_cond, NULL) != 0)
+        ::abort();
+
     if (::pthread_mutex_init(&metadata_mutex, &attr) != 0)
         ::abort();
     //load_metadata();
@@ -361,8 +475,36 @@ driver_t::driver_t(const char *root, jobject obj, fileio::driver_t *d)
 CRYSTAX_LOCAL
 driver_t::~driver_t()
 {
+    {
+        scope_lock_t lock(copy_mutex);
+        prefetch_stopping = true;
+        ::pthread_cond_signal(&prefetch_cond);
+    }
+    if (prefetch_started)
+        ::pthread_join(prefetch_thread, NULL);
+    prefetch_queue.clear();
+
+    if (spare_buffer)
+        free_buffer(spare_buffer);
+
+    if (::pthread_cond_destroy(&prefetch_cond) != 0)
+        ::abort();
+    if (::pthread_cond_destroy(&copy_cond) != 0)
+        ::abort();
+    if (::pthread_mutex_destroy(&copy_mutex) != 0)
+        ::abort();
+
     jnienv()->DeleteGlobalRef(objAssetManager);
 
+    for (size_t fd = 0; fd != sizeof(fd_table)/sizeof(fd_table[0]); ++fd)
+        if (fd_table[fd].file)
+            fd_table[fd].file->release();
+    delete apk;
+    delete tree;
+
+    if (::pthread_mutex_destroy(&tree_mutex) != 0)
+        ::abort();
+
     if (::pthread_mutex_destroy(&fd_table_mutex) != 0)
         ::abort();
     if (::pthread_mutex_destroy(&metadata_mutex) != 0)
@@ -380,6 +522,7 @@ void driver_t::init_fd()
         e.pos = 0;
         e.size = 0;
         e.extfd = -1;
+        e.file = NULL;
         e.path.reset();
     }
 }
@@ -396,7 +539,7 @@ int driver_t::alloc_fd(jobject obj, size_t size, abspath_t const &abspath)
     for (size_t fd = 0; fd != sizeof(fd_table)/sizeof(fd_table[0]); ++fd)
     {
         fd_entry_t &e = fd_table[fd];
-        if (e.obj != NULL || e.extfd != -1)
+        if (e.obj != NULL || e.extfd != -1 || e.file != NULL)
             continue;
 
         DBG("NewGlobalRef for obj %p", obj);
@@ -404,6 +547,7 @@ int driver_t::alloc_fd(jobject obj, size_t size, abspath_t const &abspath)
         e.pos = 0;
         e.size = size;
         e.extfd = -1;
+        e.file = NULL;
         e.path.reset(::strdup(abspath.c_str()));
         return fd;
     }
@@ -422,13 +566,40 @@ int driver_t::alloc_fd(int extfd, abspath_t const &abspath)
     for (size_t fd = 0; fd != sizeof(fd_table)/sizeof(fd_table[0]); ++fd)
     {
         fd_entry_t &e = fd_table[fd];
-        if (e.obj != NULL || e.extfd != -1)
+        if (e.obj != NULL || e.extfd != -1 || e.file != NULL)
             continue;
 
         e.obj = NULL;
         e.pos = 0;
         e.size = 0;
         e.extfd = extfd;
+        e.file = NULL;
+        e.path.reset(::strdup(abspath.c_str()));
+        return fd;
+    }
+
+    return -1;
+}
+
+CRYSTAX_LOCAL
+int driver_t::alloc_fd(zip::file_t *file, abspath_t const &abspath)
+{
+    DBG("file=%p", file);
+    if (file == NULL)
+        return -1;
+
+    scope_lock_t lock(fd_table_mutex);
+    for (size_t fd = 0; fd != sizeof(fd_table)/sizeof(fd_table[0]); ++fd)
+    {
+        fd_entry_t &e = fd_table[fd];
+        if (e.obj != NULL || e.extfd != -1 || e.file != NULL)
+            continue;
+
+        e.obj = NULL;
+        e.pos = 0;
+        e.size = file->size();
+        e.extfd = -1;
+        e.file = file;
         e.path.reset(::strdup(abspath.c_str()));
         return fd;
     }
@@ -450,10 +621,13 @@ void driver_t::free_fd(int fd)
     fd_entry_t &e = fd_table[fd];
     if (e.obj)
         env->DeleteGlobalRef(e.obj);
+    if (e.file)
+        e.file->release();
     e.obj = NULL;
     e.pos = 0;
     e.size = 0;
     e.extfd = -1;
+    e.file = NULL;
     e.path.reset();
 }
 
@@ -489,6 +663,58 @@ bool driver_t::update(int fd, size_t pos)
     return true;
 }
 
+/*
+ * Return entry of APK opened by fd with extra reference (caller must release it),
+ * or NULL if fd is served some other way.
+ */
+CRYSTAX_LOCAL
+zip::file_t *driver_t::acquire(int fd)
+{
+    if (fd < 0 || (size_t)fd >= sizeof(fd_table)/sizeof(fd_table[0]))
+        return NULL;
+
+    scope_lock_t lock(fd_table_mutex);
+
+    zip::file_t *file = fd_table[fd].file;
+    if (file)
+        file->retain();
+    return file;
+}
+
+CRYSTAX_LOCAL
+zip::entry_t const *driver_t::find_apk(path_t const &rpath)
+{
+    if (!apk)
+        return NULL;
+
+    char name[PATH_MAX + 8];
+    size_t length = rpath.length();
+    if (length + 8 > sizeof(name))
+        return NULL;
+    ::memcpy(name, "assets/", 7);
+    ::memcpy(name + 7, rpath.c_str(), length + 1);
+
+    return apk->archive().find(name, length + 7);
+}
+
+CRYSTAX_LOCAL
+zip::file_t *driver_t::open_apk(path_t const &rpath)
+{
+    zip::entry_t const *e = find_apk(rpath);
+    if (!e)
+        return NULL;
+
+    zip::file_t *file = new zip::file_t(*apk, *e);
+    if (!file->valid())
+    {
+        DBG("can't read %s from APK", rpath.c_str());
+        file->release();
+        return NULL;
+    }
+
+    return file;
+}
+
 CRYSTAX_LOCAL
 bool driver_t::check_subpath(abspath_t const &abspath)
 {
@@ -549,88 +775,366 @@ CRYSTAX_LOCAL
 int driver_t::closedir(DIR *dirp)
 {
     TRACE;
-    return underlying()->closedir(dirp);
+    dir_t *d = reinterpret_cast<dir_t *>(dirp);
+    int ret = d->ext ? underlying()->closedir(d->ext) : 0;
+    delete d->stream;
+    delete d;
+    return ret;
 }
 
+/*
+ * Large buffer for copying assets out: plain memory, plus Java array of the same
+ * size if asset is read through AssetManager. Driver keeps one spare buffer, so
+ * they're not reallocated for every copied file.
+ */
+struct driver_t::copy_buffer_t
+{
+    char *data;
+    jbyteArray array;
+};
+
+CRYSTAX_LOCAL
+driver_t::copy_buffer_t *driver_t::take_buffer()
+{
+    copy_buffer_t *b = __atomic_exchange_n(&spare_buffer, (copy_buffer_t *)NULL, __ATOMIC_ACQ_REL);
+    if (b)
+        return b;
+
+    b = new copy_buffer_t;
+    b->data = (char *)::malloc(CRYSTAX_ASSETS_COPY_BUFFER_SIZE);
+    b->array = NULL;
+    if (!b->data)
+    {
+        delete b;
+        errno = ENOMEM;
+        return NULL;
+    }
+    return b;
+}
+
+CRYSTAX_LOCAL
+void driver_t::give_buffer(copy_buffer_t *b)
+{
+    copy_buffer_t *expected = NULL;
+    if (!__atomic_compare_exchange_n(&spare_buffer, &expected, b, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        free_buffer(b);
+}
+
+CRYSTAX_LOCAL
+void driver_t::free_buffer(copy_buffer_t *b)
+{
+    if (b->array)
+        jnienv()->DeleteGlobalRef(b->array);
+    ::free(b->data);
+    delete b;
+}
+
+CRYSTAX_LOCAL
+bool driver_t::copy_comparator(copy_entry_t const &e, abspath_t const *path)
+{
+    return e.path == *path;
+}
+
+/*
+ * Materialize asset on underlying file system, unless it's there already. Copies
+ * of the same file made concurrently (e.g. by prefetch thread) are serialized.
+ */
 CRYSTAX_LOCAL
 bool driver_t::copy_from_assets(abspath_t const &abspath, path_t const &rpath)
 {
     DBG("abspath=%s, rpath=%s", abspath.c_str(), rpath.c_str());
+
+    copy_entry_t *entry;
+    {
+        scope_lock_t lock(copy_mutex);
+        while (copying.find(&copy_comparator, &abspath))
+            ::pthread_cond_wait(&copy_cond, &copy_mutex);
+
+        struct stat st;
+        if (underlying()->stat(abspath.c_str(), &st) == 0)
+        {
+            DBG("copied already");
+            return true;
+        }
+
+        entry = new copy_entry_t(abspath.c_str());
+        copying.push_back(entry);
+    }
+
+    bool ok = copy_up(abspath, rpath);
+    int save_errno = errno;
+
+    {
+        scope_lock_t lock(copy_mutex);
+        delete copying.pop(entry);
+        ::pthread_cond_broadcast(&copy_cond);
+    }
+
+    errno = save_errno;
+    return ok;
+}
+
+/*
+ * Copy asset to temporary file beside its final place, then rename it, so
+ * interrupted copy is never taken for complete one. Content is taken right from
+ * mapped APK if possible, and streamed through AssetManager otherwise.
+ */
+CRYSTAX_LOCAL
+bool driver_t::copy_up(abspath_t const &abspath, path_t const &rpath)
+{
     abspath_t dir(abspath.dirname());
     if (mkdir_p(dir, S_IRWXU) != 0)
+        return false;
+
+    dir_tree_t::node_t const *n = tree->lookup(rpath.c_str(), rpath.length());
+    if (!n || n->type != DT_REG)
     {
-        TRACE;
+        errno = ENOENT;
         return false;
     }
 
-    TRACE;
+    static const char suffix[] = ".copy-up";
+    scope_c_ptr_t<char> tmp((char *)::malloc(abspath.length() + sizeof(suffix)));
+    ::memcpy(tmp.get(), abspath.c_str(), abspath.length());
+    ::memcpy(tmp.get() + abspath.length(), suffix, sizeof(suffix));
+
+    int fd = underlying()->open(tmp.get(), O_WRONLY|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR);
+    DBG("fd=%d", fd);
+    if (fd == -1)
+        return false;
+
+#if CRYSTAX_ASSETS_COPY_FALLOCATE
+    // Only descriptors of system driver are kernel ones; it's just a hint, so errors are ignored
+    uint64_t size;
+    if (tree->size(*n, &size) && size > 0 && underlying() == system::driver_t::instance())
+        ::posix_fallocate64(fd, 0, (off64_t)size);
+#endif
+
+    zip::entry_t const *e = find_apk(rpath);
+    bool ok = e ? copy_apk(fd, *e) : copy_jni(fd, rpath);
+    int save_errno = errno;
+
+    if (underlying()->close(fd) != 0 && ok)
+    {
+        ok = false;
+        save_errno = errno;
+    }
+    if (ok && underlying()->rename(tmp.get(), abspath.c_str()) != 0)
+    {
+        ok = false;
+        save_errno = errno;
+    }
+    if (!ok)
+        underlying()->unlink(tmp.get());
+
+    errno = save_errno;
+    return ok;
+}
+
+CRYSTAX_LOCAL
+bool driver_t::write_all(int fd, const void *buf, size_t count)
+{
+    const char *p = (const char *)buf;
+    while (count > 0)
+    {
+        ssize_t n = underlying()->write(fd, p, count);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+        {
+            if (n == 0)
+                errno = EIO;
+            return false;
+        }
+        p += n;
+        count -= n;
+    }
+    return true;
+}
+
+CRYSTAX_LOCAL
+bool driver_t::copy_apk(int fd, zip::entry_t const &e)
+{
+    DBG("method=%u, usize=%llu", e.method, (unsigned long long)e.usize);
+
+    if (e.method == zip::STORED)
+    {
+        // Nothing to decode: write straight from mapping
+        const uint8_t *data = apk->archive().data(e);
+        if (!data)
+            return false;
+        for (uint64_t off = 0; off < e.usize;)
+        {
+            size_t chunk = e.usize - off > SSIZE_MAX ? (size_t)SSIZE_MAX : (size_t)(e.usize - off);
+            if (!write_all(fd, data + off, chunk))
+                return false;
+            off += chunk;
+        }
+        return true;
+    }
+
+    zip::file_t *file = new zip::file_t(*apk, e);
+    copy_buffer_t *b = file->valid() ? take_buffer() : NULL;
+    if (!b)
+    {
+        int save_errno = errno;
+        file->release();
+        errno = save_errno;
+        return false;
+    }
+
+    bool ok = true;
+    for (;;)
+    {
+        ssize_t n = file->read(b->data, CRYSTAX_ASSETS_COPY_BUFFER_SIZE);
+        if (n < 0 || (n > 0 && !write_all(fd, b->data, n)))
+            ok = false;
+        if (n <= 0 || !ok)
+            break;
+    }
+
+    int save_errno = errno;
+    give_buffer(b);
+    file->release();
+    errno = save_errno;
+    return ok;
+}
+
+CRYSTAX_LOCAL
+bool driver_t::copy_jni(int fd, path_t const &rpath)
+{
     JNIEnv *env = jnienv();
 
     jhobject objInputStream = jni::call_method<jhobject>(env,
         objAssetManager, midAmOpen, jcast<jhstring>(rpath), ACCESS_STREAMING);
     if (env->ExceptionCheck())
     {
-        TRACE;
         env->ExceptionClear();
         errno = ENOENT;
         return false;
     }
 
-    TRACE;
-    int fd = underlying()->open(abspath.c_str(), O_WRONLY|O_CREAT, S_IRUSR|S_IWUSR);
-    DBG("fd=%d", fd);
-    if (fd == -1)
+    copy_buffer_t *b = take_buffer();
+    if (b && !b->array)
+    {
+        jhbyteArray objArray(env->NewByteArray(CRYSTAX_ASSETS_COPY_BUFFER_SIZE));
+        if (env->ExceptionCheck())
+            env->ExceptionClear();
+        else
+            b->array = (jbyteArray)env->NewGlobalRef(objArray.get());
+        if (!b->array)
+        {
+            free_buffer(b);
+            b = NULL;
+            errno = ENOMEM;
+        }
+    }
+    if (!b)
     {
+        int save_errno = errno;
         jni::call_method<void>(env, objInputStream, midIsClose);
         env->ExceptionClear();
+        errno = save_errno;
         return false;
     }
 
-    char buf[4096];
-    jhbyteArray objArray(env->NewByteArray(sizeof(buf)));
+    bool ok = true;
     for (;;)
     {
-        jint n = jni::call_method<jint>(env, objInputStream, midIsReset, objArray);
-        DBG("n=%d", n);
-        bool success = !env->ExceptionCheck();
-        env->ExceptionClear();
-        if (!success)
+        jint n = env->CallIntMethod(objInputStream.get(), midIsRead, b->array);
+        if (env->ExceptionCheck())
         {
-            TRACE;
-            jni::call_method<void>(env, objInputStream, midIsClose);
             env->ExceptionClear();
-            underlying()->close(fd);
-            errno = EFAULT;
-            return false;
+            errno = EIO;
+            ok = false;
+            break;
         }
-
-        TRACE;
         if (n < 0)
-        {
-            TRACE;
             break;
-        }
 
-        TRACE;
-        env->GetByteArrayRegion(objArray.get(), 0, n, (jbyte*)buf);
-        if (underlying()->write(fd, buf, n) < 0)
+        env->GetByteArrayRegion(b->array, 0, n, (jbyte*)b->data);
+        if (!write_all(fd, b->data, n))
         {
-            TRACE;
-            int save_errno = errno;
-            jni::call_method<void>(env, objInputStream, midIsClose);
-            env->ExceptionClear();
-            underlying()->close(fd);
-            errno = save_errno;
-            return false;
+            ok = false;
+            break;
         }
     }
 
-    TRACE;
+    int save_errno = errno;
+    give_buffer(b);
     jni::call_method<void>(env, objInputStream, midIsClose);
     env->ExceptionClear();
-    underlying()->close(fd);
+    errno = save_errno;
+    return ok;
+}
 
-    return true;
+/*
+ * Queue asset to be copied out by background thread, so opening it for writing
+ * later doesn't wait for copy.
+ */
+CRYSTAX_LOCAL
+int driver_t::prefetch(const char *path)
+{
+    DBG("path=%s", path);
+
+    abspath_t abspath(path);
+    if (!check_subpath(abspath))
+        return -1;
+
+    path_t rpath(abspath.relpath(root()));
+    dir_tree_t::node_t const *n = tree->lookup(rpath.c_str(), rpath.length());
+    if (!n)
+    {
+        errno = ENOENT;
+        return -1;
+    }
+    if (n->type != DT_REG)
+    {
+        errno = EISDIR;
+        return -1;
+    }
+
+    scope_lock_t lock(copy_mutex);
+
+    if (!prefetch_started)
+    {
+        if (::pthread_create(&prefetch_thread, NULL, &prefetch_run, this) != 0)
+            return -1;
+        prefetch_started = true;
+    }
+
+    prefetch_queue.push_back(new copy_entry_t(abspath.c_str()));
+    ::pthread_cond_signal(&prefetch_cond);
+    return 1;
+}
+
+CRYSTAX_LOCAL
+void *driver_t::prefetch_run(void *arg)
+{
+    reinterpret_cast<driver_t *>(arg)->prefetch_loop();
+    return NULL;
+}
+
+CRYSTAX_LOCAL
+void driver_t::prefetch_loop()
+{
+    for (;;)
+    {
+        copy_entry_t *entry;
+        {
+            scope_lock_t lock(copy_mutex);
+            while (prefetch_queue.empty() && !prefetch_stopping)
+                ::pthread_cond_wait(&prefetch_cond, &copy_mutex);
+            if (prefetch_stopping)
+                break;
+            entry = prefetch_queue.pop_front();
+        }
+
+        path_t rpath(entry->path.relpath(root()));
+        if (!copy_from_assets(entry->path, rpath))
+            ERR("can't copy %s out of assets", entry->path.c_str());
+        delete entry;
+    }
 }
 
 CRYSTAX_LOCAL
@@ -732,7 +1236,9 @@ int driver_t::ioctl(int fd, int request, va_list &vl)
         return underlying()->ioctl(extfd, request, vl);
     }
 
-    DBG("use obj=%p", obj);
+    zip::file_t *file = acquire(fd);
+
+    DBG("use obj=%p, file=%p", obj, file);
 
     JNIEnv *env = jnienv();
 
@@ -743,10 +1249,20 @@ int driver_t::ioctl(int fd, int request, va_list &vl)
             int *avail = va_arg(vl, int *);
             if (avail == NULL)
             {
+                if (file)
+                    file->release();
                 errno = EINVAL;
                 return -1;
             }
 
+            if (file)
+            {
+                uint64_t left = file->available();
+                file->release();
+                *avail = left > INT_MAX ? INT_MAX : (int)left;
+                return 0;
+            }
+
             *avail = jni::call_method<jint>(env, obj, midIsAvail);
             if (env->ExceptionCheck())
             {
@@ -759,6 +1275,8 @@ int driver_t::ioctl(int fd, int request, va_list &vl)
         }
         break;
     default:
+        if (file)
+            file->release();
         NOT_IMPLEMENTED;
     }
 }
@@ -802,6 +1320,15 @@ loff_t driver_t::lseek64(int fd, loff_t offset, int whence)
         return underlying()->lseek64(extfd, offset, whence);
     }
 
+    zip::file_t *file = acquire(fd);
+    if (file)
+    {
+        DBG("use file=%p", file);
+        loff_t ret = file->seek(offset, whence);
+        file->release();
+        return ret;
+    }
+
     DBG("use obj=%p", obj);
 
     JNIEnv *env = jnienv();
@@ -928,7 +1455,15 @@ int driver_t::open(const char *path, int oflag, va_list &vl)
 
     bool ul = false;
     struct stat ulst;
-    if (oflag & (O_WRONLY|O_RDWR))
+    if ((oflag & (O_CREAT|O_EXCL|O_TRUNC)) == (O_CREAT|O_TRUNC))
+    {
+        // Content of asset would be thrown away anyway
+        abspath_t dir(abspath.dirname());
+        if (mkdir_p(dir, S_IRWXU) != 0)
+            return -1;
+        ul = true;
+    }
+    else if (oflag & (O_WRONLY|O_RDWR))
     {
         if (!copy_from_assets(abspath, rpath) && errno != ENOENT)
             return -1;
@@ -954,6 +1489,22 @@ int driver_t::open(const char *path, int oflag, va_list &vl)
         return fd;
     }
 
+    zip::file_t *file = open_apk(rpath);
+    if (file)
+    {
+        DBG("read from APK");
+        int fd = alloc_fd(file, abspath);
+        if (fd < 0)
+        {
+            ERR("can't alloc fd");
+            file->release();
+            errno = EMFILE;
+            return -1;
+        }
+        DBG("return fd=%d", fd);
+        return fd;
+    }
+
     JNIEnv *env = jnienv();
 
     jhobject objInputStream = jni::call_method<jhobject>(env, objAssetManager, midAmOpen,
@@ -1011,13 +1562,67 @@ CRYSTAX_LOCAL
 DIR *driver_t::opendir(const char *dirpath)
 {
     DBG("dirpath=%s", dirpath);
-    return underlying()->opendir(dirpath);
+
+    abspath_t abspath(dirpath);
+    if (!check_subpath(abspath))
+        return NULL;
+
+    path_t rpath(abspath.relpath(root()));
+    DBG("rpath=%s", rpath.c_str());
+
+    dir_tree_t::node_t const *n = tree->lookup(rpath.c_str(), rpath.length());
+    if (n && n->type != DT_DIR)
+    {
+        errno = ENOTDIR;
+        return NULL;
+    }
+
+    // Files copied out of assets or created by application
+    DIR *ext = underlying()->opendir(dirpath);
+    if (!n && !ext)
+        return NULL;
+
+    dir_t *d = new dir_t;
+    d->stream = n ? new dir_stream_t(*tree, *n) : NULL;
+    d->ext = ext;
+    return reinterpret_cast<DIR *>(d);
 }
 
 CRYSTAX_LOCAL
-ssize_t driver_t::pread(int /* fd */, void * /* buf */, size_t /* count */, off_t /* offset */)
+ssize_t driver_t::pread(int fd, void *buf, size_t count, off_t offset)
 {
-    NOT_IMPLEMENTED;
+    DBG("fd=%d, count=%u, offset=%lld", fd, (unsigned)count, (long long)offset);
+
+    int extfd;
+    if (!resolve(fd, NULL, NULL, NULL, &extfd, NULL))
+    {
+        ERR("wrong fd passed");
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (extfd != -1)
+    {
+        DBG("use extfd=%d", extfd);
+        return underlying()->pread(extfd, buf, count, offset);
+    }
+
+    zip::file_t *file = acquire(fd);
+    if (!file)
+    {
+        NOT_IMPLEMENTED;
+    }
+
+    if (offset < 0)
+    {
+        file->release();
+        errno = EINVAL;
+        return -1;
+    }
+
+    ssize_t n = file->pread(buf, count, (uint64_t)offset);
+    file->release();
+    return n;
 }
 
 CRYSTAX_LOCAL
@@ -1053,6 +1658,15 @@ ssize_t driver_t::read(int fd, void *buf, size_t count)
         return underlying()->read(extfd, buf, count);
     }
 
+    zip::file_t *file = acquire(fd);
+    if (file)
+    {
+        DBG("use file=%p", file);
+        ssize_t n = file->read(buf, count);
+        file->release();
+        return n;
+    }
+
     DBG("use obj=%p", obj);
     JNIEnv *env = jnienv();
 
@@ -1097,23 +1711,81 @@ ssize_t driver_t::read(int fd, void *buf, size_t count)
 }
 
 CRYSTAX_LOCAL
-int driver_t::readv(int /* fd */, const struct iovec * /* iov */, int /* count */)
+int driver_t::readv(int fd, const struct iovec *iov, int count)
 {
-    NOT_IMPLEMENTED;
+    DBG("fd=%d, count=%d", fd, count);
+
+    int extfd;
+    if (!resolve(fd, NULL, NULL, NULL, &extfd, NULL))
+    {
+        ERR("wrong fd passed");
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (extfd != -1)
+    {
+        DBG("use extfd=%d", extfd);
+        return underlying()->readv(extfd, iov, count);
+    }
+
+    zip::file_t *file = acquire(fd);
+    if (!file)
+    {
+        NOT_IMPLEMENTED;
+    }
+
+    ssize_t n = file->readv(iov, count);
+    file->release();
+    return n;
+}
+
+/*
+ * Return true if entry of underlying directory was listed from assets already.
+ */
+CRYSTAX_LOCAL
+bool driver_t::skip_ul(dir_t const &d, struct dirent const *e) const
+{
+    if (!d.stream)
+        return false;
+    if (::strcmp(e->d_name, ".") == 0 || ::strcmp(e->d_name, "..") == 0)
+        return true;
+    return tree->child(d.stream->node(), e->d_name, ::strlen(e->d_name)) != NULL;
 }
 
 CRYSTAX_LOCAL
 struct dirent *driver_t::readdir(DIR *dirp)
 {
     TRACE;
-    return underlying()->readdir(dirp);
+    dir_t *d = reinterpret_cast<dir_t *>(dirp);
+
+    struct dirent *e = d->stream ? d->stream->read() : NULL;
+    if (e || !d->ext)
+        return e;
+
+    while ((e = underlying()->readdir(d->ext)) != NULL && skip_ul(*d, e));
+    return e;
 }
 
 CRYSTAX_LOCAL
 int driver_t::readdir_r(DIR *dirp, struct dirent *entry, struct dirent **result)
 {
     TRACE;
-    return underlying()->readdir_r(dirp, entry, result);
+    dir_t *d = reinterpret_cast<dir_t *>(dirp);
+
+    if (d->stream)
+    {
+        d->stream->read_r(entry, result);
+        if (*result || !d->ext)
+            return 0;
+    }
+
+    for (;;)
+    {
+        int ret = underlying()->readdir_r(d->ext, entry, result);
+        if (ret != 0 || !*result || !skip_ul(*d, *result))
+            return ret;
+    }
 }
 
 CRYSTAX_LOCAL
@@ -1168,9 +1840,13 @@ int driver_t::rename(const char *oldpath, const char *newpath)
 }
 
 CRYSTAX_LOCAL
-void driver_t::rewinddir(DIR * /* dirp */)
+void driver_t::rewinddir(DIR *dirp)
 {
-    NOT_IMPLEMENTED_BASE;
+    dir_t *d = reinterpret_cast<dir_t *>(dirp);
+    if (d->stream)
+        d->stream->rewind();
+    if (d->ext)
+        underlying()->rewinddir(d->ext);
 }
 
 CRYSTAX_LOCAL
@@ -1181,16 +1857,77 @@ int driver_t::rmdir(const char *path)
 }
 
 CRYSTAX_LOCAL
-int driver_t::scandir(const char * /* dir */, struct dirent *** /* namelist */, int (* /* filter */)(const struct dirent *),
-    int (* /* compar */)(const struct dirent **, const struct dirent **))
+int driver_t::scandir(const char *dir, struct dirent ***namelist, int (*filter)(const struct dirent *),
+    int (*compar)(const struct dirent **, const struct dirent **))
 {
-    NOT_IMPLEMENTED;
+    DBG("dir=%s", dir);
+
+    DIR *dirp = opendir(dir);
+    if (!dirp)
+        return -1;
+
+    dir_t *d = reinterpret_cast<dir_t *>(dirp);
+    if (!d->ext)
+    {
+        // Pure assets directory, answer right from metadata
+        int ret = tree->scandir(d->stream->node(), namelist, filter, compar);
+        closedir(dirp);
+        return ret;
+    }
+
+    size_t n = 0, capacity = 0;
+    struct dirent **list = NULL;
+    for (struct dirent *e; (e = readdir(dirp)) != NULL;)
+    {
+        if (filter && !filter(e))
+            continue;
+
+        struct dirent *copy = (struct dirent *)::malloc(sizeof(struct dirent));
+        if (copy && n == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 32;
+            struct dirent **l = (struct dirent **)::realloc(list, capacity * sizeof(struct dirent *));
+            if (!l)
+            {
+                ::free(copy);
+                copy = NULL;
+            }
+            else
+                list = l;
+        }
+        if (!copy)
+        {
+            while (n > 0)
+                ::free(list[--n]);
+            ::free(list);
+            closedir(dirp);
+            errno = ENOMEM;
+            return -1;
+        }
+
+        ::memset(copy, 0, sizeof(struct dirent));
+        ::memcpy(copy, e, e->d_reclen < sizeof(struct dirent) ? e->d_reclen : sizeof(struct dirent));
+        list[n++] = copy;
+    }
+    closedir(dirp);
+
+    if (compar)
+        ::qsort(list, n, sizeof(struct dirent *), (int (*)(const void *, const void *))compar);
+
+    *namelist = list;
+    return (int)n;
 }
 
 CRYSTAX_LOCAL
-void driver_t::seekdir(DIR * /* dirp */, long /* offset */)
+void driver_t::seekdir(DIR *dirp, long offset)
 {
-    NOT_IMPLEMENTED_BASE;
+    dir_t *d = reinterpret_cast<dir_t *>(dirp);
+    if (d->ext)
+    {
+        NOT_IMPLEMENTED_BASE;
+        return;
+    }
+    d->stream->seek(offset);
 }
 
 CRYSTAX_LOCAL
@@ -1199,6 +1936,19 @@ int driver_t::select(int /* maxfd */, fd_set * /* rfd */, fd_set * /* wfd */, fd
     NOT_IMPLEMENTED;
 }
 
+/*
+ * Descriptors copied up to underlying filesystem are waited on there; ones served
+ * from APK or AssetManager are always ready.
+ */
+CRYSTAX_LOCAL
+int driver_t::kernel_fd(int fd)
+{
+    int extfd;
+    if (!resolve(fd, NULL, NULL, NULL, &extfd, NULL) || extfd < 0)
+        return -1;
+    return underlying()->kernel_fd(extfd);
+}
+
 CRYSTAX_LOCAL
 int driver_t::stat(const char *path, struct stat *st)
 {
@@ -1243,44 +1993,63 @@ int driver_t::stat(const char *path, struct stat *st)
 CRYSTAX_LOCAL
 int driver_t::stat_as(path_t const &rpath, struct stat *st)
 {
-    JNIEnv *env = jnienv();
-
-    DBG("is it file?");
-    jhstring objPath = jcast<jhstring>(rpath);
-    jhobject objInputStream = jni::call_method<jhobject>(env, objAssetManager, midAmOpen,
-        objPath, ACCESS_STREAMING);
-    env->ExceptionClear();
-    if (objInputStream)
+    dir_tree_t::node_t const *n = tree->lookup(rpath.c_str(), rpath.length());
+    if (!n)
     {
-        DBG("it is file");
-
-        jlong skipped = jni::call_method<jlong>(env, objInputStream, midIsSkip, (jlong)INT_MAX);
-        env->ExceptionClear();
-        jni::call_method<void>(env, objInputStream, midIsClose);
-        env->ExceptionClear();
-
-        ::memcpy(st, &sst, sizeof(struct stat));
-        st->st_mode = S_IFREG|S_IRWXU;
-        st->st_size = (size_t)skipped;
-        dump_stat(*st);
-        return 0;
+        DBG("no such entry");
+        errno = ENOENT;
+        return -1;
     }
 
-    DBG("is it directory?");
-    jhobjectArray objArray = jni::call_method<jhobjectArray>(env, objAssetManager, midAmList, objPath);
-    env->ExceptionClear();
-    if (objArray && env->GetArrayLength(objArray.get()) > 0)
+    ::memcpy(st, &sst, sizeof(struct stat));
+    st->st_ino = tree->index(n) + 1;
+
+    uint64_t size;
+    if (n->type == DT_DIR || !size_as(rpath, *n, &size))
     {
         DBG("it is directory");
-        ::memcpy(st, &sst, sizeof(struct stat));
         st->st_mode = S_IFDIR|S_IRWXU;
         dump_stat(*st);
         return 0;
     }
 
-    DBG("no such entry");
-    errno = ENOENT;
-    return -1;
+    DBG("it is file");
+    st->st_mode = S_IFREG|S_IRWXU;
+    st->st_size = size;
+    dump_stat(*st);
+    return 0;
+}
+
+/*
+ * Get size of asset file. Only if metadata was built from AssetManager listing,
+ * it's not known in advance; then it's learned (once) by skipping through the
+ * whole stream. Return false if asset can't be opened as file: AssetManager.list()
+ * doesn't tell empty directories from files.
+ */
+CRYSTAX_LOCAL
+bool driver_t::size_as(path_t const &rpath, dir_tree_t::node_t const &n, uint64_t *size)
+{
+    if (tree->size(n, size))
+        return true;
+
+    JNIEnv *env = jnienv();
+
+    jhobject objInputStream = jni::call_method<jhobject>(env, objAssetManager, midAmOpen,
+        jcast<jhstring>(rpath), ACCESS_STREAMING);
+    env->ExceptionClear();
+    if (!objInputStream)
+        return false;
+
+    jlong skipped = jni::call_method<jlong>(env, objInputStream, midIsSkip, (jlong)INT_MAX);
+    env->ExceptionClear();
+    jni::call_method<void>(env, objInputStream, midIsClose);
+    env->ExceptionClear();
+
+    *size = (uint64_t)skipped;
+
+    scope_lock_t lock(tree_mutex);
+    tree->set_size(n, *size);
+    return true;
 }
 
 CRYSTAX_LOCAL
@@ -1319,9 +2088,14 @@ int driver_t::symlink(const char * /* src */, const char * /* dst */)
 }
 
 CRYSTAX_LOCAL
-long driver_t::telldir(DIR * /* dirp */)
+long driver_t::telldir(DIR *dirp)
 {
-    NOT_IMPLEMENTED;
+    dir_t *d = reinterpret_cast<dir_t *>(dirp);
+    if (d->ext)
+    {
+        NOT_IMPLEMENTED;
+    }
+    return d->stream->tell();
 }
 
 CRYSTAX_LOCAL
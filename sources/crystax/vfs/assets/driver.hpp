@@ -32,6 +32,16 @@
 
 #include <crystax/list.hpp>
 #include "fileio/driver.hpp"
+#include "zip/package.hpp"
+
+#ifndef CRYSTAX_ASSETS_COPY_BUFFER_SIZE
+#define CRYSTAX_ASSETS_COPY_BUFFER_SIZE (256 * 1024)
+#endif
+
+// Preallocate space for copy of asset on underlying file system
+#ifndef CRYSTAX_ASSETS_COPY_FALLOCATE
+#define CRYSTAX_ASSETS_COPY_FALLOCATE 1
+#endif
 
 namespace crystax
 {
@@ -95,22 +105,45 @@ public:
     ssize_t write(int fd, const void *buf, size_t count);
     int    writev(int fd, const struct iovec *iov, int count);
 
+    int    prefetch(const char *path);
+    int    kernel_fd(int fd);
+
 private:
     void init_jni(JNIEnv *env, jni::jhobject const &objContext);
     bool check_subpath(abspath_t const &abspath);
 
     int stat_as(path_t const &rpath, struct stat *st);
+    bool size_as(path_t const &rpath, dir_tree_t::node_t const &n, uint64_t *size);
+    bool list_assets(JNIEnv *env, dir_tree_t::builder_t &builder, const char *dir,
+        jni::jhobjectArray const &content);
     int stat_ul(abspath_t const &abspath, path_t const &rpath, struct stat *st);
 
     int mkdir_p(abspath_t const &abspath, mode_t mode);
     bool copy_from_assets(abspath_t const &abspath, path_t const &rpath);
+    bool copy_up(abspath_t const &abspath, path_t const &rpath);
+    bool copy_apk(int fd, zip::entry_t const &e);
+    bool copy_jni(int fd, path_t const &rpath);
+    bool write_all(int fd, const void *buf, size_t count);
+
+    struct copy_buffer_t;
+    copy_buffer_t *take_buffer();
+    void give_buffer(copy_buffer_t *b);
+    void free_buffer(copy_buffer_t *b);
+
+    static void *prefetch_run(void *arg);
+    void prefetch_loop();
 
     void init_fd();
     int alloc_fd(jobject obj, size_t size, abspath_t const &abspath);
     int alloc_fd(int extfd, abspath_t const &abspath);
+    int alloc_fd(zip::file_t *file, abspath_t const &abspath);
     void free_fd(int fd);
     bool resolve(int fd, jobject *obj, size_t *pos, size_t *size, int *extfd, abspath_t *abspath);
     bool update(int fd, size_t pos);
+    zip::file_t *acquire(int fd);
+
+    zip::entry_t const *find_apk(path_t const &rpath);
+    zip::file_t *open_apk(path_t const &rpath);
 
     void load_metadata();
     void save_metadata();
@@ -131,12 +164,29 @@ private:
 
     struct stat sst;
 
+    // APK mapped directly, if it's readable; NULL means assets are read through AssetManager
+    zip::package_t *apk;
+
+    // Metadata of all assets, built at mount time
+    dir_tree_t *tree;
+    pthread_mutex_t tree_mutex;
+
+    // Directory stream: assets first, then files which exist only in underlying directory
+    struct dir_t
+    {
+        dir_stream_t *stream;
+        DIR *ext;
+    };
+
+    bool skip_ul(dir_t const &d, struct dirent const *e) const;
+
     struct fd_entry_t
     {
         jobject obj;
         size_t pos;
         size_t size;
         int extfd;
+        zip::file_t *file;
         abspath_t path;
     };
 
@@ -160,6 +210,33 @@ private:
     pthread_mutex_t metadata_mutex;
 
     static bool metadata_comparator(metadata_entry_t const &e, const char *path);
+
+    struct copy_entry_t
+    {
+        abspath_t path;
+
+        copy_entry_t *next;
+        copy_entry_t *prev;
+
+        explicit copy_entry_t(const char *p)
+            :path(p), next(0), prev(0)
+        {}
+    };
+
+    static bool copy_comparator(copy_entry_t const &e, abspath_t const *path);
+
+    // Files being copied right now, and files to be copied by prefetch thread
+    list_t<copy_entry_t> copying;
+    list_t<copy_entry_t> prefetch_queue;
+    pthread_mutex_t copy_mutex;
+    pthread_cond_t copy_cond;
+    pthread_cond_t prefetch_cond;
+    pthread_t prefetch_thread;
+    bool prefetch_started;
+    bool prefetch_stopping;
+
+    // Buffer left by last copy, reused by next one
+    copy_buffer_t *spare_buffer;
 };
 
 } // namespace assets
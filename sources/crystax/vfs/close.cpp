@@ -44,6 +44,7 @@ int close(int fd)
     if (!resolve(fd, NULL, &extfd, NULL, &driver))
         return -1;
 
+    epoll_forget(fd);
     free_fd(fd);
     return driver->close(extfd);
 }
@@ -0,0 +1,449 @@
+/*
+ * Copyright (c) 2011-2015 CrystaX.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice, this list of
+ *       conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *       of conditions and the following disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY CrystaX ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL CrystaX OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those of the
+ * authors and should not be interpreted as representing official policies, either expressed
+ * or implied, of CrystaX.
+ */
+
+#include "fileio/api.hpp"
+#include "fileio/readyset.hpp"
+#include "system/driver.hpp"
+
+#include <sys/eventfd.h>
+#include <time.h>
+
+namespace crystax
+{
+namespace fileio
+{
+
+/*
+ * epoll instances are plain kernel ones, served by system driver. Kernel-backed
+ * descriptors of any driver are registered there directly; memory-backed ones
+ * are kept in ready set of that instance (indexed by its VFS descriptor) and
+ * reported by epoll_wait() along with kernel events. Unless caller asks for a
+ * single event, ready set leaves at least one slot to kernel, so busy memory-backed
+ * descriptors can't starve kernel ones; with a single slot, they take turns.
+ *
+ * Each instance with memory-backed descriptors also has an eventfd registered in
+ * its kernel instance, signalled when such descriptor is added or modified, so
+ * that threads already blocked in epoll_wait() wake up and report it. Kernel
+ * events of that eventfd carry address of the instance's state and aren't passed
+ * to caller.
+ *
+ * For every descriptor, watchers[] lists instances it's registered in as
+ * memory-backed one, so close() only looks at those.
+ */
+struct epoll_state_t
+{
+    epoll_state_t() :wakefd(-1), signalled(false), kernel_turn(false) {}
+
+    ready_set_t set;
+    // eventfd registered in kernel instance, or -1 if it couldn't be created
+    int wakefd;
+    // Whether wakefd is readable
+    bool signalled;
+    // Whether kernel goes first next time caller asks for a single event
+    bool kernel_turn;
+};
+
+struct watchers_t
+{
+    int *epfds;
+    size_t count;
+    size_t capacity;
+};
+
+static epoll_state_t *epoll_states[FD_TABLE_SIZE];
+static watchers_t watchers[FD_TABLE_SIZE];
+static pthread_mutex_t ready_mutex = PTHREAD_MUTEX_INITIALIZER;
+// Number of non-NULL entries in epoll_states; lets close() skip locking if there are none
+static int epoll_states_count = 0;
+
+static bool watch(int fd, int epfd)
+{
+    watchers_t &w = watchers[fd];
+    if (w.count == w.capacity)
+    {
+        size_t n = w.capacity ? w.capacity * 2 : 2;
+        int *p = (int *)::realloc(w.epfds, n * sizeof(int));
+        if (!p)
+            return false;
+        w.epfds = p;
+        w.capacity = n;
+    }
+    w.epfds[w.count++] = epfd;
+    return true;
+}
+
+static void unwatch(int fd, int epfd)
+{
+    watchers_t &w = watchers[fd];
+    for (size_t i = 0; i != w.count; ++i)
+    {
+        if (w.epfds[i] == epfd)
+        {
+            w.epfds[i] = w.epfds[--w.count];
+            break;
+        }
+    }
+    if (w.count == 0)
+    {
+        ::free(w.epfds);
+        w.epfds = NULL;
+        w.capacity = 0;
+    }
+}
+
+static epoll_state_t *epoll_state_create(int kepfd)
+{
+    epoll_state_t *state = new epoll_state_t;
+
+    int wakefd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakefd < 0)
+    {
+        ERR("can't create eventfd, errno=%d; blocked epoll_wait() won't wake up", errno);
+        return state;
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = state;
+    if (system_epoll_ctl(kepfd, EPOLL_CTL_ADD, wakefd, &ev) < 0)
+    {
+        system_close(wakefd);
+        return state;
+    }
+
+    state->wakefd = wakefd;
+    return state;
+}
+
+static void epoll_wake(epoll_state_t *state)
+{
+    if (state->wakefd < 0 || state->signalled)
+        return;
+    uint64_t one = 1;
+    if (system_write(state->wakefd, &one, sizeof(one)) == sizeof(one))
+        state->signalled = true;
+}
+
+/*
+ * Caller is about to look at ready set, so pending wakeup isn't needed anymore;
+ * left signalled, it would take the slot kept for kernel events.
+ */
+static void epoll_unwake(epoll_state_t *state)
+{
+    if (!state->signalled)
+        return;
+    uint64_t value;
+    system_read(state->wakefd, &value, sizeof(value));
+    state->signalled = false;
+}
+
+/*
+ * Drop wakeup events from 'events' and return number of the rest.
+ */
+static int epoll_drop_wakeups(epoll_state_t *state, struct epoll_event *events, int n, bool *woken)
+{
+    int k = 0;
+    for (int i = 0; i != n; ++i)
+    {
+        if (events[i].data.ptr == state)
+        {
+            *woken = true;
+            continue;
+        }
+        events[k++] = events[i];
+    }
+
+    if (*woken)
+        epoll_unwake(state);
+    return k;
+}
+
+static int64_t now_ms()
+{
+    struct timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int epoll_alloc(int epfd)
+{
+    if (epfd < 0)
+        return -1;
+
+    int fd = alloc_fd(NULL, epfd, system::driver_t::instance());
+    if (fd < 0)
+    {
+        system_close(epfd);
+        errno = EMFILE;
+        return -1;
+    }
+
+    DBG("return fd=%d", fd);
+    return fd;
+}
+
+static int epoll_resolve(int epfd)
+{
+    int extfd;
+    driver_t *driver;
+    if (!resolve(epfd, NULL, &extfd, NULL, &driver))
+        return -1;
+
+    int kfd = driver->kernel_fd(extfd);
+    if (kfd < 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    return kfd;
+}
+
+CRYSTAX_LOCAL
+int epoll_create(int size)
+{
+    DBG("size=%d", size);
+    return epoll_alloc(system_epoll_create(size));
+}
+
+CRYSTAX_LOCAL
+int epoll_create1(int flags)
+{
+    DBG("flags=%d", flags);
+    return epoll_alloc(system_epoll_create1(flags));
+}
+
+CRYSTAX_LOCAL
+int epoll_ctl(int epfd, int op, int fd, struct epoll_event *event)
+{
+    DBG("epfd=%d, op=%d, fd=%d, event=%p", epfd, op, fd, event);
+
+    int kepfd = epoll_resolve(epfd);
+    if (kepfd < 0)
+        return -1;
+
+    int extfd;
+    driver_t *driver;
+    if (!resolve(fd, NULL, &extfd, NULL, &driver))
+        return -1;
+
+    int kfd = driver->kernel_fd(extfd);
+    if (kfd >= 0)
+        return system_epoll_ctl(kepfd, op, kfd, event);
+
+    if (op != EPOLL_CTL_DEL && !event)
+    {
+        errno = EFAULT;
+        return -1;
+    }
+
+    scope_lock_t lock(ready_mutex);
+
+    epoll_state_t *&state = epoll_states[epfd];
+    switch (op)
+    {
+    case EPOLL_CTL_ADD:
+        if (!state)
+        {
+            state = epoll_state_create(kepfd);
+            __atomic_add_fetch(&epoll_states_count, 1, __ATOMIC_RELAXED);
+        }
+        if (state->set.contains(fd))
+        {
+            errno = EEXIST;
+            return -1;
+        }
+        if (!watch(fd, epfd))
+        {
+            errno = ENOMEM;
+            return -1;
+        }
+        if (state->set.add(fd, *event) < 0)
+        {
+            unwatch(fd, epfd);
+            return -1;
+        }
+        epoll_wake(state);
+        return 0;
+    case EPOLL_CTL_MOD:
+        if (!state)
+        {
+            errno = ENOENT;
+            return -1;
+        }
+        if (state->set.modify(fd, *event) < 0)
+            return -1;
+        epoll_wake(state);
+        return 0;
+    case EPOLL_CTL_DEL:
+        if (!state)
+        {
+            errno = ENOENT;
+            return -1;
+        }
+        if (state->set.remove(fd) < 0)
+            return -1;
+        unwatch(fd, epfd);
+        return 0;
+    default:
+        errno = EINVAL;
+        return -1;
+    }
+}
+
+CRYSTAX_LOCAL
+int epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout)
+{
+    DBG("epfd=%d, events=%p, maxevents=%d, timeout=%d", epfd, events, maxevents, timeout);
+
+    int kepfd = epoll_resolve(epfd);
+    if (kepfd < 0)
+        return -1;
+
+    if (maxevents <= 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int64_t deadline = timeout > 0 ? now_ms() + timeout : 0;
+    for (;;)
+    {
+        int n = 0;
+        bool ready = false;
+        if (__atomic_load_n(&epoll_states_count, __ATOMIC_RELAXED) > 0)
+        {
+            scope_lock_t lock(ready_mutex);
+            epoll_state_t *state = epoll_states[epfd];
+            if (state)
+            {
+                epoll_unwake(state);
+                int room = maxevents - 1;
+                if (room == 0)
+                {
+                    state->kernel_turn = !state->kernel_turn;
+                    room = state->kernel_turn ? 0 : 1;
+                }
+                n = state->set.collect(events, room);
+                ready = state->set.ready();
+            }
+        }
+
+        int k = system_epoll_wait(kepfd, events + n, maxevents - n, n > 0 || ready ? 0 : timeout);
+        if (k < 0)
+            return n > 0 ? n : -1;
+
+        bool woken = false;
+        if (__atomic_load_n(&epoll_states_count, __ATOMIC_RELAXED) > 0)
+        {
+            scope_lock_t lock(ready_mutex);
+            epoll_state_t *state = epoll_states[epfd];
+            if (state)
+            {
+                k = epoll_drop_wakeups(state, events + n, k, &woken);
+                // Kernel had its turn and has nothing, or memory-backed descriptor was just added
+                if (n + k == 0)
+                    n = state->set.collect(events, maxevents);
+            }
+        }
+
+        if (n + k > 0 || !woken || timeout == 0)
+        {
+            DBG("return %d", n + k);
+            return n + k;
+        }
+
+        // Woken up for descriptor which is already removed, so wait for the rest of time
+        if (timeout > 0)
+        {
+            int64_t left = deadline - now_ms();
+            if (left <= 0)
+                return 0;
+            timeout = (int)left;
+        }
+    }
+}
+
+CRYSTAX_LOCAL
+void epoll_forget(int fd)
+{
+    if (__atomic_load_n(&epoll_states_count, __ATOMIC_RELAXED) == 0)
+        return;
+
+    scope_lock_t lock(ready_mutex);
+
+    if (fd < 0 || fd >= FD_TABLE_SIZE)
+        return;
+
+    epoll_state_t *state = epoll_states[fd];
+    if (state)
+    {
+        for (size_t i = 0; i != state->set.size(); ++i)
+            unwatch(state->set.fd_at(i), fd);
+        if (state->wakefd >= 0)
+            system_close(state->wakefd);
+        delete state;
+        epoll_states[fd] = NULL;
+        __atomic_sub_fetch(&epoll_states_count, 1, __ATOMIC_RELAXED);
+    }
+
+    watchers_t &w = watchers[fd];
+    for (size_t i = 0; i != w.count; ++i)
+        epoll_states[w.epfds[i]]->set.remove(fd);
+    ::free(w.epfds);
+    w.epfds = NULL;
+    w.count = 0;
+    w.capacity = 0;
+}
+
+} // namespace fileio
+} // namespace crystax
+
+CRYSTAX_GLOBAL
+int epoll_create(int size)
+{
+    return ::crystax::fileio::epoll_create(size);
+}
+
+CRYSTAX_GLOBAL
+int epoll_create1(int flags)
+{
+    return ::crystax::fileio::epoll_create1(flags);
+}
+
+CRYSTAX_GLOBAL
+int epoll_ctl(int epfd, int op, int fd, struct epoll_event *event)
+{
+    return ::crystax::fileio::epoll_ctl(epfd, op, fd, event);
+}
+
+CRYSTAX_GLOBAL
+int epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout)
+{
+    return ::crystax::fileio::epoll_wait(epfd, events, maxevents, timeout);
+}
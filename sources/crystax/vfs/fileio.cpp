@@ -29,8 +29,11 @@
 
 #include "fileio/common.hpp"
 #include "fileio/driver.hpp"
+#include "fileio/fdtable.hpp"
+#include "fileio/intern.hpp"
 #include "system/driver.hpp"
 #include "assets/driver.hpp"
+#include "zip/driver.hpp"
 
 namespace crystax
 {
@@ -44,18 +47,7 @@ const char *cpath = NULL;
 size_t cpath_length = 0;
 pthread_mutex_t cpath_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER;
 
-struct fd_record_t
-{
-    DIR *dirp;
-    int extfd;
-    DIR *extdirp;
-    driver_t *driver;
-    const char *path;
-};
-
-fd_record_t fd_table[FD_TABLE_SIZE];
-size_t fd_table_top = 0;
-pthread_mutex_t fd_table_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER;
+fd_table_t fd_table(&intern_release);
 
 CRYSTAX_LOCAL
 driver_t *load_driver(const char *source, const char *target, const char *fstype,
@@ -73,6 +65,19 @@ driver_t *load_driver(const char *source, const char *target, const char *fstype
         return new assets::driver_t(target, context, underlying);
     }
 
+    if (fstype != NULL && ::strcmp(fstype, "zip") == 0)
+    {
+        // 'data' is optional directory inside of archive, e.g. "assets" for APK
+        zip::driver_t *driver = new zip::driver_t(target, source, (const char *)data, underlying);
+        if (!driver->valid())
+        {
+            ERR("can't mount zip archive %s", source);
+            delete driver;
+            return NULL;
+        }
+        return driver;
+    }
+
     ERR("unknown source %s and/or fstype %s", source, fstype);
     return NULL;
 }
@@ -133,159 +138,63 @@ CRYSTAX_LOCAL
 void init_fd()
 {
     TRACE;
-    scope_lock_t lock(fd_table_mutex);
-    for (size_t fd = 0; fd != 3; ++fd)
-    {
-        fd_record_t &r = fd_table[fd];
-        r.dirp = NULL;
-        r.extfd = fd;
-        r.extdirp = NULL;
-        r.driver = system::driver_t::instance();
-        r.path = NULL;
-        if (fd_table_top < fd)
-            fd_table_top = fd;
-    }
-    for (size_t fd = 3; fd != FD_TABLE_SIZE; ++fd)
-    {
-        fd_record_t &r = fd_table[fd];
-        r.dirp = NULL;
-        r.extfd = -1;
-        r.extdirp = NULL;
-        r.driver = NULL;
-        r.path = NULL;
-    }
+    for (int fd = 0; fd != 3; ++fd)
+        fd_table.install(fd, fd, system::driver_t::instance(), NULL);
 }
 
 CRYSTAX_LOCAL
 int alloc_fd(const char *path, int extfd, driver_t *driver)
 {
-    scope_lock_t lock(fd_table_mutex);
-
-    for (size_t fd = 0; fd != FD_TABLE_SIZE; ++fd)
-    {
-        fd_record_t &r = fd_table[fd];
-        if (r.extfd < 0)
-        {
-            r.dirp = NULL;
-            r.extfd = extfd;
-            r.extdirp = NULL;
-            r.driver = driver;
-            r.path = absolutize(path);
-            if (fd_table_top < fd)
-                fd_table_top = fd;
-            return fd;
-        }
-    }
-
-    return -1;
+    char buf[PATH_MAX + 1];
+    abspath_view_t abspath(path, buf, sizeof(buf));
+    return fd_table.alloc(extfd, NULL, driver, intern(abspath));
 }
 
 CRYSTAX_LOCAL
 void free_fd(int fd)
 {
-    if (fd < 0 || fd > FD_TABLE_SIZE)
-        return;
-
-    scope_lock_t lock(fd_table_mutex);
-
-    fd_record_t &r = fd_table[fd];
-    if (r.extfd < 0)
-        return;
-
-    r.dirp = NULL;
-    r.extfd = -1;
-    r.extdirp = NULL;
-    r.driver = NULL;
-    ::free((void*)r.path);
-    r.path = NULL;
-
-    if (fd_table_top == (size_t)fd)
-    {
-        for (size_t i = fd_table_top + 1; i > 0; --i)
-        {
-            if (fd_table[i - 1].extfd >= 0)
-                break;
-            --fd_table_top;
-        }
-    }
+    fd_table.release(fd);
 }
 
 CRYSTAX_LOCAL
 DIR *alloc_dirp(const char *path, DIR *extdirp, driver_t *driver)
 {
-    scope_lock_t lock(fd_table_mutex);
-
-    for (size_t fd = 0; fd != FD_TABLE_SIZE; ++fd)
-    {
-        fd_record_t &r = fd_table[fd];
-        if (r.extfd < 0)
-        {
-            r.dirp = reinterpret_cast<DIR*>(-(int)fd - 1);
-            r.extfd = driver->dirfd(extdirp);
-            r.extdirp = extdirp;
-            r.driver = driver;
-            r.path = absolutize(path);
-            if (fd_table_top < fd)
-                fd_table_top = fd;
-            return r.dirp;
-        }
-    }
-
-    return NULL;
+    char buf[PATH_MAX + 1];
+    abspath_view_t abspath(path, buf, sizeof(buf));
+    int fd = fd_table.alloc(driver->dirfd(extdirp), extdirp, driver, intern(abspath), true);
+    if (fd < 0)
+        return NULL;
+    return fd_table_t::fd2dirp(fd);
 }
 
 CRYSTAX_LOCAL
 void free_dirp(DIR *dirp)
 {
-    scope_lock_t lock(fd_table_mutex);
-
-    for (size_t fd = 0; fd != fd_table_top; ++fd)
-    {
-        fd_record_t &r = fd_table[fd];
-        if (r.dirp != dirp)
-            continue;
-
-        if (r.extfd < 0)
-            break;
-
-        r.dirp = NULL;
-        r.extfd = -1;
-        r.extdirp = NULL;
-        r.driver = NULL;
-        ::free((void*)r.path);
-        r.path = NULL;
-
-        if (fd_table_top == (size_t)fd)
-        {
-            for (size_t i = fd_table_top + 1; i > 0; --i)
-            {
-                if (fd_table[i - 1].extfd >= 0)
-                    break;
-                --fd_table_top;
-            }
-        }
+    fd_table.release(dirp);
+}
 
-        break;
-    }
+static void reset_path(int fd, path_t *path)
+{
+    const char *ipath = fd_table.path(fd, &intern_retain);
+    path->reset(ipath);
+    intern_release(ipath);
 }
 
 CRYSTAX_LOCAL
 bool resolve(int fd, DIR **dirp, int *extfd, DIR **extdirp, driver_t **driver, path_t *path)
 {
-    if (fd < 0 || fd > FD_TABLE_SIZE)
+    fd_record_t r;
+    if (!fd_table.lookup(fd, &r))
     {
-        errno = EBADFD;
+        errno = EBADF;
         return false;
     }
 
-    scope_lock_t lock(fd_table_mutex);
-
-    fd_record_t const &r = fd_table[fd];
     if (dirp) *dirp = r.dirp;
     if (extfd) *extfd = r.extfd;
     if (extdirp) *extdirp = r.extdirp;
     if (driver) *driver = r.driver;
-    if (path) path->reset(absolutize(r.path));
+    if (path) reset_path(fd, path);
 
     return true;
 }
@@ -293,23 +202,21 @@ bool resolve(int fd, DIR **dirp, int *extfd, DIR **extdirp, driver_t **driver, p
 CRYSTAX_LOCAL
 bool resolve(DIR *dirp, int *fd, int *extfd, DIR **extdirp, driver_t **driver, path_t *path)
 {
-    scope_lock_t lock(fd_table_mutex);
-
-    for (size_t i = 0; i != FD_TABLE_SIZE; ++i)
+    int n;
+    fd_record_t r;
+    if (!fd_table.lookup(dirp, &n, &r))
     {
-        fd_record_t &r = fd_table[i];
-        if (r.dirp != dirp)
-            continue;
-
-        if (fd) *fd = i;
-        if (extfd) *extfd = r.extfd;
-        if (extdirp) *extdirp = r.extdirp;
-        if (driver) *driver = r.driver;
-        if (path) path->reset(absolutize(r.path));
-        return true;
+        errno = EBADF;
+        return false;
     }
 
-    return false;
+    if (fd) *fd = n;
+    if (extfd) *extfd = r.extfd;
+    if (extdirp) *extdirp = r.extdirp;
+    if (driver) *driver = r.driver;
+    if (path) reset_path(n, path);
+
+    return true;
 }
 
 } // namespace fileio
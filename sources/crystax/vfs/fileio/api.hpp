@@ -33,6 +33,8 @@
 #include "fileio/common.hpp"
 #include "fileio/driver.hpp"
 
+#include <poll.h>
+
 namespace crystax
 {
 namespace fileio
@@ -44,6 +46,11 @@ void free_fd(int fd);
 DIR *alloc_dirp(const char *path, DIR *extdirp, driver_t *driver);
 void free_dirp(DIR *dirp);
 
+int poll(struct pollfd *fds, nfds_t nfds, int timeout);
+
+// Drop epoll registrations of memory-backed descriptor which is being closed
+void epoll_forget(int fd);
+
 } // namespace fileio
 } // namespace crystax
 
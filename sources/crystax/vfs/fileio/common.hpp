@@ -43,6 +43,10 @@
 #include "crystax/lock.hpp"
 #include "crystax/path.hpp"
 
+#ifndef FD_TABLE_SIZE
+#define FD_TABLE_SIZE 1024
+#endif
+
 #define NOT_IMPLEMENTED_BASE \
     WARN("FUNCTION IS NOT IMPLEMENTED!!!"); \
     errno = EIO
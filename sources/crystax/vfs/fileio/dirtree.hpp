@@ -0,0 +1,639 @@
+/*
+ * Copyright (c) 2011-2015 CrystaX.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice, this list of
+ *       conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *       of conditions and the following disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY CrystaX ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL CrystaX OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those of the
+ * authors and should not be interpreted as representing official policies, either expressed
+ * or implied, of CrystaX.
+ */
+
+#ifndef _CRYSTAX_FILEIO_DIRTREE_HPP_ec7cf148b84846c0978c7d41c2b20786
+#define _CRYSTAX_FILEIO_DIRTREE_HPP_ec7cf148b84846c0978c7d41c2b20786
+
+/*
+ * This header intentionally depends on nothing but system headers, so it could be
+ * used (and tested) outside of libcrystax.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+
+namespace crystax
+{
+namespace fileio
+{
+
+/*
+ * Immutable in-memory image of read-only directory hierarchy (e.g. assets of APK):
+ * path -> (type, size, offset). It's built once, when content is mounted, so
+ * stat() and directory listing never go to the backing store.
+ *
+ * Nodes are laid out so that children of every directory are contiguous and sorted
+ * by name: lookup is a binary search per path component, and directory stream is
+ * just an index into that range. Node 0 is the root.
+ */
+class dir_tree_t
+{
+public:
+    enum
+    {
+        ROOT = 0
+    };
+
+    struct node_t
+    {
+        const char *name;   // Last path component, NUL-terminated; empty for root
+        uint32_t namelen;
+        uint32_t parent;
+        uint32_t first;     // Children range, for directories only
+        uint32_t count;
+        unsigned char type; // DT_DIR or DT_REG
+        uint32_t known;     // Non-zero if 'size' is valid
+        uint64_t size;
+        uint64_t offset;    // Where content starts in backing store, if it makes sense
+        size_t tag;         // Opaque value given by builder's client
+    };
+
+    /*
+     * Accumulates entries in any order. Parent directories are created implicitly;
+     * leading, trailing and repeated slashes are ignored, and entries with "." or
+     * ".." components are dropped.
+     */
+    class builder_t
+    {
+    public:
+        builder_t() :records(NULL), nrecords(0), crecords(0), paths(NULL), npaths(0), cpaths(0) {}
+
+        ~builder_t()
+        {
+            for (size_t i = 0; i != npaths; ++i)
+                ::free(paths[i]);
+            ::free(paths);
+            ::free(records);
+        }
+
+        /*
+         * Add entry. If 'known' is false, size of file is unknown yet (see dir_tree_t::size()).
+         * Return false and set errno on failure.
+         */
+        bool add(const char *path, size_t len, unsigned char type, bool known = false,
+            uint64_t size = 0, uint64_t offset = 0, size_t tag = 0)
+        {
+            char *s = (char *)::malloc(len + 1);
+            if (!s)
+            {
+                errno = ENOMEM;
+                return false;
+            }
+
+            // Normalize: drop empty components and reject relative ones
+            size_t n = 0;
+            for (size_t i = 0; i < len;)
+            {
+                size_t j = i;
+                while (j < len && path[j] != '/')
+                    ++j;
+                size_t clen = j - i;
+                if (clen == 1 && path[i] == '.')
+                    clen = 0;
+                if (clen == 2 && path[i] == '.' && path[i + 1] == '.')
+                {
+                    ::free(s);
+                    return true;
+                }
+                if (clen > 0)
+                {
+                    if (n > 0)
+                        s[n++] = '/';
+                    ::memcpy(s + n, path + i, clen);
+                    n += clen;
+                }
+                i = j + 1;
+            }
+            s[n] = '\0';
+
+            if (n == 0 || !keep(s))
+            {
+                ::free(s);
+                return n == 0;
+            }
+
+            // Entry itself and all its parents, sharing the same string
+            for (size_t i = 0; i <= n; ++i)
+            {
+                if (i != n && s[i] != '/')
+                    continue;
+
+                record_t r;
+                r.path = s;
+                r.len = i;
+                r.explicit_ = i == n;
+                r.type = i == n ? type : (unsigned char)DT_DIR;
+                r.known = i == n && known;
+                r.size = i == n ? size : 0;
+                r.offset = i == n ? offset : 0;
+                r.tag = i == n ? tag : 0;
+                if (!push(r))
+                    return false;
+            }
+
+            return true;
+        }
+
+        /*
+         * Make tree of everything added so far. Return NULL and set errno on failure.
+         */
+        dir_tree_t *build()
+        {
+            ::qsort(records, nrecords, sizeof(record_t), &compare);
+
+            // Drop duplicates; directory beats file with the same name, explicit entry beats implicit one
+            size_t n = 0;
+            for (size_t i = 0; i != nrecords; ++i)
+            {
+                if (n > 0 && same(records[n - 1], records[i]))
+                    continue;
+                records[n++] = records[i];
+            }
+            nrecords = n;
+
+            return dir_tree_t::make(records, nrecords);
+        }
+
+    private:
+        builder_t(builder_t const &);
+        builder_t &operator=(builder_t const &);
+
+        friend class dir_tree_t;
+
+        struct record_t
+        {
+            const char *path;
+            size_t len;
+            bool explicit_;
+            unsigned char type;
+            bool known;
+            uint64_t size;
+            uint64_t offset;
+            size_t tag;
+        };
+
+        bool keep(char *s)
+        {
+            if (npaths == cpaths)
+            {
+                size_t c = cpaths ? cpaths * 2 : 64;
+                char **p = (char **)::realloc(paths, c * sizeof(char *));
+                if (!p)
+                {
+                    errno = ENOMEM;
+                    return false;
+                }
+                paths = p;
+                cpaths = c;
+            }
+            paths[npaths++] = s;
+            return true;
+        }
+
+        bool push(record_t const &r)
+        {
+            if (nrecords == crecords)
+            {
+                size_t c = crecords ? crecords * 2 : 256;
+                record_t *p = (record_t *)::realloc(records, c * sizeof(record_t));
+                if (!p)
+                {
+                    errno = ENOMEM;
+                    return false;
+                }
+                records = p;
+                crecords = c;
+            }
+            records[nrecords++] = r;
+            return true;
+        }
+
+        static bool same(record_t const &a, record_t const &b)
+        {
+            return a.len == b.len && ::memcmp(a.path, b.path, a.len) == 0;
+        }
+
+        /*
+         * Slash sorts before any other character, so whole subtree of directory
+         * directly follows it: sorted records are in depth-first order.
+         */
+        static int compare(const void *pa, const void *pb)
+        {
+            record_t const &a = *(record_t const *)pa;
+            record_t const &b = *(record_t const *)pb;
+            size_t l = a.len < b.len ? a.len : b.len;
+            for (size_t i = 0; i != l; ++i)
+            {
+                unsigned ca = a.path[i] == '/' ? 0 : (unsigned char)a.path[i];
+                unsigned cb = b.path[i] == '/' ? 0 : (unsigned char)b.path[i];
+                if (ca != cb)
+                    return ca < cb ? -1 : 1;
+            }
+            if (a.len != b.len)
+                return a.len < b.len ? -1 : 1;
+            if (a.type != b.type)
+                return a.type == DT_DIR ? -1 : 1;
+            if (a.explicit_ != b.explicit_)
+                return a.explicit_ ? -1 : 1;
+            return 0;
+        }
+
+    private:
+        record_t *records;
+        size_t nrecords;
+        size_t crecords;
+        char **paths;
+        size_t npaths;
+        size_t cpaths;
+    };
+
+    ~dir_tree_t()
+    {
+        ::free(nodes);
+        ::free(pool);
+    }
+
+    size_t count() const {return nnodes;}
+    node_t const &node(size_t idx) const {return nodes[idx];}
+    size_t index(node_t const *n) const {return n - nodes;}
+    node_t const &root() const {return nodes[ROOT];}
+
+    /*
+     * Find node by relative path; empty path means root. Return NULL if there is
+     * no such entry.
+     */
+    node_t const *lookup(const char *path, size_t len) const
+    {
+        node_t const *n = &nodes[ROOT];
+        for (size_t i = 0; i < len;)
+        {
+            size_t j = i;
+            while (j < len && path[j] != '/')
+                ++j;
+            size_t clen = j - i;
+            if (clen > 0 && !(clen == 1 && path[i] == '.'))
+            {
+                n = child(*n, path + i, clen);
+                if (!n)
+                    return NULL;
+            }
+            i = j + 1;
+        }
+        return n;
+    }
+
+    node_t const *lookup(const char *path) const {return lookup(path, ::strlen(path));}
+
+    /*
+     * Find child of directory by name, or return NULL.
+     */
+    node_t const *child(node_t const &dir, const char *name, size_t len) const
+    {
+        if (dir.type != DT_DIR)
+            return NULL;
+
+        size_t lo = dir.first, hi = (size_t)dir.first + dir.count;
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            node_t const &c = nodes[mid];
+            size_t l = c.namelen < len ? c.namelen : len;
+            int r = ::memcmp(c.name, name, l);
+            if (r == 0)
+                r = c.namelen < len ? -1 : c.namelen > len ? 1 : 0;
+            if (r == 0)
+                return &c;
+            if (r < 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return NULL;
+    }
+
+    /*
+     * Size of file, if it's known already. Sizes which are expensive to get could
+     * be left unknown by builder and supplied later with set_size().
+     */
+    bool size(node_t const &n, uint64_t *sz) const
+    {
+        if (!__atomic_load_n(&n.known, __ATOMIC_ACQUIRE))
+            return false;
+        *sz = n.size;
+        return true;
+    }
+
+    /*
+     * Remember size of file. Calls must be serialized by caller; size() could be
+     * used concurrently with it.
+     */
+    void set_size(node_t const &n, uint64_t sz)
+    {
+        node_t &m = nodes[index(&n)];
+        m.size = sz;
+        __atomic_store_n(&m.known, 1, __ATOMIC_RELEASE);
+    }
+
+    /*
+     * Read-only scandir(3) of directory: "." and ".." first, then children in
+     * name order, filtered and sorted as requested. Return number of entries, or -1
+     * and set errno on failure.
+     */
+    int scandir(node_t const &dir, struct dirent ***namelist, int (*filter)(const struct dirent *),
+        int (*compar)(const struct dirent **, const struct dirent **)) const;
+
+private:
+    dir_tree_t() :nodes(NULL), nnodes(0), pool(NULL) {}
+    dir_tree_t(dir_tree_t const &);
+    dir_tree_t &operator=(dir_tree_t const &);
+
+    typedef builder_t::record_t record_t;
+
+    /*
+     * Records are unique and in depth-first order. Nodes are placed so children of
+     * each directory form contiguous block, blocks ordered by their parents' position
+     * in depth-first order, children within block by name.
+     */
+    static dir_tree_t *make(record_t const *records, size_t nrecords)
+    {
+        if (nrecords >= (size_t)(uint32_t)-1)
+        {
+            errno = EOVERFLOW;
+            return NULL;
+        }
+
+        dir_tree_t *t = new dir_tree_t;
+
+        // parent[i] is depth-first index of parent of record i plus one, 0 for root
+        uint32_t *parent = (uint32_t *)::malloc((nrecords + 1) * sizeof(uint32_t));
+        uint32_t *start = (uint32_t *)::calloc(nrecords + 2, sizeof(uint32_t));
+        uint32_t *stack = (uint32_t *)::malloc((nrecords + 1) * sizeof(uint32_t));
+        size_t poolsize = 1;
+        for (size_t i = 0; i != nrecords; ++i)
+            poolsize += name_length(records[i]) + 1;
+        t->pool = (char *)::malloc(poolsize);
+        t->nodes = (node_t *)::calloc(nrecords + 1, sizeof(node_t));
+        if (!parent || !start || !stack || !t->pool || !t->nodes)
+        {
+            ::free(parent);
+            ::free(start);
+            ::free(stack);
+            delete t;
+            errno = ENOMEM;
+            return NULL;
+        }
+        t->nnodes = nrecords + 1;
+
+        size_t depth = 0;
+        for (size_t i = 0; i != nrecords; ++i)
+        {
+            record_t const &r = records[i];
+            while (depth > 0)
+            {
+                record_t const &d = records[stack[depth - 1] - 1];
+                if (r.len > d.len && r.path[d.len] == '/' && ::memcmp(r.path, d.path, d.len) == 0)
+                    break;
+                --depth;
+            }
+            parent[i] = depth > 0 ? stack[depth - 1] : 0;
+            ++start[parent[i] + 1];
+            if (r.type == DT_DIR)
+                stack[depth++] = i + 1;
+        }
+
+        // Prefix sums: start[p] becomes position of first child of p (root is 0)
+        uint32_t pos = 1;
+        for (size_t p = 0; p <= nrecords; ++p)
+        {
+            uint32_t c = start[p + 1];
+            start[p + 1] = pos;
+            pos += c;
+        }
+        // Now start[p + 1] is first child of p; reuse stack[] as per-parent fill counters
+        for (size_t p = 0; p <= nrecords; ++p)
+            stack[p] = start[p + 1];
+
+        char *names = t->pool;
+        *names++ = '\0';
+        node_t &root = t->nodes[ROOT];
+        root.name = t->pool;
+        root.namelen = 0;
+        root.parent = ROOT;
+        root.type = DT_DIR;
+        root.first = start[1];
+        root.count = 0;
+
+        // Position of record i in nodes[], needed to link children with parents
+        uint32_t *where = parent;
+        for (size_t i = 0; i != nrecords; ++i)
+        {
+            record_t const &r = records[i];
+            uint32_t p = parent[i];
+            uint32_t idx = stack[p]++;
+            uint32_t pidx = p == 0 ? (uint32_t)ROOT : where[p - 1];
+
+            node_t &n = t->nodes[idx];
+            size_t nlen = name_length(r);
+            ::memcpy(names, r.path + r.len - nlen, nlen);
+            names[nlen] = '\0';
+            n.name = names;
+            n.namelen = nlen;
+            names += nlen + 1;
+            n.parent = pidx;
+            n.type = r.type;
+            n.first = start[i + 2];
+            n.count = 0;
+            n.known = r.type == DT_DIR || r.known;
+            n.size = r.size;
+            n.offset = r.offset;
+            n.tag = r.tag;
+            ++t->nodes[pidx].count;
+
+            // parent[] of already visited records isn't needed anymore
+            where[i] = idx;
+        }
+
+        ::free(parent);
+        ::free(start);
+        ::free(stack);
+        return t;
+    }
+
+    static size_t name_length(record_t const &r)
+    {
+        size_t i = r.len;
+        while (i > 0 && r.path[i - 1] != '/')
+            --i;
+        return r.len - i;
+    }
+
+private:
+    node_t *nodes;
+    size_t nnodes;
+    char *pool;
+};
+
+/*
+ * Directory stream over dir_tree_t: "." and ".." first, then children of directory.
+ * Position is index in that sequence, so telldir()/seekdir() are trivial.
+ */
+class dir_stream_t
+{
+public:
+    dir_stream_t(dir_tree_t const &t, dir_tree_t::node_t const &d)
+        :tree(t), dir(d), pos(0)
+    {}
+
+    struct dirent *read()
+    {
+        if (!fill(pos, &ent))
+            return NULL;
+        ++pos;
+        return &ent;
+    }
+
+    int read_r(struct dirent *entry, struct dirent **result)
+    {
+        if (!fill(pos, entry))
+        {
+            *result = NULL;
+            return 0;
+        }
+        ++pos;
+        *result = entry;
+        return 0;
+    }
+
+    void rewind() {pos = 0;}
+    long tell() const {return (long)pos;}
+    void seek(long p) {pos = p < 0 ? 0 : (size_t)p;}
+
+    dir_tree_t::node_t const &node() const {return dir;}
+    size_t size() const {return (size_t)dir.count + 2;}
+
+    bool fill(size_t p, struct dirent *e) const
+    {
+        dir_tree_t::node_t const *n;
+        const char *name;
+        size_t namelen;
+        unsigned char type = DT_DIR;
+        if (p == 0)
+        {
+            n = &dir;
+            name = ".";
+            namelen = 1;
+        }
+        else if (p == 1)
+        {
+            n = &tree.node(dir.parent);
+            name = "..";
+            namelen = 2;
+        }
+        else if (p - 2 < dir.count)
+        {
+            n = &tree.node(dir.first + (p - 2));
+            name = n->name;
+            namelen = n->namelen;
+            type = n->type;
+        }
+        else
+            return false;
+
+        if (namelen >= sizeof(e->d_name))
+            namelen = sizeof(e->d_name) - 1;
+
+        e->d_ino = tree.index(n) + 1;
+        e->d_off = p + 1;
+        e->d_reclen = sizeof(struct dirent);
+        e->d_type = type;
+        ::memcpy(e->d_name, name, namelen);
+        e->d_name[namelen] = '\0';
+        return true;
+    }
+
+private:
+    dir_stream_t(dir_stream_t const &);
+    dir_stream_t &operator=(dir_stream_t const &);
+
+    dir_tree_t const &tree;
+    dir_tree_t::node_t const &dir;
+    size_t pos;
+    struct dirent ent;
+};
+
+inline
+int dir_tree_t::scandir(node_t const &dir, struct dirent ***namelist, int (*filter)(const struct dirent *),
+    int (*compar)(const struct dirent **, const struct dirent **)) const
+{
+    dir_stream_t stream(*this, dir);
+
+    size_t n = 0;
+    struct dirent **list = (struct dirent **)::malloc(stream.size() * sizeof(struct dirent *));
+    if (!list)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    for (size_t p = 0; p != stream.size(); ++p)
+    {
+        struct dirent *e = (struct dirent *)::malloc(sizeof(struct dirent));
+        if (!e)
+        {
+            while (n > 0)
+                ::free(list[--n]);
+            ::free(list);
+            errno = ENOMEM;
+            return -1;
+        }
+
+        stream.fill(p, e);
+        if (filter && !filter(e))
+        {
+            ::free(e);
+            continue;
+        }
+        list[n++] = e;
+    }
+
+    if (compar)
+        ::qsort(list, n, sizeof(struct dirent *), (int (*)(const void *, const void *))compar);
+
+    *namelist = list;
+    return (int)n;
+}
+
+} // namespace fileio
+} // namespace crystax
+
+#endif // _CRYSTAX_FILEIO_DIRTREE_HPP_ec7cf148b84846c0978c7d41c2b20786
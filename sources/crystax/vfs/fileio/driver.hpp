@@ -47,7 +47,7 @@ public:
     virtual const char *name() const = 0;
     virtual const char *info() const = 0;
 
-    path_t const &root() const {return rootpath;}
+    abspath_t const &root() const {return rootpath;}
 
     driver_t *underlying() const {return underlying_driver;}
 
@@ -97,6 +97,19 @@ public:
     virtual ssize_t write(int fd, const void *buf, size_t count) = 0;
     virtual int    writev(int fd, const struct iovec *iov, int count) = 0;
 
+    /*
+     * Hint that file is going to be opened for writing soon: drivers backed by
+     * read-only storage could start copying it out in background. Return 1 if
+     * that's started, 0 if there is nothing to do, -1 and set errno on failure.
+     */
+    virtual int    prefetch(const char * /* path */) {return 0;}
+
+    /*
+     * Kernel descriptor readiness of 'fd' could be waited on, or -1 if there is
+     * none: such descriptors are served from memory and always ready for I/O.
+     */
+    virtual int    kernel_fd(int /* fd */) {return -1;}
+
     int open(const char *path, int oflag, ...)
     {
         va_list vl;
@@ -125,7 +138,7 @@ public:
     }
 
 private:
-    path_t rootpath;
+    abspath_t rootpath;
     driver_t *underlying_driver;
 };
 
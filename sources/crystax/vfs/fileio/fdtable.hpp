@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2011-2015 CrystaX.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice, this list of
+ *       conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *       of conditions and the following disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY CrystaX ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL CrystaX OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those of the
+ * authors and should not be interpreted as representing official policies, either expressed
+ * or implied, of CrystaX.
+ */
+
+#ifndef _CRYSTAX_FILEIO_FDTABLE_HPP_b9bf85d4d9474d2d9705ab2d1c99ac45
+#define _CRYSTAX_FILEIO_FDTABLE_HPP_b9bf85d4d9474d2d9705ab2d1c99ac45
+
+/*
+ * This header intentionally depends on nothing but system headers, so it could be
+ * used (and benchmarked) outside of libcrystax.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <dirent.h>
+#include <pthread.h>
+
+#ifndef FD_TABLE_SIZE
+#define FD_TABLE_SIZE 1024
+#endif
+
+namespace crystax
+{
+namespace fileio
+{
+
+class driver_t;
+
+struct fd_record_t
+{
+    DIR *dirp;
+    int extfd;
+    DIR *extdirp;
+    driver_t *driver;
+};
+
+/*
+ * Descriptor table with lock-free lookup.
+ *
+ * Each slot is published through its own sequence counter: writer makes it odd
+ * while updating record and even again when done; reader takes a snapshot of the
+ * record and retries if counter changed meanwhile. This way readers never block
+ * and never touch memory which could be reclaimed under them.
+ *
+ * Slots are allocated from a bitmap, so lowest free descriptor is always returned
+ * first, as POSIX requires. DIR pointers handed out by the table encode slot
+ * number, so DIR -> slot mapping is O(1) too.
+ *
+ * Paths are not needed on hot paths, so they're kept aside and protected
+ * by mutex.
+ *
+ * Constructor is constexpr, so a global table is initialized statically,
+ * before any code could open files. Table is never destroyed: descriptors
+ * could be closed by atexit handlers and static destructors of any
+ * translation unit, so it has to outlive them all. Free slots are zeroed;
+ * only 'driver' tells if slot is busy.
+ */
+class fd_table_t
+{
+public:
+    enum
+    {
+        SIZE = FD_TABLE_SIZE,
+        WORD_BITS = 32,
+        WORDS = (SIZE + WORD_BITS - 1) / WORD_BITS
+    };
+
+    typedef void (*release_path_t)(const char *);
+
+    constexpr explicit fd_table_t(release_path_t rp = &free_path)
+        :release_path(rp), bitmap{}, slots{}, path_mutex PTHREAD_MUTEX_INITIALIZER
+    {}
+
+    static DIR *fd2dirp(int fd) {return reinterpret_cast<DIR*>(-(intptr_t)fd - 1);}
+    static int dirp2fd(DIR *dirp) {return (int)(-reinterpret_cast<intptr_t>(dirp) - 1);}
+
+    /*
+     * Take ownership on 'path' (it's disposed with release_path later) and return
+     * lowest free descriptor, or -1 if table is full. If 'dir' is true, record
+     * is marked as directory stream and could be found by fd2dirp(fd) later.
+     */
+    int alloc(int extfd, DIR *extdirp, driver_t *driver, const char *path, bool dir = false)
+    {
+        for (size_t w = 0; w != WORDS; ++w)
+        {
+            uint32_t v = __atomic_load_n(&bitmap[w], __ATOMIC_RELAXED);
+            while (v != ~(uint32_t)0)
+            {
+                size_t bit = __builtin_ctz(~v);
+                size_t fd = w * WORD_BITS + bit;
+                if (fd >= SIZE)
+                    break;
+                if (__atomic_compare_exchange_n(&bitmap[w], &v, v | ((uint32_t)1 << bit),
+                        false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+                {
+                    publish(fd, dir ? fd2dirp(fd) : NULL, extfd, extdirp, driver, path);
+                    return fd;
+                }
+            }
+        }
+
+        release_path(path);
+        return -1;
+    }
+
+    /*
+     * Occupy exactly specified descriptor. Return false if it's busy already.
+     */
+    bool install(int fd, int extfd, driver_t *driver, const char *path)
+    {
+        if (fd < 0 || fd >= SIZE)
+            return false;
+
+        uint32_t mask = (uint32_t)1 << (fd % WORD_BITS);
+        uint32_t prev = __atomic_fetch_or(&bitmap[fd / WORD_BITS], mask, __ATOMIC_ACQUIRE);
+        if (prev & mask)
+            return false;
+
+        publish(fd, NULL, extfd, NULL, driver, path);
+        return true;
+    }
+
+    bool release(int fd)
+    {
+        if (fd < 0 || fd >= SIZE)
+            return false;
+
+        slot_t &s = slots[fd];
+        uint32_t seq = write_begin(s);
+        bool busy = s.rec.driver != NULL;
+        if (busy)
+        {
+            __atomic_store_n(&s.rec.dirp, (DIR*)NULL, __ATOMIC_RELAXED);
+            __atomic_store_n(&s.rec.extfd, -1, __ATOMIC_RELAXED);
+            __atomic_store_n(&s.rec.extdirp, (DIR*)NULL, __ATOMIC_RELAXED);
+            __atomic_store_n(&s.rec.driver, (driver_t*)NULL, __ATOMIC_RELAXED);
+        }
+        write_end(s, seq);
+
+        if (!busy)
+            return false;
+
+        ::pthread_mutex_lock(&path_mutex);
+        const char *path = s.path;
+        s.path = NULL;
+        ::pthread_mutex_unlock(&path_mutex);
+        release_path(path);
+
+        __atomic_fetch_and(&bitmap[fd / WORD_BITS], ~((uint32_t)1 << (fd % WORD_BITS)), __ATOMIC_RELEASE);
+        return true;
+    }
+
+    bool release(DIR *dirp)
+    {
+        fd_record_t r;
+        int fd = dirp2fd(dirp);
+        if (!lookup(fd, &r) || r.dirp != dirp)
+            return false;
+        return release(fd);
+    }
+
+    /*
+     * Hot path: never blocks and never allocates.
+     */
+    bool lookup(int fd, fd_record_t *r) const
+    {
+        if (fd < 0 || fd >= SIZE)
+            return false;
+
+        slot_t const &s = slots[fd];
+        for (;;)
+        {
+            uint32_t seq = __atomic_load_n(&s.seq, __ATOMIC_ACQUIRE);
+            if (seq & 1)
+                continue;
+
+            r->dirp = __atomic_load_n(&s.rec.dirp, __ATOMIC_RELAXED);
+            r->extfd = __atomic_load_n(&s.rec.extfd, __ATOMIC_RELAXED);
+            r->extdirp = __atomic_load_n(&s.rec.extdirp, __ATOMIC_RELAXED);
+            r->driver = __atomic_load_n(&s.rec.driver, __ATOMIC_RELAXED);
+
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&s.seq, __ATOMIC_RELAXED) == seq)
+                break;
+        }
+
+        return r->driver != NULL;
+    }
+
+    bool lookup(DIR *dirp, int *fd, fd_record_t *r) const
+    {
+        int n = dirp2fd(dirp);
+        if (!lookup(n, r) || r->dirp != dirp)
+            return false;
+        if (fd) *fd = n;
+        return true;
+    }
+
+    /*
+     * Return copy of path associated with descriptor, or NULL.
+     */
+    const char *path(int fd, const char *(*copy)(const char *)) const
+    {
+        if (fd < 0 || fd >= SIZE)
+            return NULL;
+
+        ::pthread_mutex_lock(&path_mutex);
+        const char *p = slots[fd].path ? copy(slots[fd].path) : NULL;
+        ::pthread_mutex_unlock(&path_mutex);
+        return p;
+    }
+
+    static void free_path(const char *path) {::free((void*)path);}
+
+private:
+    fd_table_t(fd_table_t const &);
+    fd_table_t &operator=(fd_table_t const &);
+
+    struct slot_t
+    {
+        uint32_t seq;
+        fd_record_t rec;
+        const char *path;
+    };
+
+    static uint32_t write_begin(slot_t &s)
+    {
+        uint32_t seq = __atomic_load_n(&s.seq, __ATOMIC_RELAXED);
+        for (;;)
+        {
+            if ((seq & 1) == 0 &&
+                __atomic_compare_exchange_n(&s.seq, &seq, seq + 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+                break;
+            seq = __atomic_load_n(&s.seq, __ATOMIC_RELAXED);
+        }
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        return seq;
+    }
+
+    static void write_end(slot_t &s, uint32_t seq)
+    {
+        __atomic_store_n(&s.seq, seq + 2, __ATOMIC_RELEASE);
+    }
+
+    void publish(int fd, DIR *dirp, int extfd, DIR *extdirp, driver_t *driver, const char *path)
+    {
+        slot_t &s = slots[fd];
+
+        ::pthread_mutex_lock(&path_mutex);
+        const char *prev = s.path;
+        s.path = path;
+        ::pthread_mutex_unlock(&path_mutex);
+        release_path(prev);
+
+        uint32_t seq = write_begin(s);
+        __atomic_store_n(&s.rec.dirp, dirp, __ATOMIC_RELAXED);
+        __atomic_store_n(&s.rec.extfd, extfd, __ATOMIC_RELAXED);
+        __atomic_store_n(&s.rec.extdirp, extdirp, __ATOMIC_RELAXED);
+        __atomic_store_n(&s.rec.driver, driver, __ATOMIC_RELAXED);
+        write_end(s, seq);
+    }
+
+private:
+    release_path_t release_path;
+    uint32_t bitmap[WORDS];
+    slot_t slots[SIZE];
+    mutable pthread_mutex_t path_mutex;
+};
+
+} // namespace fileio
+} // namespace crystax
+
+#endif // _CRYSTAX_FILEIO_FDTABLE_HPP_b9bf85d4d9474d2d9705ab2d1c99ac45
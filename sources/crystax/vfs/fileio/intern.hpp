@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2011-2015 CrystaX.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice, this list of
+ *       conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *       of conditions and the following disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY CrystaX ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL CrystaX OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those of the
+ * authors and should not be interpreted as representing official policies, either expressed
+ * or implied, of CrystaX.
+ */
+
+#ifndef _CRYSTAX_FILEIO_INTERN_HPP_4a5b7949292f4a5e8be266411cc56577
+#define _CRYSTAX_FILEIO_INTERN_HPP_4a5b7949292f4a5e8be266411cc56577
+
+#include "fileio/common.hpp"
+
+namespace crystax
+{
+namespace fileio
+{
+
+/*
+ * Table of interned paths. Each distinct normalized absolute path is stored only once,
+ * together with its length and hash. Interned strings are reference counted and stay
+ * valid (and unchanged) until the last reference is released, so they could be passed
+ * around as plain 'const char *' without copying.
+ */
+
+uint32_t path_hash(const char *path, size_t length);
+
+const char *intern(abspath_view_t const &path);
+const char *intern_retain(const char *ipath);
+void intern_release(const char *ipath);
+
+} // namespace fileio
+} // namespace crystax
+
+#endif // _CRYSTAX_FILEIO_INTERN_HPP_4a5b7949292f4a5e8be266411cc56577
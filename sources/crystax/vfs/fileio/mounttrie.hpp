@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2011-2015 CrystaX.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice, this list of
+ *       conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *       of conditions and the following disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY CrystaX ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL CrystaX OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those of the
+ * authors and should not be interpreted as representing official policies, either expressed
+ * or implied, of CrystaX.
+ */
+
+#ifndef _CRYSTAX_FILEIO_MOUNTTRIE_HPP_7a266d3f21ab4e06b3f49e72af530715
+#define _CRYSTAX_FILEIO_MOUNTTRIE_HPP_7a266d3f21ab4e06b3f49e72af530715
+
+/*
+ * This header intentionally depends on nothing but system headers, so it could be
+ * used (and benchmarked) outside of libcrystax.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace crystax
+{
+namespace fileio
+{
+
+class driver_t;
+
+/*
+ * Immutable radix trie of mount roots, keyed by path components.
+ *
+ * Lookup walks the path once, component by component, and remembers the deepest
+ * node having driver attached, so its cost depends on the path depth, not on the
+ * number of mounts. Trie is never modified after build(); mount table changes
+ * build new one and publish it (see rcu.hpp).
+ *
+ * Few mounts are checked faster by plain reverse scan (exactly as mount table did
+ * it before), so trie is built only when number of mounts exceeds LINEAR_MAX.
+ */
+class mount_trie_t
+{
+public:
+    enum
+    {
+        LINEAR_MAX = 16
+    };
+
+    struct entry_t
+    {
+        const char *root;
+        size_t length;
+        driver_t *driver;
+    };
+
+    /*
+     * Build trie from mounts listed in the order they were made. Roots must be
+     * normalized absolute paths. As with the mount table it replaces, mount made
+     * over an ancestor directory later hides everything mounted beneath it before.
+     * Return NULL if out of memory.
+     */
+    static mount_trie_t *build(entry_t const *entries, size_t count)
+    {
+        mount_trie_t *trie = new mount_trie_t;
+        if (count <= LINEAR_MAX)
+        {
+            if (!trie->flatten(entries, count))
+            {
+                delete trie;
+                return NULL;
+            }
+            return trie;
+        }
+
+        for (size_t i = 0; i != count; ++i)
+        {
+            if (!trie->insert(entries[i]))
+            {
+                delete trie;
+                return NULL;
+            }
+        }
+        return trie;
+    }
+
+    ~mount_trie_t()
+    {
+        clear(&top);
+        for (size_t i = 0; i != nflat; ++i)
+            ::free((void *)flat[i].root);
+        ::free(flat);
+    }
+
+    bool empty() const {return nflat == 0 && top.driver == NULL && top.count == 0;}
+
+    /*
+     * Return driver mounted on the longest prefix of 'path' (normalized absolute),
+     * or NULL if there is no such mount.
+     */
+    driver_t *lookup(const char *path, size_t length) const
+    {
+        if (flat)
+            return linear_lookup(path, length);
+
+        node_t const *node = &top;
+        driver_t *found = node->driver;
+
+        const char *end = path + length;
+        for (const char *s = path; s < end && node->count != 0;)
+        {
+            while (s < end && *s == '/')
+                ++s;
+            if (s == end)
+                break;
+
+            // Components are short, so plain loop is cheaper than memchr call there
+            const char *e = s;
+            while (e < end && *e != '/')
+                ++e;
+
+            node = find(node, s, e - s);
+            if (!node)
+                break;
+            if (node->driver)
+                found = node->driver;
+
+            s = e;
+        }
+
+        return found;
+    }
+
+private:
+    struct node_t
+    {
+        driver_t *driver;
+        size_t count;
+        size_t capacity;
+        node_t **children;
+        size_t namelen;
+        char name[1];
+    };
+
+    mount_trie_t()
+        :flat(NULL), nflat(0)
+    {
+        top.driver = NULL;
+        top.count = 0;
+        top.capacity = 0;
+        top.children = NULL;
+        top.namelen = 0;
+        top.name[0] = '\0';
+    }
+
+    mount_trie_t(mount_trie_t const &);
+    mount_trie_t &operator=(mount_trie_t const &);
+
+    static int compare(node_t const *n, const char *name, size_t len)
+    {
+        size_t l = n->namelen < len ? n->namelen : len;
+        int r = ::memcmp(n->name, name, l);
+        if (r != 0)
+            return r;
+        return n->namelen < len ? -1 : n->namelen > len ? 1 : 0;
+    }
+
+    // Binary search among children sorted by name. Return insertion point if not found.
+    static size_t lower_bound(node_t const *node, const char *name, size_t len)
+    {
+        size_t lo = 0, hi = node->count;
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            if (compare(node->children[mid], name, len) < 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    static node_t const *find(node_t const *node, const char *name, size_t len)
+    {
+        size_t i = lower_bound(node, name, len);
+        if (i == node->count || compare(node->children[i], name, len) != 0)
+            return NULL;
+        return node->children[i];
+    }
+
+    static void clear(node_t *node)
+    {
+        for (size_t i = 0; i != node->count; ++i)
+        {
+            clear(node->children[i]);
+            ::free(node->children[i]);
+        }
+        ::free(node->children);
+        node->children = NULL;
+        node->count = 0;
+        node->capacity = 0;
+    }
+
+    static node_t *child(node_t *node, const char *name, size_t len)
+    {
+        size_t i = lower_bound(node, name, len);
+        if (i != node->count && compare(node->children[i], name, len) == 0)
+            return node->children[i];
+
+        if (node->count == node->capacity)
+        {
+            size_t capacity = node->capacity ? node->capacity * 2 : 4;
+            node_t **children = (node_t **)::realloc(node->children, capacity * sizeof(node_t *));
+            if (!children)
+                return NULL;
+            node->children = children;
+            node->capacity = capacity;
+        }
+
+        node_t *n = (node_t *)::malloc(sizeof(node_t) + len);
+        if (!n)
+            return NULL;
+        n->driver = NULL;
+        n->count = 0;
+        n->capacity = 0;
+        n->children = NULL;
+        n->namelen = len;
+        ::memcpy(n->name, name, len);
+        n->name[len] = '\0';
+
+        ::memmove(node->children + i + 1, node->children + i, (node->count - i) * sizeof(node_t *));
+        node->children[i] = n;
+        ++node->count;
+        return n;
+    }
+
+    bool flatten(entry_t const *entries, size_t count)
+    {
+        if (count == 0)
+            return true;
+
+        flat = (entry_t *)::malloc(count * sizeof(entry_t));
+        if (!flat)
+            return false;
+
+        for (; nflat != count; ++nflat)
+        {
+            entry_t const &e = entries[nflat];
+            char *root = (char *)::malloc(e.length + 1);
+            if (!root)
+                return false;
+            ::memcpy(root, e.root, e.length);
+            root[e.length] = '\0';
+            flat[nflat].root = root;
+            flat[nflat].length = e.length;
+            flat[nflat].driver = e.driver;
+        }
+        return true;
+    }
+
+    // Latest mount on any prefix wins; that's the same as deepest mount not hidden by later one
+    driver_t *linear_lookup(const char *path, size_t length) const
+    {
+        for (size_t i = nflat; i > 0; --i)
+        {
+            entry_t const &e = flat[i - 1];
+            if (e.length > length || ::memcmp(path, e.root, e.length) != 0)
+                continue;
+            if (e.length == length || path[e.length] == '/' || e.root[e.length - 1] == '/')
+                return e.driver;
+        }
+        return NULL;
+    }
+
+    bool insert(entry_t const &e)
+    {
+        node_t *node = &top;
+
+        const char *end = e.root + e.length;
+        for (const char *s = e.root; s < end;)
+        {
+            while (s < end && *s == '/')
+                ++s;
+            if (s == end)
+                break;
+
+            const char *p = (const char *)::memchr(s, '/', end - s);
+            if (!p)
+                p = end;
+
+            node = child(node, s, p - s);
+            if (!node)
+                return false;
+
+            s = p;
+        }
+
+        node->driver = e.driver;
+        // New mount hides everything mounted beneath it
+        clear(node);
+        return true;
+    }
+
+private:
+    node_t top;
+    entry_t *flat;
+    size_t nflat;
+};
+
+} // namespace fileio
+} // namespace crystax
+
+#endif // _CRYSTAX_FILEIO_MOUNTTRIE_HPP_7a266d3f21ab4e06b3f49e72af530715
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2011-2015 CrystaX.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice, this list of
+ *       conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *       of conditions and the following disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY CrystaX ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL CrystaX OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those of the
+ * authors and should not be interpreted as representing official policies, either expressed
+ * or implied, of CrystaX.
+ */
+
+#ifndef _CRYSTAX_FILEIO_RCU_HPP_197f9b6925a5483d9919c886682746c8
+#define _CRYSTAX_FILEIO_RCU_HPP_197f9b6925a5483d9919c886682746c8
+
+/*
+ * This header intentionally depends on nothing but system headers, so it could be
+ * used (and benchmarked) outside of libcrystax.
+ */
+
+#include <stddef.h>
+#include <sched.h>
+
+namespace crystax
+{
+namespace fileio
+{
+
+/*
+ * Pointer to immutable object which is read without locks and replaced by
+ * copy-on-write.
+ *
+ * Readers are accounted in one of two counters, selected by parity of current epoch.
+ * Writer publishes new object, flips the epoch and waits until all readers which
+ * could still see the previous object leave; only after that previous object is
+ * returned to the caller for disposal. Writers must be serialized by the caller.
+ */
+template <typename T>
+class rcu_ptr_t
+{
+public:
+    class reader_t
+    {
+    public:
+        explicit reader_t(rcu_ptr_t const &p)
+            :owner(p), epoch(p.read_lock())
+        {}
+
+        ~reader_t() {owner.read_unlock(epoch);}
+
+        T *get() const {return __atomic_load_n(&owner.ptr, __ATOMIC_ACQUIRE);}
+        T *operator->() const {return get();}
+
+    private:
+        reader_t(reader_t const &);
+        reader_t &operator=(reader_t const &);
+
+        rcu_ptr_t const &owner;
+        unsigned epoch;
+    };
+
+    explicit rcu_ptr_t(T *p = NULL)
+        :ptr(p), epoch(0)
+    {
+        readers[0].count = 0;
+        readers[1].count = 0;
+    }
+
+    // Writer side. Never call it from inside of read-side section.
+    T *exchange(T *p)
+    {
+        T *prev = __atomic_exchange_n(&ptr, p, __ATOMIC_SEQ_CST);
+        synchronize();
+        return prev;
+    }
+
+    // Writer side. Return when every reader started before the call has finished.
+    void synchronize()
+    {
+        unsigned e = __atomic_fetch_add(&epoch, 1, __ATOMIC_SEQ_CST);
+        while (__atomic_load_n(&readers[e & 1].count, __ATOMIC_ACQUIRE) != 0)
+            ::sched_yield();
+    }
+
+    // Writer side; object could be accessed without protection there.
+    T *unsafe_get() const {return ptr;}
+
+private:
+    rcu_ptr_t(rcu_ptr_t const &);
+    rcu_ptr_t &operator=(rcu_ptr_t const &);
+
+    unsigned read_lock() const
+    {
+        for (;;)
+        {
+            unsigned e = __atomic_load_n(&epoch, __ATOMIC_SEQ_CST);
+            __atomic_fetch_add(&readers[e & 1].count, 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&epoch, __ATOMIC_SEQ_CST) == e)
+                return e;
+            __atomic_fetch_sub(&readers[e & 1].count, 1, __ATOMIC_RELEASE);
+        }
+    }
+
+    void read_unlock(unsigned e) const
+    {
+        __atomic_fetch_sub(&readers[e & 1].count, 1, __ATOMIC_RELEASE);
+    }
+
+private:
+    T *ptr;
+    unsigned epoch;
+    // Keep counters on separate cache lines so readers of different epochs don't bounce
+    mutable struct
+    {
+        unsigned count;
+        char padding[64 - sizeof(unsigned)];
+    } readers[2];
+};
+
+} // namespace fileio
+} // namespace crystax
+
+#endif // _CRYSTAX_FILEIO_RCU_HPP_197f9b6925a5483d9919c886682746c8
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2011-2015 CrystaX.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice, this list of
+ *       conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *       of conditions and the following disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY CrystaX ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL CrystaX OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those of the
+ * authors and should not be interpreted as representing official policies, either expressed
+ * or implied, of CrystaX.
+ */
+
+#ifndef _CRYSTAX_FILEIO_READYSET_HPP_fab587fbd12147c2ba73886ab47a4736
+#define _CRYSTAX_FILEIO_READYSET_HPP_fab587fbd12147c2ba73886ab47a4736
+
+/*
+ * This header intentionally depends on nothing but system headers, so it could be
+ * used (and tested) outside of libcrystax.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/epoll.h>
+
+// Older Bionic headers don't define these
+#ifndef EPOLLRDNORM
+#define EPOLLRDNORM 0x040
+#endif
+#ifndef EPOLLWRNORM
+#define EPOLLWRNORM 0x100
+#endif
+
+namespace crystax
+{
+namespace fileio
+{
+
+/*
+ * Registrations of memory-backed descriptors in one epoll set.
+ *
+ * Kernel knows nothing about such descriptors, so they can't be added to kernel
+ * epoll instance; instead they're kept here and reported by epoll_wait() before
+ * asking kernel. They're always ready for reading and writing, so level-triggered
+ * entries are reported on every call, while edge-triggered and one-shot ones -
+ * only once after being added or modified. Reporting starts where previous call
+ * stopped, so every entry gets its turn even if caller asks for fewer events
+ * than there are registrations. Entries are kept sorted by descriptor, so they're
+ * looked up with binary search.
+ *
+ * Not thread-safe; caller is expected to serialize access.
+ */
+class ready_set_t
+{
+public:
+    static const uint32_t ALWAYS = EPOLLIN | EPOLLRDNORM | EPOLLOUT | EPOLLWRNORM;
+
+    ready_set_t()
+        :entries(NULL), count(0), capacity(0), cursor(0), pending(0)
+    {}
+
+    ~ready_set_t() {::free(entries);}
+
+    bool empty() const {return count == 0;}
+    size_t size() const {return count;}
+    bool contains(int fd) const {return find(fd) != count;}
+    int fd_at(size_t i) const {return entries[i].fd;}
+
+    /*
+     * Whether collect() would report anything.
+     */
+    bool ready() const {return pending != 0;}
+
+    int add(int fd, struct epoll_event const &ev)
+    {
+        size_t i = lower_bound(fd);
+        if (i != count && entries[i].fd == fd)
+        {
+            errno = EEXIST;
+            return -1;
+        }
+
+        if (count == capacity)
+        {
+            size_t n = capacity ? capacity * 2 : 4;
+            entry_t *p = (entry_t *)::realloc(entries, n * sizeof(entry_t));
+            if (!p)
+            {
+                errno = ENOMEM;
+                return -1;
+            }
+            entries = p;
+            capacity = n;
+        }
+
+        ::memmove(&entries[i + 1], &entries[i], (count - i) * sizeof(entry_t));
+        ++count;
+        // Keep cursor on the same entry
+        if (i < cursor)
+            ++cursor;
+
+        entry_t &e = entries[i];
+        e.fd = fd;
+        e.ev = ev;
+        e.armed = true;
+        if (reportable(e))
+            ++pending;
+        return 0;
+    }
+
+    int modify(int fd, struct epoll_event const &ev)
+    {
+        size_t i = find(fd);
+        if (i == count)
+        {
+            errno = ENOENT;
+            return -1;
+        }
+
+        if (reportable(entries[i]))
+            --pending;
+        entries[i].ev = ev;
+        entries[i].armed = true;
+        if (reportable(entries[i]))
+            ++pending;
+        return 0;
+    }
+
+    int remove(int fd)
+    {
+        size_t i = find(fd);
+        if (i == count)
+        {
+            errno = ENOENT;
+            return -1;
+        }
+
+        if (reportable(entries[i]))
+            --pending;
+        --count;
+        ::memmove(&entries[i], &entries[i + 1], (count - i) * sizeof(entry_t));
+        if (i < cursor)
+            --cursor;
+        if (cursor >= count)
+            cursor = 0;
+        return 0;
+    }
+
+    /*
+     * Fill at most 'maxevents' events and return their number.
+     */
+    int collect(struct epoll_event *events, int maxevents)
+    {
+        int n = 0;
+        size_t scanned = 0;
+        for (; scanned != count && n < maxevents; ++scanned)
+        {
+            entry_t &e = entries[(cursor + scanned) % count];
+            if (!reportable(e))
+                continue;
+
+            events[n].events = e.ev.events & ALWAYS;
+            events[n].data = e.ev.data;
+            ++n;
+
+            if (e.ev.events & (EPOLLET | EPOLLONESHOT))
+            {
+                e.armed = false;
+                --pending;
+            }
+        }
+
+        if (count)
+            cursor = (cursor + scanned) % count;
+        return n;
+    }
+
+private:
+    ready_set_t(ready_set_t const &);
+    ready_set_t &operator=(ready_set_t const &);
+
+    struct entry_t
+    {
+        int fd;
+        struct epoll_event ev;
+        bool armed;
+    };
+
+    static bool reportable(entry_t const &e)
+    {
+        return e.armed && (e.ev.events & ALWAYS) != 0;
+    }
+
+    // Index of first entry with descriptor not less than 'fd'
+    size_t lower_bound(int fd) const
+    {
+        size_t low = 0;
+        size_t n = count;
+        while (n > 0)
+        {
+            size_t half = n / 2;
+            if (entries[low + half].fd < fd)
+            {
+                low += half + 1;
+                n -= half + 1;
+            }
+            else
+                n = half;
+        }
+        return low;
+    }
+
+    size_t find(int fd) const
+    {
+        size_t i = lower_bound(fd);
+        return i != count && entries[i].fd == fd ? i : count;
+    }
+
+private:
+    entry_t *entries;
+    size_t count;
+    size_t capacity;
+    size_t cursor;
+    // Number of entries collect() would report
+    size_t pending;
+};
+
+} // namespace fileio
+} // namespace crystax
+
+#endif // _CRYSTAX_FILEIO_READYSET_HPP_fab587fbd12147c2ba73886ab47a4736
@@ -51,68 +51,83 @@ namespace crystax
 namespace fileio
 {
 
-char *normalize(const char *path)
+static bool append(char *buf, size_t bufsize, size_t *buflen, const char *s, size_t n)
 {
-    char part[NAME_MAX + 1];
-    char buf[PATH_MAX + 1];
-    size_t buflen;
+    if (*buflen + n >= bufsize)
+    {
+        ERR("not enough space in buf");
+        errno = ENAMETOOLONG;
+        return false;
+    }
 
+    ::memcpy(buf + *buflen, s, n);
+    *buflen += n;
+    buf[*buflen] = '\0';
+    return true;
+}
+
+bool normalize(const char *path, char *buf, size_t bufsize, size_t *length)
+{
     DBG("** path=%s", path);
 
     if (path == NULL)
     {
         ERR("empty path");
-        return NULL;
+        return false;
+    }
+
+    if (buf == NULL || bufsize == 0)
+    {
+        ERR("no buffer");
+        return false;
     }
 
     buf[0] = '\0';
-    buflen = 0;
+    size_t buflen = 0;
     for (const char *s = path, *p = path; p; s = p + 1)
     {
         DBG("s=%s", s);
         p = ::strchr(s, '/');
         DBG("p=%s", p);
         size_t partlen = p ? p - s : ::strlen(s);
-        if (partlen >= sizeof(part))
-            partlen = sizeof(part) - 1;
-        ::strncpy(part, s, partlen);
-        part[partlen] = '\0';
-        DBG("- part=%s", part);
+        if (partlen > NAME_MAX)
+            partlen = NAME_MAX;
+        DBG("- part=%.*s", (int)partlen, s);
 
         if (partlen == 0)
         {
             if (buflen == 0 && *path == '/')
             {
                 DBG("leading slash found");
-                ::strcat(buf, "/");
-                ++buflen;
+                if (!append(buf, bufsize, &buflen, "/", 1))
+                    return false;
             }
             else
                 DBG("ignore empty part");
         }
-        else if (partlen == 1 && part[0] == '.')
+        else if (partlen == 1 && s[0] == '.')
         {
             if (buflen == 0)
             {
                 DBG("'.' part at begin");
-                ::strcat(buf, ".");
-                ++buflen;
+                if (!append(buf, bufsize, &buflen, ".", 1))
+                    return false;
             }
             else
                 DBG("ignore '.' part");
         }
-        else if (partlen == 2 && part[0] == '.' && part[1] == '.')
+        else if (partlen == 2 && s[0] == '.' && s[1] == '.')
         {
             if (buflen == 0)
             {
                 DBG("'..' part at begin");
-                ::strcat(buf, "..");
-                buflen += 2;
+                if (!append(buf, bufsize, &buflen, "..", 2))
+                    return false;
             }
             else
             {
                 DBG("remove last component");
-                char *v = ::strrchr(buf, '/');
+                char *v = (char*)::memrchr(buf, '/', buflen);
                 DBG("v=%s", v);
                 if (v == NULL)
                 {
@@ -121,19 +136,21 @@ char *normalize(const char *path)
                     if (buflen == 1 && buf[0] == '.')
                     {
                         // Special case: '.'
-                        ::strcpy(buf, "..");
-                        buflen += 2;
+                        buflen = 0;
+                        if (!append(buf, bufsize, &buflen, "..", 2))
+                            return false;
                     }
                     else if (buflen == 2 && buf[0] == '.' && buf[1] == '.')
                     {
                         // Special case: '..'
-                        ::strcat(buf, "/..");
-                        buflen += 3;
+                        if (!append(buf, bufsize, &buflen, "/..", 3))
+                            return false;
                     }
                     else
                     {
-                        ::strcpy(buf, ".");
-                        buflen = 1;
+                        buflen = 0;
+                        if (!append(buf, bufsize, &buflen, ".", 1))
+                            return false;
                     }
                 }
                 else
@@ -150,8 +167,8 @@ char *normalize(const char *path)
                     if (buf + buflen - v == 3 && v[0] == '/' && v[1] == '.' && v[2] == '.')
                     {
                         // Special case: '../..'
-                        ::strcat(buf, "/..");
-                        buflen += 3;
+                        if (!append(buf, bufsize, &buflen, "/..", 3))
+                            return false;
                     }
                     else
                     {
@@ -173,16 +190,25 @@ char *normalize(const char *path)
             if (buflen > 0 && buf[buflen - 1] != '/')
             {
                 DBG("add '/' to the end");
-                ::strcat(buf, "/");
-                ++buflen;
+                if (!append(buf, bufsize, &buflen, "/", 1))
+                    return false;
             }
-            ::strcat(buf, part);
-            buflen += partlen;
+            if (!append(buf, bufsize, &buflen, s, partlen))
+                return false;
         }
         DBG("-- buf=%s", buf);
     }
 
     DBG("++ result=%s", buf);
+    if (length) *length = buflen;
+    return true;
+}
+
+char *normalize(const char *path)
+{
+    char buf[PATH_MAX + 1];
+    if (!normalize(path, buf, sizeof(buf), NULL))
+        return NULL;
     return ::strdup(buf);
 }
 
@@ -227,42 +253,52 @@ bool is_normalized(const char *path)
     return true;
 }
 
-char *absolutize(const char *path)
+bool absolutize(const char *path, char *buf, size_t bufsize, size_t *length)
 {
-    char buf[PATH_MAX + 1];
+    char tmp[PATH_MAX + 1];
 
     DBG("path=%s", path);
 
     if (path == NULL || *path == '\0')
     {
         ERR("empty path");
-        return NULL;
+        return false;
     }
 
     if (*path == '/')
     {
         DBG("already absolute path, going to normalize");
-        return normalize(path);
+        return normalize(path, buf, bufsize, length);
     }
 
     DBG("going to getcwd");
-    if (getcwd(buf, sizeof buf) == NULL)
+    if (getcwd(tmp, sizeof tmp) == NULL)
     {
         DBG("getcwd return NULL");
-        return NULL;
+        return false;
     }
 
-    DBG("getcwd() return %s", buf);
-    if (sizeof(buf) - strlen(buf) - 1 < strlen(path) + 1)
+    DBG("getcwd() return %s", tmp);
+    size_t cwdlen = ::strlen(tmp);
+    size_t pathlen = ::strlen(path);
+    if (sizeof(tmp) - cwdlen - 1 < pathlen + 1)
     {
         ERR("not enough space in buf");
-        return NULL;
+        return false;
     }
 
-    strcat(buf, "/");
-    strcat(buf, path);
-    DBG("going to normalize %s", buf);
-    return normalize(buf);
+    tmp[cwdlen] = '/';
+    ::memcpy(tmp + cwdlen + 1, path, pathlen + 1);
+    DBG("going to normalize %s", tmp);
+    return normalize(tmp, buf, bufsize, length);
+}
+
+char *absolutize(const char *path)
+{
+    char buf[PATH_MAX + 1];
+    if (!absolutize(path, buf, sizeof(buf), NULL))
+        return NULL;
+    return ::strdup(buf);
 }
 
 bool is_absolute(const char *path)
@@ -30,6 +30,7 @@
 #ifndef _CRYSTAX_VFS_H_86150e922dc84672bc8fc4003d28619e
 #define _CRYSTAX_VFS_H_86150e922dc84672bc8fc4003d28619e
 
+#include <stddef.h>
 #include <jni.h>
 
 #ifdef __cplusplus
@@ -39,6 +40,13 @@ extern "C" {
 int crystax_vfs_jni_on_load(JavaVM *vm);
 void crystax_vfs_jni_on_unload(JavaVM *vm);
 
+/*
+ * Start copying given files out of read-only storage (e.g. assets) in background,
+ * so opening them for writing later is cheap. Files not backed by such storage are
+ * ignored. Return number of files queued, or -1 and set errno.
+ */
+int crystax_vfs_prefetch(const char *const *paths, size_t count);
+
 #ifdef __cplusplus
 }
 #endif
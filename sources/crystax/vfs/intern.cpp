@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2011-2015 CrystaX.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice, this list of
+ *       conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *       of conditions and the following disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY CrystaX ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL CrystaX OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those of the
+ * authors and should not be interpreted as representing official policies, either expressed
+ * or implied, of CrystaX.
+ */
+
+#include "fileio/intern.hpp"
+
+namespace crystax
+{
+namespace fileio
+{
+
+struct intern_entry_t
+{
+    intern_entry_t *next;
+    int refs;
+    uint32_t hash;
+    size_t length;
+    char path[1];
+};
+
+enum
+{
+    INTERN_BUCKETS = 1024
+};
+
+static intern_entry_t *intern_table[INTERN_BUCKETS];
+static pthread_mutex_t intern_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static intern_entry_t *entry(const char *ipath)
+{
+    return reinterpret_cast<intern_entry_t *>(const_cast<char *>(ipath) - offsetof(intern_entry_t, path));
+}
+
+CRYSTAX_LOCAL
+uint32_t path_hash(const char *path, size_t length)
+{
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i != length; ++i)
+    {
+        h ^= (unsigned char)path[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+CRYSTAX_LOCAL
+const char *intern(abspath_view_t const &path)
+{
+    if (!path)
+        return NULL;
+
+    uint32_t h = path_hash(path.c_str(), path.length());
+    intern_entry_t **bucket = &intern_table[h % INTERN_BUCKETS];
+
+    scope_lock_t lock(intern_mutex);
+
+    for (intern_entry_t *e = *bucket; e; e = e->next)
+    {
+        if (e->hash != h || e->length != path.length())
+            continue;
+        if (::memcmp(e->path, path.c_str(), path.length()) != 0)
+            continue;
+
+        __sync_add_and_fetch(&e->refs, 1);
+        return e->path;
+    }
+
+    intern_entry_t *e = (intern_entry_t *)::malloc(sizeof(intern_entry_t) + path.length());
+    if (!e)
+        return NULL;
+
+    e->refs = 1;
+    e->hash = h;
+    e->length = path.length();
+    ::memcpy(e->path, path.c_str(), path.length());
+    e->path[path.length()] = '\0';
+
+    e->next = *bucket;
+    *bucket = e;
+
+    DBG("interned %s", e->path);
+    return e->path;
+}
+
+CRYSTAX_LOCAL
+const char *intern_retain(const char *ipath)
+{
+    if (ipath)
+        __sync_add_and_fetch(&entry(ipath)->refs, 1);
+    return ipath;
+}
+
+CRYSTAX_LOCAL
+void intern_release(const char *ipath)
+{
+    if (!ipath)
+        return;
+
+    intern_entry_t *e = entry(ipath);
+
+    // Drop reference without the lock while it's not the last one
+    int refs = __atomic_load_n(&e->refs, __ATOMIC_RELAXED);
+    while (refs > 1)
+    {
+        if (__atomic_compare_exchange_n(&e->refs, &refs, refs - 1, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            return;
+    }
+
+    // Reference could be resurrected by intern() only under the lock,
+    // so last reference have to be dropped under the lock too
+    scope_lock_t lock(intern_mutex);
+
+    if (__sync_sub_and_fetch(&e->refs, 1) != 0)
+        return;
+
+    for (intern_entry_t **pe = &intern_table[e->hash % INTERN_BUCKETS]; *pe; pe = &(*pe)->next)
+    {
+        if (*pe != e)
+            continue;
+
+        *pe = e->next;
+        break;
+    }
+
+    DBG("released %s", e->path);
+    ::free(e);
+}
+
+} // namespace fileio
+} // namespace crystax
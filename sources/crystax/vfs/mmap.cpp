@@ -35,7 +35,7 @@ namespace fileio
 {
 
 CRYSTAX_LOCAL
-int mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset)
+void *mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset)
 {
     DBG("fd=%d", fd);
 
@@ -45,12 +45,12 @@ int mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset)
     else
     {
         if (!resolve(fd, NULL, &extfd, NULL, NULL))
-            return -1;
+            return MAP_FAILED;
 
         if (extfd == -1)
         {
             errno = EBADF;
-            return -1;
+            return MAP_FAILED;
         }
     }
 
@@ -61,7 +61,7 @@ int mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset)
 } // namespace crystax
 
 CRYSTAX_GLOBAL
-int mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset)
+void *mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset)
 {
     return ::crystax::fileio::mmap(addr, length, prot, flags, fd, offset);
 }
@@ -31,6 +31,8 @@
 
 #include "fileio/common.hpp"
 #include "fileio/driver.hpp"
+#include "fileio/mounttrie.hpp"
+#include "fileio/rcu.hpp"
 
 #include "crystax/memory.hpp"
 #include "crystax/lock.hpp"
@@ -51,10 +53,36 @@ enum
     MOUNT_TABLE_SIZE = 256
 };
 
+// Mount records in the order they were made. Changed only under mount_table_mutex;
+// readers use immutable trie built from it.
 static driver_t *mount_table[MOUNT_TABLE_SIZE];
 static int mount_table_pos = 0;
 static pthread_mutex_t mount_table_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER;
 
+static rcu_ptr_t<mount_trie_t> mount_trie;
+
+// Should be called with mount_table_mutex locked
+static mount_trie_t *build_mount_trie(driver_t *const *drivers, size_t count, driver_t *skip = NULL)
+{
+    mount_trie_t::entry_t entries[MOUNT_TABLE_SIZE];
+    size_t n = 0;
+    for (size_t i = 0; i != count; ++i)
+    {
+        driver_t *d = drivers[i];
+        if (d == skip)
+            continue;
+
+        entries[n].root = d->root().c_str();
+        entries[n].length = d->root().length();
+        entries[n].driver = d;
+        ++n;
+    }
+
+    return mount_trie_t::build(entries, n);
+}
+
+// Returned driver is only looked up under RCU protection; it's not referenced, so
+// it stays valid only as long as its file system isn't unmounted (see umount()).
 CRYSTAX_LOCAL
 driver_t *find_driver(const char *path)
 {
@@ -63,25 +91,24 @@ driver_t *find_driver(const char *path)
     if (path == NULL || *path == '\0')
         return NULL;
 
-    scope_lock_t lock(mount_table_mutex);
+    rcu_ptr_t<mount_trie_t>::reader_t trie(mount_trie);
 
-    if (mount_table_pos == 0)
+    if (!trie.get() || trie->empty())
     {
         DBG("path=%s: no mount records registered, use SYSTEM driver", path);
         return system::driver_t::instance();
     }
 
-    abspath_t abspath(path);
-    size_t nlen = ::strlen(abspath.c_str());
-    for (size_t i = mount_table_pos; i > 0; --i)
+    char buf[PATH_MAX + 1];
+    abspath_view_t abspath(path, buf, sizeof(buf));
+    if (!abspath)
+        return NULL;
+
+    driver_t *d = trie->lookup(abspath.c_str(), abspath.length());
+    if (d)
     {
-        driver_t *d = mount_table[i - 1];
-        size_t len = ::strlen(d->root().c_str());
-        if (nlen >= len && ::strncmp(abspath.c_str(), d->root().c_str(), len) == 0)
-        {
-            DBG("path=%s: use driver %s (%s)", path, d->name(), d->info());
-            return d;
-        }
+        DBG("path=%s: use driver %s (%s)", path, d->name(), d->info());
+        return d;
     }
 
     DBG("path=%s: no mount record found, use system driver", path);
@@ -126,8 +153,19 @@ int mount(const char *source, const char *target, const char *fstype,
 
     mount_table[mount_table_pos] = driver;
 
+    mount_trie_t *trie = build_mount_trie(mount_table, mount_table_pos + 1);
+    if (!trie)
+    {
+        ERR("can't build mount trie");
+        unload_driver(driver);
+        errno = ENOMEM;
+        return -1;
+    }
+
     ++mount_table_pos;
 
+    delete mount_trie.exchange(trie);
+
     return 0;
 }
 
@@ -158,11 +196,23 @@ int umount(const char *target, int flags)
         if (d->root() == abspath)
         {
             DBG("unmount target %s", abspath.c_str());
-            unload_driver(d);
+            mount_trie_t *trie = build_mount_trie(mount_table, mount_table_pos, d);
+            if (!trie)
+            {
+                ERR("can't build mount trie");
+                errno = ENOMEM;
+                return -1;
+            }
             // Shift above records
             for (size_t j = i - 1; j < (size_t)mount_table_pos - 1; ++j)
                 mount_table[j] = mount_table[j + 1];
             --mount_table_pos;
+            // After exchange() no new lookup returns d. That doesn't cover
+            // callers which got d from find_driver() earlier and are still using
+            // it, nor descriptors opened through it: as before, caller of umount()
+            // must make sure nothing uses the file system being unmounted.
+            delete mount_trie.exchange(trie);
+            unload_driver(d);
             return 0;
         }
     }
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2011-2015 CrystaX.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice, this list of
+ *       conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *       of conditions and the following disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY CrystaX ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL CrystaX OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those of the
+ * authors and should not be interpreted as representing official policies, either expressed
+ * or implied, of CrystaX.
+ */
+
+#include "fileio/api.hpp"
+#include "system/driver.hpp"
+
+namespace crystax
+{
+namespace fileio
+{
+
+enum
+{
+    POLL_STACK_FDS = 64
+};
+
+// Memory-backed descriptors never block
+static const short MEMORY_READY = POLLIN | POLLRDNORM | POLLOUT | POLLWRNORM;
+
+/*
+ * Descriptors of all drivers are resolved without locking and translated to
+ * kernel ones in place, so the whole set is waited on with one system call.
+ * Memory-backed descriptors are reported ready right away; if there are any,
+ * kernel is only asked what's ready now, without waiting.
+ */
+CRYSTAX_LOCAL
+int poll(struct pollfd *fds, nfds_t nfds, int timeout)
+{
+    DBG("fds=%p, nfds=%lu, timeout=%d", fds, (unsigned long)nfds, timeout);
+
+    struct pollfd stackfds[POLL_STACK_FDS];
+    struct pollfd *kfds = stackfds;
+    if (nfds > POLL_STACK_FDS)
+    {
+        kfds = (struct pollfd *)::malloc(nfds * sizeof(struct pollfd));
+        if (!kfds)
+        {
+            errno = ENOMEM;
+            return -1;
+        }
+    }
+
+    int ready = 0;
+    nfds_t nkernel = 0;
+    for (nfds_t i = 0; i != nfds; ++i)
+    {
+        struct pollfd &p = fds[i];
+        p.revents = 0;
+        kfds[i].fd = -1;
+        kfds[i].events = 0;
+        kfds[i].revents = 0;
+
+        if (p.fd < 0)
+            continue;
+
+        int extfd;
+        driver_t *driver;
+        if (!resolve(p.fd, NULL, &extfd, NULL, &driver))
+        {
+            p.revents = POLLNVAL;
+            ++ready;
+            continue;
+        }
+
+        int kfd = driver->kernel_fd(extfd);
+        if (kfd < 0)
+        {
+            p.revents = p.events & MEMORY_READY;
+            if (p.revents)
+                ++ready;
+            continue;
+        }
+
+        kfds[i].fd = kfd;
+        kfds[i].events = p.events;
+        ++nkernel;
+    }
+
+    // Even with nothing to wait for, caller expects us to sleep for 'timeout'
+    if (nkernel > 0 || ready == 0)
+    {
+        int n = system_poll(kfds, nfds, ready > 0 ? 0 : timeout);
+        if (n < 0 && ready == 0)
+            ready = -1;
+        for (nfds_t i = 0; n > 0 && i != nfds; ++i)
+        {
+            if (kfds[i].fd < 0 || kfds[i].revents == 0)
+                continue;
+            fds[i].revents = kfds[i].revents;
+            ++ready;
+        }
+    }
+
+    if (kfds != stackfds)
+    {
+        int err = errno;
+        ::free(kfds);
+        errno = err;
+    }
+
+    DBG("return %d", ready);
+    return ready;
+}
+
+} // namespace fileio
+} // namespace crystax
+
+CRYSTAX_GLOBAL
+int poll(struct pollfd *fds, nfds_t nfds, int timeout)
+{
+    return ::crystax::fileio::poll(fds, nfds, timeout);
+}
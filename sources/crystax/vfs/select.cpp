@@ -29,60 +29,135 @@
 
 #include "fileio/api.hpp"
 
+#include <limits.h>
+
 namespace crystax
 {
 namespace fileio
 {
 
+enum
+{
+    SELECT_STACK_FDS = 64,
+    SELECT_WORD_BITS = sizeof(unsigned long) * CHAR_BIT
+};
+
+/*
+ * fd_set is bit array of unsigned longs in both Bionic and glibc; walk it word by
+ * word, so sparse sets don't cost a test per descriptor.
+ */
+static unsigned long set_word(fd_set const *set, size_t w)
+{
+    return set ? reinterpret_cast<const unsigned long *>(set)[w] : 0;
+}
+
+/*
+ * Implemented on top of poll(), so descriptors of different drivers could be
+ * mixed freely, and kernel descriptors behind them don't have to fit FD_SETSIZE.
+ */
 CRYSTAX_LOCAL
 int select(int maxfd, fd_set *rfd, fd_set *wfd, fd_set *efd, struct timeval *tv)
 {
     DBG("maxfd=%d, rfd=%p, wfd=%p, efd=%p, tv=%p", maxfd, rfd, wfd, efd, tv);
 
-    driver_t *driver = NULL;
-    int extmaxfd = 0;
-    fd_set extrfd;
-    fd_set extwfd;
-    fd_set extefd;
+    if (maxfd < 0 || (tv && (tv->tv_sec < 0 || tv->tv_usec < 0)))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    if (maxfd > FD_SETSIZE)
+        maxfd = FD_SETSIZE;
 
-    if (rfd) FD_ZERO(&extrfd);
-    if (wfd) FD_ZERO(&extwfd);
-    if (efd) FD_ZERO(&extefd);
+    struct pollfd stackfds[SELECT_STACK_FDS];
+    struct pollfd *pfds = stackfds;
+    if (maxfd > SELECT_STACK_FDS)
+    {
+        pfds = (struct pollfd *)::malloc(maxfd * sizeof(struct pollfd));
+        if (!pfds)
+        {
+            errno = ENOMEM;
+            return -1;
+        }
+    }
 
-    for (int fd = 0; fd < maxfd; ++fd)
+    nfds_t nfds = 0;
+    size_t words = (maxfd + SELECT_WORD_BITS - 1) / SELECT_WORD_BITS;
+    for (size_t w = 0; w != words; ++w)
     {
-#define CRYSTAX_SELECT_SET(fd, fds, extfds)                        \
-        if (fds && FD_ISSET(fd, fds))                              \
-        {                                                          \
-            int extfd;                                             \
-            driver_t *d;                                           \
-            if (!resolve(fd, NULL, &extfd, NULL, &d))              \
-                return -1;                                         \
-            if (!driver)                                           \
-                driver = d;                                        \
-            else if (driver != d)                                  \
-            {                                                      \
-                ERR("select across sources not supported yet");    \
-                errno = EXDEV;                                     \
-                return -1;                                         \
-            }                                                      \
-            if (extmaxfd <= extfd)                                 \
-                extmaxfd = extfd + 1;                              \
-            FD_SET(extfd, &extfds);                                \
+        unsigned long r = set_word(rfd, w);
+        unsigned long x = set_word(wfd, w);
+        unsigned long e = set_word(efd, w);
+        for (unsigned long bits = r | x | e; bits != 0; bits &= bits - 1)
+        {
+            int bit = __builtin_ctzl(bits);
+            int fd = w * SELECT_WORD_BITS + bit;
+            if (fd >= maxfd)
+                break;
+
+            unsigned long mask = 1UL << bit;
+            struct pollfd &p = pfds[nfds++];
+            p.fd = fd;
+            p.events = 0;
+            if (r & mask) p.events |= POLLIN;
+            if (x & mask) p.events |= POLLOUT;
+            if (e & mask) p.events |= POLLPRI;
+        }
+    }
+
+    int timeout = -1;
+    if (tv)
+    {
+        long long ms = (long long)tv->tv_sec * 1000 + (tv->tv_usec + 999) / 1000;
+        timeout = ms > INT_MAX ? INT_MAX : (int)ms;
+    }
+
+    int ret = fileio::poll(pfds, nfds, timeout);
+    for (nfds_t i = 0; ret > 0 && i != nfds; ++i)
+    {
+        if (pfds[i].revents & POLLNVAL)
+        {
+            errno = EBADF;
+            ret = -1;
         }
-        CRYSTAX_SELECT_SET(fd, rfd, extrfd);
-        CRYSTAX_SELECT_SET(fd, wfd, extwfd);
-        CRYSTAX_SELECT_SET(fd, efd, extefd);
-#undef CRYSTAX_SELECT_SET
     }
-    if (!driver)
+
+    if (ret >= 0)
+    {
+        if (rfd) FD_ZERO(rfd);
+        if (wfd) FD_ZERO(wfd);
+        if (efd) FD_ZERO(efd);
+
+        ret = 0;
+        for (nfds_t i = 0; i != nfds; ++i)
+        {
+            struct pollfd const &p = pfds[i];
+            if ((p.events & POLLIN) && (p.revents & (POLLIN | POLLHUP | POLLERR)))
+            {
+                FD_SET(p.fd, rfd);
+                ++ret;
+            }
+            if ((p.events & POLLOUT) && (p.revents & (POLLOUT | POLLERR)))
+            {
+                FD_SET(p.fd, wfd);
+                ++ret;
+            }
+            if ((p.events & POLLPRI) && (p.revents & POLLPRI))
+            {
+                FD_SET(p.fd, efd);
+                ++ret;
+            }
+        }
+    }
+
+    if (pfds != stackfds)
     {
-        DBG("empty sets");
-        return 0;
+        int err = errno;
+        ::free(pfds);
+        errno = err;
     }
 
-    return driver->select(extmaxfd, rfd ? &extrfd : NULL, wfd ? &extwfd : NULL,
-        efd ? &extefd : NULL, tv);
+    DBG("return %d", ret);
+    return ret;
 }
 
 } // namespace fileio
@@ -32,6 +32,13 @@
 
 #include "fileio/driver.hpp"
 
+#include <poll.h>
+#include <sys/epoll.h>
+
+#ifndef EPOLL_CLOEXEC
+#define EPOLL_CLOEXEC O_CLOEXEC
+#endif
+
 namespace crystax
 {
 namespace fileio
@@ -100,10 +107,19 @@ public:
     int    unlink(const char *path);
     ssize_t write(int fd, const void *buf, size_t count);
     int    writev(int fd, const struct iovec *iov, int count);
+
+    int    kernel_fd(int fd) {return fd;}
 };
 
 } // namespace system
 } // namespace fileio
+
+int system_epoll_create(int size);
+int system_epoll_create1(int flags);
+int system_epoll_ctl(int epfd, int op, int fd, struct epoll_event *event);
+int system_epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout);
+int system_poll(struct pollfd *fds, nfds_t nfds, int timeout);
+
 } // namespace crystax
 
 #endif // _CRYSTAX_FILEIO_SYSTEM_DRIVER_HPP_8c3ea337310344549cb60cbfe3683166
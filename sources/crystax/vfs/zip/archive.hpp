@@ -0,0 +1,691 @@
+/*
+ * Copyright (c) 2011-2015 CrystaX.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice, this list of
+ *       conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *       of conditions and the following disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY CrystaX ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL CrystaX OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those of the
+ * authors and should not be interpreted as representing official policies, either expressed
+ * or implied, of CrystaX.
+ */
+
+#ifndef _CRYSTAX_FILEIO_ZIP_ARCHIVE_HPP_ee4fdb7e23244f60878e4222cbeb9ac5
+#define _CRYSTAX_FILEIO_ZIP_ARCHIVE_HPP_ee4fdb7e23244f60878e4222cbeb9ac5
+
+/*
+ * This header intentionally depends on nothing but system headers and zlib, so it
+ * could be used (and tested) outside of libcrystax.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+#include <zlib.h>
+
+#include "zip/seekindex.hpp"
+
+namespace crystax
+{
+namespace fileio
+{
+namespace zip
+{
+
+enum
+{
+    STORED = 0,
+    DEFLATED = 8
+};
+
+struct entry_t
+{
+    const char *name; // Points to central directory, not NUL-terminated
+    size_t namelen;
+    unsigned method;
+    unsigned flags;
+    uint32_t crc;
+    uint32_t dostime;
+    uint32_t mode;    // Unix mode if archive was made on Unix, 0 otherwise
+    uint64_t csize;
+    uint64_t usize;
+    uint64_t offset;  // Offset of local header
+};
+
+/*
+ * Read-only index of zip archive mapped into memory.
+ *
+ * Central directory is parsed once into array of entries sorted by name, so both
+ * lookup of file and check for directory are binary searches. Names and data are
+ * never copied; they're referenced right in mapped archive.
+ */
+class archive_t
+{
+public:
+    /*
+     * Parse archive mapped at [base, base + size). Memory must stay mapped while
+     * archive_t and anything obtained from it is used. Return NULL and set errno
+     * if it's not a valid zip archive.
+     */
+    static archive_t *open(const void *base, uint64_t size)
+    {
+        archive_t *a = new archive_t(base, size);
+        if (!a->parse())
+        {
+            int e = errno;
+            delete a;
+            errno = e;
+            return NULL;
+        }
+        return a;
+    }
+
+    ~archive_t()
+    {
+        ::free(entries);
+    }
+
+    const uint8_t *base() const {return start;}
+    uint64_t size() const {return length;}
+
+    size_t count() const {return nentries;}
+    entry_t const &entry(size_t idx) const {return entries[idx];}
+    size_t index(entry_t const *e) const {return e - entries;}
+
+    /*
+     * Find file by exact name (relative, no leading slash). Directory markers
+     * (names with trailing slash) are never returned.
+     */
+    entry_t const *find(const char *name, size_t len) const
+    {
+        size_t i = lower_bound(name, len, false);
+        if (i == nentries)
+            return NULL;
+        entry_t const &e = entries[i];
+        if (e.namelen != len || ::memcmp(e.name, name, len) != 0)
+            return NULL;
+        return &e;
+    }
+
+    /*
+     * Return true if 'name' is a directory, i.e. there is explicit directory marker
+     * for it or any entry beneath it. Empty name means archive root.
+     */
+    bool directory(const char *name, size_t len) const
+    {
+        if (len == 0)
+            return true;
+        return first(name, len) != nentries;
+    }
+
+    /*
+     * Return index of first entry beneath directory 'name' (entries beneath it are
+     * contiguous), or count() if there are no such entries.
+     */
+    size_t first(const char *name, size_t len) const
+    {
+        if (len == 0)
+            return 0;
+        size_t i = lower_bound(name, len, true);
+        if (i == nentries || !beneath(entries[i], name, len))
+            return nentries;
+        return i;
+    }
+
+    static bool beneath(entry_t const &e, const char *name, size_t len)
+    {
+        return len == 0 ||
+            (e.namelen > len && e.name[len] == '/' && ::memcmp(e.name, name, len) == 0);
+    }
+
+    /*
+     * Return pointer to (possibly compressed) data of entry, or NULL and set errno
+     * if local header is broken.
+     */
+    const uint8_t *data(entry_t const &e) const
+    {
+        if (e.offset > length || length - e.offset < LOCAL_HEADER_SIZE)
+        {
+            errno = EIO;
+            return NULL;
+        }
+
+        const uint8_t *p = start + e.offset;
+        if (le32(p) != LOCAL_HEADER_SIGNATURE)
+        {
+            errno = EIO;
+            return NULL;
+        }
+
+        uint64_t off = e.offset + LOCAL_HEADER_SIZE + le16(p + 26) + le16(p + 28);
+        if (off > length || length - off < e.csize)
+        {
+            errno = EIO;
+            return NULL;
+        }
+
+        return start + off;
+    }
+
+    static time_t mtime(entry_t const &e)
+    {
+        struct tm tm;
+        ::memset(&tm, 0, sizeof(tm));
+        tm.tm_sec = (e.dostime & 0x1f) * 2;
+        tm.tm_min = (e.dostime >> 5) & 0x3f;
+        tm.tm_hour = (e.dostime >> 11) & 0x1f;
+        tm.tm_mday = (e.dostime >> 16) & 0x1f;
+        tm.tm_mon = ((e.dostime >> 21) & 0x0f) - 1;
+        tm.tm_year = ((e.dostime >> 25) & 0x7f) + 80;
+        tm.tm_isdst = -1;
+        return ::mktime(&tm);
+    }
+
+    static uint16_t le16(const uint8_t *p) {return (uint16_t)(p[0] | (p[1] << 8));}
+    static uint32_t le32(const uint8_t *p) {return (uint32_t)le16(p) | ((uint32_t)le16(p + 2) << 16);}
+    static uint64_t le64(const uint8_t *p) {return (uint64_t)le32(p) | ((uint64_t)le32(p + 4) << 32);}
+
+private:
+    enum
+    {
+        LOCAL_HEADER_SIGNATURE = 0x04034b50,
+        LOCAL_HEADER_SIZE = 30,
+        CENTRAL_HEADER_SIGNATURE = 0x02014b50,
+        CENTRAL_HEADER_SIZE = 46,
+        EOCD_SIGNATURE = 0x06054b50,
+        EOCD_SIZE = 22,
+        ZIP64_LOCATOR_SIGNATURE = 0x07064b50,
+        ZIP64_LOCATOR_SIZE = 20,
+        ZIP64_EOCD_SIGNATURE = 0x06064b50,
+        ZIP64_EOCD_SIZE = 56,
+        ZIP64_EXTRA_ID = 0x0001,
+        MADE_BY_UNIX = 3
+    };
+
+    archive_t(const void *base, uint64_t size)
+        :start((const uint8_t *)base), length(size), entries(NULL), nentries(0)
+    {}
+
+    archive_t(archive_t const &);
+    archive_t &operator=(archive_t const &);
+
+    // Compare entry name with key; if 'dir' is true, key is treated as if it has trailing slash
+    static int compare(entry_t const &e, const char *key, size_t len, bool dir)
+    {
+        size_t l = e.namelen < len ? e.namelen : len;
+        int r = ::memcmp(e.name, key, l);
+        if (r != 0)
+            return r;
+        if (e.namelen < len)
+            return -1;
+        if (!dir)
+            return e.namelen > len ? 1 : 0;
+        if (e.namelen == len)
+            return -1;
+        return (unsigned char)e.name[len] - (unsigned char)'/';
+    }
+
+    static int compare(const void *a, const void *b)
+    {
+        entry_t const *ea = (entry_t const *)a;
+        entry_t const *eb = (entry_t const *)b;
+        return compare(*ea, eb->name, eb->namelen, false);
+    }
+
+    size_t lower_bound(const char *key, size_t len, bool dir) const
+    {
+        size_t lo = 0, hi = nentries;
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            if (compare(entries[mid], key, len, dir) < 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    const uint8_t *find_eocd() const
+    {
+        if (length < EOCD_SIZE)
+            return NULL;
+
+        // EOCD is followed by comment of at most 64K
+        uint64_t lowest = length > EOCD_SIZE + 0xffff ? length - EOCD_SIZE - 0xffff : 0;
+        for (uint64_t off = length - EOCD_SIZE + 1; off-- > lowest;)
+        {
+            const uint8_t *p = start + off;
+            if (le32(p) == EOCD_SIGNATURE && off + EOCD_SIZE + le16(p + 20) <= length)
+                return p;
+        }
+        return NULL;
+    }
+
+    bool parse()
+    {
+        const uint8_t *eocd = find_eocd();
+        if (!eocd)
+        {
+            errno = EINVAL;
+            return false;
+        }
+
+        uint64_t total = le16(eocd + 10);
+        uint64_t cdsize = le32(eocd + 12);
+        uint64_t cdoff = le32(eocd + 16);
+
+        if (total == 0xffff || cdsize == 0xffffffff || cdoff == 0xffffffff)
+        {
+            uint64_t eocdoff = eocd - start;
+            if (eocdoff < ZIP64_LOCATOR_SIZE || le32(eocd - ZIP64_LOCATOR_SIZE) != ZIP64_LOCATOR_SIGNATURE)
+            {
+                errno = EINVAL;
+                return false;
+            }
+            uint64_t z64off = le64(eocd - ZIP64_LOCATOR_SIZE + 8);
+            if (z64off > length || length - z64off < ZIP64_EOCD_SIZE ||
+                le32(start + z64off) != ZIP64_EOCD_SIGNATURE)
+            {
+                errno = EINVAL;
+                return false;
+            }
+            const uint8_t *p = start + z64off;
+            total = le64(p + 32);
+            cdsize = le64(p + 40);
+            cdoff = le64(p + 48);
+        }
+
+        if (cdoff > length || length - cdoff < cdsize || total > cdsize / CENTRAL_HEADER_SIZE)
+        {
+            errno = EINVAL;
+            return false;
+        }
+
+        if (total == 0)
+            return true;
+
+        entries = (entry_t *)::malloc(total * sizeof(entry_t));
+        if (!entries)
+        {
+            errno = ENOMEM;
+            return false;
+        }
+
+        const uint8_t *p = start + cdoff;
+        const uint8_t *end = p + cdsize;
+        for (uint64_t i = 0; i != total; ++i)
+        {
+            if (end - p < CENTRAL_HEADER_SIZE || le32(p) != CENTRAL_HEADER_SIGNATURE)
+            {
+                errno = EINVAL;
+                return false;
+            }
+
+            size_t namelen = le16(p + 28);
+            size_t extralen = le16(p + 30);
+            size_t commentlen = le16(p + 32);
+            if ((size_t)(end - p) < CENTRAL_HEADER_SIZE + namelen + extralen + commentlen)
+            {
+                errno = EINVAL;
+                return false;
+            }
+
+            entry_t &e = entries[nentries];
+            e.name = (const char *)p + CENTRAL_HEADER_SIZE;
+            e.namelen = namelen;
+            e.flags = le16(p + 8);
+            e.method = le16(p + 10);
+            e.dostime = ((uint32_t)le16(p + 14) << 16) | le16(p + 12);
+            e.crc = le32(p + 16);
+            e.csize = le32(p + 20);
+            e.usize = le32(p + 24);
+            e.mode = (p[5] == MADE_BY_UNIX) ? le32(p + 38) >> 16 : 0;
+            e.offset = le32(p + 42);
+
+            if (!zip64(e, p + CENTRAL_HEADER_SIZE + namelen, extralen))
+            {
+                errno = EINVAL;
+                return false;
+            }
+
+            p += CENTRAL_HEADER_SIZE + namelen + extralen + commentlen;
+
+            // Skip absolute names, they can't be reached by relative lookup anyway
+            if (namelen == 0 || e.name[0] == '/')
+                continue;
+
+            ++nentries;
+        }
+
+        ::qsort(entries, nentries, sizeof(entry_t), &compare);
+        return true;
+    }
+
+    // Replace saturated 32-bit fields with values from ZIP64 extra field
+    static bool zip64(entry_t &e, const uint8_t *extra, size_t len)
+    {
+        if (e.usize != 0xffffffff && e.csize != 0xffffffff && e.offset != 0xffffffff)
+            return true;
+
+        for (const uint8_t *p = extra, *end = extra + len; end - p >= 4;)
+        {
+            unsigned id = le16(p);
+            size_t size = le16(p + 2);
+            p += 4;
+            if ((size_t)(end - p) < size)
+                return false;
+
+            if (id == ZIP64_EXTRA_ID)
+            {
+                const uint8_t *f = p, *fend = p + size;
+                uint64_t *fields[] = {&e.usize, &e.csize, &e.offset};
+                for (size_t i = 0; i != sizeof(fields)/sizeof(fields[0]); ++i)
+                {
+                    if (*fields[i] != 0xffffffff)
+                        continue;
+                    if (fend - f < 8)
+                        return false;
+                    *fields[i] = le64(f);
+                    f += 8;
+                }
+                return true;
+            }
+
+            p += size;
+        }
+
+        return false;
+    }
+
+private:
+    const uint8_t *start;
+    uint64_t length;
+    entry_t *entries;
+    size_t nentries;
+};
+
+/*
+ * Sequential/random reader of single archive entry. Stored entries are served
+ * right from mapped archive; deflated ones are inflated on the fly. If seek index
+ * is given, reader both uses it to restart inflate from nearest checkpoint on seek
+ * and records new checkpoints while it passes through parts not indexed yet.
+ * Otherwise seeking backwards restarts decompression from the beginning.
+ * Not thread-safe, but any number of readers could share one index.
+ */
+class reader_t
+{
+public:
+    reader_t(archive_t const &a, entry_t const &e, index_t *idx = NULL)
+        :ent(e), src(NULL), index(e.method == DEFLATED ? idx : NULL),
+        zinit(false), zpos(0), zin(0), scratch(NULL), window(NULL)
+    {
+        src = a.data(e);
+        ::memset(&zs, 0, sizeof(zs));
+    }
+
+    ~reader_t()
+    {
+        if (zinit)
+            ::inflateEnd(&zs);
+        ::free(scratch);
+        ::free(window);
+    }
+
+    /*
+     * Check if entry could be read. Return false and set errno if not.
+     */
+    bool valid() const
+    {
+        if (!src)
+            return false;
+        if (ent.flags & 1)
+        {
+            // Encrypted
+            errno = EACCES;
+            return false;
+        }
+        if (ent.method != STORED && ent.method != DEFLATED)
+        {
+            errno = ENOTSUP;
+            return false;
+        }
+        if (ent.method == STORED && ent.csize != ent.usize)
+        {
+            errno = EIO;
+            return false;
+        }
+        return true;
+    }
+
+    entry_t const &entry() const {return ent;}
+    uint64_t size() const {return ent.usize;}
+
+    /*
+     * Return pointer to uncompressed content if entry is stored, NULL otherwise.
+     */
+    const uint8_t *map() const {return ent.method == STORED ? src : NULL;}
+
+    ssize_t pread(void *buf, size_t count, uint64_t offset)
+    {
+        if (offset >= ent.usize || count == 0)
+            return 0;
+        if (count > ent.usize - offset)
+            count = ent.usize - offset;
+
+        if (ent.method == STORED)
+        {
+            ::memcpy(buf, src + offset, count);
+            return count;
+        }
+
+        if (!seek(offset))
+            return -1;
+        return inflate((uint8_t *)buf, count);
+    }
+
+private:
+    reader_t(reader_t const &);
+    reader_t &operator=(reader_t const &);
+
+    enum
+    {
+        SCRATCH_SIZE = 16 * 1024,
+        // zlib counts input in uInt, so feed huge entries by parts
+        INPUT_CHUNK = 1u << 30
+    };
+
+    bool rewind()
+    {
+        int rc = zinit ? ::inflateReset(&zs) : ::inflateInit2(&zs, -MAX_WBITS);
+        if (rc != Z_OK)
+        {
+            errno = rc == Z_MEM_ERROR ? ENOMEM : EIO;
+            return false;
+        }
+        zinit = true;
+        zs.next_in = NULL;
+        zs.avail_in = 0;
+        zpos = 0;
+        zin = 0;
+        return true;
+    }
+
+    bool restore(index_t::point_t const &p)
+    {
+        if (p.in > ent.csize || (p.bits && p.in == 0))
+        {
+            errno = EIO;
+            return false;
+        }
+
+        if (!rewind())
+            return false;
+
+        if (p.bits && ::inflatePrime(&zs, p.bits, src[p.in - 1] >> (8 - p.bits)) != Z_OK)
+        {
+            errno = EIO;
+            return false;
+        }
+        if (::inflateSetDictionary(&zs, p.window, p.wsize) != Z_OK)
+        {
+            errno = EIO;
+            return false;
+        }
+
+        zpos = p.out;
+        zin = p.in;
+        return true;
+    }
+
+    bool seek(uint64_t offset)
+    {
+        bool forward = zinit && offset >= zpos;
+        index_t::point_t const *p = index ? index->find(offset) : NULL;
+        if (p && (!forward || p->out > zpos))
+        {
+            if (!restore(*p))
+                return false;
+        }
+        else if (!forward)
+        {
+            if (!rewind())
+                return false;
+        }
+
+        if (offset == zpos)
+            return true;
+
+        if (!scratch)
+        {
+            scratch = (uint8_t *)::malloc(SCRATCH_SIZE);
+            if (!scratch)
+            {
+                errno = ENOMEM;
+                return false;
+            }
+        }
+
+        while (zpos < offset)
+        {
+            uint64_t n = offset - zpos;
+            ssize_t r = inflate(scratch, n < SCRATCH_SIZE ? (size_t)n : (size_t)SCRATCH_SIZE);
+            if (r <= 0)
+            {
+                if (r == 0)
+                    errno = EIO;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Record checkpoint if inflate stopped at block boundary far enough from previous one
+    void checkpoint()
+    {
+#if CRYSTAX_ZIP_SEEKINDEX_BUILD
+        if ((zs.data_type & 128) == 0 || (zs.data_type & 64) != 0 || !index->wants(zpos))
+            return;
+
+        if (!window)
+        {
+            window = (unsigned char *)::malloc(index_t::WINDOW_SIZE);
+            if (!window)
+                return;
+        }
+
+        uInt wsize = index_t::WINDOW_SIZE;
+        if (::inflateGetDictionary(&zs, window, &wsize) != Z_OK)
+            return;
+
+        index->add(zpos, zin - zs.avail_in, zs.data_type & 7, window, wsize);
+#endif
+    }
+
+    ssize_t inflate(uint8_t *buf, size_t count)
+    {
+        // Stop at each block boundary only if there is index to fill
+        int flush = index && CRYSTAX_ZIP_SEEKINDEX_BUILD ? Z_BLOCK : Z_NO_FLUSH;
+
+        size_t done = 0;
+        while (done < count)
+        {
+            if (zs.avail_in == 0 && zin < ent.csize)
+            {
+                uint64_t n = ent.csize - zin;
+                zs.next_in = (Bytef *)(src + zin);
+                zs.avail_in = n < INPUT_CHUNK ? (uInt)n : (uInt)INPUT_CHUNK;
+                zin += zs.avail_in;
+            }
+
+            size_t want = count - done;
+            zs.next_out = buf + done;
+            zs.avail_out = want < INPUT_CHUNK ? (uInt)want : (uInt)INPUT_CHUNK;
+            uInt avail = zs.avail_out;
+            uInt avail_in = zs.avail_in;
+
+            int rc = ::inflate(&zs, flush);
+            size_t produced = avail - zs.avail_out;
+            done += produced;
+            zpos += produced;
+
+            if (rc == Z_STREAM_END)
+                break;
+            if (rc == Z_BUF_ERROR && produced == 0 && avail_in == zs.avail_in)
+            {
+                // No progress possible: stream is truncated
+                errno = EIO;
+                return -1;
+            }
+            if (rc != Z_OK && rc != Z_BUF_ERROR)
+            {
+                errno = rc == Z_MEM_ERROR ? ENOMEM : EIO;
+                return -1;
+            }
+
+            if (flush == Z_BLOCK)
+                checkpoint();
+        }
+
+        return done;
+    }
+
+private:
+    entry_t const &ent;
+    const uint8_t *src;
+    index_t *index;
+    z_stream zs;
+    bool zinit;
+    uint64_t zpos; // Uncompressed offset of inflate state
+    uint64_t zin;  // Compressed bytes given to inflate
+    uint8_t *scratch;
+    unsigned char *window;
+};
+
+} // namespace zip
+} // namespace fileio
+} // namespace crystax
+
+#endif // _CRYSTAX_FILEIO_ZIP_ARCHIVE_HPP_ee4fdb7e23244f60878e4222cbeb9ac5
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2011-2015 CrystaX.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice, this list of
+ *       conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *       of conditions and the following disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY CrystaX ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL CrystaX OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those of the
+ * authors and should not be interpreted as representing official policies, either expressed
+ * or implied, of CrystaX.
+ */
+
+#ifndef _CRYSTAX_FILEIO_ZIP_DRIVER_HPP_e02dd9aa45464b90b1a585578d0d9eb4
+#define _CRYSTAX_FILEIO_ZIP_DRIVER_HPP_e02dd9aa45464b90b1a585578d0d9eb4
+
+#include "fileio/driver.hpp"
+#include "zip/package.hpp"
+
+namespace crystax
+{
+namespace fileio
+{
+namespace zip
+{
+
+/*
+ * Read-only driver exposing content of zip archive (e.g. APK) mounted at 'root'.
+ * Archive is mapped into memory once and its central directory is indexed, so
+ * open(), stat() and directory listing never touch the disk, stored entries are read right from
+ * mapping and deflated ones are inflated directly into caller's buffer, seeking
+ * through seek index of entry (see package_t).
+ *
+ * If 'prefix' is given (e.g. "assets" for APK), only entries under that directory
+ * of archive are visible.
+ */
+class driver_t : public ::crystax::fileio::driver_t
+{
+public:
+    driver_t(const char *root, const char *source, const char *prefix, fileio::driver_t *d);
+    ~driver_t();
+
+    // Return false (and errno set) if archive can't be used
+    bool valid() const {return pkg != NULL && tree != NULL;}
+
+    const char *name() const {return "ZIP";}
+    const char *info() const {return source.c_str();}
+
+    int    chown(const char *path, uid_t uid, gid_t gid);
+    int    close(int fd);
+    int    closedir(DIR *dirp);
+    int    dirfd(DIR *dirp);
+    int    dup(int fd);
+    int    dup2(int fd, int fd2);
+    int    fchown(int fd, uid_t uid, gid_t gid);
+    int    fcntl(int fd, int command, va_list &vl);
+    int    fdatasync(int fd);
+    DIR *  fdopendir(int fd);
+    int    flock(int fd, int operation);
+    int    fstat(int fd, struct stat *st);
+    int    fsync(int fd);
+    int    ftruncate(int fd, off_t offset);
+    int    getdents(unsigned int fd, struct dirent *entry, unsigned int count);
+    int    ioctl(int fd, int request, va_list &vl);
+    int    lchown(const char *path, uid_t uid, gid_t gid);
+    int    link(const char *src, const char *dst);
+    off_t  lseek(int fd, off_t offset, int whence);
+    loff_t lseek64(int fd, loff_t offset, int whence);
+    int    lstat(const char *path, struct stat *st);
+    int    mkdir(const char *path, mode_t mode);
+    int    open(const char *path, int oflag, va_list &vl);
+    DIR *  opendir(const char *dirpath);
+    ssize_t pread(int fd, void *buf, size_t count, off_t offset);
+    ssize_t pwrite(int fd, const void *buf, size_t count, off_t offset);
+    ssize_t read(int fd, void *buf, size_t count);
+    int    readv(int fd, const struct iovec *iov, int count);
+    struct dirent *readdir(DIR *dirp);
+    int    readdir_r(DIR *dirp, struct dirent *entry, struct dirent **result);
+    int    readlink(const char *path, char *buf, size_t bufsize);
+    int    remove(const char *path);
+    int    rename(const char *oldpath, const char *newpath);
+    void   rewinddir(DIR *dirp);
+    int    rmdir(const char *path);
+    int    scandir(const char *dir, struct dirent ***namelist, int (*filter)(const struct dirent *),
+        int (*compar)(const struct dirent **, const struct dirent **));
+    void   seekdir(DIR *dirp, long offset);
+    int    select(int maxfd, fd_set *rfd, fd_set *wfd, fd_set *efd, struct timeval *tv);
+    int    stat(const char *path, struct stat *st);
+    int    symlink(const char *src, const char *dst);
+    long   telldir(DIR *dirp);
+    int    unlink(const char *path);
+    ssize_t write(int fd, const void *buf, size_t count);
+    int    writev(int fd, const struct iovec *iov, int count);
+
+private:
+    bool entry_name(const char *path, char *buf, size_t bufsize, size_t *length);
+    int stat_entry(const char *name, size_t length, struct stat *st);
+    void fill_stat(entry_t const &e, struct stat *st);
+    dir_tree_t::node_t const *lookup_dir(const char *path);
+
+    int alloc_fd(file_t *file);
+    file_t *acquire(int fd);
+    file_t *take(int fd);
+
+private:
+    abspath_t source;
+    path_t prefix;
+
+    package_t *pkg;
+    dir_tree_t *tree;
+
+    /*
+     * Open files, indexed by fd. Slots are taken with CAS and read without locks;
+     * 'users' counts threads between loading 'file' and retaining it, so close()
+     * waits for them before dropping its reference.
+     */
+    struct fd_slot_t
+    {
+        file_t *file;
+        unsigned users;
+    };
+    fd_slot_t fd_table[FD_TABLE_SIZE];
+};
+
+} // namespace zip
+} // namespace fileio
+} // namespace crystax
+
+#endif // _CRYSTAX_FILEIO_ZIP_DRIVER_HPP_e02dd9aa45464b90b1a585578d0d9eb4
@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2011-2015 CrystaX.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice, this list of
+ *       conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *       of conditions and the following disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY CrystaX ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL CrystaX OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those of the
+ * authors and should not be interpreted as representing official policies, either expressed
+ * or implied, of CrystaX.
+ */
+
+#include "zip/package.hpp"
+#include "system/driver.hpp"
+
+namespace crystax
+{
+namespace fileio
+{
+namespace zip
+{
+
+CRYSTAX_LOCAL
+package_t::package_t()
+    :base(MAP_FAILED), size(0), zip(NULL), indexes(NULL)
+{}
+
+CRYSTAX_LOCAL
+package_t::~package_t()
+{
+    if (indexes)
+    {
+        for (size_t i = 0; i != zip->count(); ++i)
+            delete indexes[i];
+        ::free(indexes);
+    }
+
+    delete zip;
+    if (base != MAP_FAILED)
+        ::munmap(base, size);
+}
+
+CRYSTAX_LOCAL
+package_t *package_t::open(const char *path)
+{
+    DBG("path=%s", path);
+
+    // Archive itself lives on real file system, so bypass any mounts there
+    fileio::driver_t *sd = system::driver_t::instance();
+
+    int fd = sd->open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        ERR("can't open %s", path);
+        return NULL;
+    }
+
+    scope_cpp_ptr_t<package_t> pkg(new package_t);
+
+    if (sd->fstat(fd, &pkg->st) < 0 || !S_ISREG(pkg->st.st_mode) || pkg->st.st_size == 0)
+    {
+        ERR("%s is not a regular file", path);
+        sd->close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    pkg->size = pkg->st.st_size;
+    pkg->base = system_mmap(NULL, pkg->size, PROT_READ, MAP_SHARED, fd, 0);
+    int save_errno = errno;
+    sd->close(fd);
+
+    if (pkg->base == MAP_FAILED)
+    {
+        ERR("can't map %s", path);
+        errno = save_errno;
+        return NULL;
+    }
+
+    pkg->zip = archive_t::open(pkg->base, pkg->size);
+    if (!pkg->zip)
+    {
+        ERR("%s is not a valid zip archive", path);
+        return NULL;
+    }
+
+    pkg->indexes = (index_t **)::calloc(pkg->zip->count() ? pkg->zip->count() : 1, sizeof(index_t *));
+    if (!pkg->indexes)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    DBG("%s: %u entries", path, (unsigned)pkg->zip->count());
+    return pkg.release();
+}
+
+CRYSTAX_LOCAL
+dir_tree_t *package_t::tree(const char *prefix, size_t len) const
+{
+    while (len > 0 && *prefix == '/')
+    {
+        ++prefix;
+        --len;
+    }
+    while (len > 0 && prefix[len - 1] == '/')
+        --len;
+
+    dir_tree_t::builder_t builder;
+    for (size_t i = zip->first(prefix, len); i < zip->count(); ++i)
+    {
+        entry_t const &e = zip->entry(i);
+        if (!archive_t::beneath(e, prefix, len))
+            break;
+
+        const char *name = e.name + (len ? len + 1 : 0);
+        size_t namelen = e.namelen - (len ? len + 1 : 0);
+        bool dir = namelen > 0 && name[namelen - 1] == '/';
+        if (!builder.add(name, namelen, dir ? DT_DIR : DT_REG, true, e.usize, e.offset, i))
+            return NULL;
+    }
+
+    return builder.build();
+}
+
+CRYSTAX_LOCAL
+index_t *package_t::seekindex(entry_t const &e)
+{
+    if (e.method != DEFLATED || e.usize < 2 * (uint64_t)CRYSTAX_ZIP_SEEK_SPACING)
+        return NULL;
+
+    index_t **slot = &indexes[zip->index(&e)];
+    index_t *idx = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+    if (idx)
+        return idx;
+
+    idx = load_seekindex(e);
+    if (!idx)
+        idx = new index_t(CRYSTAX_ZIP_SEEK_SPACING);
+
+    index_t *expected = NULL;
+    if (!__atomic_compare_exchange_n(slot, &expected, idx, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+        // Somebody else was faster
+        delete idx;
+        idx = expected;
+    }
+
+    return idx;
+}
+
+CRYSTAX_LOCAL
+index_t *package_t::load_seekindex(entry_t const &e)
+{
+    char name[PATH_MAX + 1];
+    if (e.namelen + 6 > sizeof(name))
+        return NULL;
+    ::memcpy(name, e.name, e.namelen);
+    ::memcpy(name + e.namelen, ".cxzi", 6);
+
+    entry_t const *se = zip->find(name, e.namelen + 5);
+    if (!se || se->usize > SIZE_MAX)
+        return NULL;
+
+    reader_t r(*zip, *se);
+    if (!r.valid())
+        return NULL;
+
+    index_t *idx = NULL;
+    if (r.map())
+        idx = index_t::deserialize(r.map(), se->usize, e.usize, e.crc);
+    else
+    {
+        scope_c_ptr_t<uint8_t> buf((uint8_t *)::malloc(se->usize));
+        if (buf.get() && r.pread(buf.get(), se->usize, 0) == (ssize_t)se->usize)
+            idx = index_t::deserialize(buf.get(), se->usize, e.usize, e.crc);
+    }
+
+    if (!idx)
+        ERR("ignore broken seek index %s", name);
+    else
+        DBG("loaded seek index %s: %u points", name, (unsigned)idx->count());
+    return idx;
+}
+
+CRYSTAX_LOCAL
+file_t::file_t(package_t &pkg, entry_t const &e)
+    :reader(pkg.archive(), e, pkg.seekindex(e)), pos(0), refs(1)
+{
+    if (::pthread_mutex_init(&mutex, NULL) != 0)
+        ::abort();
+}
+
+CRYSTAX_LOCAL
+file_t::~file_t()
+{
+    if (::pthread_mutex_destroy(&mutex) != 0)
+        ::abort();
+}
+
+CRYSTAX_LOCAL
+ssize_t file_t::read(void *buf, size_t count)
+{
+    scope_lock_t lock(mutex);
+    ssize_t n = reader.pread(buf, count, pos);
+    if (n > 0)
+        pos += n;
+    return n;
+}
+
+CRYSTAX_LOCAL
+ssize_t file_t::pread(void *buf, size_t count, uint64_t offset)
+{
+    scope_lock_t lock(mutex);
+    return reader.pread(buf, count, offset);
+}
+
+CRYSTAX_LOCAL
+ssize_t file_t::readv(const struct iovec *iov, int count)
+{
+    if (count < 0 || count > IOV_MAX)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    scope_lock_t lock(mutex);
+
+    ssize_t total = 0;
+    for (int i = 0; i != count; ++i)
+    {
+        ssize_t n = reader.pread(iov[i].iov_base, iov[i].iov_len, pos);
+        if (n < 0)
+            return total ? total : -1;
+
+        pos += n;
+        total += n;
+        if ((size_t)n < iov[i].iov_len)
+            break;
+    }
+
+    return total;
+}
+
+CRYSTAX_LOCAL
+loff_t file_t::seek(loff_t offset, int whence)
+{
+    scope_lock_t lock(mutex);
+
+    loff_t base;
+    switch (whence)
+    {
+    case SEEK_SET:
+        base = 0;
+        break;
+    case SEEK_CUR:
+        base = (loff_t)pos;
+        break;
+    case SEEK_END:
+        base = (loff_t)reader.size();
+        break;
+    default:
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (base + offset < 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // Seek itself is free; reader repositions (using seek index) on next read
+    pos = (uint64_t)(base + offset);
+    return (loff_t)pos;
+}
+
+CRYSTAX_LOCAL
+uint64_t file_t::available()
+{
+    scope_lock_t lock(mutex);
+    return pos < reader.size() ? reader.size() - pos : 0;
+}
+
+} // namespace zip
+} // namespace fileio
+} // namespace crystax
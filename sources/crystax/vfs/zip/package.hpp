@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2011-2015 CrystaX.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice, this list of
+ *       conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *       of conditions and the following disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY CrystaX ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL CrystaX OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those of the
+ * authors and should not be interpreted as representing official policies, either expressed
+ * or implied, of CrystaX.
+ */
+
+#ifndef _CRYSTAX_FILEIO_ZIP_PACKAGE_HPP_616f67598171453d8df1ee41d59582f6
+#define _CRYSTAX_FILEIO_ZIP_PACKAGE_HPP_616f67598171453d8df1ee41d59582f6
+
+#include "fileio/common.hpp"
+#include "fileio/dirtree.hpp"
+#include "zip/archive.hpp"
+
+#ifndef CRYSTAX_ZIP_SEEK_SPACING
+#define CRYSTAX_ZIP_SEEK_SPACING (1024 * 1024)
+#endif
+
+namespace crystax
+{
+namespace fileio
+{
+namespace zip
+{
+
+/*
+ * Zip archive on real file system, mapped into memory, with seek indexes of its
+ * deflated entries. Shared by drivers which serve content of archives (ZIP, and
+ * ASSETS when APK is accessible directly).
+ */
+class package_t : non_copyable_t
+{
+public:
+    /*
+     * Map and index archive. Return NULL and set errno on failure.
+     */
+    static package_t *open(const char *path);
+    ~package_t();
+
+    archive_t const &archive() const {return *zip;}
+    struct stat const &stat() const {return st;}
+
+    /*
+     * Return seek index shared by all readers of entry, or NULL if entry doesn't
+     * need it (it's stored, or too small for seeking to be expensive). Index is
+     * created on first request; if archive contains "<name>.cxzi" entry, index is
+     * loaded from it (see index_t for its format), otherwise it's filled lazily
+     * by readers.
+     */
+    index_t *seekindex(entry_t const &e);
+
+    /*
+     * Build metadata tree of entries beneath directory 'prefix' of archive (whole
+     * archive if it's empty), with prefix stripped. Tag of file node is index of
+     * its entry in archive(), offset is offset of its local header. Return NULL and
+     * set errno on failure.
+     */
+    dir_tree_t *tree(const char *prefix, size_t len) const;
+
+private:
+    package_t();
+
+    index_t *load_seekindex(entry_t const &e);
+
+private:
+    void *base;
+    uint64_t size;
+    archive_t *zip;
+    struct stat st;
+    index_t **indexes;
+};
+
+/*
+ * Open entry of package: reader with its own position. Thread-safe; reference
+ * counted, so it could be safely released by close() while used by another thread.
+ */
+class file_t : non_copyable_t
+{
+public:
+    file_t(package_t &pkg, entry_t const &e);
+
+    // Check if entry could be read. Return false and set errno if not.
+    bool valid() const {return reader.valid();}
+
+    entry_t const &entry() const {return reader.entry();}
+    uint64_t size() const {return reader.size();}
+
+    ssize_t read(void *buf, size_t count);
+    ssize_t pread(void *buf, size_t count, uint64_t offset);
+    ssize_t readv(const struct iovec *iov, int count);
+    loff_t seek(loff_t offset, int whence);
+    uint64_t available();
+
+    void retain() {__sync_add_and_fetch(&refs, 1);}
+    void release()
+    {
+        if (__sync_sub_and_fetch(&refs, 1) == 0)
+            delete this;
+    }
+
+private:
+    ~file_t();
+
+    reader_t reader;
+    uint64_t pos;
+    unsigned refs;
+    pthread_mutex_t mutex;
+};
+
+} // namespace zip
+} // namespace fileio
+} // namespace crystax
+
+#endif // _CRYSTAX_FILEIO_ZIP_PACKAGE_HPP_616f67598171453d8df1ee41d59582f6
@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2011-2015 CrystaX.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice, this list of
+ *       conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *       of conditions and the following disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY CrystaX ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL CrystaX OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those of the
+ * authors and should not be interpreted as representing official policies, either expressed
+ * or implied, of CrystaX.
+ */
+
+#ifndef _CRYSTAX_FILEIO_ZIP_SEEKINDEX_HPP_4a502ef94b0d4cf58f963bc843562da0
+#define _CRYSTAX_FILEIO_ZIP_SEEKINDEX_HPP_4a502ef94b0d4cf58f963bc843562da0
+
+/*
+ * This header intentionally depends on nothing but system headers and zlib, so it
+ * could be used (and tested) outside of libcrystax.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <zlib.h>
+
+// inflateGetDictionary() appeared in zlib 1.2.7.1
+#if ZLIB_VERNUM >= 0x1271
+#define CRYSTAX_ZIP_SEEKINDEX_BUILD 1
+#else
+#define CRYSTAX_ZIP_SEEKINDEX_BUILD 0
+#endif
+
+namespace crystax
+{
+namespace fileio
+{
+namespace zip
+{
+
+/*
+ * Random access index of deflated stream.
+ *
+ * Every 'spacing' bytes of uncompressed data (at nearest deflate block boundary)
+ * inflate state is checkpointed: offsets in both streams, bit position and last
+ * 32K of output, which is all that's needed to restart inflate from there. So
+ * seek to any offset costs at most 'spacing' bytes of decompression instead of
+ * decompressing everything from the beginning.
+ *
+ * Index is filled lazily by readers as they pass through the stream (see
+ * reader_t), and could be shared by any number of them. It could also be saved
+ * into a sidecar and loaded later, so it's never built at run time at all.
+ *
+ * Checkpoints are only appended and never move, so pointers returned by find()
+ * stay valid while index is alive.
+ */
+class index_t
+{
+public:
+    enum
+    {
+        WINDOW_SIZE = 32768,
+        DEFAULT_SPACING = 1024 * 1024
+    };
+
+    struct point_t
+    {
+        uint64_t out;  // Offset in uncompressed data
+        uint64_t in;   // Offset of first whole byte in compressed data
+        unsigned bits; // Number of bits of previous byte which belong to this point
+        size_t wsize;
+        unsigned char window[WINDOW_SIZE];
+    };
+
+    explicit index_t(uint64_t sp = DEFAULT_SPACING)
+        :space(sp ? sp : (uint64_t)DEFAULT_SPACING), next(space), points(NULL), npoints(0), capacity(0)
+    {
+        ::pthread_mutex_init(&mutex, NULL);
+    }
+
+    ~index_t()
+    {
+        for (size_t i = 0; i != npoints; ++i)
+            ::free(points[i]);
+        ::free(points);
+        ::pthread_mutex_destroy(&mutex);
+    }
+
+    uint64_t spacing() const {return space;}
+
+    size_t count() const
+    {
+        ::pthread_mutex_lock(&mutex);
+        size_t n = npoints;
+        ::pthread_mutex_unlock(&mutex);
+        return n;
+    }
+
+    /*
+     * Return checkpoint with greatest offset not exceeding 'offset', or NULL.
+     */
+    point_t const *find(uint64_t offset) const
+    {
+        ::pthread_mutex_lock(&mutex);
+        size_t lo = 0, hi = npoints;
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            if (points[mid]->out <= offset)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        point_t const *p = lo ? points[lo - 1] : NULL;
+        ::pthread_mutex_unlock(&mutex);
+        return p;
+    }
+
+    /*
+     * Return true if checkpoint at 'out' would be added. It's cheap pre-check;
+     * add() checks it again.
+     */
+    bool wants(uint64_t out) const
+    {
+        return out >= __atomic_load_n(&next, __ATOMIC_RELAXED);
+    }
+
+    bool add(uint64_t out, uint64_t in, unsigned bits, const unsigned char *window, size_t wsize)
+    {
+        if (wsize > WINDOW_SIZE)
+            return false;
+
+        point_t *p = (point_t *)::malloc(sizeof(point_t));
+        if (!p)
+            return false;
+        p->out = out;
+        p->in = in;
+        p->bits = bits;
+        p->wsize = wsize;
+        ::memcpy(p->window, window, wsize);
+
+        ::pthread_mutex_lock(&mutex);
+        bool ok = append(p);
+        ::pthread_mutex_unlock(&mutex);
+
+        if (!ok)
+            ::free(p);
+        return ok;
+    }
+
+    /*
+     * Sidecar format (all numbers are little-endian):
+     *
+     *   "CXZI" u32:version u64:usize u32:crc u64:spacing u32:count
+     *   count * { u64:out u64:in u32:bits u32:wsize u8[wsize]:window }
+     *
+     * 'usize' and 'crc' identify the stream index was built for.
+     */
+    size_t serialized_size() const
+    {
+        ::pthread_mutex_lock(&mutex);
+        size_t size = HEADER_SIZE;
+        for (size_t i = 0; i != npoints; ++i)
+            size += POINT_HEADER_SIZE + points[i]->wsize;
+        ::pthread_mutex_unlock(&mutex);
+        return size;
+    }
+
+    /*
+     * Write index to 'buf' of 'size' bytes. Return number of bytes written,
+     * or 0 if buffer is too small.
+     */
+    size_t serialize(void *buf, size_t size, uint64_t usize, uint32_t crc) const
+    {
+        ::pthread_mutex_lock(&mutex);
+        uint8_t *p = (uint8_t *)buf, *end = p + size;
+        size_t n = 0;
+        if (size >= HEADER_SIZE)
+        {
+            ::memcpy(p, magic(), 4);
+            put32(p + 4, VERSION);
+            put64(p + 8, usize);
+            put32(p + 16, crc);
+            put64(p + 20, space);
+            put32(p + 28, npoints);
+            p += HEADER_SIZE;
+
+            size_t i = 0;
+            for (; i != npoints; ++i)
+            {
+                point_t const *pt = points[i];
+                if ((size_t)(end - p) < POINT_HEADER_SIZE + pt->wsize)
+                    break;
+                put64(p, pt->out);
+                put64(p + 8, pt->in);
+                put32(p + 16, pt->bits);
+                put32(p + 20, pt->wsize);
+                ::memcpy(p + POINT_HEADER_SIZE, pt->window, pt->wsize);
+                p += POINT_HEADER_SIZE + pt->wsize;
+            }
+            if (i == npoints)
+                n = p - (uint8_t *)buf;
+        }
+        ::pthread_mutex_unlock(&mutex);
+        return n;
+    }
+
+    /*
+     * Load index saved by serialize(). Return NULL if data is broken or was made
+     * for another stream.
+     */
+    static index_t *deserialize(const void *buf, size_t size, uint64_t usize, uint32_t crc)
+    {
+        const uint8_t *p = (const uint8_t *)buf, *end = p + size;
+        if (size < HEADER_SIZE || ::memcmp(p, magic(), 4) != 0 || get32(p + 4) != VERSION ||
+            get64(p + 8) != usize || get32(p + 16) != crc)
+            return NULL;
+
+        index_t *idx = new index_t(get64(p + 20));
+        size_t count = get32(p + 28);
+        p += HEADER_SIZE;
+
+        for (size_t i = 0; i != count; ++i)
+        {
+            if ((size_t)(end - p) < POINT_HEADER_SIZE)
+                break;
+            size_t wsize = get32(p + 20);
+            if (wsize > WINDOW_SIZE || (size_t)(end - p) < POINT_HEADER_SIZE + wsize ||
+                get32(p + 16) > 7 || !idx->add(get64(p), get64(p + 8), get32(p + 16), p + POINT_HEADER_SIZE, wsize))
+                break;
+            p += POINT_HEADER_SIZE + wsize;
+        }
+
+        if (idx->npoints != count)
+        {
+            delete idx;
+            return NULL;
+        }
+        return idx;
+    }
+
+private:
+    index_t(index_t const &);
+    index_t &operator=(index_t const &);
+
+    enum
+    {
+        VERSION = 1,
+        HEADER_SIZE = 32,
+        POINT_HEADER_SIZE = 24
+    };
+
+    static const char *magic() {return "CXZI";}
+
+    // Should be called with mutex locked
+    bool append(point_t *p)
+    {
+        if (npoints && p->out < points[npoints - 1]->out + space)
+            return false;
+
+        if (npoints == capacity)
+        {
+            size_t cap = capacity ? capacity * 2 : 16;
+            point_t **np = (point_t **)::realloc(points, cap * sizeof(point_t *));
+            if (!np)
+                return false;
+            points = np;
+            capacity = cap;
+        }
+
+        points[npoints++] = p;
+        __atomic_store_n(&next, p->out + space, __ATOMIC_RELAXED);
+        return true;
+    }
+
+    static void put32(uint8_t *p, uint32_t v)
+    {
+        for (int i = 0; i != 4; ++i)
+            p[i] = (uint8_t)(v >> (i * 8));
+    }
+
+    static void put64(uint8_t *p, uint64_t v)
+    {
+        put32(p, (uint32_t)v);
+        put32(p + 4, (uint32_t)(v >> 32));
+    }
+
+    static uint32_t get32(const uint8_t *p)
+    {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    static uint64_t get64(const uint8_t *p)
+    {
+        return (uint64_t)get32(p) | ((uint64_t)get32(p + 4) << 32);
+    }
+
+private:
+    uint64_t space;
+    uint64_t next;
+    point_t **points;
+    size_t npoints;
+    size_t capacity;
+    mutable pthread_mutex_t mutex;
+};
+
+} // namespace zip
+} // namespace fileio
+} // namespace crystax
+
+#endif // _CRYSTAX_FILEIO_ZIP_SEEKINDEX_HPP_4a502ef94b0d4cf58f963bc843562da0
@@ -0,0 +1,707 @@
+/*
+ * Copyright (c) 2011-2015 CrystaX.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice, this list of
+ *       conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *       of conditions and the following disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY CrystaX ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL CrystaX OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those of the
+ * authors and should not be interpreted as representing official policies, either expressed
+ * or implied, of CrystaX.
+ */
+
+#include "zip/driver.hpp"
+#include "system/driver.hpp"
+
+#include <sched.h>
+
+namespace crystax
+{
+namespace fileio
+{
+namespace zip
+{
+
+CRYSTAX_LOCAL
+driver_t::driver_t(const char *root, const char *src, const char *pfx, fileio::driver_t *d)
+    :fileio::driver_t(root, d), source(src), prefix(pfx && *pfx ? pfx : NULL), pkg(NULL), tree(NULL)
+{
+    for (size_t fd = 0; fd != sizeof(fd_table)/sizeof(fd_table[0]); ++fd)
+    {
+        fd_table[fd].file = NULL;
+        fd_table[fd].users = 0;
+    }
+
+    pkg = package_t::open(source.c_str());
+    if (pkg)
+    {
+        const char *pfx = prefix ? prefix.c_str() : "";
+        tree = pkg->tree(pfx, ::strlen(pfx));
+    }
+}
+
+CRYSTAX_LOCAL
+driver_t::~driver_t()
+{
+    for (size_t fd = 0; fd != sizeof(fd_table)/sizeof(fd_table[0]); ++fd)
+        if (fd_table[fd].file)
+            fd_table[fd].file->release();
+
+    delete tree;
+    delete pkg;
+}
+
+/*
+ * Translate path to name of archive entry. Root of mount becomes prefix itself
+ * (or empty string if there is no prefix).
+ */
+CRYSTAX_LOCAL
+bool driver_t::entry_name(const char *path, char *buf, size_t bufsize, size_t *length)
+{
+    char tmp[PATH_MAX + 1];
+    abspath_view_t abspath(path, tmp, sizeof(tmp));
+    if (!abspath)
+        return false;
+
+    if (!abspath.subpath(root()))
+    {
+        errno = EINVAL;
+        return false;
+    }
+
+    const char *rel = abspath.c_str() + root().length();
+    while (*rel == '/')
+        ++rel;
+    size_t rellen = abspath.length() - (rel - abspath.c_str());
+
+    const char *pfx = prefix ? prefix.c_str() : "";
+    while (*pfx == '/')
+        ++pfx;
+    size_t pfxlen = ::strlen(pfx);
+
+    if (pfxlen + rellen + 2 > bufsize)
+    {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+
+    size_t n = 0;
+    ::memcpy(buf, pfx, pfxlen);
+    n += pfxlen;
+    if (pfxlen && rellen)
+        buf[n++] = '/';
+    ::memcpy(buf + n, rel, rellen);
+    n += rellen;
+    buf[n] = '\0';
+
+    *length = n;
+    return true;
+}
+
+/*
+ * Find directory in metadata tree; set errno and return NULL if there is no such
+ * directory.
+ */
+CRYSTAX_LOCAL
+dir_tree_t::node_t const *driver_t::lookup_dir(const char *path)
+{
+    char name[PATH_MAX + 1];
+    size_t length;
+    if (!entry_name(path, name, sizeof(name), &length))
+        return NULL;
+
+    // Tree is built with prefix stripped
+    const char *pfx = prefix ? prefix.c_str() : "";
+    while (*pfx == '/')
+        ++pfx;
+    size_t pfxlen = ::strlen(pfx);
+
+    dir_tree_t::node_t const *n = tree->lookup(name + pfxlen, length - pfxlen);
+    if (!n)
+    {
+        errno = ENOENT;
+        return NULL;
+    }
+    if (n->type != DT_DIR)
+    {
+        errno = ENOTDIR;
+        return NULL;
+    }
+    return n;
+}
+
+CRYSTAX_LOCAL
+void driver_t::fill_stat(entry_t const &e, struct stat *st)
+{
+    ::memcpy(st, &pkg->stat(), sizeof(struct stat));
+    st->st_mode = S_IFREG | (e.mode ? (e.mode & (S_IRUSR|S_IRGRP|S_IROTH|S_IXUSR|S_IXGRP|S_IXOTH)) : S_IRUSR|S_IRGRP|S_IROTH);
+    st->st_nlink = 1;
+    st->st_ino = pkg->archive().index(&e) + 1;
+    st->st_size = e.usize;
+    st->st_blocks = (e.usize + 511) / 512;
+    st->st_mtime = archive_t::mtime(e);
+}
+
+CRYSTAX_LOCAL
+int driver_t::stat_entry(const char *name, size_t length, struct stat *st)
+{
+    entry_t const *e = pkg->archive().find(name, length);
+    if (e)
+    {
+        fill_stat(*e, st);
+        return 0;
+    }
+
+    if (!pkg->archive().directory(name, length))
+    {
+        errno = ENOENT;
+        return -1;
+    }
+
+    ::memcpy(st, &pkg->stat(), sizeof(struct stat));
+    st->st_mode = S_IFDIR|S_IRUSR|S_IXUSR|S_IRGRP|S_IXGRP|S_IROTH|S_IXOTH;
+    st->st_nlink = 2;
+    st->st_size = 0;
+    st->st_blocks = 0;
+    return 0;
+}
+
+CRYSTAX_LOCAL
+int driver_t::alloc_fd(file_t *file)
+{
+    for (size_t fd = 0; fd != sizeof(fd_table)/sizeof(fd_table[0]); ++fd)
+    {
+        file_t *expected = NULL;
+        if (__atomic_compare_exchange_n(&fd_table[fd].file, &expected, file, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+            return fd;
+    }
+    return -1;
+}
+
+/*
+ * Return file open as 'fd' with reference taken, or set errno and return NULL.
+ * Wait-free: the file can't be freed while this thread is counted in 'users',
+ * since take() waits for them before anyone could release it.
+ */
+CRYSTAX_LOCAL
+file_t *driver_t::acquire(int fd)
+{
+    if (fd < 0 || (size_t)fd >= sizeof(fd_table)/sizeof(fd_table[0]))
+    {
+        errno = EBADF;
+        return NULL;
+    }
+
+    fd_slot_t &s = fd_table[fd];
+    __atomic_add_fetch(&s.users, 1, __ATOMIC_SEQ_CST);
+    file_t *file = __atomic_load_n(&s.file, __ATOMIC_SEQ_CST);
+    if (file)
+        file->retain();
+    __atomic_sub_fetch(&s.users, 1, __ATOMIC_RELEASE);
+
+    if (!file)
+        errno = EBADF;
+    return file;
+}
+
+/*
+ * Remove file from slot and return the reference slot held, or NULL if slot is
+ * free. Once this returns, nobody else could get the file from the slot.
+ */
+CRYSTAX_LOCAL
+file_t *driver_t::take(int fd)
+{
+    fd_slot_t &s = fd_table[fd];
+    file_t *file = __atomic_exchange_n(&s.file, (file_t *)NULL, __ATOMIC_SEQ_CST);
+    if (file)
+    {
+        // Readers leave right after retain(), so this is short
+        while (__atomic_load_n(&s.users, __ATOMIC_SEQ_CST) != 0)
+            ::sched_yield();
+    }
+    return file;
+}
+
+CRYSTAX_LOCAL
+int driver_t::chown(const char * /* path */, uid_t /* uid */, gid_t /* gid */)
+{
+    errno = EROFS;
+    return -1;
+}
+
+CRYSTAX_LOCAL
+int driver_t::close(int fd)
+{
+    DBG("fd=%d", fd);
+
+    if (fd < 0 || (size_t)fd >= sizeof(fd_table)/sizeof(fd_table[0]))
+    {
+        errno = EBADF;
+        return -1;
+    }
+
+    file_t *file = take(fd);
+    if (!file)
+    {
+        errno = EBADF;
+        return -1;
+    }
+
+    file->release();
+    return 0;
+}
+
+CRYSTAX_LOCAL
+int driver_t::closedir(DIR *dirp)
+{
+    DBG("dirp=%p", dirp);
+    delete reinterpret_cast<dir_stream_t *>(dirp);
+    return 0;
+}
+
+CRYSTAX_LOCAL
+int driver_t::dirfd(DIR * /* dirp */)
+{
+    // Directory streams of archive have no descriptors. Called on every opendir(),
+    // so just say so, leaving errno alone.
+    return -1;
+}
+
+CRYSTAX_LOCAL
+int driver_t::dup(int /* fd */)
+{
+    NOT_IMPLEMENTED;
+}
+
+CRYSTAX_LOCAL
+int driver_t::dup2(int /* fd */, int /* fd2 */)
+{
+    NOT_IMPLEMENTED;
+}
+
+CRYSTAX_LOCAL
+int driver_t::fchown(int /* fd */, uid_t /* uid */, gid_t /* gid */)
+{
+    errno = EROFS;
+    return -1;
+}
+
+CRYSTAX_LOCAL
+int driver_t::fcntl(int fd, int command, va_list &/* vl */)
+{
+    DBG("fd=%d, command=%d", fd, command);
+
+    file_t *file = acquire(fd);
+    if (!file)
+        return -1;
+    file->release();
+
+    switch (command)
+    {
+    case F_GETFL:
+        return O_RDONLY;
+    case F_GETFD:
+    case F_SETFD:
+        return 0;
+    default:
+        NOT_IMPLEMENTED;
+    }
+}
+
+CRYSTAX_LOCAL
+int driver_t::fdatasync(int fd)
+{
+    return fsync(fd);
+}
+
+CRYSTAX_LOCAL
+DIR *driver_t::fdopendir(int /* fd */)
+{
+    NOT_IMPLEMENTED_NULL;
+}
+
+CRYSTAX_LOCAL
+int driver_t::flock(int /* fd */, int /* operation */)
+{
+    NOT_IMPLEMENTED;
+}
+
+CRYSTAX_LOCAL
+int driver_t::fstat(int fd, struct stat *st)
+{
+    file_t *file = acquire(fd);
+    if (!file)
+        return -1;
+
+    fill_stat(file->entry(), st);
+    file->release();
+    return 0;
+}
+
+CRYSTAX_LOCAL
+int driver_t::fsync(int fd)
+{
+    // Nothing to flush for read-only file
+    file_t *file = acquire(fd);
+    if (!file)
+        return -1;
+    file->release();
+    return 0;
+}
+
+CRYSTAX_LOCAL
+int driver_t::ftruncate(int /* fd */, off_t /* offset */)
+{
+    errno = EROFS;
+    return -1;
+}
+
+CRYSTAX_LOCAL
+int driver_t::getdents(unsigned int /* fd */, struct dirent * /* entry */, unsigned int /* count */)
+{
+    NOT_IMPLEMENTED;
+}
+
+CRYSTAX_LOCAL
+int driver_t::ioctl(int fd, int request, va_list &vl)
+{
+    DBG("fd=%d, request=%d", fd, request);
+
+    file_t *file = acquire(fd);
+    if (!file)
+        return -1;
+
+    switch (request)
+    {
+    case FIONREAD:
+        {
+            int *avail = va_arg(vl, int *);
+            if (avail == NULL)
+            {
+                file->release();
+                errno = EINVAL;
+                return -1;
+            }
+
+            uint64_t left = file->available();
+            *avail = left > INT_MAX ? INT_MAX : (int)left;
+        }
+        file->release();
+        return 0;
+    default:
+        file->release();
+        NOT_IMPLEMENTED;
+    }
+}
+
+CRYSTAX_LOCAL
+int driver_t::lchown(const char * /* path */, uid_t /* uid */, gid_t /* gid */)
+{
+    errno = EROFS;
+    return -1;
+}
+
+CRYSTAX_LOCAL
+int driver_t::link(const char * /* src */, const char * /* dst */)
+{
+    errno = EROFS;
+    return -1;
+}
+
+CRYSTAX_LOCAL
+off_t driver_t::lseek(int fd, off_t offset, int whence)
+{
+    loff_t pos = lseek64(fd, offset, whence);
+    if (pos > (loff_t)LONG_MAX)
+    {
+        errno = EOVERFLOW;
+        return -1;
+    }
+    return (off_t)pos;
+}
+
+CRYSTAX_LOCAL
+loff_t driver_t::lseek64(int fd, loff_t offset, int whence)
+{
+    DBG("fd=%d, offset=%lld, whence=%d", fd, (long long)offset, whence);
+
+    file_t *file = acquire(fd);
+    if (!file)
+        return -1;
+
+    loff_t pos = file->seek(offset, whence);
+    file->release();
+    return pos;
+}
+
+CRYSTAX_LOCAL
+int driver_t::lstat(const char *path, struct stat *st)
+{
+    return stat(path, st);
+}
+
+CRYSTAX_LOCAL
+int driver_t::mkdir(const char * /* path */, mode_t /* mode */)
+{
+    errno = EROFS;
+    return -1;
+}
+
+CRYSTAX_LOCAL
+int driver_t::open(const char *path, int oflag, va_list &/* vl */)
+{
+    DBG("path=%s, oflag=%d", path, oflag);
+
+    char name[PATH_MAX + 1];
+    size_t length;
+    if (!entry_name(path, name, sizeof(name), &length))
+        return -1;
+
+    entry_t const *e = pkg->archive().find(name, length);
+    if (!e)
+    {
+        if (pkg->archive().directory(name, length))
+            errno = EISDIR;
+        else
+            errno = (oflag & O_CREAT) ? EROFS : ENOENT;
+        return -1;
+    }
+
+    if ((oflag & O_ACCMODE) != O_RDONLY || (oflag & O_TRUNC))
+    {
+        errno = EROFS;
+        return -1;
+    }
+
+    file_t *file = new file_t(*pkg, *e);
+    if (!file->valid())
+    {
+        int save_errno = errno;
+        ERR("can't read %s (method %u)", name, e->method);
+        file->release();
+        errno = save_errno;
+        return -1;
+    }
+
+    int fd = alloc_fd(file);
+    if (fd < 0)
+    {
+        ERR("can't alloc fd");
+        file->release();
+        errno = EMFILE;
+        return -1;
+    }
+
+    DBG("return fd=%d", fd);
+    return fd;
+}
+
+CRYSTAX_LOCAL
+DIR *driver_t::opendir(const char *dirpath)
+{
+    DBG("dirpath=%s", dirpath);
+
+    dir_tree_t::node_t const *n = lookup_dir(dirpath);
+    if (!n)
+        return NULL;
+
+    return reinterpret_cast<DIR *>(new dir_stream_t(*tree, *n));
+}
+
+CRYSTAX_LOCAL
+ssize_t driver_t::pread(int fd, void *buf, size_t count, off_t offset)
+{
+    DBG("fd=%d, count=%u, offset=%lld", fd, (unsigned)count, (long long)offset);
+
+    if (offset < 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    file_t *file = acquire(fd);
+    if (!file)
+        return -1;
+
+    ssize_t n = file->pread(buf, count, (uint64_t)offset);
+    file->release();
+    return n;
+}
+
+CRYSTAX_LOCAL
+ssize_t driver_t::pwrite(int /* fd */, const void * /* buf */, size_t /* count */, off_t /* offset */)
+{
+    errno = EBADF;
+    return -1;
+}
+
+CRYSTAX_LOCAL
+ssize_t driver_t::read(int fd, void *buf, size_t count)
+{
+    DBG("fd=%d, count=%u", fd, (unsigned)count);
+
+    file_t *file = acquire(fd);
+    if (!file)
+        return -1;
+
+    ssize_t n = file->read(buf, count);
+    file->release();
+    return n;
+}
+
+CRYSTAX_LOCAL
+int driver_t::readv(int fd, const struct iovec *iov, int count)
+{
+    DBG("fd=%d, count=%d", fd, count);
+
+    file_t *file = acquire(fd);
+    if (!file)
+        return -1;
+
+    ssize_t n = file->readv(iov, count);
+    file->release();
+    return n;
+}
+
+CRYSTAX_LOCAL
+struct dirent *driver_t::readdir(DIR *dirp)
+{
+    return reinterpret_cast<dir_stream_t *>(dirp)->read();
+}
+
+CRYSTAX_LOCAL
+int driver_t::readdir_r(DIR *dirp, struct dirent *entry, struct dirent **result)
+{
+    return reinterpret_cast<dir_stream_t *>(dirp)->read_r(entry, result);
+}
+
+CRYSTAX_LOCAL
+int driver_t::readlink(const char *path, char * /* buf */, size_t /* bufsize */)
+{
+    // There are no symlinks in archive
+    struct stat st;
+    if (stat(path, &st) < 0)
+        return -1;
+    errno = EINVAL;
+    return -1;
+}
+
+CRYSTAX_LOCAL
+int driver_t::remove(const char * /* path */)
+{
+    errno = EROFS;
+    return -1;
+}
+
+CRYSTAX_LOCAL
+int driver_t::rename(const char * /* oldpath */, const char * /* newpath */)
+{
+    errno = EROFS;
+    return -1;
+}
+
+CRYSTAX_LOCAL
+void driver_t::rewinddir(DIR *dirp)
+{
+    reinterpret_cast<dir_stream_t *>(dirp)->rewind();
+}
+
+CRYSTAX_LOCAL
+int driver_t::rmdir(const char * /* path */)
+{
+    errno = EROFS;
+    return -1;
+}
+
+CRYSTAX_LOCAL
+int driver_t::scandir(const char *dir, struct dirent ***namelist, int (*filter)(const struct dirent *),
+    int (*compar)(const struct dirent **, const struct dirent **))
+{
+    DBG("dir=%s", dir);
+
+    dir_tree_t::node_t const *n = lookup_dir(dir);
+    if (!n)
+        return -1;
+
+    return tree->scandir(*n, namelist, filter, compar);
+}
+
+CRYSTAX_LOCAL
+void driver_t::seekdir(DIR *dirp, long offset)
+{
+    reinterpret_cast<dir_stream_t *>(dirp)->seek(offset);
+}
+
+CRYSTAX_LOCAL
+int driver_t::select(int /* maxfd */, fd_set * /* rfd */, fd_set * /* wfd */, fd_set * /* efd */, struct timeval * /* tv */)
+{
+    NOT_IMPLEMENTED;
+}
+
+CRYSTAX_LOCAL
+int driver_t::stat(const char *path, struct stat *st)
+{
+    DBG("path=%s", path);
+
+    char name[PATH_MAX + 1];
+    size_t length;
+    if (!entry_name(path, name, sizeof(name), &length))
+        return -1;
+
+    return stat_entry(name, length, st);
+}
+
+CRYSTAX_LOCAL
+int driver_t::symlink(const char * /* src */, const char * /* dst */)
+{
+    errno = EROFS;
+    return -1;
+}
+
+CRYSTAX_LOCAL
+long driver_t::telldir(DIR *dirp)
+{
+    return reinterpret_cast<dir_stream_t *>(dirp)->tell();
+}
+
+CRYSTAX_LOCAL
+int driver_t::unlink(const char * /* path */)
+{
+    errno = EROFS;
+    return -1;
+}
+
+CRYSTAX_LOCAL
+ssize_t driver_t::write(int /* fd */, const void * /* buf */, size_t /* count */)
+{
+    errno = EBADF;
+    return -1;
+}
+
+CRYSTAX_LOCAL
+int driver_t::writev(int /* fd */, const struct iovec * /* iov */, int /* count */)
+{
+    errno = EBADF;
+    return -1;
+}
+
+} // namespace zip
+} // namespace fileio
+} // namespace crystax
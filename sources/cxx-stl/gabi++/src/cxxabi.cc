@@ -187,6 +187,81 @@ namespace {
     FreeItem* free_items_;     // Linked list of free items.
   };
 
+  // Exception memory. Every block starts with a prefix recording its size
+  // class, padded so that what follows keeps malloc's alignment.
+  //
+  // Nearly all exceptions fit in blocks of the few smallest size classes.
+  // Such blocks are not returned to malloc when freed, but put on per-thread
+  // free lists in __cxa_eh_globals, a few of each size, so that code throwing
+  // in a loop doesn't go to the allocator at all.
+  union BlockPrefix {
+    size_t size_class;
+    void* align[2];
+  };
+
+  const size_t kCachedClassSize[] = {256, 512, 1024};
+  const size_t kCachedClasses =
+      sizeof(kCachedClassSize) / sizeof(kCachedClassSize[0]);
+  const size_t kUncachedClass = kCachedClasses;
+  const unsigned char kMaxCachedBlocks = 4;
+
+  BlockPrefix*& NextCachedBlock(BlockPrefix* block) {
+    return *reinterpret_cast<BlockPrefix**>(block + 1);
+  }
+
+  void* AllocateExceptionMemory(size_t size) {
+    size_t block_size = size + sizeof(BlockPrefix);
+    size_t size_class = 0;
+    while (size_class < kUncachedClass &&
+           kCachedClassSize[size_class] < block_size)
+      ++size_class;
+
+    BlockPrefix* block = NULL;
+    if (size_class != kUncachedClass) {
+      block_size = kCachedClassSize[size_class];
+      __cxa_eh_globals* globals = __cxa_get_globals();
+      if (globals->exceptionCacheCount[size_class] != 0) {
+        block = static_cast<BlockPrefix*>(globals->exceptionCache[size_class]);
+        globals->exceptionCache[size_class] = NextCachedBlock(block);
+        --globals->exceptionCacheCount[size_class];
+      }
+    }
+    if (!block)
+      block = static_cast<BlockPrefix*>(malloc(block_size));
+    if (!block)
+      return NULL;
+    block->size_class = size_class;
+    return block + 1;
+  }
+
+  void FreeExceptionMemory(void* ptr) {
+    BlockPrefix* block = static_cast<BlockPrefix*>(ptr) - 1;
+    size_t size_class = block->size_class;
+    if (size_class != kUncachedClass) {
+      __cxa_eh_globals* globals = __cxa_get_globals_fast();
+      if (globals && globals->exceptionCacheCount[size_class] < kMaxCachedBlocks) {
+        NextCachedBlock(block) =
+            static_cast<BlockPrefix*>(globals->exceptionCache[size_class]);
+        globals->exceptionCache[size_class] = block;
+        ++globals->exceptionCacheCount[size_class];
+        return;
+      }
+    }
+    free(block);
+  }
+
+  void ReleaseExceptionCache(__cxa_eh_globals* globals) {
+    for (size_t size_class = 0; size_class < kCachedClasses; ++size_class) {
+      while (globals->exceptionCacheCount[size_class] != 0) {
+        BlockPrefix* block =
+            static_cast<BlockPrefix*>(globals->exceptionCache[size_class]);
+        globals->exceptionCache[size_class] = NextCachedBlock(block);
+        --globals->exceptionCacheCount[size_class];
+        free(block);
+      }
+    }
+  }
+
   // Technical note:
   // Use a pthread_key_t to hold the key used to store our thread-specific
   // __cxa_eh_globals objects. The key is created and destroyed through
@@ -249,6 +324,7 @@ namespace {
   private:
     // Called when a thread is destroyed.
     static void freeObject(void* obj) {
+      ReleaseExceptionCache(reinterpret_cast<__cxa_eh_globals*>(obj));
       __cxa_eh_globals_allocator.Release(obj);
     }
 
@@ -296,7 +372,8 @@ namespace __cxxabiv1 {
 
   extern "C" void *__cxa_allocate_exception(size_t thrown_size) _GABIXX_NOEXCEPT {
     size_t size = thrown_size + sizeof(__cxa_exception);
-    __cxa_exception *buffer = static_cast<__cxa_exception*>(malloc(size));
+    __cxa_exception *buffer =
+        static_cast<__cxa_exception*>(AllocateExceptionMemory(size));
     if (!buffer) {
       // Since Android uses memory-overcommit, we enter here only when
       // the exception object is VERY large. This will propably never happen.
@@ -319,7 +396,7 @@ namespace __cxxabiv1 {
       }
     }
 
-    free(exc);
+    FreeExceptionMemory(exc);
   }
 
   extern "C" void __cxa_throw(void* thrown_exc,
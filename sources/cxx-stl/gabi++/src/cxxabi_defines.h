@@ -309,6 +309,10 @@ struct __cxa_eh_globals {
 #ifdef __arm__
   __cxa_exception* cleanupExceptions;
 #endif
+  // Exception memory freed by this thread and kept for reuse, by size class.
+  // See cxxabi.cc.
+  void* exceptionCache[3];
+  unsigned char exceptionCacheCount[3];
 };
 
 }  // extern "C"
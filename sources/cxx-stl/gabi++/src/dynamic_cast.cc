@@ -262,6 +262,107 @@ namespace
       }
      context->dst_object = saved_dst_object;
   }
+
+  // Cache of __dynamic_cast results.
+  //
+  // The result of a cast only depends on the layout of the most derived
+  // object, the place of the source subobject in it, the source and
+  // destination types and the hint.  The first two are both identified by
+  // the virtual table pointer of the source subobject: different subobjects
+  // of the same type have different offset-to-top, and so different virtual
+  // tables.  Results are kept as an offset from the source pointer, and
+  // failed casts (including ambiguous and non-public ones) are kept too.
+  //
+  // The cache is direct-mapped. Each entry is published through its own
+  // sequence counter: writer makes it odd while updating the entry, reader
+  // retries if it changed meanwhile. A writer which finds an entry being
+  // updated by another thread just drops its result, so nobody ever blocks.
+
+  struct cast_cache_entry
+  {
+    unsigned seq;
+    const void* vtable;
+    const abi::__class_type_info* src_type;
+    const abi::__class_type_info* dst_type;
+    std::ptrdiff_t src2dst_offset;
+    std::ptrdiff_t src_to_result;
+    bool found;
+  };
+
+  const size_t cast_cache_size = 512;  // power of 2
+
+  cast_cache_entry cast_cache[cast_cache_size];
+
+  cast_cache_entry&
+  cast_cache_slot(const void* vtable,
+                  const abi::__class_type_info* src,
+                  const abi::__class_type_info* dst)
+  {
+    size_t hash = reinterpret_cast<size_t>(vtable) ^
+                  (reinterpret_cast<size_t>(src) >> 3) ^
+                  (reinterpret_cast<size_t>(dst) >> 5);
+    hash *= 2654435761u;
+    return cast_cache[(hash >> 7) & (cast_cache_size - 1)];
+  }
+
+  // If the cast is in the cache, set *result to its result and return true.
+
+  bool
+  cast_cache_find(const void* v,
+                  const abi::__class_type_info* src,
+                  const abi::__class_type_info* dst,
+                  std::ptrdiff_t src2dst_offset,
+                  const void** result)
+  {
+    const void* vtable = get_vtable(v);
+    cast_cache_entry& e = cast_cache_slot(vtable, src, dst);
+    for (;;)
+      {
+        unsigned seq = __atomic_load_n(&e.seq, __ATOMIC_ACQUIRE);
+        if (seq & 1)
+          return false;
+        bool hit =
+          __atomic_load_n(&e.vtable, __ATOMIC_RELAXED) == vtable &&
+          __atomic_load_n(&e.src_type, __ATOMIC_RELAXED) == src &&
+          __atomic_load_n(&e.dst_type, __ATOMIC_RELAXED) == dst &&
+          __atomic_load_n(&e.src2dst_offset, __ATOMIC_RELAXED) == src2dst_offset;
+        std::ptrdiff_t offset = __atomic_load_n(&e.src_to_result, __ATOMIC_RELAXED);
+        bool found = __atomic_load_n(&e.found, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&e.seq, __ATOMIC_RELAXED) != seq)
+          continue;
+        if (!hit)
+          return false;
+        *result = found ? adjust_pointer(v, offset) : NULL;
+        return true;
+      }
+  }
+
+  void
+  cast_cache_store(const void* v,
+                   const abi::__class_type_info* src,
+                   const abi::__class_type_info* dst,
+                   std::ptrdiff_t src2dst_offset,
+                   const void* result)
+  {
+    const void* vtable = get_vtable(v);
+    cast_cache_entry& e = cast_cache_slot(vtable, src, dst);
+    unsigned seq = __atomic_load_n(&e.seq, __ATOMIC_RELAXED);
+    if ((seq & 1) ||
+        !__atomic_compare_exchange_n(&e.seq, &seq, seq + 1, false,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+      return;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    std::ptrdiff_t offset = result == NULL ? 0 :
+      static_cast<const char*>(result) - static_cast<const char*>(v);
+    __atomic_store_n(&e.vtable, vtable, __ATOMIC_RELAXED);
+    __atomic_store_n(&e.src_type, src, __ATOMIC_RELAXED);
+    __atomic_store_n(&e.dst_type, dst, __ATOMIC_RELAXED);
+    __atomic_store_n(&e.src2dst_offset, src2dst_offset, __ATOMIC_RELAXED);
+    __atomic_store_n(&e.src_to_result, offset, __ATOMIC_RELAXED);
+    __atomic_store_n(&e.found, result != NULL, __ATOMIC_RELAXED);
+    __atomic_store_n(&e.seq, seq + 2, __ATOMIC_RELEASE);
+  }
 } // namespace
 
 namespace __cxxabiv1
@@ -285,11 +386,11 @@ namespace __cxxabiv1
    *    base type of dst at offset src2dst_offset from the
    *    origin of dst.
    */
-  extern "C" void*
-  __dynamic_cast (const void *v,
-                  const abi::__class_type_info *src,
-                  const abi::__class_type_info *dst,
-                  std::ptrdiff_t src2dst_offset)
+  static void*
+  dynamic_cast_uncached(const void *v,
+                        const abi::__class_type_info *src,
+                        const abi::__class_type_info *dst,
+                        std::ptrdiff_t src2dst_offset)
   {
     const void* most_derived_object = get_most_derived_object(v);
     const void* vtable = get_vtable(most_derived_object);
@@ -353,4 +454,18 @@ namespace __cxxabiv1
       walk_object(most_derived_object, most_derived_class_type_info, v, src);
     return v_object == v ? t_object : NULL;
   }
+
+  extern "C" void*
+  __dynamic_cast (const void *v,
+                  const abi::__class_type_info *src,
+                  const abi::__class_type_info *dst,
+                  std::ptrdiff_t src2dst_offset)
+  {
+    const void* result;
+    if (cast_cache_find(v, src, dst, src2dst_offset, &result))
+      return const_cast<void*>(result);
+    result = dynamic_cast_uncached(v, src, dst, src2dst_offset);
+    cast_cache_store(v, src, dst, src2dst_offset, result);
+    return const_cast<void*>(result);
+  }
 } // namespace __cxxabiv1
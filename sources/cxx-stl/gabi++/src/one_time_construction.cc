@@ -42,74 +42,76 @@
  * code simpler and slightly more efficient
  */
 
-#include <stddef.h>
-#include <pthread.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
-/* In this implementation, we use a single global mutex+condvar pair.
- *
- * Pros: portable and doesn't require playing with futexes, atomics
- *       and memory barriers.
- *
- * Cons: Slower than necessary.
+/* In this implementation, there is no global lock: each guard variable is
+ * its own futex. Bit 8 indicates that the guard value is being initialized,
+ * and bit 9 that there are threads sleeping on it, waiting for completion.
+ * Only those threads are woken when initialization completes or is aborted,
+ * and threads initializing unrelated statics never contend with each other.
  */
-static pthread_mutex_t  sMutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER;
-static pthread_cond_t   sCond  = PTHREAD_COND_INITIALIZER;
 
+enum {
+    kInitialized = 0x1,
+    kPending = 0x100,
+    kWaiters = 0x200
+};
+
+static void futex_wait(int volatile* gv, int expected)
+{
+    // Spurious wakeups, EINTR and EAGAIN are all handled by caller's loop.
+    syscall(__NR_futex, gv, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+static void futex_wake_all(int volatile* gv)
+{
+    syscall(__NR_futex, gv, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
 
 extern "C" int __cxa_guard_acquire(int volatile * gv)
 {
-    pthread_mutex_lock(&sMutex);
+    int guard = __atomic_load_n(gv, __ATOMIC_ACQUIRE);
     for (;;) {
-        // while gv points to a volatile value, we use the
-        // previous pthread_mutex_lock or pthread_cond_wait
-        // as a trivial memory barrier
-        int guard = *gv;
-        if ((guard & 1) != 0) {
+        if ((guard & kInitialized) != 0) {
             /* already initialized - return 0 */
-            pthread_mutex_unlock(&sMutex);
             return 0;
         }
 
-        // we use bit 8 to indicate that the guard value is being
-        // initialized, and bit 9 to indicate that there is another
-        // thread waiting for its completion.
-        if ((guard & 0x100) == 0) {
+        if ((guard & kPending) == 0) {
             // nobody is initializing this yet, so mark the guard value
             // first. and allow initialization to proceed.
-            *gv = 0x100;
-            pthread_mutex_unlock(&sMutex);
-            return 1;
+            if (__atomic_compare_exchange_n(gv, &guard, guard | kPending, false,
+                                            __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+                return 1;
+            continue;
         }
 
-        // already being initialized by amother thread,
+        // already being initialized by another thread,
         // we must indicate that there is a waiter, then
         // wait to be woken up before trying again.
-        *gv = guard | 0x200;
-        pthread_cond_wait(&sCond, &sMutex);
+        if ((guard & kWaiters) == 0 &&
+            !__atomic_compare_exchange_n(gv, &guard, guard | kWaiters, false,
+                                         __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+            continue;
+        futex_wait(gv, guard | kWaiters);
+        guard = __atomic_load_n(gv, __ATOMIC_ACQUIRE);
     }
 }
 
 extern "C" void __cxa_guard_release(int volatile * gv)
 {
-    pthread_mutex_lock(&sMutex);
-
-    int guard = *gv;
     // this indicates initialization for our two ABIs.
-    *gv = 0x1;
-    if ((guard & 0x200) != 0)
-        pthread_cond_broadcast(&sCond);
-
-    pthread_mutex_unlock(&sMutex);
+    int guard = __atomic_exchange_n(gv, kInitialized, __ATOMIC_RELEASE);
+    if ((guard & kWaiters) != 0)
+        futex_wake_all(gv);
 }
 
 extern "C" void __cxa_guard_abort(int volatile * gv)
 {
-    pthread_mutex_lock(&sMutex);
-
-    int guard = *gv;
-    *gv = 0;
-    if ((guard & 0x200) != 0)
-        pthread_cond_broadcast(&sCond);
-
-    pthread_mutex_unlock(&sMutex);
+    int guard = __atomic_exchange_n(gv, 0, __ATOMIC_RELEASE);
+    if ((guard & kWaiters) != 0)
+        futex_wake_all(gv);
 }
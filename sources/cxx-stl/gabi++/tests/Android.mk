@@ -21,6 +21,7 @@ $(call do_test,rtti,test_gabixx_rtti.cpp)
 $(call do_test,exceptions,test_gabixx_exceptions.cpp)
 $(call do_test,aux_runtime,test_aux_runtime.cpp)
 $(call do_test_simple,test_guard)
+$(call do_test_simple,guard_stress)
 $(call do_test_simple,catch_array_01)
 $(call do_test_simple,catch_array_02)
 $(call do_test_simple,catch_class_01)
@@ -38,6 +39,7 @@ $(call do_test_simple,catch_ptr)
 $(call do_test_simple,catch_ptr_02)
 $(call do_test_simple,dynamic_cast3)
 $(call do_test_simple,dynamic_cast5)
+$(call do_test_simple,dynamic_cast_cache)
 $(call do_test_simple,test_vector1)
 $(call do_test_simple,test_vector2)
 $(call do_test_simple,test_vector3)
@@ -0,0 +1,83 @@
+/* This program measures throughput of one-time construction of many
+ * distinct guard variables, raced for by 1..64 threads at once, each
+ * starting at its own place in the list.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+extern "C" int  __cxa_guard_acquire(int volatile* gv);
+extern "C" void __cxa_guard_release(int volatile* gv);
+
+#define GUARDS  4096
+#define ROUNDS  20
+#define MAX_THREADS 64
+
+// 64-bit, as generic C++ ABI guard variables are.
+static int64_t  sGuards[GUARDS];
+static int      sValues[GUARDS];
+static int      sInits;
+
+static void* thread_run(void* arg)
+{
+    int first = (int)(intptr_t)arg;
+    for (int i = 0; i < GUARDS; i++) {
+        int n = (first + i) % GUARDS;
+        if (__cxa_guard_acquire(reinterpret_cast<int volatile*>(&sGuards[n]))) {
+            // Some work for others to wait for
+            for (int k = 0; k < 64; k++)
+                sValues[n] = sValues[n] * 31 + k;
+            __sync_add_and_fetch(&sInits, 1);
+            __cxa_guard_release(reinterpret_cast<int volatile*>(&sGuards[n]));
+        }
+    }
+    return NULL;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int run(int nthreads)
+{
+    pthread_t threads[MAX_THREADS];
+    double elapsed = 0;
+    for (int r = 0; r < ROUNDS; r++) {
+        memset(sGuards, 0, sizeof(sGuards));
+        sInits = 0;
+        double start = now();
+        for (int nn = 0; nn < nthreads; nn++) {
+            pthread_create(&threads[nn], NULL, thread_run,
+                           reinterpret_cast<void*>(nn * GUARDS / nthreads));
+        }
+        for (int nn = 0; nn < nthreads; nn++) {
+            void* dummy;
+            pthread_join(threads[nn], &dummy);
+        }
+        elapsed += now() - start;
+
+        if (sInits != GUARDS) {
+            fprintf(stderr, "ERROR: %d initializations (%d expected)\n",
+                    sInits, GUARDS);
+            return 1;
+        }
+    }
+    printf("%d threads: %ld inits/s\n", nthreads,
+           (long)(GUARDS * ROUNDS / elapsed));
+    return 0;
+}
+
+int main(void)
+{
+    for (int n = 1; n <= MAX_THREADS; n *= 2) {
+        if (run(n) != 0)
+            return 1;
+    }
+    return 0;
+}
@@ -154,6 +154,20 @@ extern char* __cxa_demangle(const char* mangled_name,
                             size_t*     length,
                             int*        status);
 
+// Demangler extension for demangling many names in a row.  A context keeps
+// the memory used for one name for the next one, and must not be used by
+// two threads at once.  __cxa_demangle_with_context writes into
+// output_buffer, which is never reallocated; when the name does not fit,
+// *length is set to the size needed and *status to -5.
+struct __cxa_demangle_context;
+extern __cxa_demangle_context* __cxa_demangle_context_create();
+extern void __cxa_demangle_context_destroy(__cxa_demangle_context* context);
+extern char* __cxa_demangle_with_context(__cxa_demangle_context* context,
+                                         const char* mangled_name,
+                                         char*       output_buffer,
+                                         size_t*     length,
+                                         int*        status);
+
 // Apple additions to support C++ 0x exception_ptr class
 // These are primitives to wrap a smart pointer around an exception object
 extern void * __cxa_current_primary_exception() throw();
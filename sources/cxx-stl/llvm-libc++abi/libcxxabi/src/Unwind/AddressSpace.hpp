@@ -64,6 +64,27 @@ extern EHTEntry __exidx_end;
 #endif
 #endif
 
+// Old Android platforms have no dl_iterate_phdr() on ARM.
+#if LIBCXXABI_ARM_EHABI && defined(__ANDROID__)
+#include <android/api-level.h>
+#endif
+#if !defined(__APPLE__) && !defined(_LIBUNWIND_IS_BAREMETAL) &&                \
+    (!LIBCXXABI_ARM_EHABI || !defined(__ANDROID__) || __ANDROID_API__ >= 21)
+  #define _LIBUNWIND_USE_DSO_INDEX 1
+#else
+  #define _LIBUNWIND_USE_DSO_INDEX 0
+#endif
+
+#if _LIBUNWIND_USE_DSO_INDEX
+#include <algorithm>
+#include <elf.h>
+#include <link.h>
+#include <pthread.h>
+#ifndef PT_ARM_EXIDX
+#define PT_ARM_EXIDX 0x70000001
+#endif
+#endif
+
 namespace libunwind {
 
 /// Used by findUnwindSections() to return info about needed sections.
@@ -336,6 +357,216 @@ LocalAddressSpace::getEncodedP(pint_t &addr, pint_t end, uint8_t encoding,
   #endif
 #endif
 
+#if _LIBUNWIND_USE_DSO_INDEX
+/// Snapshot of loaded objects: their PT_LOAD segments sorted by address, with
+/// unwind sections of each.  Looking for pc with dl_iterate_phdr() means a
+/// callback per loaded object; with the snapshot it's a binary search and a
+/// single callback, to compare loader's dlpi_adds/dlpi_subs counters with the
+/// ones snapshot was taken at.  If they differ, snapshot is taken again.
+///
+/// Snapshot is only touched from dl_iterate_phdr() callbacks, under _lock, so
+/// the lock is always taken inside of loader's one.  For loaders which don't
+/// report counters find() returns -1 and caller has to walk objects itself.
+template <typename A>
+class _LIBUNWIND_HIDDEN DsoIndex {
+  typedef typename A::pint_t pint_t;
+public:
+  struct Range {
+    pint_t begin;
+    pint_t end;
+    pint_t eh_frame_hdr;
+    pint_t eh_frame_hdr_length;
+    pint_t exidx;
+    pint_t exidx_count;
+  };
+
+  static int find(pint_t pc, Range &range);
+
+private:
+  // dl_phdr_info as passed by loaders which count loads and unloads (glibc,
+  // bionic since Android 11); older ones pass only first four fields.
+  struct CountedPhdrInfo {
+    ElfW(Addr) dlpi_addr;
+    const char *dlpi_name;
+    const ElfW(Phdr) *dlpi_phdr;
+    ElfW(Half) dlpi_phnum;
+    unsigned long long dlpi_adds;
+    unsigned long long dlpi_subs;
+  };
+
+  enum { FOUND = 1, NOT_FOUND = 0, UNSUPPORTED = -1, STALE = -2 };
+
+  struct LookupData {
+    pint_t pc;
+    Range *range;
+    int result;
+  };
+
+  struct Snapshot {
+    unsigned long long adds;
+    unsigned long long subs;
+    Range *ranges;
+    size_t count;
+    size_t capacity;
+    bool failed;
+  };
+
+  static bool lessBegin(const Range &a, const Range &b) {
+    return a.begin < b.begin;
+  }
+  static int lookupCallback(struct dl_phdr_info *pinfo, size_t size,
+                            void *data);
+  static int collectCallback(struct dl_phdr_info *pinfo, size_t size,
+                             void *data);
+  static int publishCallback(struct dl_phdr_info *pinfo, size_t size,
+                             void *data);
+
+  static pthread_mutex_t _lock;
+  static Snapshot _current;
+};
+
+template <typename A>
+pthread_mutex_t DsoIndex<A>::_lock = PTHREAD_MUTEX_INITIALIZER;
+
+template <typename A>
+typename DsoIndex<A>::Snapshot DsoIndex<A>::_current;
+
+/// Called for the first object only: check counters and search snapshot.
+template <typename A>
+int DsoIndex<A>::lookupCallback(struct dl_phdr_info *pinfo, size_t size,
+                                void *data) {
+  LookupData *d = static_cast<LookupData *>(data);
+  if (size < sizeof(CountedPhdrInfo)) {
+    d->result = UNSUPPORTED;
+    return 1;
+  }
+  const CountedPhdrInfo *info = reinterpret_cast<CountedPhdrInfo *>(pinfo);
+
+  _LIBUNWIND_LOG_NON_ZERO(::pthread_mutex_lock(&_lock));
+  if ((_current.ranges == NULL) || (_current.adds != info->dlpi_adds) ||
+      (_current.subs != info->dlpi_subs)) {
+    d->result = STALE;
+  } else {
+    // Last range starting at or below pc
+    const Range *first = _current.ranges;
+    size_t count = _current.count;
+    while (count > 0) {
+      size_t half = count / 2;
+      if (first[half].begin <= d->pc) {
+        first += half + 1;
+        count -= half + 1;
+      } else {
+        count = half;
+      }
+    }
+    d->result = NOT_FOUND;
+    if ((first != _current.ranges) && (d->pc < first[-1].end)) {
+      *d->range = first[-1];
+      d->result = FOUND;
+    }
+  }
+  _LIBUNWIND_LOG_NON_ZERO(::pthread_mutex_unlock(&_lock));
+  return 1;
+}
+
+/// Called for each object: add its segments to private snapshot.
+template <typename A>
+int DsoIndex<A>::collectCallback(struct dl_phdr_info *pinfo, size_t size,
+                                 void *data) {
+  Snapshot *s = static_cast<Snapshot *>(data);
+  if (size < sizeof(CountedPhdrInfo)) {
+    s->failed = true;
+    return 1;
+  }
+  const CountedPhdrInfo *info = reinterpret_cast<CountedPhdrInfo *>(pinfo);
+  // Counters don't change during the walk
+  s->adds = info->dlpi_adds;
+  s->subs = info->dlpi_subs;
+
+  Range unwind = {0, 0, 0, 0, 0, 0};
+  for (ElfW(Half) i = 0; i < info->dlpi_phnum; i++) {
+    const ElfW(Phdr) *phdr = &info->dlpi_phdr[i];
+    if (phdr->p_type == PT_GNU_EH_FRAME) {
+      unwind.eh_frame_hdr = info->dlpi_addr + phdr->p_vaddr;
+      unwind.eh_frame_hdr_length = phdr->p_memsz;
+    } else if (phdr->p_type == PT_ARM_EXIDX) {
+      unwind.exidx = info->dlpi_addr + phdr->p_vaddr;
+      unwind.exidx_count = phdr->p_memsz / 8;
+    }
+  }
+  if ((unwind.eh_frame_hdr == 0) && (unwind.exidx == 0))
+    return 0;
+
+  for (ElfW(Half) i = 0; i < info->dlpi_phnum; i++) {
+    const ElfW(Phdr) *phdr = &info->dlpi_phdr[i];
+    if (phdr->p_type != PT_LOAD)
+      continue;
+    if (s->count == s->capacity) {
+      size_t capacity = s->capacity ? s->capacity * 2 : 64;
+      // Can't use operator new (we are below it).
+      Range *ranges = (Range *)realloc(s->ranges, capacity * sizeof(Range));
+      if (ranges == NULL) {
+        s->failed = true;
+        return 1;
+      }
+      s->ranges = ranges;
+      s->capacity = capacity;
+    }
+    Range &r = s->ranges[s->count++];
+    r = unwind;
+    r.begin = info->dlpi_addr + phdr->p_vaddr;
+    r.end = r.begin + phdr->p_memsz;
+  }
+  return 0;
+}
+
+/// Called for the first object only: install snapshot if it's still current.
+template <typename A>
+int DsoIndex<A>::publishCallback(struct dl_phdr_info *pinfo, size_t size,
+                                 void *data) {
+  Snapshot *s = static_cast<Snapshot *>(data);
+  if (size < sizeof(CountedPhdrInfo))
+    return 1;
+  const CountedPhdrInfo *info = reinterpret_cast<CountedPhdrInfo *>(pinfo);
+  if ((s->adds != info->dlpi_adds) || (s->subs != info->dlpi_subs))
+    return 1;
+
+  _LIBUNWIND_LOG_NON_ZERO(::pthread_mutex_lock(&_lock));
+  Snapshot old = _current;
+  _current = *s;
+  *s = old;
+  _LIBUNWIND_LOG_NON_ZERO(::pthread_mutex_unlock(&_lock));
+  return 1;
+}
+
+/// Return 1 and fill range if pc is in some loaded object with unwind info,
+/// 0 if it's not, or -1 if loader can't tell whether snapshot is current.
+template <typename A>
+int DsoIndex<A>::find(pint_t pc, Range &range) {
+  LookupData d = {pc, &range, UNSUPPORTED};
+  dl_iterate_phdr(&lookupCallback, &d);
+  if (d.result != STALE)
+    return d.result;
+
+  Snapshot s = {0, 0, NULL, 0, 0, false};
+  dl_iterate_phdr(&collectCallback, &s);
+  if (!s.failed) {
+    std::sort(s.ranges, s.ranges + s.count, &lessBegin);
+    // Empty snapshot is current too
+    if (s.ranges == NULL)
+      s.ranges = (Range *)malloc(sizeof(Range));
+    if (s.ranges != NULL)
+      dl_iterate_phdr(&publishCallback, &s);
+  }
+  // Either previous snapshot or the new one if it's gone stale meanwhile
+  free(s.ranges);
+
+  d.result = UNSUPPORTED;
+  dl_iterate_phdr(&lookupCallback, &d);
+  return (d.result == STALE) ? UNSUPPORTED : d.result;
+}
+#endif // _LIBUNWIND_USE_DSO_INDEX
+
 inline bool LocalAddressSpace::findUnwindSections(pint_t targetAddr,
                                                   UnwindInfoSections &info) {
 #ifdef __APPLE__
@@ -356,10 +587,24 @@ inline bool LocalAddressSpace::findUnwindSections(pint_t targetAddr,
   info.arm_section =        (uintptr_t)(&__exidx_start);
   info.arm_section_length = (uintptr_t)(&__exidx_end - &__exidx_start);
  #else
-  int length = 0;
-  info.arm_section = (uintptr_t) dl_unwind_find_exidx(
-      (_Unwind_Ptr) targetAddr, &length);
-  info.arm_section_length = (uintptr_t)length;
+  int indexed = -1;
+  #if _LIBUNWIND_USE_DSO_INDEX
+  DsoIndex<LocalAddressSpace>::Range range;
+  indexed = DsoIndex<LocalAddressSpace>::find(targetAddr, range);
+  if (indexed > 0) {
+    info.arm_section = range.exidx;
+    info.arm_section_length = range.exidx_count;
+  } else if (indexed == 0) {
+    info.arm_section = 0;
+    info.arm_section_length = 0;
+  }
+  #endif
+  if (indexed < 0) {
+    int length = 0;
+    info.arm_section = (uintptr_t) dl_unwind_find_exidx(
+        (_Unwind_Ptr) targetAddr, &length);
+    info.arm_section_length = (uintptr_t)length;
+  }
  #endif
   _LIBUNWIND_TRACE_UNWINDING("findUnwindSections: section %X length %x\n",
                              info.arm_section, info.arm_section_length);
@@ -367,6 +612,23 @@ inline bool LocalAddressSpace::findUnwindSections(pint_t targetAddr,
     return true;
 #elif _LIBUNWIND_SUPPORT_DWARF_UNWIND
 #if _LIBUNWIND_SUPPORT_DWARF_INDEX
+  DsoIndex<LocalAddressSpace>::Range range;
+  int indexed = DsoIndex<LocalAddressSpace>::find(targetAddr, range);
+  if (indexed >= 0) {
+    if ((indexed == 0) || (range.eh_frame_hdr == 0))
+      return false;
+    EHHeaderParser<LocalAddressSpace>::EHHeaderInfo hdrInfo;
+    EHHeaderParser<LocalAddressSpace>::decodeEHHdr(
+        *this, range.eh_frame_hdr,
+        range.eh_frame_hdr + range.eh_frame_hdr_length, hdrInfo);
+    info.dso_base = range.begin;
+    info.dwarf_index_section = range.eh_frame_hdr;
+    info.dwarf_index_section_length = range.eh_frame_hdr_length;
+    info.dwarf_section = hdrInfo.eh_frame_ptr;
+    info.dwarf_section_length = range.end - range.begin;
+    return true;
+  }
+
   struct dl_iterate_cb_data {
     LocalAddressSpace *addressSpace;
     UnwindInfoSections *sects;
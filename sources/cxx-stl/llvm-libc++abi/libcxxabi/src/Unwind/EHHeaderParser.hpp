@@ -67,8 +67,14 @@ void EHHeaderParser<A>::decodeEHHdr(A &addressSpace, pint_t ehHdrStart,
 
   ehHdrInfo.eh_frame_ptr =
       addressSpace.getEncodedP(p, ehHdrEnd, eh_frame_ptr_enc, ehHdrStart);
-  ehHdrInfo.fde_count =
-      addressSpace.getEncodedP(p, ehHdrEnd, fde_count_enc, ehHdrStart);
+  if (fde_count_enc == DW_EH_PE_omit) {
+    // No search table
+    ehHdrInfo.fde_count = 0;
+    ehHdrInfo.table_enc = DW_EH_PE_omit;
+  } else {
+    ehHdrInfo.fde_count =
+        addressSpace.getEncodedP(p, ehHdrEnd, fde_count_enc, ehHdrStart);
+  }
   ehHdrInfo.table = p;
 }
 
@@ -103,6 +109,10 @@ bool EHHeaderParser<A>::findFDE(A &addressSpace, pint_t pc, pint_t ehHdrStart,
   EHHeaderParser<A>::EHHeaderInfo hdrInfo;
   EHHeaderParser<A>::decodeEHHdr(addressSpace, ehHdrStart, ehHdrEnd, hdrInfo);
 
+  // Without search table let caller look for FDE in __eh_frame itself.
+  if ((hdrInfo.fde_count == 0) || (hdrInfo.table_enc == DW_EH_PE_omit))
+    return false;
+
   size_t tableEntrySize = getTableEntrySize(hdrInfo.table_enc);
   pint_t tableEntry;
 
@@ -38,12 +38,30 @@ namespace libunwind {
 
 #if _LIBUNWIND_SUPPORT_DWARF_UNWIND
 /// Cache of recently found FDEs.
+///
+/// Entries are kept sorted by ip_start, so lookup is a binary search.  Lookup
+/// takes no lock: writers (serialized by _lock) make _seq odd while changing
+/// entries and readers retry if _seq changed under them.  Outgrown buffers are
+/// never freed since some reader could still be looking at them; buffers grow
+/// geometrically, so all retired ones together are smaller than the live one.
+///
+/// On first miss in a DSO which has no usable .eh_frame_hdr, all its FDEs are
+/// added at once (see addSection()), so further lookups in it never need to
+/// scan __eh_frame.  The set of such DSOs is kept sorted and published the
+/// same way as the entries, so isIndexed() takes no lock either.
+///
+/// Each thread also remembers the last entry it found, so repeated lookups of
+/// the same function skip the search.  It's kept under a pthread key rather
+/// than thread_local, which the NDK toolchains don't support on all targets.
 template <typename A>
 class _LIBUNWIND_HIDDEN DwarfFDECache {
   typedef typename A::pint_t pint_t;
 public:
   static pint_t findFDE(pint_t mh, pint_t pc);
   static void add(pint_t mh, pint_t ip_start, pint_t ip_end, pint_t fde);
+  static bool addSection(A &addressSpace, pint_t mh, pint_t ehSectionStart,
+                         uint32_t sectionLength);
+  static bool isIndexed(pint_t mh);
   static void removeAllIn(pint_t mh);
   static void iterateCacheEntries(void (*func)(unw_word_t ip_start,
                                                unw_word_t ip_end,
@@ -58,18 +76,48 @@ private:
     pint_t fde;
   };
 
+  static entry load(const entry *p);
+  static void store(entry *p, const entry &e);
+  static bool lessStart(const entry &a, const entry &b) {
+    return a.ip_start < b.ip_start;
+  }
+  static size_t upperBound(const entry *buffer, size_t count, pint_t pc);
+  static bool contains(const entry &e);
+  static bool insert(entry *fdes, size_t count);
+  static size_t indexedLowerBound(const pint_t *indexed, size_t count,
+                                  pint_t mh);
+  static bool addIndexed(pint_t mh);
+  static uint32_t writeBegin();
+  static void writeEnd(uint32_t seq);
+  static void createLastHitKey();
+
   // These fields are all static to avoid needing an initializer.
   // There is only one instance of this class per process.
-  static pthread_rwlock_t _lock;
+  static pthread_mutex_t _lock;
+  static uint32_t _seq;
 #ifdef __APPLE__
   static void dyldUnloadHook(const struct mach_header *mh, intptr_t slide);
   static bool _registeredForDyldUnloads;
 #endif
   // Can't use std::vector<> here because this code is below libc++.
   static entry *_buffer;
-  static entry *_bufferUsed;
-  static entry *_bufferEnd;
+  static size_t _count;
+  static size_t _capacity;
+  static pint_t _maxLength;
   static entry _initialBuffer[64];
+  // DSOs all FDEs of which are in cache, sorted.
+  static pint_t *_indexed;
+  static size_t _indexedCount;
+  static size_t _indexedCapacity;
+  static pint_t _initialIndexed[16];
+  // Last entry found by a thread; valid while _seq is still the same.
+  struct lastHit {
+    uint32_t seq;
+    entry e;
+  };
+  static pthread_once_t _lastHitOnce;
+  static pthread_key_t _lastHitKey;
+  static bool _lastHitKeyValid;
 };
 
 template <typename A>
@@ -77,83 +125,385 @@ typename DwarfFDECache<A>::entry *
 DwarfFDECache<A>::_buffer = _initialBuffer;
 
 template <typename A>
-typename DwarfFDECache<A>::entry *
-DwarfFDECache<A>::_bufferUsed = _initialBuffer;
+size_t DwarfFDECache<A>::_count = 0;
 
 template <typename A>
-typename DwarfFDECache<A>::entry *
-DwarfFDECache<A>::_bufferEnd = &_initialBuffer[64];
+size_t DwarfFDECache<A>::_capacity = 64;
+
+template <typename A>
+typename A::pint_t DwarfFDECache<A>::_maxLength = 0;
 
 template <typename A>
 typename DwarfFDECache<A>::entry DwarfFDECache<A>::_initialBuffer[64];
 
 template <typename A>
-pthread_rwlock_t DwarfFDECache<A>::_lock = PTHREAD_RWLOCK_INITIALIZER;
+typename A::pint_t *DwarfFDECache<A>::_indexed = _initialIndexed;
+
+template <typename A>
+size_t DwarfFDECache<A>::_indexedCount = 0;
+
+template <typename A>
+size_t DwarfFDECache<A>::_indexedCapacity = 16;
+
+template <typename A>
+typename A::pint_t DwarfFDECache<A>::_initialIndexed[16];
+
+template <typename A>
+pthread_mutex_t DwarfFDECache<A>::_lock = PTHREAD_MUTEX_INITIALIZER;
+
+template <typename A>
+uint32_t DwarfFDECache<A>::_seq = 0;
+
+template <typename A>
+pthread_once_t DwarfFDECache<A>::_lastHitOnce = PTHREAD_ONCE_INIT;
+
+template <typename A>
+pthread_key_t DwarfFDECache<A>::_lastHitKey;
+
+template <typename A>
+bool DwarfFDECache<A>::_lastHitKeyValid = false;
 
 #ifdef __APPLE__
 template <typename A>
 bool DwarfFDECache<A>::_registeredForDyldUnloads = false;
 #endif
 
+template <typename A>
+typename DwarfFDECache<A>::entry DwarfFDECache<A>::load(const entry *p) {
+  entry e;
+  e.mh = __atomic_load_n(&p->mh, __ATOMIC_RELAXED);
+  e.ip_start = __atomic_load_n(&p->ip_start, __ATOMIC_RELAXED);
+  e.ip_end = __atomic_load_n(&p->ip_end, __ATOMIC_RELAXED);
+  e.fde = __atomic_load_n(&p->fde, __ATOMIC_RELAXED);
+  return e;
+}
+
+template <typename A>
+void DwarfFDECache<A>::store(entry *p, const entry &e) {
+  __atomic_store_n(&p->mh, e.mh, __ATOMIC_RELAXED);
+  __atomic_store_n(&p->ip_start, e.ip_start, __ATOMIC_RELAXED);
+  __atomic_store_n(&p->ip_end, e.ip_end, __ATOMIC_RELAXED);
+  __atomic_store_n(&p->fde, e.fde, __ATOMIC_RELAXED);
+}
+
+/// Index of first entry starting above pc.
+template <typename A>
+size_t DwarfFDECache<A>::upperBound(const entry *buffer, size_t count,
+                                    pint_t pc) {
+  size_t low = 0;
+  while (count > 0) {
+    size_t half = count / 2;
+    if (__atomic_load_n(&buffer[low + half].ip_start, __ATOMIC_RELAXED) <= pc) {
+      low += half + 1;
+      count -= half + 1;
+    } else {
+      count = half;
+    }
+  }
+  return low;
+}
+
+template <typename A>
+uint32_t DwarfFDECache<A>::writeBegin() {
+  uint32_t seq = _seq;
+  __atomic_store_n(&_seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  return seq;
+}
+
+template <typename A>
+void DwarfFDECache<A>::writeEnd(uint32_t seq) {
+  __atomic_store_n(&_seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+template <typename A>
+void DwarfFDECache<A>::createLastHitKey() {
+  if (::pthread_key_create(&_lastHitKey, &free) == 0)
+    __atomic_store_n(&_lastHitKeyValid, true, __ATOMIC_RELEASE);
+}
+
 template <typename A>
 typename A::pint_t DwarfFDECache<A>::findFDE(pint_t mh, pint_t pc) {
-  pint_t result = 0;
-  _LIBUNWIND_LOG_NON_ZERO(::pthread_rwlock_rdlock(&_lock));
-  for (entry *p = _buffer; p < _bufferUsed; ++p) {
-    if ((mh == p->mh) || (mh == 0)) {
-      if ((p->ip_start <= pc) && (pc < p->ip_end)) {
-        result = p->fde;
+  lastHit *hit = NULL;
+  if (__atomic_load_n(&_lastHitKeyValid, __ATOMIC_ACQUIRE))
+    hit = static_cast<lastHit *>(::pthread_getspecific(_lastHitKey));
+  for (;;) {
+    uint32_t seq = __atomic_load_n(&_seq, __ATOMIC_ACQUIRE);
+    if (seq & 1)
+      continue;
+    if ((hit != NULL) && (hit->seq == seq) &&
+        ((mh == hit->e.mh) || (mh == 0)) && (hit->e.ip_start <= pc) &&
+        (pc < hit->e.ip_end))
+      return hit->e.fde;
+    // Count is published after buffer, so buffer is never shorter than count.
+    size_t count = __atomic_load_n(&_count, __ATOMIC_ACQUIRE);
+    const entry *buffer = __atomic_load_n(&_buffer, __ATOMIC_ACQUIRE);
+    pint_t maxLength = __atomic_load_n(&_maxLength, __ATOMIC_RELAXED);
+    entry found = {0, 0, 0, 0};
+    for (size_t i = upperBound(buffer, count, pc); i-- > 0;) {
+      entry e = load(&buffer[i]);
+      if (pc - e.ip_start >= maxLength)
+        break;
+      if (((mh == e.mh) || (mh == 0)) && (pc < e.ip_end)) {
+        found = e;
         break;
       }
     }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&_seq, __ATOMIC_RELAXED) != seq)
+      continue;
+    if (found.fde != 0) {
+      if (hit == NULL) {
+        ::pthread_once(&_lastHitOnce, &createLastHitKey);
+        // Can't use operator new (we are below it).
+        if (__atomic_load_n(&_lastHitKeyValid, __ATOMIC_ACQUIRE))
+          hit = (lastHit *)malloc(sizeof(lastHit));
+        if ((hit != NULL) && (::pthread_setspecific(_lastHitKey, hit) != 0)) {
+          free(hit);
+          hit = NULL;
+        }
+      }
+      if (hit != NULL) {
+        hit->seq = seq;
+        hit->e = found;
+      }
+    }
+    return found.fde;
   }
-  _LIBUNWIND_LOG_NON_ZERO(::pthread_rwlock_unlock(&_lock));
-  return result;
+}
+
+/// Whether entry for the same function is cached already; _lock must be held.
+template <typename A>
+bool DwarfFDECache<A>::contains(const entry &e) {
+  for (size_t i = upperBound(_buffer, _count, e.ip_start); i-- > 0;) {
+    if (_buffer[i].ip_start != e.ip_start)
+      break;
+    if (_buffer[i].mh == e.mh)
+      return true;
+  }
+  return false;
+}
+
+/// Merge entries sorted by ip_start into cache; _lock must be held.  Return
+/// false if the buffer could not grow, in which case nothing was added.
+template <typename A>
+bool DwarfFDECache<A>::insert(entry *fdes, size_t count) {
+  size_t n = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (!contains(fdes[i]))
+      fdes[n++] = fdes[i];
+  }
+  if (n == 0)
+    return true;
+
+  entry *buffer = _buffer;
+  if (_count + n > _capacity) {
+    size_t newCapacity = _capacity * 4;
+    while (newCapacity < _count + n)
+      newCapacity *= 4;
+    // Can't use operator new (we are below it).
+    entry *newBuffer = (entry *)malloc(newCapacity * sizeof(entry));
+    if (newBuffer == NULL)
+      return false;
+    memcpy(newBuffer, buffer, _count * sizeof(entry));
+    // Contents are the same, so readers don't need to retry because of that.
+    __atomic_store_n(&_buffer, newBuffer, __ATOMIC_RELEASE);
+    _capacity = newCapacity;
+    buffer = newBuffer;
+  }
+
+  uint32_t seq = writeBegin();
+  pint_t maxLength = _maxLength;
+  // Merge from the back, so nothing is overwritten before it's moved.
+  size_t i = _count, j = n, k = _count + n;
+  while (j > 0) {
+    if ((i > 0) && (buffer[i - 1].ip_start > fdes[j - 1].ip_start)) {
+      --i;
+      store(&buffer[--k], buffer[i]);
+    } else {
+      --j;
+      store(&buffer[--k], fdes[j]);
+      if (fdes[j].ip_end - fdes[j].ip_start > maxLength)
+        maxLength = fdes[j].ip_end - fdes[j].ip_start;
+    }
+  }
+  __atomic_store_n(&_maxLength, maxLength, __ATOMIC_RELAXED);
+  __atomic_store_n(&_count, _count + n, __ATOMIC_RELEASE);
+  writeEnd(seq);
+  return true;
+}
+
+/// Index of first DSO in indexed not below mh.
+template <typename A>
+size_t DwarfFDECache<A>::indexedLowerBound(const pint_t *indexed, size_t count,
+                                           pint_t mh) {
+  size_t low = 0;
+  while (count > 0) {
+    size_t half = count / 2;
+    if (__atomic_load_n(&indexed[low + half], __ATOMIC_RELAXED) < mh) {
+      low += half + 1;
+      count -= half + 1;
+    } else {
+      count = half;
+    }
+  }
+  return low;
+}
+
+/// Record that all FDEs of mh are in cache; _lock must be held.  Return false
+/// if the set could not grow.  Outgrown arrays are kept like outgrown buffers.
+template <typename A>
+bool DwarfFDECache<A>::addIndexed(pint_t mh) {
+  size_t i = indexedLowerBound(_indexed, _indexedCount, mh);
+  if ((i < _indexedCount) && (_indexed[i] == mh))
+    return true;
+
+  pint_t *indexed = _indexed;
+  if (_indexedCount == _indexedCapacity) {
+    size_t newCapacity = _indexedCapacity * 2;
+    pint_t *newIndexed = (pint_t *)malloc(newCapacity * sizeof(pint_t));
+    if (newIndexed == NULL)
+      return false;
+    memcpy(newIndexed, indexed, _indexedCount * sizeof(pint_t));
+    __atomic_store_n(&_indexed, newIndexed, __ATOMIC_RELEASE);
+    _indexedCapacity = newCapacity;
+    indexed = newIndexed;
+  }
+
+  uint32_t seq = writeBegin();
+  for (size_t j = _indexedCount; j > i; --j)
+    __atomic_store_n(&indexed[j], indexed[j - 1], __ATOMIC_RELAXED);
+  __atomic_store_n(&indexed[i], mh, __ATOMIC_RELAXED);
+  __atomic_store_n(&_indexedCount, _indexedCount + 1, __ATOMIC_RELEASE);
+  writeEnd(seq);
+  return true;
 }
 
 template <typename A>
 void DwarfFDECache<A>::add(pint_t mh, pint_t ip_start, pint_t ip_end,
                            pint_t fde) {
-  _LIBUNWIND_LOG_NON_ZERO(::pthread_rwlock_wrlock(&_lock));
-  if (_bufferUsed >= _bufferEnd) {
-    size_t oldSize = (size_t)(_bufferEnd - _buffer);
-    size_t newSize = oldSize * 4;
-    // Can't use operator new (we are below it).
-    entry *newBuffer = (entry *)malloc(newSize * sizeof(entry));
-    memcpy(newBuffer, _buffer, oldSize * sizeof(entry));
-    if (_buffer != _initialBuffer)
-      free(_buffer);
-    _buffer = newBuffer;
-    _bufferUsed = &newBuffer[oldSize];
-    _bufferEnd = &newBuffer[newSize];
-  }
-  _bufferUsed->mh = mh;
-  _bufferUsed->ip_start = ip_start;
-  _bufferUsed->ip_end = ip_end;
-  _bufferUsed->fde = fde;
-  ++_bufferUsed;
+  entry e = {mh, ip_start, ip_end, fde};
+  _LIBUNWIND_LOG_NON_ZERO(::pthread_mutex_lock(&_lock));
+  insert(&e, 1);
 #ifdef __APPLE__
   if (!_registeredForDyldUnloads) {
     _dyld_register_func_for_remove_image(&dyldUnloadHook);
     _registeredForDyldUnloads = true;
   }
 #endif
-  _LIBUNWIND_LOG_NON_ZERO(::pthread_rwlock_unlock(&_lock));
+  _LIBUNWIND_LOG_NON_ZERO(::pthread_mutex_unlock(&_lock));
+}
+
+/// Add all FDEs of __eh_frame section of mh at once.  Return false if it was
+/// done already or can't be done, so caller has to scan section by itself.
+template <typename A>
+bool DwarfFDECache<A>::addSection(A &addressSpace, pint_t mh,
+                                  pint_t ehSectionStart,
+                                  uint32_t sectionLength) {
+  if (isIndexed(mh))
+    return false;
+
+  entry *fdes = NULL;
+  size_t count = 0;
+  size_t capacity = 0;
+  pint_t p = ehSectionStart;
+  const pint_t ehSectionEnd = p + sectionLength;
+  while (p < ehSectionEnd) {
+    pint_t currentCFI = p;
+    pint_t cfiLength = addressSpace.get32(p);
+    p += 4;
+    if (cfiLength == 0xffffffff) {
+      // 0xffffffff means length is really next 8 bytes
+      cfiLength = (pint_t)addressSpace.get64(p);
+      p += 8;
+    }
+    if (cfiLength == 0)
+      break; // end marker
+    pint_t nextCFI = p + cfiLength;
+    uint32_t ciePointer = addressSpace.get32(p);
+    pint_t cieStart = p - ciePointer;
+    // skip over CIEs, validate pointer to CIE is within section
+    if ((ciePointer != 0) && (ehSectionStart <= cieStart) &&
+        (cieStart < ehSectionEnd)) {
+      typename CFI_Parser<A>::FDE_Info fdeInfo;
+      typename CFI_Parser<A>::CIE_Info cieInfo;
+      if ((CFI_Parser<A>::decodeFDE(addressSpace, currentCFI, &fdeInfo,
+                                    &cieInfo) == NULL) &&
+          (fdeInfo.pcStart < fdeInfo.pcEnd)) {
+        if (count == capacity) {
+          capacity = capacity ? capacity * 2 : 256;
+          entry *grown = (entry *)realloc(fdes, capacity * sizeof(entry));
+          if (grown == NULL) {
+            free(fdes);
+            return false;
+          }
+          fdes = grown;
+        }
+        entry &e = fdes[count++];
+        e.mh = mh;
+        e.ip_start = fdeInfo.pcStart;
+        e.ip_end = fdeInfo.pcEnd;
+        e.fde = currentCFI;
+      }
+    }
+    p = nextCFI;
+  }
+
+  std::sort(fdes, fdes + count, &lessStart);
+  size_t n = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if ((n == 0) || (fdes[n - 1].ip_start != fdes[i].ip_start))
+      fdes[n++] = fdes[i];
+  }
+
+  // mh only counts as indexed once its FDEs are really all in cache.  If
+  // either step fails, the caller keeps scanning the section.
+  _LIBUNWIND_LOG_NON_ZERO(::pthread_mutex_lock(&_lock));
+  bool added = insert(fdes, n) && addIndexed(mh);
+  _LIBUNWIND_LOG_NON_ZERO(::pthread_mutex_unlock(&_lock));
+  free(fdes);
+  return added;
+}
+
+/// Whether all FDEs of mh are in cache, so a miss means there is none.
+template <typename A>
+bool DwarfFDECache<A>::isIndexed(pint_t mh) {
+  for (;;) {
+    uint32_t seq = __atomic_load_n(&_seq, __ATOMIC_ACQUIRE);
+    if (seq & 1)
+      continue;
+    size_t count = __atomic_load_n(&_indexedCount, __ATOMIC_ACQUIRE);
+    const pint_t *indexed = __atomic_load_n(&_indexed, __ATOMIC_ACQUIRE);
+    size_t i = indexedLowerBound(indexed, count, mh);
+    bool result = (i < count) &&
+                  (__atomic_load_n(&indexed[i], __ATOMIC_RELAXED) == mh);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&_seq, __ATOMIC_RELAXED) == seq)
+      return result;
+  }
 }
 
 template <typename A>
 void DwarfFDECache<A>::removeAllIn(pint_t mh) {
-  _LIBUNWIND_LOG_NON_ZERO(::pthread_rwlock_wrlock(&_lock));
+  _LIBUNWIND_LOG_NON_ZERO(::pthread_mutex_lock(&_lock));
+  uint32_t seq = writeBegin();
   entry *d = _buffer;
-  for (const entry *s = _buffer; s < _bufferUsed; ++s) {
+  for (const entry *s = _buffer; s < _buffer + _count; ++s) {
     if (s->mh != mh) {
       if (d != s)
-        *d = *s;
+        store(d, *s);
       ++d;
     }
   }
-  _bufferUsed = d;
-  _LIBUNWIND_LOG_NON_ZERO(::pthread_rwlock_unlock(&_lock));
+  __atomic_store_n(&_count, (size_t)(d - _buffer), __ATOMIC_RELEASE);
+  size_t i = indexedLowerBound(_indexed, _indexedCount, mh);
+  if ((i < _indexedCount) && (_indexed[i] == mh)) {
+    for (; i + 1 < _indexedCount; ++i)
+      __atomic_store_n(&_indexed[i], _indexed[i + 1], __ATOMIC_RELAXED);
+    __atomic_store_n(&_indexedCount, _indexedCount - 1, __ATOMIC_RELEASE);
+  }
+  writeEnd(seq);
+  _LIBUNWIND_LOG_NON_ZERO(::pthread_mutex_unlock(&_lock));
 }
 
 #ifdef __APPLE__
@@ -166,11 +516,11 @@ void DwarfFDECache<A>::dyldUnloadHook(const struct mach_header *mh, intptr_t ) {
 template <typename A>
 void DwarfFDECache<A>::iterateCacheEntries(void (*func)(
     unw_word_t ip_start, unw_word_t ip_end, unw_word_t fde, unw_word_t mh)) {
-  _LIBUNWIND_LOG_NON_ZERO(::pthread_rwlock_wrlock(&_lock));
-  for (entry *p = _buffer; p < _bufferUsed; ++p) {
+  _LIBUNWIND_LOG_NON_ZERO(::pthread_mutex_lock(&_lock));
+  for (entry *p = _buffer; p < _buffer + _count; ++p) {
     (*func)(p->ip_start, p->ip_end, p->fde, p->mh);
   }
-  _LIBUNWIND_LOG_NON_ZERO(::pthread_rwlock_unlock(&_lock));
+  _LIBUNWIND_LOG_NON_ZERO(::pthread_mutex_unlock(&_lock));
 }
 #endif // _LIBUNWIND_SUPPORT_DWARF_UNWIND
 
@@ -836,8 +1186,14 @@ bool UnwindCursor<A, R>::getInfoFromDwarfSection(pint_t pc,
   }
 #endif
   if (!foundFDE) {
-    // otherwise, search cache of previously found FDEs.
+    // otherwise, search cache of previously found FDEs, adding all FDEs of
+    // this DSO to it on first miss.
     pint_t cachedFDE = DwarfFDECache<A>::findFDE(sects.dso_base, pc);
+    if ((cachedFDE == 0) && (fdeSectionOffsetHint == 0) &&
+        DwarfFDECache<A>::addSection(_addressSpace, sects.dso_base,
+                                     sects.dwarf_section,
+                                     (uint32_t)sects.dwarf_section_length))
+      cachedFDE = DwarfFDECache<A>::findFDE(sects.dso_base, pc);
     if (cachedFDE != 0) {
       foundFDE =
           CFI_Parser<A>::findFDE(_addressSpace, pc, sects.dwarf_section,
@@ -846,7 +1202,7 @@ bool UnwindCursor<A, R>::getInfoFromDwarfSection(pint_t pc,
       foundInCache = foundFDE;
     }
   }
-  if (!foundFDE) {
+  if (!foundFDE && !DwarfFDECache<A>::isIndexed(sects.dso_base)) {
     // Still not found, do full scan of __eh_frame section.
     foundFDE = CFI_Parser<A>::findFDE(_addressSpace, pc, sects.dwarf_section,
                                       (uint32_t)sects.dwarf_section_length, 0,
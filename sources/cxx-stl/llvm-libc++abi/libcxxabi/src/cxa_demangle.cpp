@@ -17,6 +17,13 @@
 #include <cstdlib>
 #include <cstring>
 #include <cctype>
+#include <new>
+
+#include "config.h"
+
+#if !LIBCXXABI_HAS_NO_THREADS && !defined(HAS_THREAD_LOCAL)
+#include <pthread.h>
+#endif
 
 namespace __cxxabiv1
 {
@@ -26,7 +33,8 @@ namespace
 
 enum
 {
-    unknown_error = -4,
+    buffer_too_small = -5,
+    unknown_error,
     invalid_args = -3,
     invalid_mangled_name,
     memory_alloc_failure,
@@ -4702,24 +4710,45 @@ demangle(const char* first, const char* last, C& db, int& status)
         status = invalid_mangled_name;
 }
 
+// Bump allocator for the names of one mangled symbol.  It starts in an inline
+// buffer of N bytes and goes on in malloc'd chunks, which reset() keeps for the
+// next symbol, so that an arena which is reused stops calling malloc once it
+// has seen its largest symbol.  Memory is only reclaimed before reset() when it
+// was the last block handed out.
 template <std::size_t N>
 class arena
 {
     static const std::size_t alignment = 16;
+    // reset() gives back the chunks when they grew beyond this
+    static const std::size_t max_retained = 1024 * 1024;
+
+    struct alignas(alignment) chunk
+    {
+        chunk* next;
+        std::size_t size;
+
+        char* data() noexcept {return reinterpret_cast<char*>(this + 1);}
+    };
+
     alignas(alignment) char buf_[N];
     char* ptr_;
+    char* end_;
+    chunk* chunks_;
+    chunk* current_;
+    std::size_t retained_;
 
-    std::size_t 
+    std::size_t
     align_up(std::size_t n) noexcept
         {return n + (alignment-1) & ~(alignment-1);}
 
-    bool
-    pointer_in_buffer(char* p) noexcept
-        {return buf_ <= p && p <= buf_ + N;}
+    char* allocate_chunk(std::size_t n);
+    void release() noexcept;
 
 public:
-    arena() noexcept : ptr_(buf_) {}
-    ~arena() {ptr_ = nullptr;}
+    arena() noexcept
+        : ptr_(buf_), end_(buf_ + N), chunks_(nullptr), current_(nullptr),
+          retained_(0) {}
+    ~arena() {release();}
     arena(const arena&) = delete;
     arena& operator=(const arena&) = delete;
 
@@ -4727,36 +4756,83 @@ public:
     void deallocate(char* p, std::size_t n) noexcept;
 
     static constexpr std::size_t size() {return N;}
-    std::size_t used() const {return static_cast<std::size_t>(ptr_ - buf_);}
-    void reset() {ptr_ = buf_;}
+    void reset() noexcept;
 };
 
 template <std::size_t N>
+inline
 char*
 arena<N>::allocate(std::size_t n)
 {
     n = align_up(n);
-    if (static_cast<std::size_t>(buf_ + N - ptr_) >= n)
+    if (static_cast<std::size_t>(end_ - ptr_) >= n)
     {
         char* r = ptr_;
         ptr_ += n;
         return r;
     }
-    return static_cast<char*>(std::malloc(n));
+    return allocate_chunk(n);
+}
+
+template <std::size_t N>
+char*
+arena<N>::allocate_chunk(std::size_t n)
+{
+    chunk** link = current_ ? &current_->next : &chunks_;
+    chunk* c = *link;
+    if (c == nullptr || c->size < n)
+    {
+        // Each new chunk is at least twice the previous one
+        std::size_t size = current_ ? 2 * current_->size : 2 * N;
+        if (size < n)
+            size = n;
+        chunk* nc = static_cast<chunk*>(std::malloc(sizeof(chunk) + size));
+        if (nc == nullptr)
+            return nullptr;
+        nc->next = c;
+        nc->size = size;
+        *link = nc;
+        retained_ += size;
+        c = nc;
+    }
+    current_ = c;
+    ptr_ = c->data() + n;
+    end_ = c->data() + c->size;
+    return c->data();
 }
 
 template <std::size_t N>
+inline
 void
 arena<N>::deallocate(char* p, std::size_t n) noexcept
 {
-    if (pointer_in_buffer(p))
+    n = align_up(n);
+    if (p + n == ptr_)
+        ptr_ = p;
+}
+
+template <std::size_t N>
+void
+arena<N>::reset() noexcept
+{
+    if (retained_ > max_retained)
+        release();
+    ptr_ = buf_;
+    end_ = buf_ + N;
+    current_ = nullptr;
+}
+
+template <std::size_t N>
+void
+arena<N>::release() noexcept
+{
+    while (chunks_ != nullptr)
     {
-        n = align_up(n);
-        if (p + n == ptr_)
-            ptr_ = p;
+        chunk* next = chunks_->next;
+        std::free(chunks_);
+        chunks_ = next;
     }
-    else
-        std::free(p);
+    retained_ = 0;
 }
 
 template <class T, std::size_t N>
@@ -4809,45 +4885,127 @@ operator!=(const short_alloc<T, N>& x, const short_alloc<U, M>& y) noexcept
     return !(x == y);
 }
 
+const size_t bs = 4 * 1024;
+template <class T> using Alloc = short_alloc<T, bs>;
+template <class T> using Vector = std::vector<T, Alloc<T>>;
+
+// The parser creates strings without saying where from, so the arena of the
+// symbol being demangled is looked up per thread when a string is created.
+
+#if LIBCXXABI_HAS_NO_THREADS
+
+arena<bs>* current_arena_ = nullptr;
+
+inline arena<bs>* get_current_arena() {return current_arena_;}
+inline void set_current_arena(arena<bs>* a) {current_arena_ = a;}
+
+#elif defined(HAS_THREAD_LOCAL)
+
+thread_local arena<bs>* current_arena_ = nullptr;
+
+inline arena<bs>* get_current_arena() {return current_arena_;}
+inline void set_current_arena(arena<bs>* a) {current_arena_ = a;}
+
+#else
+
+pthread_key_t current_arena_key_;
+pthread_once_t current_arena_once_ = PTHREAD_ONCE_INIT;
+bool current_arena_key_valid_ = false;
+
+void
+create_current_arena_key()
+{
+    current_arena_key_valid_ =
+        pthread_key_create(&current_arena_key_, nullptr) == 0;
+}
+
+inline
+arena<bs>*
+get_current_arena()
+{
+    if (!current_arena_key_valid_)
+        return nullptr;
+    return static_cast<arena<bs>*>(pthread_getspecific(current_arena_key_));
+}
+
+inline
+void
+set_current_arena(arena<bs>* a)
+{
+    pthread_once(&current_arena_once_, create_current_arena_key);
+    if (current_arena_key_valid_)
+        pthread_setspecific(current_arena_key_, a);
+}
+
+#endif
+
+// Makes a the current arena, and empties it when the symbol is done.
+class arena_scope
+{
+    arena<bs>& a_;
+    arena<bs>* saved_;
+public:
+    explicit arena_scope(arena<bs>& a) : a_(a), saved_(get_current_arena())
+        {set_current_arena(&a);}
+    ~arena_scope()
+    {
+        set_current_arena(saved_);
+        a_.reset();
+    }
+    arena_scope(const arena_scope&) = delete;
+    arena_scope& operator=(const arena_scope&) = delete;
+};
+
+// Allocates from the current arena, or from malloc when there is none.
 template <class T>
-class malloc_alloc
+class string_alloc
 {
+    arena<bs>* a_;
 public:
     typedef T value_type;
 
-    malloc_alloc() = default;
-    template <class U> malloc_alloc(const malloc_alloc<U>&) noexcept {}
+    string_alloc() noexcept : a_(get_current_arena()) {}
+    template <class U>
+        string_alloc(const string_alloc<U>& a) noexcept : a_(a.a_) {}
 
     T* allocate(std::size_t n)
     {
-        return static_cast<T*>(std::malloc(n*sizeof(T)));
+        if (a_ == nullptr)
+            return static_cast<T*>(std::malloc(n*sizeof(T)));
+        return reinterpret_cast<T*>(a_->allocate(n*sizeof(T)));
     }
-    void deallocate(T* p, std::size_t) noexcept
+    void deallocate(T* p, std::size_t n) noexcept
     {
-        std::free(p);
+        if (a_ == nullptr)
+            std::free(p);
+        else
+            a_->deallocate(reinterpret_cast<char*>(p), n*sizeof(T));
     }
+
+    template <class T1, class U>
+    friend
+    bool
+    operator==(const string_alloc<T1>& x, const string_alloc<U>& y) noexcept;
+
+    template <class U> friend class string_alloc;
 };
 
 template <class T, class U>
 inline
 bool
-operator==(const malloc_alloc<T>&, const malloc_alloc<U>&) noexcept
+operator==(const string_alloc<T>& x, const string_alloc<U>& y) noexcept
 {
-    return true;
+    return x.a_ == y.a_;
 }
 
 template <class T, class U>
 inline
 bool
-operator!=(const malloc_alloc<T>& x, const malloc_alloc<U>& y) noexcept
+operator!=(const string_alloc<T>& x, const string_alloc<U>& y) noexcept
 {
     return !(x == y);
 }
 
-const size_t bs = 4 * 1024;
-template <class T> using Alloc = short_alloc<T, bs>;
-template <class T> using Vector = std::vector<T, Alloc<T>>;
-
 template <class StrT>
 struct string_pair
 {
@@ -4869,7 +5027,7 @@ struct string_pair
 struct Db
 {
     typedef std::basic_string<char, std::char_traits<char>,
-                              malloc_alloc<char>> String;
+                              string_alloc<char>> String;
     typedef Vector<string_pair<String>> sub_type;
     typedef Vector<sub_type> template_param_type;
     sub_type names;
@@ -4891,21 +5049,14 @@ struct Db
     {}
 };
 
-}  // unnamed namespace
-
-extern "C"
-__attribute__ ((__visibility__("default")))
-char*
-__cxa_demangle(const char* mangled_name, char* buf, size_t* n, int* status)
+// Demangles mangled_name with memory from a, and hands the result to output,
+// whose status is returned.  The result's parts are not joined, so that output
+// may copy them straight to where they go.
+template <class Output>
+int
+demangle_symbol(const char* mangled_name, arena<bs>& a, Output output)
 {
-    if (mangled_name == nullptr || (buf != nullptr && n == nullptr))
-    {
-        if (status)
-            *status = invalid_args;
-        return nullptr;
-    }
-    size_t internal_size = buf != nullptr ? *n : 0;
-    arena<bs> a;
+    arena_scope scope(a);
     Db db(a);
     db.cv = 0;
     db.ref = 0;
@@ -4931,35 +5082,117 @@ __cxa_demangle(const char* mangled_name, char* buf, size_t* n, int* status)
             internal_status = invalid_mangled_name;
     }
     if (internal_status == success)
+        internal_status = output(db.names.back());
+    return internal_status;
+}
+
+template <class StrT>
+void
+copy_name(const string_pair<StrT>& name, char* buf)
+{
+    size_t n1 = name.first.size();
+    size_t n2 = name.second.size();
+    std::memcpy(buf, name.first.data(), n1);
+    std::memcpy(buf + n1, name.second.data(), n2);
+    buf[n1 + n2] = char(0);
+}
+
+}  // unnamed namespace
+
+extern "C"
+{
+
+struct __cxa_demangle_context
+{
+    arena<bs> a;
+};
+
+__attribute__ ((__visibility__("default")))
+char*
+__cxa_demangle(const char* mangled_name, char* buf, size_t* n, int* status)
+{
+    if (mangled_name == nullptr || (buf != nullptr && n == nullptr))
     {
-        size_t sz = db.names.back().size() + 1;
-        if (sz > internal_size)
+        if (status)
+            *status = invalid_args;
+        return nullptr;
+    }
+    size_t internal_size = buf != nullptr ? *n : 0;
+    arena<bs> a;
+    int internal_status = demangle_symbol(mangled_name, a,
+        [&](const string_pair<Db::String>& name) -> int
         {
-            char* newbuf = static_cast<char*>(std::realloc(buf, sz));
-            if (newbuf == nullptr)
-            {
-                internal_status = memory_alloc_failure;
-                buf = nullptr;
-            }
-            else
+            size_t sz = name.size() + 1;
+            if (sz > internal_size)
             {
+                char* newbuf = static_cast<char*>(std::realloc(buf, sz));
+                if (newbuf == nullptr)
+                    return memory_alloc_failure;
                 buf = newbuf;
                 if (n != nullptr)
                     *n = sz;
             }
-        }
-        if (buf != nullptr)
-        {
-            db.names.back().first += db.names.back().second;
-            std::memcpy(buf, db.names.back().first.data(), sz-1);
-            buf[sz-1] = char(0);
-        }
-    }
-    else
+            copy_name(name, buf);
+            return success;
+        });
+    if (internal_status != success)
         buf = nullptr;
     if (status)
         *status = internal_status;
     return buf;
 }
 
+__attribute__ ((__visibility__("default")))
+__cxa_demangle_context*
+__cxa_demangle_context_create()
+{
+    void* p = std::malloc(sizeof(__cxa_demangle_context));
+    if (p == nullptr)
+        return nullptr;
+    return new (p) __cxa_demangle_context;
+}
+
+__attribute__ ((__visibility__("default")))
+void
+__cxa_demangle_context_destroy(__cxa_demangle_context* ctx)
+{
+    if (ctx != nullptr)
+    {
+        ctx->~__cxa_demangle_context();
+        std::free(ctx);
+    }
+}
+
+__attribute__ ((__visibility__("default")))
+char*
+__cxa_demangle_with_context(__cxa_demangle_context* ctx,
+                            const char* mangled_name, char* buf, size_t* n,
+                            int* status)
+{
+    if (ctx == nullptr || mangled_name == nullptr || n == nullptr)
+    {
+        if (status)
+            *status = invalid_args;
+        return nullptr;
+    }
+    size_t capacity = buf != nullptr ? *n : 0;
+    int internal_status = demangle_symbol(mangled_name, ctx->a,
+        [&](const string_pair<Db::String>& name) -> int
+        {
+            size_t sz = name.size() + 1;
+            if (sz > capacity)
+            {
+                *n = sz;
+                return buffer_too_small;
+            }
+            copy_name(name, buf);
+            return success;
+        });
+    if (status)
+        *status = internal_status;
+    return internal_status == success ? buf : nullptr;
+}
+
+}  // extern "C"
+
 }  // __cxxabiv1
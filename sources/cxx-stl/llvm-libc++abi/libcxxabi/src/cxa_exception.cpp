@@ -106,16 +106,142 @@ static inline  int decrementHandlerCount(__cxa_exception *exception) {
 
 #include "fallback_malloc.ipp"
 
+/*
+    Exception memory.  Every block starts with a prefix recording its size
+    class, padded so that what follows keeps malloc's alignment.
+
+    Nearly all exceptions, and all dependent ones, fit in blocks of the few
+    smallest size classes.  Such blocks are not returned to malloc when freed,
+    but put on per-thread free lists in __cxa_eh_globals, a few of each size,
+    so that code throwing in a loop doesn't go to the allocator at all.
+    Blocks can be freed on another thread than the one they were allocated on,
+    they are cached there then.
+
+    If malloc fails, blocks are taken from a small pool of fixed-size slots
+    claimed with atomic bit operations, and only then from the fallback heap,
+    which takes a lock.
+*/
+
+namespace {
+
+union block_prefix {
+    size_t sizeClass;
+    void*  align[2];
+};
+
+const size_t kCachedClassSize[kExceptionCacheClasses] = {256, 512, 1024};
+const size_t kUncachedClass = kExceptionCacheClasses;
+const unsigned char kMaxCachedBlocks = 4;
+
+const size_t kEmergencySlots = 16;
+const size_t kEmergencySlotSize = 1024;
+
+union emergency_slot {
+    char data[kEmergencySlotSize];
+    block_prefix align;
+};
+
+emergency_slot emergency_pool[kEmergencySlots];
+uint32_t emergency_map;     // bit N is set if emergency_pool[N] is taken
+
+}  // unnamed namespace
+
+static size_t size_class(size_t size) {
+    size_t sizeClass = 0;
+    while (sizeClass < kUncachedClass && kCachedClassSize[sizeClass] < size)
+        ++sizeClass;
+    return sizeClass;
+}
+
+static bool is_emergency_ptr(void *ptr) {
+    return ptr >= emergency_pool && ptr < emergency_pool + kEmergencySlots;
+}
+
+static void *emergency_malloc(size_t size) {
+    if (size > kEmergencySlotSize)
+        return NULL;
+    uint32_t map = __atomic_load_n(&emergency_map, __ATOMIC_RELAXED);
+    for (;;) {
+        uint32_t free_slots = ~map & ((1u << kEmergencySlots) - 1);
+        if (free_slots == 0)
+            return NULL;
+        uint32_t slot = __builtin_ctz(free_slots);
+        if (__atomic_compare_exchange_n(&emergency_map, &map, map | (1u << slot),
+                                        false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            return &emergency_pool[slot];
+    }
+}
+
+static void emergency_free(void *ptr) {
+    size_t slot = static_cast<size_t>(static_cast<emergency_slot*>(ptr) - emergency_pool);
+    __atomic_fetch_and(&emergency_map, ~(1u << slot), __ATOMIC_RELEASE);
+}
+
+static block_prefix *&next_cached_block(block_prefix *block) {
+    return *reinterpret_cast<block_prefix**>(block + 1);
+}
+
 //  Allocate some memory from _somewhere_
 static void *do_malloc(size_t size) {
-    void *ptr = std::malloc(size);
-    if (NULL == ptr) // if malloc fails, fall back to emergency stash
-        ptr = fallback_malloc(size);
-    return ptr;
+    size_t block_size = size + sizeof(block_prefix);
+    size_t sizeClass = size_class(block_size);
+    block_prefix *block = NULL;
+    if (sizeClass != kUncachedClass) {
+        block_size = kCachedClassSize[sizeClass];
+        __cxa_eh_globals *globals = __cxa_get_globals();
+        if (globals->exceptionCacheCount[sizeClass] != 0) {
+            block = static_cast<block_prefix*>(globals->exceptionCache[sizeClass]);
+            globals->exceptionCache[sizeClass] = next_cached_block(block);
+            --globals->exceptionCacheCount[sizeClass];
+        }
+    }
+    if (NULL == block)
+        block = static_cast<block_prefix*>(std::malloc(block_size));
+    if (NULL == block) // if malloc fails, fall back to emergency stash
+        block = static_cast<block_prefix*>(emergency_malloc(block_size));
+    if (NULL == block)
+        block = static_cast<block_prefix*>(fallback_malloc(block_size));
+    if (NULL == block)
+        return NULL;
+    block->sizeClass = sizeClass;
+    return block + 1;
 }
 
 static void do_free(void *ptr) {
-    is_fallback_ptr(ptr) ? fallback_free(ptr) : std::free(ptr);
+    block_prefix *block = static_cast<block_prefix*>(ptr) - 1;
+    if (is_emergency_ptr(block)) {
+        emergency_free(block);
+        return;
+    }
+    if (is_fallback_ptr(block)) {
+        fallback_free(block);
+        return;
+    }
+    size_t sizeClass = block->sizeClass;
+    if (sizeClass != kUncachedClass) {
+        __cxa_eh_globals *globals = __cxa_get_globals_fast();
+        if (NULL != globals &&
+            globals->exceptionCacheCount[sizeClass] < kMaxCachedBlocks) {
+            next_cached_block(block) =
+                static_cast<block_prefix*>(globals->exceptionCache[sizeClass]);
+            globals->exceptionCache[sizeClass] = block;
+            ++globals->exceptionCacheCount[sizeClass];
+            return;
+        }
+    }
+    std::free(block);
+}
+
+void release_exception_cache(__cxa_eh_globals *globals) {
+    for (size_t sizeClass = 0; sizeClass < kExceptionCacheClasses; ++sizeClass) {
+        while (globals->exceptionCacheCount[sizeClass] != 0) {
+            block_prefix *block =
+                static_cast<block_prefix*>(globals->exceptionCache[sizeClass]);
+            globals->exceptionCache[sizeClass] = next_cached_block(block);
+            --globals->exceptionCacheCount[sizeClass];
+            std::free(block);
+        }
+    }
 }
 
 /*
@@ -101,14 +101,23 @@ struct __cxa_dependent_exception {
     _Unwind_Exception unwindHeader;
 };
 
+static const size_t kExceptionCacheClasses = 3;
+
 struct __cxa_eh_globals {
     __cxa_exception *   caughtExceptions;
     unsigned int        uncaughtExceptions;
 #if LIBCXXABI_ARM_EHABI
     __cxa_exception* propagatingExceptions;
 #endif
+    // Exception memory freed by this thread and kept for reuse, by size
+    //   class, see cxa_exception.cpp
+    void*               exceptionCache[kExceptionCacheClasses];
+    unsigned char       exceptionCacheCount[kExceptionCacheClasses];
 };
 
+// Return memory kept in globals->exceptionCache, on thread exit
+void release_exception_cache(__cxa_eh_globals* globals);
+
 #pragma GCC visibility pop
 #pragma GCC visibility push(default)
 
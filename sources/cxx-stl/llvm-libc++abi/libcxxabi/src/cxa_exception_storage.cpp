@@ -30,9 +30,14 @@ extern "C" {
 namespace __cxxabiv1 {
 
 namespace {
+    struct eh_globals_holder {
+        __cxa_eh_globals globals;
+        ~eh_globals_holder () { release_exception_cache ( &globals ); }
+        };
+
     __cxa_eh_globals * __globals () {
-        static thread_local __cxa_eh_globals eh_globals;
-        return &eh_globals;
+        static thread_local eh_globals_holder eh_globals;
+        return &eh_globals.globals;
         }
     }
 
@@ -58,6 +63,7 @@ namespace {
     pthread_once_t flag_ = PTHREAD_ONCE_INIT;
 
     void destruct_ (void *p) {
+        release_exception_cache ( static_cast<__cxa_eh_globals*> ( p ));
         std::free ( p );
         if ( 0 != ::pthread_setspecific ( key_, NULL ) ) 
             abort_message("cannot zero out thread value for __cxa_get_globals()");
@@ -10,7 +10,17 @@
 #include "abort_message.h"
 #include "config.h"
 
-#if !LIBCXXABI_HAS_NO_THREADS
+#if !LIBCXXABI_HAS_NO_THREADS && defined(__linux__)
+#  define LIBCXXABI_GUARD_USE_FUTEX 1
+#else
+#  define LIBCXXABI_GUARD_USE_FUTEX 0
+#endif
+
+#if LIBCXXABI_GUARD_USE_FUTEX
+#  include <limits.h>
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#elif !LIBCXXABI_HAS_NO_THREADS
 #  include <pthread.h>
 #endif
 #include <stdint.h>
@@ -23,6 +33,14 @@
     pthread_mutex_lock and the abort_message utility without problem.  This
     implementation also uses pthread_cond_wait which has tested to not be a
     problem.
+
+    On Linux there is no global lock at all.  The state lives in the first
+    32-bit word of the guard itself: besides the "initialized" bit (or byte)
+    the compiler tests inline, there is a "pending" bit, set by the thread
+    running the initializer, and a "waiters" bit, set by threads which went to
+    sleep on the guard word with futex.  Only those threads are woken when
+    initialization completes or is aborted, and threads initializing unrelated
+    statics never touch each other's memory.
 */
 
 namespace __cxxabiv1
@@ -50,18 +68,60 @@ inline void set_initialized(guard_type* guard_object) {
 
 typedef uint64_t guard_type;
 
-bool is_initialized(guard_type* guard_object) {
+inline bool is_initialized(guard_type* guard_object) {
     char* initialized = (char*)guard_object;
     return *initialized;
 }
 
-void set_initialized(guard_type* guard_object) {
+inline void set_initialized(guard_type* guard_object) {
     char* initialized = (char*)guard_object;
     *initialized = 1;
 }
 
 #endif
 
+#if LIBCXXABI_GUARD_USE_FUTEX
+
+// The first 32-bit word of the guard, whichever ABI is in use.  Bits are
+// chosen so that the "initialized" one overlaps what the compiler tests:
+// lowest bit on ARM, first byte elsewhere.  The rest of the first byte is
+// left zero, and "pending"/"waiters" live in the second byte.
+typedef uint32_t guard_word;
+
+#if defined(__arm__) || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+const guard_word kInitialized = 1;
+const guard_word kPending = 0x100;
+const guard_word kWaiters = 0x200;
+#else
+const guard_word kInitialized = 1u << 24;
+const guard_word kPending = 1u << 16;
+const guard_word kWaiters = 2u << 16;
+#endif
+
+inline
+guard_word*
+get_word(guard_type* guard_object)
+{
+    return reinterpret_cast<guard_word*>(guard_object);
+}
+
+inline
+void
+futex_wait(guard_word* word, guard_word expected)
+{
+    // Spurious wakeups, EINTR and EAGAIN are all handled by the caller's loop
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, 0, 0, 0);
+}
+
+inline
+void
+futex_wake_all(guard_word* word)
+{
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, INT_MAX, 0, 0, 0);
+}
+
+#else  // !LIBCXXABI_GUARD_USE_FUTEX
+
 #if !LIBCXXABI_HAS_NO_THREADS
 pthread_mutex_t guard_mut = PTHREAD_MUTEX_INITIALIZER;
 pthread_cond_t  guard_cv  = PTHREAD_COND_INITIALIZER;
@@ -161,6 +221,8 @@ set_lock(uint32_t& x, lock_type y)
 
 #endif  // __APPLE__
 
+#endif  // LIBCXXABI_GUARD_USE_FUTEX
+
 }  // unnamed namespace
 
 extern "C"
@@ -183,7 +245,52 @@ void __cxa_guard_abort(guard_type* guard_object)
     *guard_object = 0;
 }
 
-#else // !LIBCXXABI_HAS_NO_THREADS
+#elif LIBCXXABI_GUARD_USE_FUTEX
+
+int __cxa_guard_acquire(guard_type* guard_object)
+{
+    guard_word* word = get_word(guard_object);
+    guard_word state = __atomic_load_n(word, __ATOMIC_ACQUIRE);
+    for (;;)
+    {
+        if (state & kInitialized)
+            return 0;
+        if ((state & kPending) == 0)
+        {
+            // Nobody is running initializer yet: claim it
+            if (__atomic_compare_exchange_n(word, &state, state | kPending,
+                                            false, __ATOMIC_ACQUIRE,
+                                            __ATOMIC_ACQUIRE))
+                return 1;
+            continue;
+        }
+        if ((state & kWaiters) == 0 &&
+            !__atomic_compare_exchange_n(word, &state, state | kWaiters,
+                                         false, __ATOMIC_ACQUIRE,
+                                         __ATOMIC_ACQUIRE))
+            continue;
+        futex_wait(word, state | kWaiters);
+        state = __atomic_load_n(word, __ATOMIC_ACQUIRE);
+    }
+}
+
+void __cxa_guard_release(guard_type* guard_object)
+{
+    guard_word* word = get_word(guard_object);
+    guard_word state = __atomic_exchange_n(word, kInitialized, __ATOMIC_RELEASE);
+    if (state & kWaiters)
+        futex_wake_all(word);
+}
+
+void __cxa_guard_abort(guard_type* guard_object)
+{
+    guard_word* word = get_word(guard_object);
+    guard_word state = __atomic_exchange_n(word, 0, __ATOMIC_RELEASE);
+    if (state & kWaiters)
+        futex_wake_all(word);
+}
+
+#else // !LIBCXXABI_HAS_NO_THREADS && !LIBCXXABI_GUARD_USE_FUTEX
 
 int __cxa_guard_acquire(guard_type* guard_object)
 {
@@ -250,7 +357,7 @@ void __cxa_guard_abort(guard_type* guard_object)
         abort_message("__cxa_guard_abort failed to broadcast condition variable");
 }
 
-#endif // !LIBCXXABI_HAS_NO_THREADS
+#endif // !LIBCXXABI_HAS_NO_THREADS && !LIBCXXABI_GUARD_USE_FUTEX
 
 }  // extern "C"
 
@@ -26,6 +26,18 @@
 #include "Unwind/libunwind_ext.h"
 #endif
 
+// Old Android platforms have no dl_iterate_phdr() on ARM.
+#if LIBCXXABI_ARM_EHABI && defined(__ANDROID__)
+#include <android/api-level.h>
+#endif
+#if !defined(__APPLE__) &&                                                     \
+    (!LIBCXXABI_ARM_EHABI || !defined(__ANDROID__) || __ANDROID_API__ >= 21)
+#define LIBCXXABI_CALL_SITE_CACHE 1
+#include <link.h>
+#else
+#define LIBCXXABI_CALL_SITE_CACHE 0
+#endif
+
 /*
     Exception Header Layout:
 
@@ -518,6 +530,308 @@ set_registers(_Unwind_Exception* unwind_exception, _Unwind_Context* context,
     _Unwind_SetIP(context, results.landingPad);
 }
 
+#ifndef __USING_SJLJ_EXCEPTIONS__
+
+#if LIBCXXABI_CALL_SITE_CACHE
+
+/*
+    Call-site tables are decoded into sorted arrays, so repeated throws through
+    a function find the call site with binary search instead of decoding records
+    one by one (twice per frame: in search and in cleanup phase).  Decoded tables
+    are kept in a fixed-size open-addressed cache keyed by table address.  They
+    are published with CAS and never freed, since another thread could be using
+    them; if the cache is full, or memory is short, the table is scanned as
+    before.  Since code could be unloaded and something else loaded at the same
+    address, each decoded table is stamped with the loader's count of unloaded
+    objects (dlpi_subs), and is used as is only while the count stays the same.
+    Once something is unloaded, the table is decoded again on the next lookup:
+    if the call sites are the same, the cached table just gets the new stamp,
+    otherwise it's replaced, and the one it replaces leaks, so replacements stop
+    once the leaked tables reach kMaxRetiredCallSiteBytes; after that, a table
+    whose slot holds stale data is scanned.  Short tables are always scanned
+    directly, and so are all tables if the loader doesn't count unloads.
+*/
+
+namespace
+{
+
+struct call_site
+{
+    uintptr_t start;
+    uintptr_t end;
+    uintptr_t landingPad;
+    uintptr_t actionEntry;
+};
+
+struct call_site_table
+{
+    const uint8_t* callSiteTableStart;
+    uint32_t       callSiteTableLength;
+    uint8_t        callSiteEncoding;
+    uintptr_t      unloads;  // dlpi_subs the table is known to be current at
+    size_t         count;
+    call_site      sites[1];
+};
+
+const uint32_t kMinCachedCallSiteTableLength = 64;
+const size_t   kCallSiteCacheSize = 1024;  // power of 2
+const size_t   kCallSiteCacheProbes = 8;
+const size_t   kMaxRetiredCallSiteBytes = 1024 * 1024;
+
+call_site_table* call_site_cache[kCallSiteCacheSize];
+// Total size of tables replaced in call_site_cache, which are never freed
+size_t retired_call_site_bytes;
+
+// dl_phdr_info as passed by loaders which count loads and unloads (glibc,
+//   bionic since Android 11); older ones pass only first four fields.
+struct counted_phdr_info
+{
+    ElfW(Addr)        dlpi_addr;
+    const char*       dlpi_name;
+    const ElfW(Phdr)* dlpi_phdr;
+    ElfW(Half)        dlpi_phnum;
+    unsigned long long dlpi_adds;
+    unsigned long long dlpi_subs;
+};
+
+struct loader_unloads
+{
+    bool      counted;
+    uintptr_t subs;
+};
+
+}  // unnamed namespace
+
+/// Called for the first object only: take loader's count of unloaded objects
+static
+int
+loader_unloads_callback(struct dl_phdr_info* pinfo, size_t size, void* data)
+{
+    loader_unloads* unloads = static_cast<loader_unloads*>(data);
+    if (size >= sizeof(counted_phdr_info))
+    {
+        unloads->counted = true;
+        // Truncated to word, so it can be updated atomically on 32-bit targets
+        unloads->subs = static_cast<uintptr_t>(
+            reinterpret_cast<counted_phdr_info*>(pinfo)->dlpi_subs);
+    }
+    return 1;
+}
+
+static
+size_t
+call_site_table_size(size_t count)
+{
+    return sizeof(call_site_table) + (count - 1) * sizeof(call_site);
+}
+
+static
+bool
+same_call_sites(const call_site_table* a, const call_site_table* b)
+{
+    if (a->count != b->count)
+        return false;
+    for (size_t i = 0; i < a->count; ++i)
+    {
+        if (a->sites[i].start != b->sites[i].start ||
+            a->sites[i].end != b->sites[i].end ||
+            a->sites[i].landingPad != b->sites[i].landingPad ||
+            a->sites[i].actionEntry != b->sites[i].actionEntry)
+            return false;
+    }
+    return true;
+}
+
+/// Take size bytes from the budget for leaked tables, return false if too few
+///   are left
+static
+bool
+retire_call_site_bytes(size_t size)
+{
+    if (__atomic_add_fetch(&retired_call_site_bytes, size, __ATOMIC_RELAXED) <=
+        kMaxRetiredCallSiteBytes)
+        return true;
+    __atomic_sub_fetch(&retired_call_site_bytes, size, __ATOMIC_RELAXED);
+    return false;
+}
+
+/// Decode whole call-site table into newly allocated array, or return null
+static
+call_site_table*
+decode_call_site_table(const uint8_t* callSiteTableStart,
+                       uint32_t callSiteTableLength, uint8_t callSiteEncoding,
+                       uintptr_t unloads)
+{
+    const uint8_t* callSiteTableEnd = callSiteTableStart + callSiteTableLength;
+    size_t count = 0;
+    for (const uint8_t* p = callSiteTableStart; p < callSiteTableEnd; ++count)
+    {
+        readEncodedPointer(&p, callSiteEncoding);
+        readEncodedPointer(&p, callSiteEncoding);
+        readEncodedPointer(&p, callSiteEncoding);
+        readULEB128(&p);
+    }
+    if (count == 0)
+        return 0;
+    call_site_table* table = static_cast<call_site_table*>(
+        malloc(call_site_table_size(count)));
+    if (table == 0)
+        return 0;
+    table->callSiteTableStart = callSiteTableStart;
+    table->callSiteTableLength = callSiteTableLength;
+    table->callSiteEncoding = callSiteEncoding;
+    table->unloads = unloads;
+    table->count = count;
+    const uint8_t* p = callSiteTableStart;
+    for (size_t i = 0; i < count; ++i)
+    {
+        call_site& site = table->sites[i];
+        site.start = readEncodedPointer(&p, callSiteEncoding);
+        site.end = site.start + readEncodedPointer(&p, callSiteEncoding);
+        site.landingPad = readEncodedPointer(&p, callSiteEncoding);
+        site.actionEntry = readULEB128(&p);
+        // The call sites are ordered in increasing value of start, so binary
+        //   search is only possible if table is well-formed
+        if (i > 0 && site.start < table->sites[i - 1].end)
+        {
+            free(table);
+            return 0;
+        }
+    }
+    return table;
+}
+
+/// Find decoded table in cache, adding it there if it's not yet.
+/// Return null if table shouldn't or couldn't be cached.
+static
+const call_site_table*
+get_call_site_table(const uint8_t* callSiteTableStart,
+                    uint32_t callSiteTableLength, uint8_t callSiteEncoding)
+{
+    if (callSiteTableLength < kMinCachedCallSiteTableLength)
+        return 0;
+    // Taken before looking at the table: if something gets unloaded meanwhile,
+    //   the table is checked again next time
+    loader_unloads unloads = {false, 0};
+    dl_iterate_phdr(&loader_unloads_callback, &unloads);
+    if (!unloads.counted)
+        return 0;
+    call_site_table* table = 0;
+    size_t hash = (reinterpret_cast<uintptr_t>(callSiteTableStart) >> 2) * 2654435761u;
+    for (size_t probe = 0; probe < kCallSiteCacheProbes; ++probe)
+    {
+        call_site_table** slot =
+            &call_site_cache[(hash + probe) & (kCallSiteCacheSize - 1)];
+        call_site_table* cached = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+        if (cached != 0 && cached->callSiteTableStart != callSiteTableStart)
+            continue;
+        if (cached != 0 &&
+            __atomic_load_n(&cached->unloads, __ATOMIC_RELAXED) == unloads.subs)
+        {
+            free(table);
+            return cached;
+        }
+        if (table == 0)
+        {
+            table = decode_call_site_table(callSiteTableStart,
+                                           callSiteTableLength,
+                                           callSiteEncoding, unloads.subs);
+            if (table == 0)
+                return 0;
+        }
+        // Something was unloaded since cached table was stamped, but not the
+        //   code it was decoded from (or the same code was loaded back)
+        if (cached != 0 && same_call_sites(cached, table))
+        {
+            __atomic_store_n(&cached->unloads, unloads.subs, __ATOMIC_RELAXED);
+            free(table);
+            return cached;
+        }
+        // Either empty slot, or stale table of code loaded at the same address
+        //   before: replace it, but don't free, some reader could be using it
+        size_t retired = 0;
+        if (cached != 0)
+        {
+            retired = call_site_table_size(cached->count);
+            if (!retire_call_site_bytes(retired))
+                break;
+        }
+        if (__atomic_compare_exchange_n(slot, &cached, table, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            return table;
+        if (retired != 0)
+            __atomic_sub_fetch(&retired_call_site_bytes, retired,
+                               __ATOMIC_RELAXED);
+        // Someone else has taken the slot, maybe with the same table
+        if (cached->callSiteTableStart == callSiteTableStart &&
+            same_call_sites(cached, table))
+        {
+            free(table);
+            return cached;
+        }
+    }
+    free(table);
+    return 0;
+}
+
+#endif  // LIBCXXABI_CALL_SITE_CACHE
+
+/// Find call site containing ipOffset
+static
+bool
+find_call_site(const uint8_t* callSiteTableStart, uint32_t callSiteTableLength,
+               uint8_t callSiteEncoding, uintptr_t ipOffset,
+               uintptr_t& landingPad, uintptr_t& actionEntry)
+{
+#if LIBCXXABI_CALL_SITE_CACHE
+    const call_site_table* table = get_call_site_table(callSiteTableStart,
+                                                       callSiteTableLength,
+                                                       callSiteEncoding);
+    if (table != 0)
+    {
+        // Last call site starting at or before ipOffset
+        size_t low = 0;
+        size_t len = table->count;
+        while (len > 0)
+        {
+            size_t half = len / 2;
+            if (table->sites[low + half].start <= ipOffset)
+            {
+                low += half + 1;
+                len -= half + 1;
+            }
+            else
+                len = half;
+        }
+        if (low == 0 || ipOffset >= table->sites[low - 1].end)
+            return false;
+        landingPad = table->sites[low - 1].landingPad;
+        actionEntry = table->sites[low - 1].actionEntry;
+        return true;
+    }
+#endif  // LIBCXXABI_CALL_SITE_CACHE
+
+    const uint8_t* callSitePtr = callSiteTableStart;
+    const uint8_t* callSiteTableEnd = callSiteTableStart + callSiteTableLength;
+    while (callSitePtr < callSiteTableEnd)
+    {
+        // There is one entry per call site.
+        // The call sites are non-overlapping in [start, start+length)
+        // The call sites are ordered in increasing value of start
+        uintptr_t start = readEncodedPointer(&callSitePtr, callSiteEncoding);
+        uintptr_t length = readEncodedPointer(&callSitePtr, callSiteEncoding);
+        landingPad = readEncodedPointer(&callSitePtr, callSiteEncoding);
+        actionEntry = readULEB128(&callSitePtr);
+        if ((start <= ipOffset) && (ipOffset < (start + length)))
+            return true;
+        if (ipOffset < start)
+            return false;
+    }
+    return false;
+}
+
+#endif  // !__USING_SJLJ_EXCEPTIONS__
+
 /*
     There are 3 types of scans needed:
 
@@ -635,19 +949,22 @@ static void scan_eh_tab(scan_results &results, _Unwind_Action actions,
     const uint8_t* callSiteTableStart = lsda;
     const uint8_t* callSiteTableEnd = callSiteTableStart + callSiteTableLength;
     const uint8_t* actionTableStart = callSiteTableEnd;
+#ifndef __USING_SJLJ_EXCEPTIONS__
+    uintptr_t landingPad = 0;
+    uintptr_t actionEntry = 0;
+    if (!find_call_site(callSiteTableStart, callSiteTableLength,
+                        callSiteEncoding, ipOffset, landingPad, actionEntry))
+    {
+        // There is no call site for this ip
+        // Something bad has happened.  We should never get here.
+        // Possible stack corruption.
+        call_terminate(native_exception, unwind_exception);
+    }
+#else  // __USING_SJLJ_EXCEPTIONS__
     const uint8_t* callSitePtr = callSiteTableStart;
     while (callSitePtr < callSiteTableEnd)
     {
         // There is one entry per call site.
-#ifndef __USING_SJLJ_EXCEPTIONS__
-        // The call sites are non-overlapping in [start, start+length)
-        // The call sites are ordered in increasing value of start
-        uintptr_t start = readEncodedPointer(&callSitePtr, callSiteEncoding);
-        uintptr_t length = readEncodedPointer(&callSitePtr, callSiteEncoding);
-        uintptr_t landingPad = readEncodedPointer(&callSitePtr, callSiteEncoding);
-        uintptr_t actionEntry = readULEB128(&callSitePtr);
-        if ((start <= ipOffset) && (ipOffset < (start + length)))
-#else  // __USING_SJLJ_EXCEPTIONS__
         // ip is 1-based index into this table
         uintptr_t landingPad = readULEB128(&callSitePtr);
         uintptr_t actionEntry = readULEB128(&callSitePtr);
@@ -857,16 +1174,9 @@ static void scan_eh_tab(scan_results &results, _Unwind_Action actions,
                 action += actionOffset;
             }  // there is no break out of this loop, only return
         }
-#ifndef __USING_SJLJ_EXCEPTIONS__
-        else if (ipOffset < start)
-        {
-            // There is no call site for this ip
-            // Something bad has happened.  We should never get here.
-            // Possible stack corruption.
-            call_terminate(native_exception, unwind_exception);
-        }
-#endif  // !__USING_SJLJ_EXCEPTIONS__
+#ifdef __USING_SJLJ_EXCEPTIONS__
     }  // there might be some tricky cases which break out of this loop
+#endif  // __USING_SJLJ_EXCEPTIONS__
 
     // It is possible that no eh table entry specify how to handle
     // this exception. By spec, terminate it immediately.
@@ -405,6 +405,113 @@ __pointer_type_info::can_catch(const __shim_type_info* thrown_type,
 
 #pragma clang diagnostic pop
 
+// Cache of __dynamic_cast results.
+//
+// The result of a cast only depends on the layout of the complete object,
+// the place of the source subobject in it, and the source and destination
+// types.  The first two are both identified by the virtual table pointer of
+// the source subobject: it determines the dynamic type, and different
+// subobjects of the same type within an object have different offset-to-top
+// and so different virtual tables.  This holds for construction virtual
+// tables too.  So the cache maps (vtable, static_type, dst_type, hint) to the
+// offset from static_ptr to the result, or to failure.  Ambiguous, private
+// and failed casts are cached as failures the same way as found ones.
+//
+// The cache is direct-mapped, each entry is published with its own sequence
+// counter: writer makes it odd while updating the entry, reader retries if it
+// changed meanwhile.  A writer which finds an entry being updated by another
+// thread just doesn't store its result, so neither side ever blocks.
+
+namespace
+{
+
+struct dynamic_cast_cache_entry
+{
+    unsigned seq;
+    const void* vtable;
+    const __class_type_info* static_type;
+    const __class_type_info* dst_type;
+    std::ptrdiff_t src2dst_offset;
+    std::ptrdiff_t static_to_dst;
+    bool found;
+};
+
+const size_t kDynamicCastCacheSize = 512;  // power of 2
+
+dynamic_cast_cache_entry dynamic_cast_cache[kDynamicCastCacheSize];
+
+inline
+dynamic_cast_cache_entry&
+dynamic_cast_cache_slot(const void* vtable,
+                        const __class_type_info* static_type,
+                        const __class_type_info* dst_type)
+{
+    size_t hash = reinterpret_cast<size_t>(vtable) ^
+                  (reinterpret_cast<size_t>(static_type) >> 3) ^
+                  (reinterpret_cast<size_t>(dst_type) >> 5);
+    hash *= 2654435761u;
+    return dynamic_cast_cache[(hash >> 7) & (kDynamicCastCacheSize - 1)];
+}
+
+// If the cast is in the cache, set dst_ptr to its result and return true
+bool
+dynamic_cast_cache_find(const void* vtable, const void* static_ptr,
+                        const __class_type_info* static_type,
+                        const __class_type_info* dst_type,
+                        std::ptrdiff_t src2dst_offset,
+                        const void*& dst_ptr)
+{
+    dynamic_cast_cache_entry& e =
+        dynamic_cast_cache_slot(vtable, static_type, dst_type);
+    for (;;)
+    {
+        unsigned seq = __atomic_load_n(&e.seq, __ATOMIC_ACQUIRE);
+        if (seq & 1)
+            return false;
+        bool hit = __atomic_load_n(&e.vtable, __ATOMIC_RELAXED) == vtable &&
+                   __atomic_load_n(&e.static_type, __ATOMIC_RELAXED) == static_type &&
+                   __atomic_load_n(&e.dst_type, __ATOMIC_RELAXED) == dst_type &&
+                   __atomic_load_n(&e.src2dst_offset, __ATOMIC_RELAXED) == src2dst_offset;
+        std::ptrdiff_t static_to_dst = __atomic_load_n(&e.static_to_dst, __ATOMIC_RELAXED);
+        bool found = __atomic_load_n(&e.found, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&e.seq, __ATOMIC_RELAXED) != seq)
+            continue;
+        if (!hit)
+            return false;
+        dst_ptr = found ? static_cast<const char*>(static_ptr) + static_to_dst : 0;
+        return true;
+    }
+}
+
+void
+dynamic_cast_cache_store(const void* vtable, const void* static_ptr,
+                         const __class_type_info* static_type,
+                         const __class_type_info* dst_type,
+                         std::ptrdiff_t src2dst_offset,
+                         const void* dst_ptr)
+{
+    dynamic_cast_cache_entry& e =
+        dynamic_cast_cache_slot(vtable, static_type, dst_type);
+    unsigned seq = __atomic_load_n(&e.seq, __ATOMIC_RELAXED);
+    if ((seq & 1) ||
+        !__atomic_compare_exchange_n(&e.seq, &seq, seq + 1, false,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    std::ptrdiff_t static_to_dst = dst_ptr == 0 ? 0 :
+        static_cast<const char*>(dst_ptr) - static_cast<const char*>(static_ptr);
+    __atomic_store_n(&e.vtable, vtable, __ATOMIC_RELAXED);
+    __atomic_store_n(&e.static_type, static_type, __ATOMIC_RELAXED);
+    __atomic_store_n(&e.dst_type, dst_type, __ATOMIC_RELAXED);
+    __atomic_store_n(&e.src2dst_offset, src2dst_offset, __ATOMIC_RELAXED);
+    __atomic_store_n(&e.static_to_dst, static_to_dst, __ATOMIC_RELAXED);
+    __atomic_store_n(&e.found, dst_ptr != 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&e.seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+}  // unnamed namespace
+
 #pragma GCC visibility pop
 #pragma GCC visibility push(default)
 
@@ -505,6 +612,9 @@ __dynamic_cast(const void* static_ptr,
     //    results if a non-null answer is found.  Regardless, this is what will
     //    be returned.
     const void* dst_ptr = 0;
+    if (dynamic_cast_cache_find(vtable, static_ptr, static_type, dst_type,
+                                src2dst_offset, dst_ptr))
+        return const_cast<void*>(dst_ptr);
     // Initialize info struct for this search.
     __dynamic_cast_info info = {dst_type, static_ptr, static_type, src2dst_offset, 0};
 
@@ -575,6 +685,8 @@ __dynamic_cast(const void* static_ptr,
             break;
         }
     }
+    dynamic_cast_cache_store(vtable, static_ptr, static_type, dst_type,
+                             src2dst_offset, dst_ptr);
     return const_cast<void*>(dst_ptr);
 }
 
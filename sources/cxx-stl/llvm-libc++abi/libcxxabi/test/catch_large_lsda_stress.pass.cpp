@@ -0,0 +1,86 @@
+//===-------------------- catch_large_lsda_stress.cpp ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+// Throughput of throw/catch through frames of functions with long call-site
+// tables, thrown from their last call site.
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+const int Depth = 8;
+const int Throws = 20000;
+const int Guards = 256;
+
+struct guard
+{
+    int *dtors;
+    explicit guard(int *d) : dtors(d) {}
+    ~guard() {++*dtors;}
+};
+
+__attribute__((noinline))
+void step(int *counter, int n)
+{
+    if (*counter == n)
+        throw n;
+    ++*counter;
+}
+
+// Every call below has its own set of live guards, so its own landing pad
+// and call-site table entry.
+#define CALL1(n) guard g##n(dtors); step(counter, limit);
+#define CALL4(n) CALL1(n##a) CALL1(n##b) CALL1(n##c) CALL1(n##d)
+#define CALL16(n) CALL4(n##a) CALL4(n##b) CALL4(n##c) CALL4(n##d)
+#define CALL64(n) CALL16(n##a) CALL16(n##b) CALL16(n##c) CALL16(n##d)
+
+void large(int depth, int *counter, int limit, int *dtors);
+
+__attribute__((noinline))
+void next(int depth, int *counter, int limit, int *dtors)
+{
+    if (depth > 0)
+        large(depth - 1, counter, limit, dtors);
+    else
+        step(counter, *counter);
+}
+
+__attribute__((noinline))
+void large(int depth, int *counter, int limit, int *dtors)
+{
+    CALL64(a) CALL64(b) CALL64(c) CALL64(d)
+    *counter = 0;
+    next(depth, counter, limit, dtors);
+}
+
+int main()
+{
+    typedef std::chrono::steady_clock Clock;
+    int dtors = 0;
+    int caught = 0;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < Throws; ++i)
+    {
+        int counter = 0;
+        try
+        {
+            // Never reached by the calls in large(), so they don't throw
+            large(Depth, &counter, -1, &dtors);
+        }
+        catch (int)
+        {
+            ++caught;
+        }
+    }
+    double us = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - start).count();
+    assert(caught == Throws);
+    assert(dtors == Throws * (Depth + 1) * Guards);
+    std::cout << (long)(Throws / (us / 1e6)) << " throws/s" << std::endl;
+}
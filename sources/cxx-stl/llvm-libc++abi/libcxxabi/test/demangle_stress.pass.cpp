@@ -0,0 +1,444 @@
+//===------------------------- demangle_stress.cpp ------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+// Throughput of demangling symbols taken from LLVM, clang and libstdc++ with
+// __cxa_demangle, and with a reused __cxa_demangle_context, whose results
+// must be the same.
+
+#include "cxxabi.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+const char* symbols[] =
+{
+    "_ZN15LiveDebugValues16InstrRefBasedLDV21depthFirstVLocAndEmitEjRKN4llv"
+    "m8DenseMapIPKNS1_12LexicalScopeEPKNS1_10DILocationENS1_12DenseMapInfoI"
+    "S5_vEENS1_6detail12DenseMapPairIS5_S8_EEEERKNS2_IS5_NS1_8SmallSetINS1_"
+    "13DebugVariableELj4ESt4lessISI_EEESA_NSC_IS5_SL_EEEERNS2_IS5_NS1_11Sma"
+    "llPtrSetIPNS1_17MachineBasicBlockELj4EEESA_NSC_IS5_ST_EEEERNS1_11Small"
+    "VectorINSX_ISt4pairISI_NS_8DbgValueEELj8EEELj8EEERSt10unique_ptrIA_S14"
+    "_IA_NS_10ValueIDNumESt14default_deleteIS16_EES17_IS1A_EES1D_RNS1_15Sma"
+    "llVectorImplINS_11VLocTrackerEEERNS1_15MachineFunctionERNS2_ISI_jNS9_I"
+    "SI_vEENSC_ISI_jEEEERKNS1_16TargetPassConfigE",
+    "_ZN4llvm10Attributor13isAssumedDeadERKNS_17AbstractAttributeEPKNS_8AAI"
+    "sDeadERbbNS_10DepClassTyE",
+    "_ZN4llvm10MCStreamer27emitCVInlineSiteIdDirectiveEjjjjjNS_5SMLocE",
+    "_ZN4llvm10make_errorINS_8DWPErrorEJRA71_KcEEENS_5ErrorEDpOT0_",
+    "_ZN4llvm11Instruction12setSuccessorEjPNS_10BasicBlockE",
+    "_ZN4llvm11SlotTracker14CreateGUIDSlotEm",
+    "_ZN4llvm12ConstantExpr7getAShrEPNS_8ConstantES2_b",
+    "_ZN4llvm12MCSchedModel19computeInstrLatencyERKNS_15MCSubtargetInfoERKN"
+    "S_16MCSchedClassDescE",
+    "_ZN4llvm12SCEVExpander19rememberInstructionEPNS_5ValueE",
+    "_ZN4llvm12hash_combineIJjNS_19SelectPatternFlavorEPNS_5ValueES3_EEENS_"
+    "9hash_codeEDpRKT_",
+    "_ZN4llvm13GlobalDCEPass20UpdateGVDependenciesERNS_11GlobalValueE",
+    "_ZN4llvm13PrintLoopPassC2ERNS_11raw_ostreamERKNSt7__cxx1112basic_strin"
+    "gIcSt11char_traitsIcESaIcEEE",
+    "_ZN4llvm14CombinerHelper22matchSextTruncSextLoadERNS_12MachineInstrE",
+    "_ZN4llvm14MCWasmStreamer11emitELFSizeEPNS_8MCSymbolEPKNS_6MCExprE",
+    "_ZN4llvm15AliasSetTracker10addUnknownEPNS_11InstructionE",
+    "_ZN4llvm15InstrProfWriter16addMemProfRecordEmRKNS_7memprof20IndexedMem"
+    "ProfRecordE",
+    "_ZN4llvm15RandomIRBuilder9newSourceERNS_10BasicBlockENS_8ArrayRefIPNS_"
+    "11InstructionEEENS3_IPNS_5ValueEEENS_8fuzzerop10SourcePredE",
+    "_ZN4llvm15SmallVectorImplIN5clang6interp8PrimTypeEEaSEOS4_",
+    "_ZN4llvm15VPlanTransforms27removeRedundantCanonicalIVsERNS_5VPlanE",
+    "_ZN4llvm16IndexedReferenceC2ERNS_11InstructionERKNS_8LoopInfoERNS_15Sc"
+    "alarEvolutionE",
+    "_ZN4llvm16SelectionDAGISel13Select_FREEZEEPNS_6SDNodeE",
+    "_ZN4llvm17DominatorTreeBaseINS_17MachineBasicBlockELb1EE11recalculateE"
+    "RNS_15MachineFunctionE",
+    "_ZN4llvm17ProfileLikelyProbE",
+    "_ZN4llvm18DependenceAnalysis3KeyE",
+    "_ZN4llvm18wholeprogramdevirt21setBeforeReturnValuesENS_15MutableArrayR"
+    "efINS0_17VirtualCallTargetEEEmjRlRm",
+    "_ZN4llvm19SelectionDAGBuilder27visitConstrainedFPIntrinsicERKNS_22Cons"
+    "trainedFPIntrinsicE",
+    "_ZN4llvm20SCEVComparePredicateC1ENS_19FoldingSetNodeIDRefENS_7CmpInst9"
+    "PredicateEPKNS_4SCEVES6_",
+    "_ZN4llvm21StackSafetyGlobalInfoaSEOS0_",
+    "_ZN4llvm22createCFGuardCheckPassEv",
+    "_ZN4llvm23SmallVectorTemplateBaseINS_3mca10WriteStateELb0EE4growEm",
+    "_ZN4llvm24denormalizeForPostIncUseEPKNS_4SCEVERKNS_11SmallPtrSetIPKNS_"
+    "4LoopELj2EEERNS_15ScalarEvolutionE",
+    "_ZN4llvm26LoopVectorizationCostModel12expectedCostENS_12ElementCountEP"
+    "NS_15SmallVectorImplISt4pairIPNS_11InstructionES1_EEE",
+    "_ZN4llvm28ConstantFoldBinaryOpOperandsEjPNS_8ConstantES1_RKNS_10DataLa"
+    "youtE",
+    "_ZN4llvm2cl3optIjLb0ENS0_6parserIjEEE19getExtraOptionNamesERNS_15Small"
+    "VectorImplINS_9StringRefEEE",
+    "_ZN4llvm33IRSimilarityIdentifierWrapperPass11runOnModuleERNS_6ModuleE",
+    "_ZN4llvm3acc23getOpenACCDirectiveNameENS0_9DirectiveE",
+    "_ZN4llvm3lto11thinBackendERKNS0_6ConfigEjSt8functionIFNS_8ExpectedISt1"
+    "0unique_ptrINS_16CachedFileStreamESt14default_deleteIS7_EEEEjEERNS_6Mo"
+    "duleERKNS_18ModuleSummaryIndexERKNS_9StringMapISt13unordered_setImSt4h"
+    "ashImESt8equal_toImESaImEENS_15MallocAllocatorEEERKNS_8DenseMapImPNS_1"
+    "8GlobalValueSummaryENS_12DenseMapInfoImvEENS_6detail12DenseMapPairImSX"
+    "_EEEEPNS_9MapVectorINS_9StringRefENS_13BitcodeModuleENSV_IS17_jNSY_IS1"
+    "7_vEENS11_IS17_jEEEESt6vectorISt4pairIS17_S18_ESaIS1E_EEEERKS1C_IhSaIh"
+    "EE",
+    "_ZN4llvm3orc12rt_bootstrap33ExecutorSharedMemoryMapperService12deiniti"
+    "alizeERKSt6vectorINS0_12ExecutorAddrESaIS4_EE",
+    "_ZN4llvm3orc24ExecutorBootstrapServiceD2Ev",
+    "_ZN4llvm3pdb13NativeSession15findSymbolByRVAEjNS0_11PDB_SymTypeE",
+    "_ZN4llvm3pdb9TpiStreamD2Ev",
+    "_ZN4llvm3vfs18InMemoryFileSystemC2Eb",
+    "_ZN4llvm4xray13RecordPrinter5visitERNS0_13TSCWrapRecordE",
+    "_ZN4llvm4yaml18mapLoadCommandDataINS_5MachO21build_version_commandEEEv"
+    "RNS0_2IOERNS_9MachOYAML11LoadCommandE",
+    "_ZN4llvm4yaml7yamlizeISt6vectorINS_12CodeViewYAML10LeafRecordESaIS4_EE"
+    "NS0_12EmptyContextEEENSt9enable_ifIXsr18has_SequenceTraitsIT_EE5valueE"
+    "vE4typeERNS0_2IOERS9_bRT0_",
+    "_ZN4llvm5cflaa17isGlobalOrArgAttrESt6bitsetILm32EE",
+    "_ZN4llvm6detail9IEEEFloat17convertFromStringENS_9StringRefENS_12Roundi"
+    "ngModeE",
+    "_ZN4llvm6object6BinaryD2Ev",
+    "_ZN4llvm7jitlink13JITLinkerBase10linkPhase2ESt10unique_ptrIS1_St14defa"
+    "ult_deleteIS1_EENS_8ExpectedIS2_INS0_20JITLinkMemoryManager13InFlightA"
+    "llocES3_IS8_EEEE",
+    "_ZN4llvm7objcopy3elf15ELFSectionSizerINS_6object7ELFTypeILNS_7support1"
+    "0endiannessE0ELb0EEEE5visitERNS1_19SectionIndexSectionE",
+    "_ZN4llvm8ADCEPass3runERNS_8FunctionERNS_15AnalysisManagerIS1_JEEE",
+    "_ZN4llvm8LLParser18parseOptionalCallsERSt6vectorISt4pairINS_9ValueInfo"
+    "ENS_10CalleeInfoEESaIS5_EE",
+    "_ZN4llvm8codeview18getTrampolineNamesEv",
+    "_ZN4llvm9AAResults13getModRefInfoEPNS_11InstructionEPKNS_8CallBaseE",
+    "_ZN4llvm9LTOModule15addObjCCategoryEPKNS_14GlobalVariableE",
+    "_ZN4llvm9symbolize14LLVMSymbolizer21getOrCreateObjectPairERKNSt7__cxx1"
+    "112basic_stringIcSt11char_traitsIcESaIcEEES9_",
+    "_ZN5clang10TargetAttr6CreateERNS_10ASTContextEN4llvm9StringRefERKNS_19"
+    "AttributeCommonInfoE",
+    "_ZN5clang11transformer9expansionESt8functionIFN4llvm8ExpectedINS_15Cha"
+    "rSourceRangeEEERKNS_12ast_matchers11MatchFinder11MatchResultEEE",
+    "_ZN5clang12Preprocessor25usingPCHWithPragmaHdrStopEv",
+    "_ZN5clang12ast_matchers7dynamic12VariantValueC2ENS_11ASTNodeKindE",
+    "_ZN5clang12ast_matchers8internal18makeAllOfCompositeINS_17CXXDestructo"
+    "rDeclEEENS1_15BindableMatcherIT_EEN4llvm8ArrayRefIPKNS1_7MatcherIS5_EE"
+    "EE",
+    "_ZN5clang13ASTDeclWriter15VisitRecordDeclEPNS_10RecordDeclE",
+    "_ZN5clang13ASTStmtWriter20VisitFloatingLiteralEPNS_15FloatingLiteralE",
+    "_ZN5clang13ParenListExprC2ENS_14SourceLocationEN4llvm8ArrayRefIPNS_4Ex"
+    "prEEES1_",
+    "_ZN5clang14CalledOnceAttr6CreateERNS_10ASTContextERKNS_19AttributeComm"
+    "onInfoE",
+    "_ZN5clang14TextDiagnosticC1ERN4llvm11raw_ostreamERKNS_11LangOptionsEPN"
+    "S_17DiagnosticOptionsE",
+    "_ZN5clang15ASTNodeImporter23VisitUsingDirectiveDeclEPNS_18UsingDirecti"
+    "veDeclE",
+    "_ZN5clang15OMPIteratorExpr9getHelperEj",
+    "_ZN5clang16OMPClausePrinter21VisitOMPNogroupClauseEPNS_16OMPNogroupCla"
+    "useE",
+    "_ZN5clang17ExternalASTSourceD1Ev",
+    "_ZN5clang18CreateObjCRewriterERKNSt7__cxx1112basic_stringIcSt11char_tr"
+    "aitsIcESaIcEEESt10unique_ptrIN4llvm11raw_ostreamESt14default_deleteISA"
+    "_EERNS_17DiagnosticsEngineERKNS_11LangOptionsEb",
+    "_ZN5clang19PrecompiledPreamble10PCHStorageC1ENS0_16InMemoryPreambleE",
+    "_ZN5clang19RecursiveASTVisitorINS_16ParentMapContext9ParentMap10ASTVis"
+    "itorEE31TraverseOMPGenericLoopDirectiveEPNS_23OMPGenericLoopDirectiveE"
+    "PN4llvm15SmallVectorImplINS7_14PointerIntPairIPNS_4StmtELj1EbNS7_21Poi"
+    "nterLikeTypeTraitsISB_EENS7_18PointerIntPairInfoISB_Lj1ESD_EEEEEE",
+    "_ZN5clang20FunctionTemplateDecl17addSpecializationEPNS_34FunctionTempl"
+    "ateSpecializationInfoEPv",
+    "_ZN5clang21ObjCForCollectionStmtC1EPNS_4StmtEPNS_4ExprES2_NS_14SourceL"
+    "ocationES5_",
+    "_ZN5clang23TemplateParamObjectDecl6CreateERKNS_10ASTContextENS_8QualTy"
+    "peERKNS_7APValueE",
+    "_ZN5clang26BPFPreserveAccessIndexAttr6CreateERNS_10ASTContextENS_11Sou"
+    "rceRangeENS_19AttributeCommonInfo6SyntaxE",
+    "_ZN5clang30OpenCLConstantAddressSpaceAttr6CreateERNS_10ASTContextERKNS"
+    "_19AttributeCommonInfoE",
+    "_ZN5clang4Sema16CheckArrayAccessEPKNS_4ExprES3_PKNS_18ArraySubscriptEx"
+    "prEbb",
+    "_ZN5clang4Sema20isDeductionGuideNameEPNS_5ScopeERKNS_14IdentifierInfoE"
+    "NS_14SourceLocationEPNS_9OpaquePtrINS_12TemplateNameEEE",
+    "_ZN5clang4Sema24ActOnOpenMPPartialClauseEPNS_4ExprENS_14SourceLocation"
+    "ES3_S3_",
+    "_ZN5clang4Sema28ActOnOpenMPLastprivateClauseEN4llvm8ArrayRefIPNS_4Expr"
+    "EEENS_25OpenMPLastprivateModifierENS_14SourceLocationES7_S7_S7_S7_",
+    "_ZN5clang4Sema34RefersToMemberWithReducedAlignmentEPNS_4ExprEN4llvm12f"
+    "unction_refIFvS2_PNS_10RecordDeclEPNS_9FieldDeclENS_9CharUnitsEEEE",
+    "_ZN5clang4ento10categories7UnixAPIE",
+    "_ZN5clang4ento18retaincountchecker13RefLeakReport19findBindingToReport"
+    "ERNS0_14CheckerContextEPNS0_12ExplodedNodeE",
+    "_ZN5clang4ento32FalsePositiveRefutationBRVisitor9VisitNodeEPKNS0_12Exp"
+    "lodedNodeERNS0_18BugReporterContextERNS0_22PathSensitiveBugReportE",
+    "_ZN5clang5arcmt11CheckAction15BeginInvocationERNS_16CompilerInstanceE",
+    "_ZN5clang6Parser22ParseBracketDeclaratorERNS_10DeclaratorE",
+    "_ZN5clang6driver22LinkerWrapperJobAction6anchorEv",
+    "_ZN5clang6format19UnwrappedLineParser32parseCSharpGenericTypeConstrain"
+    "tEv",
+    "_ZN5clang6interp11EvalEmitter19emitAddOffsetSint64ERKNS0_10SourceInfoE",
+    "_ZN5clang6interp15ByteCodeEmitter13emitExpandPtrERKNS0_10SourceInfoE",
+    "_ZN5clang6interp15ByteCodeExprGenINS0_11EvalEmitterEE13allocateLocalEO"
+    "N4llvm12PointerUnionIJPKNS_4DeclEPKNS_4ExprEEEEb",
+    "_ZN5clang7APValue9UnionDataD1Ev",
+    "_ZN5clang7CodeGen13CodeGenModule21EmitCXXGlobalInitFuncEv",
+    "_ZN5clang7CodeGen15CodeGenFunction14EmitIvarOffsetEPKNS_17ObjCInterfac"
+    "eDeclEPKNS_12ObjCIvarDeclE",
+    "_ZN5clang7CodeGen15CodeGenFunction23isInstrumentedConditionEPKNS_4Expr"
+    "E",
+    "_ZN5clang7CodeGen20CreateGNUObjCRuntimeERNS0_13CodeGenModuleE",
+    "_ZN5clang7tooling22StandaloneToolExecutor7executeEN4llvm8ArrayRefISt4p"
+    "airISt10unique_ptrINS0_21FrontendActionFactoryESt14default_deleteIS6_E"
+    "ESt8functionIFSt6vectorINSt7__cxx1112basic_stringIcSt11char_traitsIcES"
+    "aIcEEESaISH_EERKSJ_NS2_9StringRefEEEEEE",
+    "_ZN5clang8cross_tu27CrossTranslationUnitContext14ASTUnitStorageC1ERNS_"
+    "16CompilerInstanceE",
+    "_ZN5clang9MSABIAttr14CreateImplicitERNS_10ASTContextERKNS_19AttributeC"
+    "ommonInfoE",
+    "_ZN5polly13ScopAnnotator16buildAliasScopesERNS_4ScopE",
+    "_ZN5polly14BlockGeneratorC1ERN4llvm9IRBuilderINS1_14ConstantFolderENS_"
+    "10IRInserterEEERNS1_8LoopInfoERNS1_15ScalarEvolutionERNS1_13DominatorT"
+    "reeERNS1_8DenseMapIPKNS_13ScopArrayInfoENS1_11AssertingVHINS1_10Alloca"
+    "InstEEENS1_12DenseMapInfoISG_vEENS1_6detail12DenseMapPairISG_SJ_EEEERN"
+    "S1_9MapVectorIPNS1_11InstructionESt4pairINSH_INS1_5ValueEEENS1_11Small"
+    "VectorIST_Lj4EEEENSD_IST_jNSK_IST_vEENSN_IST_jEEEESt6vectorISU_IST_SZ_"
+    "ESaIS14_EEEERNSD_ISW_SW_NSK_ISW_vEENSN_ISW_SW_EEEEPNS_14IslExprBuilder"
+    "EPNS1_10BasicBlockE",
+    "_ZN5polly14BlockGeneratorC2ERN4llvm9IRBuilderINS1_14ConstantFolderENS_"
+    "10IRInserterEEERNS1_8LoopInfoERNS1_15ScalarEvolutionERNS1_13DominatorT"
+    "reeERNS1_8DenseMapIPKNS_13ScopArrayInfoENS1_11AssertingVHINS1_10Alloca"
+    "InstEEENS1_12DenseMapInfoISG_vEENS1_6detail12DenseMapPairISG_SJ_EEEERN"
+    "S1_9MapVectorIPNS1_11InstructionESt4pairINSH_INS1_5ValueEEENS1_11Small"
+    "VectorIST_Lj4EEEENSD_IST_jNSK_IST_vEENSN_IST_jEEEESt6vectorISU_IST_SZ_"
+    "ESaIS14_EEEERNSD_ISW_SW_NSK_ISW_vEENSN_ISW_SW_EEEEPNS_14IslExprBuilder"
+    "EPNS1_10BasicBlockE",
+    "_ZN5polly25createCodePreparationPassEv",
+    "_ZNK4llvm10DwarfDebug15getDwarfVersionEv",
+    "_ZNK4llvm12APFixedPoint8toStringERNS_15SmallVectorImplIcEE",
+    "_ZNK4llvm13CoalescerPair13isCoalescableEPKNS_12MachineInstrE",
+    "_ZNK4llvm14IndirectBrInst9cloneImplEv",
+    "_ZNK4llvm15MachineFunction7viewCFGEv",
+    "_ZNK4llvm17DominatorTreeBaseINS_17MachineBasicBlockELb0EE7compareERKS2"
+    "_",
+    "_ZNK4llvm19MachineConstantPool5printERNS_11raw_ostreamE",
+    "_ZNK4llvm21VPScalarIVStepsRecipe14getCanonicalIVEv",
+    "_ZNK4llvm3DIE5printERNS_11raw_ostreamEj",
+    "_ZNK4llvm3pdb15NativeRawSymbol17getSourceFileNameB5cxx11Ev",
+    "_ZNK4llvm3pdb9TpiStream17getNumTypeRecordsEv",
+    "_ZNK4llvm6Module17getProfileSummaryEb",
+    "_ZNK4llvm6object14COFFObjectFile13getSymbolNameEPKNS0_19coff_symbol_ge"
+    "nericE",
+    "_ZNK4llvm6object18XCOFFSectionHeaderINS0_20XCOFFSectionHeader64EE21isR"
+    "eservedSectionTypeEv",
+    "_ZNK4llvm7GVNPass16isLoadPREEnabledEv",
+    "_ZNK4llvm8LoopBaseINS_17MachineBasicBlockENS_11MachineLoopEE6rbeginEv",
+    "_ZNK5clang10ASTContext21getIntTypeForBitwidthEjj",
+    "_ZNK5clang11StdCallAttr11printPrettyERN4llvm11raw_ostreamERKNS_14Print"
+    "ingPolicyE",
+    "_ZNK5clang12ast_matchers8internal31matcher_argumentCountIs0MatcherINS_"
+    "8CallExprEjE7matchesERKS3_PNS1_14ASTMatchFinderEPNS1_21BoundNodesTreeB"
+    "uilderE",
+    "_ZNK5clang14DestructorAttr11printPrettyERN4llvm11raw_ostreamERKNS_14Pr"
+    "intingPolicyE",
+    "_ZNK5clang17FunctionProtoType25hasDependentExceptionSpecEv",
+    "_ZNK5clang21EnumExtensibilityAttr11printPrettyERN4llvm11raw_ostreamERK"
+    "NS_14PrintingPolicyE",
+    "_ZNK5clang4Decl11isOutOfLineEv",
+    "_ZNK5clang4ento14ObjCMethodCall14getSourceRangeEv",
+    "_ZNK5clang6driver6Driver21GetTemporaryDirectoryB5cxx11EN4llvm9StringRe"
+    "fE",
+    "_ZNK5clang7ForStmt20getConditionVariableEv",
+    "_ZNK5polly12MemoryAccess5printERN4llvm11raw_ostreamE",
+    "_ZNKSt10filesystem7__cxx1116filesystem_error4whatEv",
+    "_ZNKSt7__cxx1112basic_stringIcSt11char_traitsIcESaIcEE4rendEv",
+    "_ZNKSt8_Rb_treeISt4pairIjbES1_St9_IdentityIS1_ESt4lessIS1_ESaIS1_EE5co"
+    "untERKS1_",
+    "_ZNSo9_M_insertIeEERSoT_",
+    "_ZNSt10filesystem4pathdVERKS0_",
+    "_ZNSt13basic_filebufIcSt11char_traitsIcEED0Ev",
+    "_ZNSt14numeric_limitsIDuE6digitsE",
+    "_ZNSt14numeric_limitsIyE11round_styleE",
+    "_ZNSt19__codecvt_utf8_baseIDsED2Ev",
+    "_ZNSt6chrono3_V212steady_clock3nowEv",
+    "_ZNSt6vectorIN4llvm7IRDataTINS0_6DCDataEEESaIS3_EE17_M_realloc_insertI"
+    "JEEEvN9__gnu_cxx17__normal_iteratorIPS3_S5_EEDpOT_",
+    "_ZNSt6vectorISt10unique_ptrIN4llvm6detail11PassConceptINS1_8LoopNestEN"
+    "S1_15AnalysisManagerINS1_4LoopEJRNS1_27LoopStandardAnalysisResultsEEEE"
+    "JS8_RNS1_10LPMUpdaterEEEESt14default_deleteISC_EESaISF_EE17_M_realloc_"
+    "insertIJSF_EEEvN9__gnu_cxx17__normal_iteratorIPSF_SH_EEDpOT_",
+    "_ZNSt7__cxx1112basic_stringIcSt11char_traitsIcESaIcEE7replaceEN9__gnu_"
+    "cxx17__normal_iteratorIPcS4_EES8_mc",
+    "_ZNSt7__cxx1118basic_stringstreamIcSt11char_traitsIcESaIcEEC2ESt13_Ios"
+    "_OpenmodeRKS3_",
+    "_ZNSt8_Rb_treeIN4llvm8DWARFDieES1_St9_IdentityIS1_ESt4lessIS1_ESaIS1_E"
+    "E16_M_insert_uniqueIRKS1_EESt4pairISt17_Rb_tree_iteratorIS1_EbEOT_",
+    "_ZNSt8_Rb_treeIPN5clang13CXXRecordDeclESt4pairIKS2_PNS0_9NamedDeclEESt"
+    "10_Select1stIS7_ESt4lessIS2_ESaIS7_EE29_M_get_insert_hint_unique_posES"
+    "t23_Rb_tree_const_iteratorIS7_ERS4_",
+    "_ZNSt8ios_base3begE",
+    "_ZSt13__adjust_heapIN9__gnu_cxx17__normal_iteratorIPSt4pairIN4llvm9Slo"
+    "tIndexEPNS3_12MachineInstrEESt6vectorIS7_SaIS7_EEEElS7_NS0_5__ops15_It"
+    "er_less_iterEEvT_T0_SG_T1_T2_",
+    "_ZSt21__inplace_stable_sortIN9__gnu_cxx17__normal_iteratorIPSt4pairIjj"
+    "ESt6vectorIS3_SaIS3_EEEENS0_5__ops15_Iter_less_iterEEvT_SB_T0_",
+    "_ZSt9__find_ifIPN4llvm9StringRefEN9__gnu_cxx5__ops16_Iter_equals_valIK"
+    "NS0_21KnownAssumptionStringEEEET_S9_S9_T0_St26random_access_iterator_t"
+    "ag",
+    "_ZTIN4llvm12CodeViewYAML6detail14LeafRecordImplINS_8codeview19UdtSourc"
+    "eLineRecordEEE",
+    "_ZTIN4llvm16RegisterBankInfoE",
+    "_ZTIN4llvm25trailing_objects_internal19TrailingObjectsImplILi8EN5clang"
+    "12CapturedDeclENS_15TrailingObjectsIS3_JPNS2_17ImplicitParamDeclEEEES3"
+    "_JS6_EEE",
+    "_ZTIN4llvm2cl3optINS_31RegAllocEvictionAdvisorAnalysis11AdvisorModeELb"
+    "0ENS0_6parserIS3_EEEE",
+    "_ZTIN4llvm3pdb23PDBSymbolUsingNamespaceE",
+    "_ZTIN4llvm6detail9PassModelINS_6ModuleENS_22InvalidateAnalysisPassINS_"
+    "20IRSimilarityAnalysisEEENS_17PreservedAnalysesENS_15AnalysisManagerIS"
+    "2_JEEEJEEE",
+    "_ZTIN4llvm7objcopy3elf21IHexSectionWriterBaseE",
+    "_ZTIN5clang12ast_matchers8internal14ForEachMatcherINS_8QualTypeENS_4St"
+    "mtEEE",
+    "_ZTIN5clang12ast_matchers8internal24ForEachDescendantMatcherINS_4AttrE"
+    "NS_18CXXCtorInitializerEEE",
+    "_ZTIN5clang13DeclFilterCCCINS_17ObjCInterfaceDeclEEE",
+    "_ZTIN5clang4ento5check18ConstPointerEscapeE",
+    "_ZTINSt7__cxx1117moneypunct_bynameIwLb1EEE",
+    "_ZTIZNK4llvm12GenericCycleINS_17GenericSSAContextINS_8FunctionEEEE5pri"
+    "ntERKS3_EUlRNS_11raw_ostreamEE_",
+    "_ZTSN4llvm13format_objectIJPKcS2_jEEE",
+    "_ZTSN4llvm19InLineChangePrinterE",
+    "_ZTSN4llvm2cl12basic_parserIdEE",
+    "_ZTSN4llvm3opt14DerivedArgListE",
+    "_ZTSN4llvm6detail19AnalysisResultModelINS_8FunctionENS_17MemorySSAAnal"
+    "ysisENS3_6ResultENS_17PreservedAnalysesENS_15AnalysisManagerIS2_JEE11I"
+    "nvalidatorELb1EEE",
+    "_ZTSN4llvm6detail9PassModelINS_8FunctionENS_22InvalidateAnalysisPassIN"
+    "S_25PostDominatorTreeAnalysisEEENS_17PreservedAnalysesENS_15AnalysisMa"
+    "nagerIS2_JEEEJEEE",
+    "_ZTSN4llvm9VPLiveOutE",
+    "_ZTSN5clang12ast_matchers8internal18ValueEqualsMatcherINS_14IntegerLit"
+    "eralEbEE",
+    "_ZTSN5clang12ast_matchers8internal30matcher_hasDeclContext0MatcherE",
+    "_ZTSN5clang24VerifyDiagnosticConsumerE",
+    "_ZTSN5clang6driver19PrecompileJobActionE",
+    "_ZTSSt23_Sp_counted_ptr_inplaceIN4llvm12CodeViewYAML6detail14LeafRecor"
+    "dImplINS0_8codeview11ClassRecordEEESaIvELN9__gnu_cxx12_Lock_policyE2EE",
+    "_ZTVN4llvm12CodeViewYAML6detail16SymbolRecordImplINS_8codeview11Compil"
+    "e3SymEEE",
+    "_ZTVN4llvm17AsmPrinterHandlerE",
+    "_ZTVN4llvm2cl12basic_parserIyEE",
+    "_ZTVN4llvm3orc31DynamicThreadPoolTaskDispatcherE",
+    "_ZTVN4llvm6detail9PassModelINS_13LazyCallGraph3SCCENS_11InlinerPassENS"
+    "_17PreservedAnalysesENS_15AnalysisManagerIS3_JRS2_EEEJS7_RNS_17CGSCCUp"
+    "dateResultEEEE",
+    "_ZTVN4llvm6object12IRObjectFileE",
+    "_ZTVN5clang12ast_matchers8internal14ForEachMatcherINS_4StmtENS_4DeclEE"
+    "E",
+    "_ZTVN5clang12ast_matchers8internal26matcher_isConstinitMatcherE",
+    "_ZTVN5clang20FunctionTemplateDeclE",
+    "_ZTVN5clang8dataflow12PointerValueE",
+    "_ZTVSt7codecvtIcc11__mbstate_tE",
+    // Not mangled names
+    "_Z",
+    "_ZN3foo",
+    "main",
+};
+
+const int NSymbols = sizeof(symbols) / sizeof(symbols[0]);
+const int Rounds = 200;
+
+void test_context()
+{
+    __cxxabiv1::__cxa_demangle_context* ctx =
+        __cxxabiv1::__cxa_demangle_context_create();
+    assert(ctx != 0);
+    for (int i = 0; i < NSymbols; ++i)
+    {
+        int expected_status;
+        char* expected = __cxxabiv1::__cxa_demangle(symbols[i], 0, 0,
+                                                     &expected_status);
+        // Ask for the size first
+        int status;
+        size_t n = 0;
+        char* r = __cxxabiv1::__cxa_demangle_with_context(ctx, symbols[i], 0,
+                                                           &n, &status);
+        assert(r == 0);
+        if (expected_status != 0)
+        {
+            assert(status == expected_status);
+            assert(n == 0);
+            continue;
+        }
+        assert(status == -5);
+        assert(n == std::strlen(expected) + 1);
+        char buf[4096];
+        std::memset(buf, 'x', sizeof(buf));
+        n = sizeof(buf);
+        r = __cxxabiv1::__cxa_demangle_with_context(ctx, symbols[i], buf, &n,
+                                                     &status);
+        assert(r == buf);
+        assert(status == 0);
+        assert(n == sizeof(buf));
+        assert(std::strcmp(buf, expected) == 0);
+        std::free(expected);
+    }
+    int status;
+    size_t n = 0;
+    assert(__cxxabiv1::__cxa_demangle_with_context(0, "_Z1fv", 0, &n,
+                                                   &status) == 0);
+    assert(status == -3);
+    assert(__cxxabiv1::__cxa_demangle_with_context(ctx, "_Z1fv", 0, 0,
+                                                   &status) == 0);
+    assert(status == -3);
+    __cxxabiv1::__cxa_demangle_context_destroy(ctx);
+}
+
+template <class Demangle>
+void test_speed(const char* name, Demangle demangle)
+{
+    typedef std::chrono::steady_clock Clock;
+    size_t chars = 0;
+    Clock::time_point start = Clock::now();
+    for (int r = 0; r < Rounds; ++r)
+        for (int i = 0; i < NSymbols; ++i)
+            chars += demangle(symbols[i]);
+    double us = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - start).count();
+    assert(chars != 0);
+    std::cout << name << ": " << (long)(NSymbols * Rounds / (us / 1e6))
+              << " symbols/s" << std::endl;
+}
+
+int main()
+{
+    test_context();
+
+    char* buf = 0;
+    size_t n = 0;
+    test_speed("__cxa_demangle", [&](const char* symbol) -> size_t
+    {
+        int status;
+        char* r = __cxxabiv1::__cxa_demangle(symbol, buf, &n, &status);
+        if (r == 0)
+            return 0;
+        buf = r;
+        return std::strlen(r);
+    });
+    std::free(buf);
+
+    __cxxabiv1::__cxa_demangle_context* ctx =
+        __cxxabiv1::__cxa_demangle_context_create();
+    static char out[4096];
+    test_speed("__cxa_demangle_with_context", [&](const char* symbol) -> size_t
+    {
+        int status;
+        size_t size = sizeof(out);
+        char* r = __cxxabiv1::__cxa_demangle_with_context(ctx, symbol, out,
+                                                          &size, &status);
+        return r != 0 ? std::strlen(r) : 0;
+    });
+    __cxxabiv1::__cxa_demangle_context_destroy(ctx);
+}
@@ -0,0 +1,170 @@
+//===----------------------- dynamic_cast_cache.cpp -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+// Repeated dynamic_casts must give the same answers as the first ones, which
+// are computed by walking the hierarchy, and should be faster.  Prints time
+// of down-casts, cross-casts and failed casts over a diamond hierarchy.
+
+#include <assert.h>
+#include <stdio.h>
+#include <time.h>
+
+// Component system: entities made of components sharing a virtual base
+namespace components
+{
+
+struct Object {virtual ~Object() {}};
+struct Transform : virtual Object {int x;};
+struct Render : virtual Object {int y;};
+struct Physics : virtual Object {int z;};
+struct Script : virtual Object {int w;};
+struct Entity : Transform, Render, Physics, Script {int id;};
+struct Other : virtual Object {};
+
+}
+
+// Same static type at two places of an object
+namespace repeated
+{
+
+struct A {virtual ~A() {}};
+struct B1 : A {int b1;};
+struct B2 : A {int b2;};
+struct D : B1, B2 {int d;};
+
+}
+
+// Ambiguous destination type
+namespace ambiguous
+{
+
+struct E {virtual ~E() {}};
+struct F1 : E {};
+struct F2 : E {};
+struct H {virtual ~H() {}};
+struct G : F1, F2, H {};
+
+}
+
+// Non-public base
+namespace hidden
+{
+
+struct P {virtual ~P() {}};
+struct Q : private P
+{
+    P* base() {return this;}
+};
+struct R {virtual ~R() {}};
+struct S : R, private P
+{
+    P* base() {return this;}
+};
+
+}
+
+template <class To, class From>
+To* cast_twice(From* from)
+{
+    To* first = dynamic_cast<To*>(from);
+    To* second = dynamic_cast<To*>(from);
+    assert(first == second);
+    return first;
+}
+
+void test_correctness()
+{
+    using namespace components;
+    Entity entity;
+    Object* object = static_cast<Transform*>(&entity);
+    assert(cast_twice<Entity>(object) == &entity);
+    assert(cast_twice<Render>(static_cast<Transform*>(&entity)) ==
+           static_cast<Render*>(&entity));
+    assert(cast_twice<Script>(static_cast<Physics*>(&entity)) ==
+           static_cast<Script*>(&entity));
+    assert(cast_twice<Other>(object) == 0);
+
+    // Different objects of the same type must reuse the offset, not the pointer
+    Entity another;
+    assert(cast_twice<Render>(static_cast<Transform*>(&another)) ==
+           static_cast<Render*>(&another));
+
+    // Partial object of another dynamic type
+    Transform transform;
+    assert(cast_twice<Entity>(static_cast<Object*>(&transform)) == 0);
+    assert(cast_twice<Transform>(static_cast<Object*>(&transform)) == &transform);
+
+    repeated::D d;
+    repeated::A* a1 = static_cast<repeated::B1*>(&d);
+    repeated::A* a2 = static_cast<repeated::B2*>(&d);
+    assert(cast_twice<repeated::D>(a1) == &d);
+    assert(cast_twice<repeated::D>(a2) == &d);
+    // Runtimes disagree on crossing from a repeated base, only check that
+    //   the answer doesn't change
+    cast_twice<repeated::B2>(a1);
+    cast_twice<repeated::B1>(a2);
+    assert(cast_twice<repeated::B1>(a1) == static_cast<repeated::B1*>(&d));
+
+    ambiguous::G g;
+    assert(cast_twice<ambiguous::E>(static_cast<ambiguous::H*>(&g)) == 0);
+    assert(cast_twice<ambiguous::G>(static_cast<ambiguous::H*>(&g)) == &g);
+
+    hidden::Q q;
+    assert(cast_twice<hidden::Q>(q.base()) == 0);
+    hidden::S s;
+    assert(cast_twice<hidden::S>(static_cast<hidden::R*>(&s)) == &s);
+    assert(cast_twice<hidden::S>(s.base()) == 0);
+    assert(cast_twice<hidden::R>(s.base()) == 0);
+}
+
+const int Casts = 1000000;
+
+double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+template <class To, class From>
+void bench(const char* name, From* const* from, int n, bool expect)
+{
+    double start = now();
+    int found = 0;
+    for (int i = 0; i < Casts; ++i)
+        if (dynamic_cast<To*>(from[i % n]) != 0)
+            ++found;
+    double elapsed = now() - start;
+    assert(found == (expect ? Casts : 0));
+    printf("%s: %.1f ns/cast\n", name, elapsed * 1e9 / Casts);
+}
+
+void test_speed()
+{
+    using namespace components;
+    const int N = 16;
+    static Entity entities[N];
+    Object* objects[N];
+    Transform* transforms[N];
+    for (int i = 0; i < N; ++i)
+    {
+        objects[i] = static_cast<Transform*>(&entities[i]);
+        transforms[i] = &entities[i];
+    }
+    bench<Entity>("down-cast", objects, N, true);
+    bench<Physics>("cross-cast", transforms, N, true);
+    bench<Other>("failed cast", objects, N, false);
+}
+
+int main()
+{
+    test_correctness();
+    test_speed();
+    return 0;
+}
@@ -0,0 +1,138 @@
+//===--------------------- exception_alloc_stress.cpp ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+// Throughput of exception object allocation, alone and as part of throw/catch,
+// on 1..64 threads at once.  Also checks that recycled memory comes back
+// zero-filled, and that it could be freed on a thread other than the one it
+// was allocated on.
+
+#include "../src/config.h"
+#include "cxxabi.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#if !LIBCXXABI_HAS_NO_THREADS
+#include <thread>
+#endif
+
+const int Throws = 2000;
+const int Allocs = 20000;
+const size_t Sizes[] = {8, 100, 300, 700, 4000};
+const int NSizes = sizeof(Sizes) / sizeof(Sizes[0]);
+
+struct error
+{
+    char what[64];
+    explicit error(int n) {std::memset(what, n, sizeof(what));}
+};
+
+__attribute__((noinline))
+void thrower(int n)
+{
+    throw error(n);
+}
+
+void check_zero(void* p, size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+        assert(static_cast<char*>(p)[i] == 0);
+}
+
+void throw_worker(int* caught)
+{
+    for (int i = 0; i < Throws; ++i)
+    {
+        try
+        {
+            thrower(i);
+        }
+        catch (const error& e)
+        {
+            assert(e.what[0] == static_cast<char>(i));
+            ++*caught;
+        }
+    }
+}
+
+void alloc_worker(int* caught)
+{
+    void* p[NSizes];
+    for (int i = 0; i < Allocs; ++i)
+    {
+        for (int k = 0; k < NSizes; ++k)
+        {
+            p[k] = __cxxabiv1::__cxa_allocate_exception(Sizes[k]);
+            if (i % 1000 == 0)
+                check_zero(p[k], Sizes[k]);
+            static_cast<char*>(p[k])[0] = 1;
+            static_cast<char*>(p[k])[Sizes[k] - 1] = 1;
+        }
+        for (int k = 0; k < NSizes; ++k)
+            __cxxabiv1::__cxa_free_exception(p[k]);
+    }
+    *caught = Throws;
+}
+
+template <class Worker>
+void test(const char* name, Worker worker, int nthreads, int ops)
+{
+    typedef std::chrono::steady_clock Clock;
+    int caught[64] = {0};
+    Clock::time_point start = Clock::now();
+#if !LIBCXXABI_HAS_NO_THREADS
+    std::thread threads[64];
+    for (int i = 0; i < nthreads; ++i)
+        threads[i] = std::thread(worker, &caught[i]);
+    for (int i = 0; i < nthreads; ++i)
+        threads[i].join();
+#else
+    nthreads = 1;
+    worker(&caught[0]);
+#endif
+    double us = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - start).count();
+    for (int i = 0; i < nthreads; ++i)
+        assert(caught[i] == Throws);
+    std::cout << name << ", " << nthreads << " threads: "
+              << (long)(ops * nthreads / (us / 1e6)) << " ops/s" << std::endl;
+}
+
+void test_cross_thread()
+{
+#if !LIBCXXABI_HAS_NO_THREADS
+    void* p[NSizes];
+    for (int k = 0; k < NSizes; ++k)
+        p[k] = __cxxabiv1::__cxa_allocate_exception(Sizes[k]);
+    std::thread t([&]() {
+        for (int k = 0; k < NSizes; ++k)
+            __cxxabiv1::__cxa_free_exception(p[k]);
+        // Cached on this thread now, taken from there
+        for (int k = 0; k < NSizes; ++k)
+        {
+            p[k] = __cxxabiv1::__cxa_allocate_exception(Sizes[k]);
+            check_zero(p[k], Sizes[k]);
+        }
+    });
+    t.join();
+    for (int k = 0; k < NSizes; ++k)
+        __cxxabiv1::__cxa_free_exception(p[k]);
+#endif
+}
+
+int main()
+{
+    test_cross_thread();
+    for (int n = 1; n <= 64; n *= 2)
+        test("throw/catch", throw_worker, n, Throws);
+    for (int n = 1; n <= 64; n *= 2)
+        test("allocate/free", alloc_worker, n, Allocs * NSizes);
+}
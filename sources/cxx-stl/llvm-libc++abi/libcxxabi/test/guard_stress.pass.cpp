@@ -0,0 +1,94 @@
+//===-------------------------- guard_stress.cpp --------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+// Throughput of one-time construction of Guards distinct statics, raced for
+// by 1..64 threads at once, each starting at its own place in the list.
+
+#include "../src/config.h"
+#include "cxxabi.h"
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+#if !LIBCXXABI_HAS_NO_THREADS
+#include <atomic>
+#include <thread>
+#endif
+
+#ifdef __arm__
+typedef uint32_t guard_type;
+#else
+typedef uint64_t guard_type;
+#endif
+
+const int Guards = 4096;
+const int Rounds = 20;
+
+guard_type guards[Guards];
+int values[Guards];
+
+#if !LIBCXXABI_HAS_NO_THREADS
+std::atomic<int> inits;
+#else
+int inits;
+#endif
+
+void worker(int first)
+{
+    for (int i = 0; i < Guards; ++i)
+    {
+        int n = (first + i) % Guards;
+        if (__cxxabiv1::__cxa_guard_acquire(&guards[n]))
+        {
+            // Some work for others to wait for
+            for (int k = 0; k < 64; ++k)
+                values[n] = values[n] * 31 + k;
+            ++inits;
+            __cxxabiv1::__cxa_guard_release(&guards[n]);
+        }
+    }
+}
+
+void test(int nthreads)
+{
+    typedef std::chrono::steady_clock Clock;
+    double us = 0;
+    for (int r = 0; r < Rounds; ++r)
+    {
+        for (int i = 0; i < Guards; ++i)
+            guards[i] = 0;
+        inits = 0;
+        Clock::time_point start = Clock::now();
+#if !LIBCXXABI_HAS_NO_THREADS
+        std::thread threads[64];
+        for (int i = 0; i < nthreads; ++i)
+            threads[i] = std::thread(worker, i * Guards / nthreads);
+        for (int i = 0; i < nthreads; ++i)
+            threads[i].join();
+#else
+        nthreads = 1;
+        worker(0);
+#endif
+        us += std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - start).count();
+        assert(inits == Guards);
+        for (int i = 0; i < nthreads; ++i)
+            worker(i);
+        assert(inits == Guards);
+    }
+    std::cout << nthreads << " threads: "
+              << (long)(Guards * Rounds / (us / 1e6)) << " inits/s" << std::endl;
+}
+
+int main()
+{
+    for (int n = 1; n <= 64; n *= 2)
+        test(n);
+}
@@ -0,0 +1,86 @@
+//===------------------------- unwind_stress.cpp --------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+// Throughput of throw/catch across Depth frames on 1..64 threads at once.
+
+#include "../src/config.h"
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+#if !LIBCXXABI_HAS_NO_THREADS
+#include <thread>
+#endif
+
+const int Depth = 16;
+const int Throws = 500;
+
+struct frame
+{
+    int *dtors;
+    explicit frame(int *d) : dtors(d) {}
+    ~frame() {++*dtors;}
+};
+
+__attribute__((noinline))
+void thrower(int depth, int *dtors)
+{
+    frame f(dtors);
+    if (depth == 0)
+        throw depth;
+    thrower(depth - 1, dtors);
+}
+
+void worker(int *caught)
+{
+    int dtors = 0;
+    for (int i = 0; i < Throws; ++i)
+    {
+        try
+        {
+            thrower(Depth, &dtors);
+        }
+        catch (int e)
+        {
+            assert(e == 0);
+            ++*caught;
+        }
+    }
+    assert(dtors == Throws * (Depth + 1));
+}
+
+void test(int nthreads)
+{
+    typedef std::chrono::steady_clock Clock;
+    int caught[64] = {0};
+    Clock::time_point start = Clock::now();
+#if !LIBCXXABI_HAS_NO_THREADS
+    std::thread threads[64];
+    for (int i = 0; i < nthreads; ++i)
+        threads[i] = std::thread(worker, &caught[i]);
+    for (int i = 0; i < nthreads; ++i)
+        threads[i].join();
+#else
+    nthreads = 1;
+    worker(&caught[0]);
+#endif
+    double us = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - start).count();
+    for (int i = 0; i < nthreads; ++i)
+        assert(caught[i] == Throws);
+    std::cout << nthreads << " threads: "
+              << (long)(Throws * nthreads / (us / 1e6)) << " throws/s" << std::endl;
+}
+
+int main()
+{
+    for (int n = 1; n <= 64; n *= 2)
+        test(n);
+}
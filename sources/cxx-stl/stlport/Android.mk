@@ -47,6 +47,8 @@ libstlport_src_files := \
         src/string.cpp \
         src/bitset.cpp \
         src/allocators.cpp \
+        src/sort_pool.cpp \
+        src/string_search.cpp \
         src/c_locale.c \
         src/cxa.c \
 
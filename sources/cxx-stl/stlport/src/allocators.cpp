@@ -177,6 +177,8 @@ __oom_handler_type _STLP_CALL __malloc_alloc::set_malloc_handler(__oom_handler_t
 //    without permanently losing part of the object.
 //
 
+#if !defined (_STLP_USE_THREAD_CACHING_NODE_ALLOC)
+
 #define _STLP_NFREELISTS 16
 
 #if defined (_STLP_LEAKS_PEDANTIC) && defined (_STLP_USE_DYNAMIC_LIB)
@@ -745,6 +747,569 @@ void * _STLP_CALL __node_alloc::_M_allocate(size_t& __n)
 void _STLP_CALL __node_alloc::_M_deallocate(void *__p, size_t __n)
 { __node_alloc_impl::_M_deallocate(__p, __n); }
 
+#else /* _STLP_USE_THREAD_CACHING_NODE_ALLOC */
+
+// *******************************************************
+// Thread caching node allocator.
+//
+// Requests of up to _MAX_NODE_BYTES are rounded up to one of _S_NCLASSES size
+// classes: multiples of _ALIGN up to _MAX_BYTES, then four classes for each
+// doubling of the size.  Every thread keeps a free list per class, that it
+// allocates from and frees to without any synchronization.  When a list grows
+// too long, a batch of its nodes goes to a lock-free stack of batches shared
+// by all threads, where an empty list takes its next batch from.
+// Behind those stacks, nodes are carved out of spans of _S_SPAN_SIZE bytes,
+// each span serving a single class.  Nodes which don't fit into the stacks go
+// back to their spans, and a span which gets all its nodes back returns to a
+// heap of free spans, which hands the pages of the spans it does not retain
+// back to the system.  Spans are never unmapped, so that a thread reading a
+// stale top of a stack never faults.
+
+#  if !defined (_STLP_PTHREADS) || !defined (__GNUC__)
+#    error The thread caching node allocator needs pthreads and GCC builtins.
+#  endif
+
+#  include <sys/mman.h>
+#  include <sched.h>
+#  include <unistd.h>
+
+_STLP_MOVE_TO_PRIV_NAMESPACE
+
+struct _Node_obj {
+  _Node_obj* _M_next;        // in a free list or a batch
+  _Node_obj* _M_next_batch;  // in a stack of batches, set on first node only
+};
+
+class _Node_spin_lock {
+  volatile int _M_locked;
+public:
+  void _M_acquire_lock() {
+    while (__sync_lock_test_and_set(&_M_locked, 1)) {
+      while (_M_locked)
+        sched_yield();
+    }
+  }
+  void _M_release_lock() { __sync_lock_release(&_M_locked); }
+};
+
+class _Node_spin_guard {
+  _Node_spin_lock& _M_lock;
+public:
+  _Node_spin_guard(_Node_spin_lock& __lock) : _M_lock(__lock) { _M_lock._M_acquire_lock(); }
+  ~_Node_spin_guard() { _M_lock._M_release_lock(); }
+};
+
+/* Lock-free stack of batches.  The top is changed together with a count of
+ * its changes, so that a thread which read a top that was popped and pushed
+ * back in the meantime fails to replace it (the ABA problem).  Where the
+ * compiler has no compare and swap of two pointers wide, a lock is taken
+ * for the few instructions of push and pop instead. */
+class _Node_batch_stack {
+#  if defined (__LP64__) && defined (__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+  typedef unsigned __int128 _Tagged;
+#    define _STLP_NODE_TAGGED_STACK
+#  elif !defined (__LP64__) && defined (__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8)
+  typedef unsigned long long _Tagged;
+#    define _STLP_NODE_TAGGED_STACK
+#  endif
+
+#  if defined (_STLP_NODE_TAGGED_STACK)
+  enum { _S_TAG_SHIFT = 8 * sizeof(void*) };
+
+  volatile _Tagged _M_top;
+
+  static _Node_obj* _S_ptr(_Tagged __t)
+  { return __REINTERPRET_CAST(_Node_obj*, (size_t)__t); }
+  static _Tagged _S_make(_Node_obj* __p, _Tagged __old)
+  { return (((__old >> _S_TAG_SHIFT) + 1) << _S_TAG_SHIFT) | (size_t)__p; }
+
+public:
+  void push(_Node_obj* __batch) {
+    _Tagged __old, __new;
+    do {
+      __old = _M_top;
+      __batch->_M_next_batch = _S_ptr(__old);
+      __new = _S_make(__batch, __old);
+    } while (!__sync_bool_compare_and_swap(&_M_top, __old, __new));
+  }
+
+  _Node_obj* pop() {
+    _Tagged __old, __new;
+    _Node_obj* __batch;
+    do {
+      __old = _M_top;
+      __batch = _S_ptr(__old);
+      if (__batch == 0)
+        return 0;
+      // May read a node which is in use by now, the exchange then fails
+      __new = _S_make(__batch->_M_next_batch, __old);
+    } while (!__sync_bool_compare_and_swap(&_M_top, __old, __new));
+    return __batch;
+  }
+#  else
+  _Node_spin_lock _M_lock;
+  _Node_obj* _M_top;
+
+public:
+  void push(_Node_obj* __batch) {
+    _Node_spin_guard __guard(_M_lock);
+    __batch->_M_next_batch = _M_top;
+    _M_top = __batch;
+  }
+
+  _Node_obj* pop() {
+    _Node_spin_guard __guard(_M_lock);
+    _Node_obj* __batch = _M_top;
+    if (__batch != 0)
+      _M_top = __batch->_M_next_batch;
+    return __batch;
+  }
+#  endif
+};
+
+struct _Node_span {
+  _Node_span* _M_next;   // in the partial list of a class, or in the span heap
+  _Node_span* _M_prev;
+  _Node_obj* _M_free;    // nodes given back to the span
+  char* _M_unused;       // first node never handed out
+  char* _M_end;
+  size_t _M_live;        // nodes handed out
+  size_t _M_class;
+  bool _M_in_partial;
+};
+
+struct _Node_thread_cache;
+
+class __node_alloc_impl {
+public:
+  enum { _S_MAX_BYTES_SHIFT = _ALIGN_SHIFT + 4, _S_MAX_NODE_SHIFT = 11 };
+  enum { _S_NCLASSES = 16 + 4 * (_S_MAX_NODE_SHIFT - _S_MAX_BYTES_SHIFT) };
+
+  enum { _S_SPAN_SHIFT = 16, _S_SPAN_SIZE = 1 << _S_SPAN_SHIFT };
+  // Spans mapped at once
+  enum { _S_REGION_SPANS = 16 };
+  // Free spans kept with their pages
+  enum { _S_RETAINED_SPANS = 16 };
+  // Batches hold about this many bytes, within the bounds below
+  enum { _S_BATCH_BYTES = 4096, _S_MIN_BATCH = 4, _S_MAX_BATCH = 64 };
+  // Bytes kept in the stack of batches of a class
+  enum { _S_STACK_BYTES = 128 * 1024 };
+  // Bytes of free nodes kept by a thread
+  enum { _S_THREAD_BYTES = 128 * 1024 };
+
+  static size_t _S_class(size_t __n) {
+    if (__n <= (size_t)_MAX_BYTES)
+      return (__n - 1) >> (int)_ALIGN_SHIFT;
+    size_t __m = __n - 1;
+    int __b = (int)(8 * sizeof(unsigned long) - 1) - __builtin_clzl(__m);
+    return 16 + (__b - (int)_S_MAX_BYTES_SHIFT) * 4 + ((__m >> (__b - 2)) - 4);
+  }
+
+  static size_t _S_class_size(size_t __c) {
+    if (__c < 16)
+      return (__c + 1) * (size_t)_ALIGN;
+    int __b = (int)_S_MAX_BYTES_SHIFT + (int)(__c - 16) / 4;
+    return (size_t)(5 + (__c - 16) % 4) << (__b - 2);
+  }
+
+  // Valid once a thread cache exists
+  static size_t _S_batch(size_t __c)
+  { return _S_batches[__c]; }
+
+  static void* _M_allocate(size_t& __n);
+  static void _M_deallocate(void* __p, size_t __n);
+  static void _S_release_free_memory();
+
+private:
+  struct _Central {
+    _Node_batch_stack _M_batches;
+    _STLP_VOLATILE long _M_nbatches;
+    _Node_spin_lock _M_lock;
+    _Node_span* _M_partial;  // spans with nodes to hand out
+  } __attribute__((aligned(64)));
+
+  static _Central _S_central[_S_NCLASSES];
+  static size_t _S_batches[_S_NCLASSES];
+
+  static _Node_spin_lock _S_heap_lock;
+  static _Node_span* _S_resident_spans;
+  static _Node_span* _S_released_spans;
+  static size_t _S_nresident;
+  static size_t _S_page_size;
+
+  static pthread_once_t _S_once;
+  static pthread_key_t _S_key;
+  static _STLP_VOLATILE bool _S_key_initialized;
+
+  static void _S_init();
+  static _Node_thread_cache* _S_cache();
+  static _Node_thread_cache* _S_new_cache();
+  static void _S_destroy_cache(void* __cache);
+
+  static _Node_obj* _S_refill(_Node_thread_cache* __cache, size_t __c);
+  static void _S_flush(_Node_thread_cache* __cache, size_t __c, size_t __keep);
+  static void _S_flush_all(_Node_thread_cache* __cache);
+  static void _S_push_batch(size_t __c, _Node_obj* __batch);
+  static size_t _S_fetch(size_t __c, size_t __n, _Node_obj*& __list);
+  static void _S_give_back(size_t __c, _Node_obj* __list);
+
+  static _Node_span* _S_span_of(void* __p)
+  { return __REINTERPRET_CAST(_Node_span*, (size_t)__p & ~((size_t)_S_SPAN_SIZE - 1)); }
+  static void _S_unlink_partial(_Central& __central, _Node_span* __span);
+  static _Node_span* _S_get_span();
+  static void _S_put_span(_Node_span* __span);
+  static void _S_release_pages(_Node_span* __span);
+};
+
+struct _Node_thread_cache {
+  _Node_obj* _M_list[__node_alloc_impl::_S_NCLASSES];
+  size_t _M_length[__node_alloc_impl::_S_NCLASSES];
+  size_t _M_bytes;
+};
+
+inline _Node_thread_cache* __node_alloc_impl::_S_cache() {
+  if (_S_key_initialized) {
+    _Node_thread_cache* __cache = __STATIC_CAST(_Node_thread_cache*, pthread_getspecific(_S_key));
+    if (__cache != 0)
+      return __cache;
+  }
+  return _S_new_cache();
+}
+
+void* __node_alloc_impl::_M_allocate(size_t& __n) {
+  size_t __c = _S_class(__n);
+  __n = _S_class_size(__c);
+  _Node_thread_cache* __cache = _S_cache();
+  _Node_obj* __r = __cache->_M_list[__c];
+  if (__r == 0)
+    return _S_refill(__cache, __c);
+  __cache->_M_list[__c] = __r->_M_next;
+  --__cache->_M_length[__c];
+  __cache->_M_bytes -= __n;
+  return __r;
+}
+
+void __node_alloc_impl::_M_deallocate(void* __p, size_t __n) {
+  size_t __c = _S_class(__n);
+  _Node_thread_cache* __cache = _S_cache();
+  _Node_obj* __obj = __STATIC_CAST(_Node_obj*, __p);
+  __obj->_M_next = __cache->_M_list[__c];
+  __cache->_M_list[__c] = __obj;
+  __cache->_M_bytes += _S_class_size(__c);
+  size_t __batch = _S_batch(__c);
+  if (++__cache->_M_length[__c] >= 2 * __batch)
+    _S_flush(__cache, __c, __batch);
+  if (__cache->_M_bytes > (size_t)_S_THREAD_BYTES)
+    _S_flush_all(__cache);
+}
+
+void __node_alloc_impl::_S_init() {
+  _STLP_STATIC_ASSERT((1 << _S_MAX_NODE_SHIFT) == _MAX_NODE_BYTES)
+  for (size_t __c = 0; __c < (size_t)_S_NCLASSES; ++__c) {
+    size_t __n = (size_t)_S_BATCH_BYTES / _S_class_size(__c);
+    _S_batches[__c] = __n < (size_t)_S_MIN_BATCH ? (size_t)_S_MIN_BATCH :
+                      __n > (size_t)_S_MAX_BATCH ? (size_t)_S_MAX_BATCH : __n;
+  }
+  if (pthread_key_create(&_S_key, _S_destroy_cache) == 0)
+    _S_key_initialized = true;
+  long __page_size = sysconf(_SC_PAGESIZE);
+  _S_page_size = __page_size > 0 ? (size_t)__page_size : 4096;
+}
+
+_Node_thread_cache* __node_alloc_impl::_S_new_cache() {
+  pthread_once(&_S_once, _S_init);
+  if (!_S_key_initialized) {
+    _STLP_THROW_BAD_ALLOC;
+  }
+  void* __cache = calloc(1, sizeof(_Node_thread_cache));
+  if (__cache == 0) {
+    _STLP_THROW_BAD_ALLOC;
+  }
+  if (pthread_setspecific(_S_key, __cache) != 0) {
+    free(__cache);
+    _STLP_THROW_BAD_ALLOC;
+  }
+  return __STATIC_CAST(_Node_thread_cache*, __cache);
+}
+
+void __node_alloc_impl::_S_destroy_cache(void* __cache) {
+  _S_flush_all(__STATIC_CAST(_Node_thread_cache*, __cache));
+  free(__cache);
+}
+
+/* Takes a batch for an empty free list, and returns its first node.
+ * In case of failure, nothing is taken. */
+_Node_obj* __node_alloc_impl::_S_refill(_Node_thread_cache* __cache, size_t __c) {
+  _Central& __central = _S_central[__c];
+  size_t __n;
+  _Node_obj* __list = __central._M_batches.pop();
+  if (__list != 0) {
+    __sync_sub_and_fetch(&__central._M_nbatches, 1);
+    __n = _S_batch(__c);
+  }
+  else {
+    __n = _S_fetch(__c, _S_batch(__c), __list);
+    if (__n == 0) {
+      _STLP_THROW_BAD_ALLOC;
+    }
+  }
+  __cache->_M_list[__c] = __list->_M_next;
+  __cache->_M_length[__c] = __n - 1;
+  __cache->_M_bytes += (__n - 1) * _S_class_size(__c);
+  return __list;
+}
+
+/* Keeps __keep nodes in the free list of class __c, full batches of the
+ * others go to the stack, the rest back to their spans. */
+void __node_alloc_impl::_S_flush(_Node_thread_cache* __cache, size_t __c, size_t __keep) {
+  size_t __batch = _S_batch(__c);
+  size_t __size = _S_class_size(__c);
+  while (__cache->_M_length[__c] > __keep) {
+    size_t __n = __cache->_M_length[__c] - __keep;
+    if (__n > __batch)
+      __n = __batch;
+    _Node_obj* __first = __cache->_M_list[__c];
+    _Node_obj* __last = __first;
+    for (size_t __i = 1; __i < __n; ++__i)
+      __last = __last->_M_next;
+    __cache->_M_list[__c] = __last->_M_next;
+    __cache->_M_length[__c] -= __n;
+    __cache->_M_bytes -= __n * __size;
+    __last->_M_next = 0;
+    if (__n == __batch)
+      _S_push_batch(__c, __first);
+    else
+      _S_give_back(__c, __first);
+  }
+}
+
+void __node_alloc_impl::_S_flush_all(_Node_thread_cache* __cache) {
+  for (size_t __c = 0; __c < (size_t)_S_NCLASSES; ++__c)
+    _S_flush(__cache, __c, 0);
+}
+
+void __node_alloc_impl::_S_push_batch(size_t __c, _Node_obj* __batch) {
+  _Central& __central = _S_central[__c];
+  long __max = (long)(_S_STACK_BYTES / (_S_batch(__c) * _S_class_size(__c)));
+  if (__sync_add_and_fetch(&__central._M_nbatches, 1) <= __max)
+    __central._M_batches.push(__batch);
+  else {
+    __sync_sub_and_fetch(&__central._M_nbatches, 1);
+    _S_give_back(__c, __batch);
+  }
+}
+
+/* Takes up to __n nodes from the spans of class __c, returns how many. */
+size_t __node_alloc_impl::_S_fetch(size_t __c, size_t __n, _Node_obj*& __list) {
+  _Central& __central = _S_central[__c];
+  size_t __size = _S_class_size(__c);
+  size_t __got = 0;
+  _Node_obj* __head = 0;
+  _Node_obj** __tail = &__head;
+  _Node_spin_guard __guard(__central._M_lock);
+  while (__got < __n) {
+    _Node_span* __span = __central._M_partial;
+    if (__span == 0) {
+      __span = _S_get_span();
+      if (__span == 0)
+        break;
+      __span->_M_free = 0;
+      __span->_M_unused = __REINTERPRET_CAST(char*, __span) +
+                          ((sizeof(_Node_span) + (size_t)_ALIGN - 1) & ~((size_t)_ALIGN - 1));
+      __span->_M_end = __REINTERPRET_CAST(char*, __span) + (size_t)_S_SPAN_SIZE;
+      __span->_M_live = 0;
+      __span->_M_class = __c;
+      __span->_M_prev = 0;
+      __span->_M_next = 0;
+      __span->_M_in_partial = true;
+      __central._M_partial = __span;
+    }
+    while (__got < __n) {
+      _Node_obj* __obj = __span->_M_free;
+      if (__obj != 0)
+        __span->_M_free = __obj->_M_next;
+      else if (__span->_M_unused + __size <= __span->_M_end) {
+        __obj = __REINTERPRET_CAST(_Node_obj*, __span->_M_unused);
+        __span->_M_unused += __size;
+      }
+      else
+        break;
+      *__tail = __obj;
+      __tail = &__obj->_M_next;
+      ++__span->_M_live;
+      ++__got;
+    }
+    if (__span->_M_free == 0 && __span->_M_unused + __size > __span->_M_end)
+      _S_unlink_partial(__central, __span);
+  }
+  *__tail = 0;
+  __list = __head;
+  return __got;
+}
+
+/* Gives the nodes of __list back to their spans. */
+void __node_alloc_impl::_S_give_back(size_t __c, _Node_obj* __list) {
+  _Central& __central = _S_central[__c];
+  _Node_span* __free_spans = 0;
+  {
+    _Node_spin_guard __guard(__central._M_lock);
+    while (__list != 0) {
+      _Node_obj* __obj = __list;
+      __list = __list->_M_next;
+      _Node_span* __span = _S_span_of(__obj);
+      __obj->_M_next = __span->_M_free;
+      __span->_M_free = __obj;
+      if (!__span->_M_in_partial) {
+        __span->_M_prev = 0;
+        __span->_M_next = __central._M_partial;
+        if (__central._M_partial != 0)
+          __central._M_partial->_M_prev = __span;
+        __central._M_partial = __span;
+        __span->_M_in_partial = true;
+      }
+      if (--__span->_M_live == 0) {
+        _S_unlink_partial(__central, __span);
+        __span->_M_next = __free_spans;
+        __free_spans = __span;
+      }
+    }
+  }
+  while (__free_spans != 0) {
+    _Node_span* __span = __free_spans;
+    __free_spans = __span->_M_next;
+    _S_put_span(__span);
+  }
+}
+
+void __node_alloc_impl::_S_unlink_partial(_Central& __central, _Node_span* __span) {
+  if (__span->_M_prev != 0)
+    __span->_M_prev->_M_next = __span->_M_next;
+  else
+    __central._M_partial = __span->_M_next;
+  if (__span->_M_next != 0)
+    __span->_M_next->_M_prev = __span->_M_prev;
+  __span->_M_in_partial = false;
+}
+
+/* Returns a free span, or 0 if the system has no memory left. */
+_Node_span* __node_alloc_impl::_S_get_span() {
+  {
+    _Node_spin_guard __guard(_S_heap_lock);
+    _Node_span* __span = _S_resident_spans;
+    if (__span != 0) {
+      _S_resident_spans = __span->_M_next;
+      --_S_nresident;
+      return __span;
+    }
+    // Released pages come back when written to
+    __span = _S_released_spans;
+    if (__span != 0) {
+      _S_released_spans = __span->_M_next;
+      return __span;
+    }
+  }
+
+  // Map a region aligned on the size of spans
+  size_t __bytes = (size_t)_S_REGION_SPANS * _S_SPAN_SIZE;
+  char* __map = __STATIC_CAST(char*, mmap(0, __bytes + _S_SPAN_SIZE, PROT_READ | PROT_WRITE,
+                                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if (__map == MAP_FAILED)
+    return 0;
+  char* __region = __REINTERPRET_CAST(char*, ((size_t)__map + _S_SPAN_SIZE - 1) & ~((size_t)_S_SPAN_SIZE - 1));
+  if (__region != __map)
+    munmap(__map, __region - __map);
+  if (__region + __bytes != __map + __bytes + _S_SPAN_SIZE)
+    munmap(__region + __bytes, __map + __bytes + _S_SPAN_SIZE - (__region + __bytes));
+
+  // Keep the first span, the others are free and untouched
+  _Node_spin_guard __guard(_S_heap_lock);
+  for (size_t __i = (size_t)_S_REGION_SPANS - 1; __i > 0; --__i) {
+    _Node_span* __span = __REINTERPRET_CAST(_Node_span*, __region + __i * _S_SPAN_SIZE);
+    __span->_M_next = _S_released_spans;
+    _S_released_spans = __span;
+  }
+  return __REINTERPRET_CAST(_Node_span*, __region);
+}
+
+void __node_alloc_impl::_S_put_span(_Node_span* __span) {
+  {
+    _Node_spin_guard __guard(_S_heap_lock);
+    if (_S_nresident < (size_t)_S_RETAINED_SPANS) {
+      __span->_M_next = _S_resident_spans;
+      _S_resident_spans = __span;
+      ++_S_nresident;
+      return;
+    }
+  }
+  _S_release_pages(__span);
+  _Node_spin_guard __guard(_S_heap_lock);
+  __span->_M_next = _S_released_spans;
+  _S_released_spans = __span;
+}
+
+/* Releases all pages of a free span but the one of its header. */
+void __node_alloc_impl::_S_release_pages(_Node_span* __span) {
+  if (_S_page_size < (size_t)_S_SPAN_SIZE)
+    madvise(__REINTERPRET_CAST(char*, __span) + _S_page_size, _S_SPAN_SIZE - _S_page_size, MADV_DONTNEED);
+}
+
+void __node_alloc_impl::_S_release_free_memory() {
+  _Node_thread_cache* __cache = 0;
+  if (_S_key_initialized)
+    __cache = __STATIC_CAST(_Node_thread_cache*, pthread_getspecific(_S_key));
+  if (__cache != 0)
+    _S_flush_all(__cache);
+
+  for (size_t __c = 0; __c < (size_t)_S_NCLASSES; ++__c) {
+    _Central& __central = _S_central[__c];
+    _Node_obj* __batch;
+    while ((__batch = __central._M_batches.pop()) != 0) {
+      __sync_sub_and_fetch(&__central._M_nbatches, 1);
+      _S_give_back(__c, __batch);
+    }
+  }
+
+  for (;;) {
+    _Node_span* __span;
+    {
+      _Node_spin_guard __guard(_S_heap_lock);
+      __span = _S_resident_spans;
+      if (__span == 0)
+        break;
+      _S_resident_spans = __span->_M_next;
+      --_S_nresident;
+    }
+    _S_release_pages(__span);
+    _Node_spin_guard __guard(_S_heap_lock);
+    __span->_M_next = _S_released_spans;
+    _S_released_spans = __span;
+  }
+}
+
+__node_alloc_impl::_Central __node_alloc_impl::_S_central[__node_alloc_impl::_S_NCLASSES];
+size_t __node_alloc_impl::_S_batches[__node_alloc_impl::_S_NCLASSES];
+_Node_spin_lock __node_alloc_impl::_S_heap_lock;
+_Node_span* __node_alloc_impl::_S_resident_spans = 0;
+_Node_span* __node_alloc_impl::_S_released_spans = 0;
+size_t __node_alloc_impl::_S_nresident = 0;
+size_t __node_alloc_impl::_S_page_size = 0;
+pthread_once_t __node_alloc_impl::_S_once = PTHREAD_ONCE_INIT;
+pthread_key_t __node_alloc_impl::_S_key;
+_STLP_VOLATILE bool __node_alloc_impl::_S_key_initialized = false;
+
+_STLP_MOVE_TO_STD_NAMESPACE
+
+void * _STLP_CALL __node_alloc::_M_allocate(size_t& __n)
+{ return _STLP_PRIV __node_alloc_impl::_M_allocate(__n); }
+
+void _STLP_CALL __node_alloc::_M_deallocate(void *__p, size_t __n)
+{ _STLP_PRIV __node_alloc_impl::_M_deallocate(__p, __n); }
+
+void _STLP_CALL __node_alloc::release_free_memory()
+{ _STLP_PRIV __node_alloc_impl::_S_release_free_memory(); }
+
+#endif /* _STLP_USE_THREAD_CACHING_NODE_ALLOC */
+
 #if defined (_STLP_PTHREADS) && !defined (_STLP_NO_THREADS)
 
 #  define _STLP_DATA_ALIGNMENT 8
@@ -41,6 +41,7 @@ extern "C" {
 
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/uio.h>            // For readv/writev
 }
 
 #ifdef __APPLE__
@@ -73,6 +74,9 @@ const _STLP_fd INVALID_STLP_FD = -1;
 #  define MAP_FAILED -1
 #endif
 
+// How much of a new mapping we ask the kernel to start reading at once.
+#define MMAP_READAHEAD 0x40000L
+
 _STLP_BEGIN_NAMESPACE
 
 static ios_base::openmode flag_to_openmode(int mode)
@@ -282,6 +286,55 @@ bool _Filebuf_base::_M_write(char* buf, ptrdiff_t n)
   }
 }
 
+// Read up to n1 characters into buf1 and, once buf1 is full, up to n2
+// more into buf2, in a single system call.  Return value is the total
+// number of characters read.
+ptrdiff_t _Filebuf_base::_M_readv(char* buf1, ptrdiff_t n1, char* buf2, ptrdiff_t n2)
+{
+  struct iovec iov[2];
+  iov[0].iov_base = buf1;
+  iov[0].iov_len = n1;
+  iov[1].iov_base = buf2;
+  iov[1].iov_len = n2;
+  return readv(_M_file_id, iov, n2 > 0 ? 2 : 1);
+}
+
+// Write n1 characters from buf1 followed by n2 characters from buf2.
+// Return value: true if we managed to write both buffers, false if we
+// didn't.
+bool _Filebuf_base::_M_writev(const char* buf1, ptrdiff_t n1, const char* buf2, ptrdiff_t n2)
+{
+  struct iovec iov[2];
+  int cnt = 0;
+  if (n1 > 0) {
+    iov[cnt].iov_base = const_cast<char*>(buf1);
+    iov[cnt++].iov_len = n1;
+  }
+  if (n2 > 0) {
+    iov[cnt].iov_base = const_cast<char*>(buf2);
+    iov[cnt++].iov_len = n2;
+  }
+
+  struct iovec* cur = iov;
+  while (cnt > 0) {
+    ptrdiff_t written = writev(_M_file_id, cur, cnt);
+    if (written <= 0)
+      return false;
+
+    // Skip what was written, which may end in the middle of a buffer.
+    while (cnt > 0 && written >= (ptrdiff_t)cur->iov_len) {
+      written -= cur->iov_len;
+      ++cur;
+      --cnt;
+    }
+    if (cnt > 0) {
+      cur->iov_base = (char*)cur->iov_base + written;
+      cur->iov_len -= written;
+    }
+  }
+  return true;
+}
+
 // Wrapper for lseek or the like.
 streamoff _Filebuf_base::_M_seek(streamoff offset, ios_base::seekdir dir)
 {
@@ -323,6 +376,14 @@ void* _Filebuf_base::_M_mmap(streamoff offset, streamoff len)
       this->_M_unmap(base, len);
       base = 0;
     }
+#  if defined (MADV_SEQUENTIAL) && defined (MADV_WILLNEED)
+    else {
+      // The mapping is read front to back: have the kernel read ahead
+      // aggressively, and start reading the first pages right away.
+      madvise(base, len, MADV_SEQUENTIAL);
+      madvise(base, len < MMAP_READAHEAD ? len : MMAP_READAHEAD, MADV_WILLNEED);
+    }
+#  endif
   } else
     base =0;
 #else
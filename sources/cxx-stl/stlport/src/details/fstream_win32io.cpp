@@ -543,6 +543,18 @@ bool _Filebuf_base::_M_write(char* buf, ptrdiff_t n) {
   }
 }
 
+// There is no scatter/gather I/O here: read into buf1 only, since reading
+// on into buf2 could wait for characters nobody asked for yet, and write
+// the two buffers one after the other.
+ptrdiff_t _Filebuf_base::_M_readv(char* buf1, ptrdiff_t n1, char*, ptrdiff_t) {
+  return _M_read(buf1, n1);
+}
+
+bool _Filebuf_base::_M_writev(const char* buf1, ptrdiff_t n1, const char* buf2, ptrdiff_t n2) {
+  return (n1 == 0 || _M_write(const_cast<char*>(buf1), n1)) &&
+         (n2 == 0 || _M_write(const_cast<char*>(buf2), n2));
+}
+
 // Wrapper for lseek or the like.
 streamoff _Filebuf_base::_M_seek(streamoff offset, ios_base::seekdir dir) {
   streamoff result = -1;
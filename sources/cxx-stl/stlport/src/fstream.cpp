@@ -30,8 +30,10 @@
 
 _STLP_BEGIN_NAMESPACE
 
-// fbp : let us map 1 MB maximum, just be sure not to trash VM
-#define MMAP_CHUNK 0x100000L
+// Input files are mapped whole, so that reading one through the get area
+// takes a single mmap.  Only files too large for a reasonable share of the
+// address space are mapped in windows of MMAP_CHUNK bytes.
+#define MMAP_CHUNK (sizeof(void*) > 4 ? 0x40000000L : 0x1000000L)
 
 _Underflow< char, char_traits<char> >::int_type _STLP_CALL
 _Underflow< char, char_traits<char> >::_M_doit(basic_filebuf<char, char_traits<char> >* __this)
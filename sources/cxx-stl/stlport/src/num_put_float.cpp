@@ -57,6 +57,12 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+
+#if (defined (__GNUC__) && !defined (__sun) && !defined (__hpux)) || \
+    defined (__DMC__)
+#  include <stdint.h>
+#endif
 
 #if defined (_STLP_MSVC_LIB) || defined (__MINGW32__) || defined (__BORLANDC__) || defined (__DJGPP) || \
     defined (_STLP_SCO_OPENSERVER) || defined (__NCR_SVR)
@@ -819,16 +825,842 @@ static size_t  __write_floatT(__iostring &buf, ios_base::fmtflags flags, int pre
 #endif
 }
 
-size_t  _STLP_CALL
-__write_float(__iostring &buf, ios_base::fmtflags flags, int precision,
-              double x) {
-  return __write_floatT(buf, flags, precision, x
-#if defined (USE_SPRINTF_INSTEAD)
-                                               , 0
+//----------------------------------------------------------------------
+// Formatting of double.
+//
+// The digits are produced here rather than by the C library: the shortest
+// representation that reads back to the same double comes from Ryu (Ulf
+// Adams, "Ryu: fast float-to-string conversion", PLDI 2018), and whenever
+// the requested rounding can be read off those digits it is used as is.
+// Otherwise the exact binary value is expanded with a small bignum. Both
+// round ties to even, so the output is the one printf gives.
+
+#if defined (_STLP_MSVC) || defined (__BORLANDC__) || defined (__ICL)
+typedef unsigned long uint32;
+typedef unsigned __int64 uint64;
+#  define ULL(x) x##Ui64
+#elif defined (__unix) || defined (__MINGW32__) || \
+      (defined (__DMC__) && (__LONGLONG)) || defined (__WATCOMC__) || \
+      defined (__ANDROID__)
+typedef uint32_t uint32;
+typedef uint64_t uint64;
+#  define ULL(x) x##ULL
+#else
+#  error There should be some unsigned 64-bit integer on the system!
 #endif
-                                                  );
+
+// Powers of 5 as 125-bit fixed point numbers, { low, high }: 5^i scaled to
+// its top 125 bits, and 2^(bits(5^i)-1+125)/5^i rounded up.
+static const uint64 _Stl_pow5_inv_split[291][2] = {
+  { ULL(0x0000000000000001), ULL(0x2000000000000000) }, { ULL(0x999999999999999a), ULL(0x1999999999999999) },
+  { ULL(0x47ae147ae147ae15), ULL(0x147ae147ae147ae1) }, { ULL(0x6c8b4395810624de), ULL(0x10624dd2f1a9fbe7) },
+  { ULL(0x7a786c226809d496), ULL(0x1a36e2eb1c432ca5) }, { ULL(0x61f9f01b866e43ab), ULL(0x14f8b588e368f084) },
+  { ULL(0xb4c7f34938583622), ULL(0x10c6f7a0b5ed8d36) }, { ULL(0x87a6520ec08d236a), ULL(0x1ad7f29abcaf4857) },
+  { ULL(0x9fb841a566d74f88), ULL(0x15798ee2308c39df) }, { ULL(0xe62d01511f12a607), ULL(0x112e0be826d694b2) },
+  { ULL(0xd6ae6881cb5109a4), ULL(0x1b7cdfd9d7bdbab7) }, { ULL(0xdef1ed34a2a73aea), ULL(0x15fd7fe17964955f) },
+  { ULL(0x7f27f0f6e885c8bb), ULL(0x119799812dea1119) }, { ULL(0x650cb4be40d60df8), ULL(0x1c25c268497681c2) },
+  { ULL(0xea70909833de7193), ULL(0x16849b86a12b9b01) }, { ULL(0x21f3a6e0297ec143), ULL(0x1203af9ee756159b) },
+  { ULL(0x6985d7cd0f313537), ULL(0x1cd2b297d889bc2b) }, { ULL(0x2137dfd73f5a90f9), ULL(0x170ef54646d49689) },
+  { ULL(0xe75fe645cc4873fa), ULL(0x12725dd1d243aba0) }, { ULL(0xa5663d3c7a0d865d), ULL(0x1d83c94fb6d2ac34) },
+  { ULL(0x511e976394d79eb1), ULL(0x179ca10c9242235d) }, { ULL(0xda7edf82dd794bc1), ULL(0x12e3b40a0e9b4f7d) },
+  { ULL(0x2a6498d1625bac68), ULL(0x1e392010175ee596) }, { ULL(0xeeb6e0a781e2f053), ULL(0x182db34012b25144) },
+  { ULL(0x58924d52ce4f26a9), ULL(0x1357c299a88ea76a) }, { ULL(0x27507bb7b07ea441), ULL(0x1ef2d0f5da7dd8aa) },
+  { ULL(0x52a6c95fc0655034), ULL(0x18c240c4aecb13bb) }, { ULL(0x0eebd44c99eaa690), ULL(0x13ce9a36f23c0fc9) },
+  { ULL(0xb17953adc3110a80), ULL(0x1fb0f6be50601941) }, { ULL(0xc12ddc8b02740867), ULL(0x195a5efea6b34767) },
+  { ULL(0x3424b06f3529a052), ULL(0x14484bfeebc29f86) }, { ULL(0x901d59f290ee19db), ULL(0x1039d66589687f9e) },
+  { ULL(0x4cfbc31db4b0295f), ULL(0x19f623d5a8a73297) }, { ULL(0x3d9635b15d59bab2), ULL(0x14c4e977ba1f5bac) },
+  { ULL(0x97ab5e277de16228), ULL(0x109d8792fb4c4956) }, { ULL(0xf2abc9d8c9689d0d), ULL(0x1a95a5b7f87a0ef0) },
+  { ULL(0x5bbca17a3aba173e), ULL(0x154484932d2e725a) }, { ULL(0xafca1ac82efb45cb), ULL(0x11039d428a8b8eae) },
+  { ULL(0xb2dcf7a6b1920945), ULL(0x1b38fb9daa78e44a) }, { ULL(0xf57d92ebc141a104), ULL(0x15c72fb1552d836e) },
+  { ULL(0xc46475896767b403), ULL(0x116c262777579c58) }, { ULL(0x6d6d88dbd8a5ecd2), ULL(0x1be03d0bf225c6f4) },
+  { ULL(0x8abe071646eb23db), ULL(0x164cfda3281e38c3) }, { ULL(0x6efe6c11d255b649), ULL(0x11d7314f534b609c) },
+  { ULL(0xb197134fb6ef8a0e), ULL(0x1c8b821885456760) }, { ULL(0x27ac0f72f8bfa1a5), ULL(0x16d601ad376ab91a) },
+  { ULL(0xb95672c260994e1e), ULL(0x1244ce242c5560e1) }, { ULL(0xf5571e03cdc21695), ULL(0x1d3ae36d13bbce35) },
+  { ULL(0x2aac18030b01abab), ULL(0x17624f8a762fd82b) }, { ULL(0xbbbce0026f348956), ULL(0x12b50c6ec4f31355) },
+  { ULL(0x92c7ccd0b1eda889), ULL(0x1dee7a4ad4b81eef) }, { ULL(0xdbd30a408e57ba07), ULL(0x17f1fb6f10934bf2) },
+  { ULL(0x7ca8d50071dfc806), ULL(0x1327fc58da0f6ff5) }, { ULL(0xfaa7bb33e9660cd6), ULL(0x1ea6608e29b24cbb) },
+  { ULL(0x9552fc298784d711), ULL(0x18851a0b548ea3c9) }, { ULL(0xaaa8c9bad2d0ac0e), ULL(0x139dae6f76d88307) },
+  { ULL(0xdddadc5e1e1aace3), ULL(0x1f62b0b257c0d1a5) }, { ULL(0x7e48b04b4b488a4f), ULL(0x191bc08eac9a4151) },
+  { ULL(0xcb6d59d5d5d3a1d9), ULL(0x141633a556e1cdda) }, { ULL(0x3c577b1177dc817b), ULL(0x1011c2eaabe7d7e2) },
+  { ULL(0xc6f25e825960cf2a), ULL(0x19b604aaaca62636) }, { ULL(0x6bf518684780a5bb), ULL(0x14919d5556eb51c5) },
+  { ULL(0x232a79ed06008496), ULL(0x10747ddddf22a7d1) }, { ULL(0xd1dd8fe1a3340756), ULL(0x1a53fc9631d10c81) },
+  { ULL(0xa7e4731ae8f66c45), ULL(0x150ffd44f4a73d34) }, { ULL(0x531d28e253f8569e), ULL(0x10d9976a5d52975d) },
+  { ULL(0xeb61db03b98d5762), ULL(0x1af5bf109550f22e) }, { ULL(0xbc4e48cfc7a445e8), ULL(0x159165a6ddda5b58) },
+  { ULL(0x6371d3d96c836b20), ULL(0x11411e1f17e1e2ad) }, { ULL(0x9f1c8628ad9f11cd), ULL(0x1b9b6364f3030448) },
+  { ULL(0xe5b06b53be18db0b), ULL(0x1615e91d8f359d06) }, { ULL(0xeaf3890fcb4715a2), ULL(0x11ab20e472914a6b) },
+  { ULL(0x44b8db4c7871bc37), ULL(0x1c45016d841baa46) }, { ULL(0x03c715d6c6c1635f), ULL(0x169d9abe03495505) },
+  { ULL(0x3638de456bcde919), ULL(0x1217aefe69077737) }, { ULL(0x56c163a2461641c1), ULL(0x1cf2b1970e725858) },
+  { ULL(0xdf011c81d1ab67ce), ULL(0x17288e1271f51379) }, { ULL(0x7f3416ce4155eca5), ULL(0x1286d80ec190dc61) },
+  { ULL(0x6520247d3556476e), ULL(0x1da48ce468e7c702) }, { ULL(0xea801d30f7783925), ULL(0x17b6d71d20b96c01) },
+  { ULL(0xbb99b0f3f92cfa84), ULL(0x12f8ac174d612334) }, { ULL(0x5f5c4e532847f739), ULL(0x1e5aacf215683854) },
+  { ULL(0x7f7d0b75b9d32c2e), ULL(0x18488a5b44536043) }, { ULL(0x9930d5f7c7dc2358), ULL(0x136d3b7c36a919cf) },
+  { ULL(0x8eb4898c72f9d226), ULL(0x1f152bf9f10e8fb2) }, { ULL(0x722a07a38f2e41b8), ULL(0x18ddbcc7f40ba628) },
+  { ULL(0xc1bb394fa5be9afa), ULL(0x13e497065cd61e86) }, { ULL(0x9c5ec2190930f7f6), ULL(0x1fd424d6faf030d7) },
+  { ULL(0x49e56814075a5ff8), ULL(0x197683df2f268d79) }, { ULL(0x6e51201005e1e660), ULL(0x145ecfe5bf520ac7) },
+  { ULL(0xf1da800cd181851a), ULL(0x104bd984990e6f05) }, { ULL(0x4fc400148268d4f5), ULL(0x1a12f5a0f4e3e4d6) },
+  { ULL(0xd96999aa01ed772b), ULL(0x14dbf7b3f71cb711) }, { ULL(0xadee1488018ac5bc), ULL(0x10aff95cc5b09274) },
+  { ULL(0x497ceda668de092c), ULL(0x1ab328946f80ea54) }, { ULL(0x3aca57b853e4d424), ULL(0x155c2076bf9a5510) },
+  { ULL(0x623b7960431d7683), ULL(0x1116805effaeaa73) }, { ULL(0x9d2bf566d1c8bd9e), ULL(0x1b5733cb32b110b8) },
+  { ULL(0x7dbcc452416d647f), ULL(0x15df5ca28ef40d60) }, { ULL(0xcafd69db678ab6cc), ULL(0x117f7d4ed8c33de6) },
+  { ULL(0xab2f0fc572778adf), ULL(0x1bff2ee48e052fd7) }, { ULL(0x88f273045b92d580), ULL(0x1665bf1d3e6a8cac) },
+  { ULL(0xd3f528d049424466), ULL(0x11eaff4a98553d56) }, { ULL(0xb988414d4203a0a3), ULL(0x1cab3210f3bb9557) },
+  { ULL(0x6139cdd76802e6e9), ULL(0x16ef5b40c2fc7779) }, { ULL(0xe761717920025254), ULL(0x125915cd68c9f92d) },
+  { ULL(0xa568b58e999d5086), ULL(0x1d5b561574765b7c) }, { ULL(0x5120913ee14aa6d2), ULL(0x177c44ddf6c515fd) },
+  { ULL(0xa74d40ff1aa21f0e), ULL(0x12c9d0b1923744ca) }, { ULL(0x0baece64f769cb4a), ULL(0x1e0fb44f50586e11) },
+  { ULL(0x3c8bd850c5ee3c3b), ULL(0x180c903f7379f1a7) }, { ULL(0xca0979da37f1c9c9), ULL(0x133d4032c2c7f485) },
+  { ULL(0xa9a8c2f6bfe942db), ULL(0x1ec866b79e0cba6f) }, { ULL(0x2153cf2bccba9be3), ULL(0x18a0522c7e709526) },
+  { ULL(0x1aa9728970954982), ULL(0x13b374f06526ddb8) }, { ULL(0xf775840f1a88759d), ULL(0x1f8587e7083e2f8c) },
+  { ULL(0x5f9136727ba05e17), ULL(0x19379fec0698260a) }, { ULL(0x1940f85b9619e4df), ULL(0x142c7ff0054684d5) },
+  { ULL(0xe100c6afab47ea4c), ULL(0x1023998cd1053710) }, { ULL(0xce67a44c453fdd47), ULL(0x19d28f47b4d524e7) },
+  { ULL(0xd852e9d69dccb106), ULL(0x14a8729fc3ddb71f) }, { ULL(0x79dbee454b0a2738), ULL(0x1086c219697e2c19) },
+  { ULL(0x295fe3a211a9d859), ULL(0x1a71368f0f30468f) }, { ULL(0xbab31c81a7bb137a), ULL(0x15275ed8d8f36ba5) },
+  { ULL(0x6228e39aec95a92f), ULL(0x10ec4be0ad8f8951) }, { ULL(0x9d0e38f7e0ef7517), ULL(0x1b13ac9aaf4c0ee8) },
+  { ULL(0xb0d82d931a592a79), ULL(0x15a956e225d67253) }, { ULL(0x8d79be0f4847552e), ULL(0x11544581b7dec1dc) },
+  { ULL(0x158f967eda0bbb7c), ULL(0x1bba08cf8c979c94) }, { ULL(0x77a611ff14d62f97), ULL(0x162e6d72d6dfb076) },
+  { ULL(0xf951a7ff43de8c79), ULL(0x11bebdf578b2f391) }, { ULL(0xc21c3ffed2fdad8e), ULL(0x1c6463225ab7ec1c) },
+  { ULL(0x01b0333242648ad8), ULL(0x16b6b5b5155ff017) }, { ULL(0x0159c28e9b83a246), ULL(0x122bc490dde659ac) },
+  { ULL(0xcef604175f3903a3), ULL(0x1d12d41afca3c2ac) }, { ULL(0x725e69ac4c2d9c83), ULL(0x17424348ca1c9bbd) },
+  { ULL(0xf5185489d68ae39c), ULL(0x129b69070816e2fd) }, { ULL(0xee8d540fbdab05c6), ULL(0x1dc574d80cf16b2f) },
+  { ULL(0xbed77672fe226b05), ULL(0x17d12a4670c1228c) }, { ULL(0xff12c528cb4ebc04), ULL(0x130dbb6b8d674ed6) },
+  { ULL(0xcb513b74787df9a0), ULL(0x1e7c5f127bd87e24) }, { ULL(0x090dc929f9fe614d), ULL(0x18637f41fcad31b7) },
+  { ULL(0xa0d7d42194cb810a), ULL(0x1382cc34ca2427c5) }, { ULL(0x67bfb9cf5478ce77), ULL(0x1f37ad21436d0c6f) },
+  { ULL(0x1fcc94a5dd2d71f9), ULL(0x18f9574dcf8a7059) }, { ULL(0x7fd6dd517dbdf4c7), ULL(0x13faac3e3fa1f37a) },
+  { ULL(0xffbe2ee8c92fee0b), ULL(0x1ff779fd329cb8c3) }, { ULL(0x6631bf20a0f324d6), ULL(0x1992c7fdc216fa36) },
+  { ULL(0xb827cc1a1a5c1d78), ULL(0x14756ccb01abfb5e) }, { ULL(0x935309ae7b7ce460), ULL(0x105df0a267bcc918) },
+  { ULL(0x1eeb42b0c594a099), ULL(0x1a2fe76a3f9474f4) }, { ULL(0xe58902270476e6e1), ULL(0x14f31f8832dd2a5c) },
+  { ULL(0xb7a0ce859d2bebe7), ULL(0x10c27fa028b0eeb0) }, { ULL(0x59014a6f61dfdfd8), ULL(0x1ad0cc33744e4ab4) },
+  { ULL(0xe0cdd525e7e64cad), ULL(0x1573d68f903ea229) }, { ULL(0x4d7177518651d6f1), ULL(0x11297872d9cbb4ee) },
+  { ULL(0x7be8bee8d6e957e8), ULL(0x1b758d848fac54b0) }, { ULL(0xfcba3253df211320), ULL(0x15f7a46a0c89dd59) },
+  { ULL(0x63c8284318e74280), ULL(0x1192e9ee706e4aae) }, { ULL(0x060d0d3827d86a66), ULL(0x1c1e43171a4a1117) },
+  { ULL(0x6b3da42cecad21eb), ULL(0x167e9c127b6e7412) }, { ULL(0x88fe1cf0bd574e56), ULL(0x11fee341fc585cdb) },
+  { ULL(0x419694b462254a23), ULL(0x1ccb0536608d615f) }, { ULL(0x67abaa29e81dd4e9), ULL(0x1708d0f84d3de77f) },
+  { ULL(0xb95621bb2017dd87), ULL(0x126d73f9d764b932) }, { ULL(0xc223692b668c95a5), ULL(0x1d7becc2f23ac1ea) },
+  { ULL(0xce82ba891ed6de1d), ULL(0x179657025b6234bb) }, { ULL(0xa53562074bdf1818), ULL(0x12deac01e2b4f6fc) },
+  { ULL(0x3b889cd87964f359), ULL(0x1e3113363787f194) }, { ULL(0xfc6d4a46c783f5e1), ULL(0x18274291c6065adc) },
+  { ULL(0x30576e9f06032b1a), ULL(0x13529ba7d19eaf17) }, { ULL(0x1a257dcb3cd1de90), ULL(0x1eea92a61c311825) },
+  { ULL(0x481dfe3c30a7e540), ULL(0x18bba884e35a79b7) }, { ULL(0xd34b31c9c0865100), ULL(0x13c9539d82aec7c5) },
+  { ULL(0x5211e942cda3b4cd), ULL(0x1fa885c8d117a609) }, { ULL(0x74db21023e1c90a4), ULL(0x19539e3a40dfb807) },
+  { ULL(0xf715b401cb4a0d50), ULL(0x1442e4fb67196005) }, { ULL(0xf8de299b09080aa7), ULL(0x103583fc527ab337) },
+  { ULL(0x8e304291a80cddd7), ULL(0x19ef3993b72ab859) }, { ULL(0x3e8d020e200a4b13), ULL(0x14bf6142f8eef9e1) },
+  { ULL(0x653d9b3e80083c0f), ULL(0x10991a9bfa58c7e7) }, { ULL(0x6ec8f864000d2ce4), ULL(0x1a8e90f9908e0ca5) },
+  { ULL(0x8bd3f9e999a423ea), ULL(0x153eda614071a3b7) }, { ULL(0x3ca994bae1501cbb), ULL(0x10ff151a99f482f9) },
+  { ULL(0xc775bac49bb3612b), ULL(0x1b31bb5dc320d18e) }, { ULL(0xd2c4956a16291a89), ULL(0x15c162b168e70e0b) },
+  { ULL(0xdbd0778811ba7ba1), ULL(0x11678227871f3e6f) }, { ULL(0x2c80bf401c5d929b), ULL(0x1bd8d03f3e9863e6) },
+  { ULL(0xbd33cc3349e47549), ULL(0x16470cff6546b651) }, { ULL(0xca8fd68f6e505dd4), ULL(0x11d270cc51055ea7) },
+  { ULL(0x4419574be3b3c953), ULL(0x1c83e7ad4e6efdd9) }, { ULL(0x0347790982f63aa9), ULL(0x16cfec8aa52597e1) },
+  { ULL(0xcf6c60d468c4fbba), ULL(0x123ff06eea847980) }, { ULL(0xe57a34870e07f92a), ULL(0x1d331a4b10d3f59a) },
+  { ULL(0x512e906c0b399422), ULL(0x175c1508da432ae2) }, { ULL(0xda8ba6bcd5c7a9b5), ULL(0x12b010d3e1cf5581) },
+  { ULL(0x90df712e22d90f87), ULL(0x1de6815302e5559c) }, { ULL(0xda4c5a8b4f140c6c), ULL(0x17eb9aa8cf1dde16) },
+  { ULL(0xaea37ba2a5a9a38a), ULL(0x1322e220a5b17e78) }, { ULL(0x7dd25f6aa2a905a9), ULL(0x1e9e369aa2b59727) },
+  { ULL(0x97db7f888220d154), ULL(0x187e92154ef7ac1f) }, { ULL(0x797c6606ce80a777), ULL(0x139874ddd8c6234c) },
+  { ULL(0x8f2d700ae4010bf1), ULL(0x1f5a549627a36bad) }, { ULL(0x0c2459a25000d65a), ULL(0x191510781fb5efbe) },
+  { ULL(0x701d1481d99a4515), ULL(0x1410d9f9b2f7f2fe) }, { ULL(0xc017439b147b6a77), ULL(0x100d7b2e28c65bfe) },
+  { ULL(0xccf205c4ed9243f2), ULL(0x19af2b7d0e0a2cca) }, { ULL(0x0a5b37d0be0e9cc2), ULL(0x148c22ca71a1bd6f) },
+  { ULL(0x0848f973cb3ee3ce), ULL(0x10701bd527b4978c) }, { ULL(0xda0e5bec78649fb0), ULL(0x1a4cf9550c5425ac) },
+  { ULL(0x7b3eaff060507fc0), ULL(0x150a6110d6a9b7bd) }, { ULL(0x95cbbff380406633), ULL(0x10d51a73deee2c97) },
+  { ULL(0xefac665266cd7052), ULL(0x1aee90b964b04758) }, { ULL(0x2623850eb8a459db), ULL(0x158ba6fab6f36c47) },
+  { ULL(0x1e82d0d893b6ae49), ULL(0x113c85955f29236c) }, { ULL(0xfd9e1af41f8ab075), ULL(0x1b9408eefea838ac) },
+  { ULL(0x97b1af29b2d559f7), ULL(0x16100725988693bd) }, { ULL(0xac8e25baf5777b2c), ULL(0x11a66c1e139edc97) },
+  { ULL(0x7a7d092b2258c513), ULL(0x1c3d79c9b8fe2dbf) }, { ULL(0x61fda0ef4ead6a76), ULL(0x169794a160cb57cc) },
+  { ULL(0xe7fe1a590bbdeec5), ULL(0x1212dd4de7091309) }, { ULL(0xa6635d5b45fcb13a), ULL(0x1ceafbafd80e84dc) },
+  { ULL(0x851c4aaf6b308dc8), ULL(0x172262f3133ed0b0) }, { ULL(0xd0e36ef2bc26d7d4), ULL(0x1281e8c275cbda26) },
+  { ULL(0xb49f17eac6a48c86), ULL(0x1d9ca79d894629d7) }, { ULL(0x2a18dfef0550706b), ULL(0x17b08617a104ee46) },
+  { ULL(0x54e0b3259dd9f389), ULL(0x12f39e794d9d8b6b) }, { ULL(0x87cdeb6f62f65274), ULL(0x1e5297287c2f4578) },
+  { ULL(0xd30b22bf825ea85d), ULL(0x18421286c9bf6ac6) }, { ULL(0x0f3c1bcc684bb9e4), ULL(0x13680ed23aff889f) },
+  { ULL(0x18602c7a4079296d), ULL(0x1f0ce4839198da98) }, { ULL(0x46b356c833942124), ULL(0x18d71d360e13e213) },
+  { ULL(0x388f78a029434db6), ULL(0x13df4a91a4dcb4dc) }, { ULL(0x5a7f2766a86baf8a), ULL(0x1fcbaa82a1612160) },
+  { ULL(0x153285ebb9efbfa2), ULL(0x196fbb9bb44db44d) }, { ULL(0xaa8ed189618c994e), ULL(0x145962e2f6a4903d) },
+  { ULL(0xeed8a7a11ad6e10c), ULL(0x1047824f2bb6d9ca) }, { ULL(0x7e27729b5e249b45), ULL(0x1a0c03b1df8af611) },
+  { ULL(0xfe85f549181d4904), ULL(0x14d6695b193bf80d) }, { ULL(0xcb9e5dd4134aa0d0), ULL(0x10ab877c142ff9a4) },
+  { ULL(0xdf63c9535211014d), ULL(0x1aac0bf9b9e65c3a) }, { ULL(0x191ca10f74da6771), ULL(0x15566ffafb1eb02f) },
+  { ULL(0xadb080d92a4852c1), ULL(0x1111f32f2f4bc025) }, { ULL(0x15e7348eaa0d5134), ULL(0x1b4feb7eb212cd09) },
+  { ULL(0xab1f5d3eee710dc4), ULL(0x15d98932280f0a6d) }, { ULL(0xbc1917658b8da49d), ULL(0x117ad428200c0857) },
+  { ULL(0x2cf4f23c127c3a94), ULL(0x1bf7b9d9cce00d59) }, { ULL(0xf0c3f4fcdb969543), ULL(0x165fc7e170b33de0) },
+  { ULL(0x5a365d9716121103), ULL(0x11e6398126f5cb1a) }, { ULL(0x9056fc24f01ce804), ULL(0x1ca38f350b22de90) },
+  { ULL(0xd9df301d8ce3ecd0), ULL(0x16e93f5da2824ba6) }, { ULL(0xe17f59b13d8323da), ULL(0x125432b14ecea2eb) },
+  { ULL(0x68cbc2b52f38395c), ULL(0x1d53844ee47dd179) }, { ULL(0x53d6355dbf602de3), ULL(0x177603725064a794) },
+  { ULL(0xa9782ab165e68b1c), ULL(0x12c4cf8ea6b6ec76) }, { ULL(0x0f26aab56fd744fa), ULL(0x1e07b27dd78b13f1) },
+  { ULL(0x3f52222abfdf6a62), ULL(0x18062864ac6f4327) }, { ULL(0x65db4e88997f884e), ULL(0x1338205089f29c1f) },
+  { ULL(0x6fc54a7428cc0d4a), ULL(0x1ec033b40fea9365) }, { ULL(0x596aa1f68709a43b), ULL(0x1899c2f673220f84) },
+  { ULL(0xadeee7f86c07b696), ULL(0x13ae3591f5b4d936) }, { ULL(0x497e3ff3e00c5756), ULL(0x1f7d228322baf524) },
+  { ULL(0xd464fff64cd6ac45), ULL(0x1930e868e89590e9) }, { ULL(0x4383fff83d7889d1), ULL(0x14272053ed4473ee) },
+  { ULL(0xcf9cccc69793a174), ULL(0x101f4d0ff1038ff1) }, { ULL(0x7f6147a425b90252), ULL(0x19cbae7fe805b31c) },
+  { ULL(0xcc4dd2e9b7c7350f), ULL(0x14a2f1ffecd15c16) }, { ULL(0x3d0b0f215fd290d9), ULL(0x10825b3323dab012) },
+  { ULL(0x61ab4b689950e7c1), ULL(0x1a6a2b85062ab350) }, { ULL(0x4e22a2ba1440b967), ULL(0x1521bc6a6b555c40) },
+  { ULL(0x0b4ee894dd009453), ULL(0x10e7c9eebc4449cd) }, { ULL(0x1217da87c800ed51), ULL(0x1b0c764ac6d3a948) },
+  { ULL(0xdb46486ca000bdda), ULL(0x15a391d56bdc876c) }, { ULL(0x490506bd4ccd64af), ULL(0x114fa7ddefe39f8a) },
+  { ULL(0xa8080ac87ae23ab1), ULL(0x1bb2a62fe638ff43) }, { ULL(0x5339a239fbe82ef4), ULL(0x162884f31e93ff69) },
+  { ULL(0x75c7b4fb2fecf25d), ULL(0x11ba03f5b20fff87) }, { ULL(0x22d92191e647ea2e), ULL(0x1c5cd322b67fff3f) },
+  { ULL(0xb57a8141850654f2), ULL(0x16b0a8e891ffff65) }, { ULL(0xc4620101373843f5), ULL(0x1226ed86db3332b7) },
+  { ULL(0x3a366801f1f39fee), ULL(0x1d0b15a491eb8459) }, { ULL(0xfb5eb99b27f6198b), ULL(0x173c115074bc69e0) },
+  { ULL(0x2f7efae2865e7ad6), ULL(0x129674405d6387e7) }, { ULL(0xe597f7d0d6fd9156), ULL(0x1dbd86cd6238d971) },
+  { ULL(0x8479930d78cadaab), ULL(0x17cad23de82d7ac1) }, { ULL(0xd06142712d6f1556), ULL(0x1308a831868ac89a) },
+  { ULL(0x4d686a4eaf182222), ULL(0x1e74404f3daada91) }, { ULL(0xa453883ef279b4e8), ULL(0x185d003f6488aeda) },
+  { ULL(0xe9dc6cff28615d87), ULL(0x137d99cc506d58ae) }, { ULL(0xa960ae650d6895a4), ULL(0x1f2f5c7a1a488de4) },
+  { ULL(0xbab3beb73ded4483), ULL(0x18f2b061aea07183) }
+};
+
+static const uint64 _Stl_pow5_split[326][2] = {
+  { ULL(0x0000000000000000), ULL(0x1000000000000000) }, { ULL(0x0000000000000000), ULL(0x1400000000000000) },
+  { ULL(0x0000000000000000), ULL(0x1900000000000000) }, { ULL(0x0000000000000000), ULL(0x1f40000000000000) },
+  { ULL(0x0000000000000000), ULL(0x1388000000000000) }, { ULL(0x0000000000000000), ULL(0x186a000000000000) },
+  { ULL(0x0000000000000000), ULL(0x1e84800000000000) }, { ULL(0x0000000000000000), ULL(0x1312d00000000000) },
+  { ULL(0x0000000000000000), ULL(0x17d7840000000000) }, { ULL(0x0000000000000000), ULL(0x1dcd650000000000) },
+  { ULL(0x0000000000000000), ULL(0x12a05f2000000000) }, { ULL(0x0000000000000000), ULL(0x174876e800000000) },
+  { ULL(0x0000000000000000), ULL(0x1d1a94a200000000) }, { ULL(0x0000000000000000), ULL(0x12309ce540000000) },
+  { ULL(0x0000000000000000), ULL(0x16bcc41e90000000) }, { ULL(0x0000000000000000), ULL(0x1c6bf52634000000) },
+  { ULL(0x0000000000000000), ULL(0x11c37937e0800000) }, { ULL(0x0000000000000000), ULL(0x16345785d8a00000) },
+  { ULL(0x0000000000000000), ULL(0x1bc16d674ec80000) }, { ULL(0x0000000000000000), ULL(0x1158e460913d0000) },
+  { ULL(0x0000000000000000), ULL(0x15af1d78b58c4000) }, { ULL(0x0000000000000000), ULL(0x1b1ae4d6e2ef5000) },
+  { ULL(0x0000000000000000), ULL(0x10f0cf064dd59200) }, { ULL(0x0000000000000000), ULL(0x152d02c7e14af680) },
+  { ULL(0x0000000000000000), ULL(0x1a784379d99db420) }, { ULL(0x0000000000000000), ULL(0x108b2a2c28029094) },
+  { ULL(0x0000000000000000), ULL(0x14adf4b7320334b9) }, { ULL(0x4000000000000000), ULL(0x19d971e4fe8401e7) },
+  { ULL(0x8800000000000000), ULL(0x1027e72f1f128130) }, { ULL(0xaa00000000000000), ULL(0x1431e0fae6d7217c) },
+  { ULL(0xd480000000000000), ULL(0x193e5939a08ce9db) }, { ULL(0xc9a0000000000000), ULL(0x1f8def8808b02452) },
+  { ULL(0xbe04000000000000), ULL(0x13b8b5b5056e16b3) }, { ULL(0xad85000000000000), ULL(0x18a6e32246c99c60) },
+  { ULL(0xd8e6400000000000), ULL(0x1ed09bead87c0378) }, { ULL(0x878fe80000000000), ULL(0x13426172c74d822b) },
+  { ULL(0x6973e20000000000), ULL(0x1812f9cf7920e2b6) }, { ULL(0x03d0da8000000000), ULL(0x1e17b84357691b64) },
+  { ULL(0x8262889000000000), ULL(0x12ced32a16a1b11e) }, { ULL(0x22fb2ab400000000), ULL(0x178287f49c4a1d66) },
+  { ULL(0xabb9f56100000000), ULL(0x1d6329f1c35ca4bf) }, { ULL(0xcb54395ca0000000), ULL(0x125dfa371a19e6f7) },
+  { ULL(0xbe2947b3c8000000), ULL(0x16f578c4e0a060b5) }, { ULL(0x2db399a0ba000000), ULL(0x1cb2d6f618c878e3) },
+  { ULL(0xfc90400474400000), ULL(0x11efc659cf7d4b8d) }, { ULL(0x7bb4500591500000), ULL(0x166bb7f0435c9e71) },
+  { ULL(0xdaa16406f5a40000), ULL(0x1c06a5ec5433c60d) }, { ULL(0xa8a4de8459868000), ULL(0x118427b3b4a05bc8) },
+  { ULL(0xd2ce16256fe82000), ULL(0x15e531a0a1c872ba) }, { ULL(0x87819baecbe22800), ULL(0x1b5e7e08ca3a8f69) },
+  { ULL(0xf4b1014d3f6d5900), ULL(0x111b0ec57e6499a1) }, { ULL(0x71dd41a08f48af40), ULL(0x1561d276ddfdc00a) },
+  { ULL(0x0e549208b31adb10), ULL(0x1aba4714957d300d) }, { ULL(0x28f4db456ff0c8ea), ULL(0x10b46c6cdd6e3e08) },
+  { ULL(0x33321216cbecfb24), ULL(0x14e1878814c9cd8a) }, { ULL(0xbffe969c7ee839ed), ULL(0x1a19e96a19fc40ec) },
+  { ULL(0xf7ff1e21cf512434), ULL(0x105031e2503da893) }, { ULL(0xf5fee5aa43256d41), ULL(0x14643e5ae44d12b8) },
+  { ULL(0x337e9f14d3eec892), ULL(0x197d4df19d605767) }, { ULL(0x005e46da08ea7ab6), ULL(0x1fdca16e04b86d41) },
+  { ULL(0xa03aec4845928cb2), ULL(0x13e9e4e4c2f34448) }, { ULL(0xc849a75a56f72fde), ULL(0x18e45e1df3b0155a) },
+  { ULL(0x7a5c1130ecb4fbd6), ULL(0x1f1d75a5709c1ab1) }, { ULL(0xec798abe93f11d65), ULL(0x13726987666190ae) },
+  { ULL(0xa797ed6e38ed64bf), ULL(0x184f03e93ff9f4da) }, { ULL(0x517de8c9c728bdef), ULL(0x1e62c4e38ff87211) },
+  { ULL(0xd2eeb17e1c7976b5), ULL(0x12fdbb0e39fb474a) }, { ULL(0x87aa5ddda397d462), ULL(0x17bd29d1c87a191d) },
+  { ULL(0xe994f5550c7dc97b), ULL(0x1dac74463a989f64) }, { ULL(0x11fd195527ce9ded), ULL(0x128bc8abe49f639f) },
+  { ULL(0xd67c5faa71c24568), ULL(0x172ebad6ddc73c86) }, { ULL(0x8c1b77950e32d6c2), ULL(0x1cfa698c95390ba8) },
+  { ULL(0x57912abd28dfc639), ULL(0x121c81f7dd43a749) }, { ULL(0xad75756c7317b7c8), ULL(0x16a3a275d494911b) },
+  { ULL(0x98d2d2c78fdda5ba), ULL(0x1c4c8b1349b9b562) }, { ULL(0x9f83c3bcb9ea8794), ULL(0x11afd6ec0e14115d) },
+  { ULL(0x0764b4abe8652979), ULL(0x161bcca7119915b5) }, { ULL(0x493de1d6e27e73d7), ULL(0x1ba2bfd0d5ff5b22) },
+  { ULL(0x6dc6ad264d8f0866), ULL(0x1145b7e285bf98f5) }, { ULL(0xc938586fe0f2ca80), ULL(0x159725db272f7f32) },
+  { ULL(0x7b866e8bd92f7d20), ULL(0x1afcef51f0fb5eff) }, { ULL(0xad34051767bdae34), ULL(0x10de1593369d1b5f) },
+  { ULL(0x9881065d41ad19c1), ULL(0x15159af804446237) }, { ULL(0x7ea147f492186032), ULL(0x1a5b01b605557ac5) },
+  { ULL(0x6f24ccf8db4f3c1f), ULL(0x1078e111c3556cbb) }, { ULL(0x4aee003712230b27), ULL(0x14971956342ac7ea) },
+  { ULL(0xdda98044d6abcdf0), ULL(0x19bcdfabc13579e4) }, { ULL(0x0a89f02b062b60b6), ULL(0x10160bcb58c16c2f) },
+  { ULL(0xcd2c6c35c7b638e4), ULL(0x141b8ebe2ef1c73a) }, { ULL(0x8077874339a3c71d), ULL(0x1922726dbaae3909) },
+  { ULL(0xe0956914080cb8e4), ULL(0x1f6b0f092959c74b) }, { ULL(0x6c5d61ac8507f38e), ULL(0x13a2e965b9d81c8f) },
+  { ULL(0x4774ba17a649f072), ULL(0x188ba3bf284e23b3) }, { ULL(0x1951e89d8fdc6c8f), ULL(0x1eae8caef261aca0) },
+  { ULL(0x0fd3316279e9c3d9), ULL(0x132d17ed577d0be4) }, { ULL(0x13c7fdbb186434cf), ULL(0x17f85de8ad5c4edd) },
+  { ULL(0x58b9fd29de7d4203), ULL(0x1df67562d8b36294) }, { ULL(0xb7743e3a2b0e4942), ULL(0x12ba095dc7701d9c) },
+  { ULL(0xe5514dc8b5d1db92), ULL(0x17688bb5394c2503) }, { ULL(0xdea5a13ae3465277), ULL(0x1d42aea2879f2e44) },
+  { ULL(0x0b2784c4ce0bf38a), ULL(0x1249ad2594c37ceb) }, { ULL(0xcdf165f6018ef06d), ULL(0x16dc186ef9f45c25) },
+  { ULL(0x416dbf7381f2ac88), ULL(0x1c931e8ab871732f) }, { ULL(0x88e497a83137abd5), ULL(0x11dbf316b346e7fd) },
+  { ULL(0xeb1dbd923d8596ca), ULL(0x1652efdc6018a1fc) }, { ULL(0x25e52cf6cce6fc7d), ULL(0x1be7abd3781eca7c) },
+  { ULL(0x97af3c1a40105dce), ULL(0x1170cb642b133e8d) }, { ULL(0xfd9b0b20d0147542), ULL(0x15ccfe3d35d80e30) },
+  { ULL(0x3d01cde904199292), ULL(0x1b403dcc834e11bd) }, { ULL(0x462120b1a28ffb9b), ULL(0x1108269fd210cb16) },
+  { ULL(0xd7a968de0b33fa82), ULL(0x154a3047c694fddb) }, { ULL(0xcd93c3158e00f923), ULL(0x1a9cbc59b83a3d52) },
+  { ULL(0xc07c59ed78c09bb6), ULL(0x10a1f5b813246653) }, { ULL(0xb09b7068d6f0c2a3), ULL(0x14ca732617ed7fe8) },
+  { ULL(0xdcc24c830cacf34c), ULL(0x19fd0fef9de8dfe2) }, { ULL(0xc9f96fd1e7ec180f), ULL(0x103e29f5c2b18bed) },
+  { ULL(0x3c77cbc661e71e13), ULL(0x144db473335deee9) }, { ULL(0x8b95beb7fa60e598), ULL(0x1961219000356aa3) },
+  { ULL(0x6e7b2e65f8f91efe), ULL(0x1fb969f40042c54c) }, { ULL(0xc50cfcffbb9bb35f), ULL(0x13d3e2388029bb4f) },
+  { ULL(0xb6503c3faa82a037), ULL(0x18c8dac6a0342a23) }, { ULL(0xa3e44b4f95234844), ULL(0x1efb1178484134ac) },
+  { ULL(0xe66eaf11bd360d2b), ULL(0x135ceaeb2d28c0eb) }, { ULL(0xe00a5ad62c839075), ULL(0x183425a5f872f126) },
+  { ULL(0x980cf18bb7a47493), ULL(0x1e412f0f768fad70) }, { ULL(0x5f0816f752c6c8dc), ULL(0x12e8bd69aa19cc66) },
+  { ULL(0xf6ca1cb527787b13), ULL(0x17a2ecc414a03f7f) }, { ULL(0xf47ca3e2715699d7), ULL(0x1d8ba7f519c84f5f) },
+  { ULL(0xf8cde66d86d62026), ULL(0x127748f9301d319b) }, { ULL(0xf7016008e88ba830), ULL(0x17151b377c247e02) },
+  { ULL(0xb4c1b80b22ae923c), ULL(0x1cda62055b2d9d83) }, { ULL(0x50f91306f5ad1b65), ULL(0x12087d4358fc8272) },
+  { ULL(0xe53757c8b318623f), ULL(0x168a9c942f3ba30e) }, { ULL(0x9e852dbadfde7acf), ULL(0x1c2d43b93b0a8bd2) },
+  { ULL(0xa3133c94cbeb0cc1), ULL(0x119c4a53c4e69763) }, { ULL(0x8bd80bb9fee5cff1), ULL(0x16035ce8b6203d3c) },
+  { ULL(0xaece0ea87e9f43ee), ULL(0x1b843422e3a84c8b) }, { ULL(0x4d40c9294f238a75), ULL(0x1132a095ce492fd7) },
+  { ULL(0x2090fb73a2ec6d12), ULL(0x157f48bb41db7bcd) }, { ULL(0x68b53a508ba78856), ULL(0x1adf1aea12525ac0) },
+  { ULL(0x417144725748b536), ULL(0x10cb70d24b7378b8) }, { ULL(0x51cd958eed1ae283), ULL(0x14fe4d06de5056e6) },
+  { ULL(0xe640faf2a8619b24), ULL(0x1a3de04895e46c9f) }, { ULL(0xefe89cd7a93d00f7), ULL(0x1066ac2d5daec3e3) },
+  { ULL(0xebe2c40d938c4134), ULL(0x14805738b51a74dc) }, { ULL(0x26db7510f86f5181), ULL(0x19a06d06e2611214) },
+  { ULL(0x9849292a9b4592f1), ULL(0x100444244d7cab4c) }, { ULL(0xbe5b73754216f7ad), ULL(0x1405552d60dbd61f) },
+  { ULL(0xadf25052929cb598), ULL(0x1906aa78b912cba7) }, { ULL(0x996ee4673743e2ff), ULL(0x1f485516e7577e91) },
+  { ULL(0xffe54ec0828a6ddf), ULL(0x138d352e5096af1a) }, { ULL(0xbfdea270a32d0957), ULL(0x18708279e4bc5ae1) },
+  { ULL(0x2fd64b0ccbf84bad), ULL(0x1e8ca3185deb719a) }, { ULL(0x5de5eee7ff7b2f4c), ULL(0x1317e5ef3ab32700) },
+  { ULL(0x755f6aa1ff59fb1f), ULL(0x17dddf6b095ff0c0) }, { ULL(0x92b7454a7f3079e7), ULL(0x1dd55745cbb7ecf0) },
+  { ULL(0x5bb28b4e8f7e4c30), ULL(0x12a5568b9f52f416) }, { ULL(0xf29f2e22335ddf3c), ULL(0x174eac2e8727b11b) },
+  { ULL(0xef46f9aac035570b), ULL(0x1d22573a28f19d62) }, { ULL(0xd58c5c0ab8215667), ULL(0x123576845997025d) },
+  { ULL(0x4aef730d6629ac01), ULL(0x16c2d4256ffcc2f5) }, { ULL(0x9dab4fd0bfb41701), ULL(0x1c73892ecbfbf3b2) },
+  { ULL(0xa28b11e277d08e60), ULL(0x11c835bd3f7d784f) }, { ULL(0x8b2dd65b15c4b1f9), ULL(0x163a432c8f5cd663) },
+  { ULL(0x6df94bf1db35de77), ULL(0x1bc8d3f7b3340bfc) }, { ULL(0xc4bbcf772901ab0a), ULL(0x115d847ad000877d) },
+  { ULL(0x35eac354f34215cd), ULL(0x15b4e5998400a95d) }, { ULL(0x8365742a30129b40), ULL(0x1b221effe500d3b4) },
+  { ULL(0xd21f689a5e0ba108), ULL(0x10f5535fef208450) }, { ULL(0x06a742c0f58e894a), ULL(0x1532a837eae8a565) },
+  { ULL(0x4851137132f22b9d), ULL(0x1a7f5245e5a2cebe) }, { ULL(0xed32ac26bfd75b42), ULL(0x108f936baf85c136) },
+  { ULL(0xa87f57306fcd3212), ULL(0x14b378469b673184) }, { ULL(0xd29f2cfc8bc07e97), ULL(0x19e056584240fde5) },
+  { ULL(0xa3a37c1dd7584f1e), ULL(0x102c35f729689eaf) }, { ULL(0x8c8c5b254d2e62e6), ULL(0x14374374f3c2c65b) },
+  { ULL(0x6faf71eea079fb9f), ULL(0x1945145230b377f2) }, { ULL(0x0b9b4e6a48987a87), ULL(0x1f965966bce055ef) },
+  { ULL(0x674111026d5f4c94), ULL(0x13bdf7e0360c35b5) }, { ULL(0xc111554308b71fba), ULL(0x18ad75d8438f4322) },
+  { ULL(0x7155aa93cae4e7a8), ULL(0x1ed8d34e547313eb) }, { ULL(0x26d58a9c5ecf10c9), ULL(0x13478410f4c7ec73) },
+  { ULL(0xf08aed437682d4fb), ULL(0x1819651531f9e78f) }, { ULL(0xecada89454238a3a), ULL(0x1e1fbe5a7e786173) },
+  { ULL(0x73ec895cb4963664), ULL(0x12d3d6f88f0b3ce8) }, { ULL(0x90e7abb3e1bbc3fd), ULL(0x1788ccb6b2ce0c22) },
+  { ULL(0x352196a0da2ab4fd), ULL(0x1d6affe45f818f2b) }, { ULL(0x0134fe24885ab11e), ULL(0x1262dfeebbb0f97b) },
+  { ULL(0xc1823dadaa715d65), ULL(0x16fb97ea6a9d37d9) }, { ULL(0x31e2cd19150db4bf), ULL(0x1cba7de5054485d0) },
+  { ULL(0x1f2dc02fad2890f7), ULL(0x11f48eaf234ad3a2) }, { ULL(0xa6f9303b9872b535), ULL(0x1671b25aec1d888a) },
+  { ULL(0x50b77c4a7e8f6282), ULL(0x1c0e1ef1a724eaad) }, { ULL(0x5272adae8f199d91), ULL(0x1188d357087712ac) },
+  { ULL(0x670f591a32e004f6), ULL(0x15eb082cca94d757) }, { ULL(0x40d32f60bf980633), ULL(0x1b65ca37fd3a0d2d) },
+  { ULL(0x4883fd9c77bf03e0), ULL(0x111f9e62fe44483c) }, { ULL(0x5aa4fd0395aec4d8), ULL(0x156785fbbdd55a4b) },
+  { ULL(0x314e3c447b1a760e), ULL(0x1ac1677aad4ab0de) }, { ULL(0xded0e5aaccf089c9), ULL(0x10b8e0acac4eae8a) },
+  { ULL(0x96851f15802cac3b), ULL(0x14e718d7d7625a2d) }, { ULL(0xfc2666dae037d74a), ULL(0x1a20df0dcd3af0b8) },
+  { ULL(0x9d980048cc22e68e), ULL(0x10548b68a044d673) }, { ULL(0x84fe005aff2ba032), ULL(0x1469ae42c8560c10) },
+  { ULL(0xa63d8071bef6883e), ULL(0x198419d37a6b8f14) }, { ULL(0xcfcce08e2eb42a4e), ULL(0x1fe52048590672d9) },
+  { ULL(0x21e00c58dd309a70), ULL(0x13ef342d37a407c8) }, { ULL(0x2a580f6f147cc10d), ULL(0x18eb0138858d09ba) },
+  { ULL(0xb4ee134ad99bf150), ULL(0x1f25c186a6f04c28) }, { ULL(0x7114cc0ec80176d2), ULL(0x137798f428562f99) },
+  { ULL(0xcd59ff127a01d486), ULL(0x18557f31326bbb7f) }, { ULL(0xc0b07ed7188249a8), ULL(0x1e6adefd7f06aa5f) },
+  { ULL(0xd86e4f466f516e09), ULL(0x1302cb5e6f642a7b) }, { ULL(0xce89e3180b25c98b), ULL(0x17c37e360b3d351a) },
+  { ULL(0x822c5bde0def3bee), ULL(0x1db45dc38e0c8261) }, { ULL(0xf15bb96ac8b58575), ULL(0x1290ba9a38c7d17c) },
+  { ULL(0x2db2a7c57ae2e6d2), ULL(0x1734e940c6f9c5dc) }, { ULL(0x391f51b6d99ba086), ULL(0x1d022390f8b83753) },
+  { ULL(0x03b3931248014454), ULL(0x1221563a9b732294) }, { ULL(0x04a077d6da019569), ULL(0x16a9abc9424feb39) },
+  { ULL(0x45c895cc9081fac3), ULL(0x1c5416bb92e3e607) }, { ULL(0x8b9d5d9fda513cba), ULL(0x11b48e353bce6fc4) },
+  { ULL(0xae84b507d0e58be8), ULL(0x1621b1c28ac20bb5) }, { ULL(0x1a25e249c51eeee3), ULL(0x1baa1e332d728ea3) },
+  { ULL(0xf057ad6e1b33554d), ULL(0x114a52dffc679925) }, { ULL(0x6c6d98c9a2002aa1), ULL(0x159ce797fb817f6f) },
+  { ULL(0x4788fefc0a803549), ULL(0x1b04217dfa61df4b) }, { ULL(0x0cb59f5d8690214e), ULL(0x10e294eebc7d2b8f) },
+  { ULL(0xcfe30734e83429a1), ULL(0x151b3a2a6b9c7672) }, { ULL(0x83dbc9022241340a), ULL(0x1a6208b50683940f) },
+  { ULL(0xb2695da15568c086), ULL(0x107d457124123c89) }, { ULL(0x1f03b509aac2f0a7), ULL(0x149c96cd6d16cbac) },
+  { ULL(0x26c4a24c1573acd1), ULL(0x19c3bc80c85c7e97) }, { ULL(0x783ae56f8d684c03), ULL(0x101a55d07d39cf1e) },
+  { ULL(0x16499ecb70c25f03), ULL(0x1420eb449c8842e6) }, { ULL(0x9bdc067e4cf2f6c4), ULL(0x19292615c3aa539f) },
+  { ULL(0x82d3081de02fb476), ULL(0x1f736f9b3494e887) }, { ULL(0xb1c3e512ac1dd0c9), ULL(0x13a825c100dd1154) },
+  { ULL(0xde34de57572544fc), ULL(0x18922f31411455a9) }, { ULL(0x55c215ed2cee963b), ULL(0x1eb6bafd91596b14) },
+  { ULL(0xb5994db43c151de5), ULL(0x133234de7ad7e2ec) }, { ULL(0xe2ffa1214b1a655e), ULL(0x17fec216198ddba7) },
+  { ULL(0xdbbf89699de0feb6), ULL(0x1dfe729b9ff15291) }, { ULL(0x2957b5e202ac9f31), ULL(0x12bf07a143f6d39b) },
+  { ULL(0xf3ada35a8357c6fe), ULL(0x176ec98994f48881) }, { ULL(0x70990c31242db8bd), ULL(0x1d4a7bebfa31aaa2) },
+  { ULL(0x865fa79eb69c9376), ULL(0x124e8d737c5f0aa5) }, { ULL(0xe7f791866443b854), ULL(0x16e230d05b76cd4e) },
+  { ULL(0xa1f575e7fd54a669), ULL(0x1c9abd04725480a2) }, { ULL(0xa53969b0fe54e801), ULL(0x11e0b622c774d065) },
+  { ULL(0x0e87c41d3dea2202), ULL(0x1658e3ab7952047f) }, { ULL(0xd229b5248d64aa82), ULL(0x1bef1c9657a6859e) },
+  { ULL(0x435a1136d85eea91), ULL(0x117571ddf6c81383) }, { ULL(0x143095848e76a536), ULL(0x15d2ce55747a1864) },
+  { ULL(0x193cbae5b2144e83), ULL(0x1b4781ead1989e7d) }, { ULL(0x2fc5f4cf8f4cb112), ULL(0x110cb132c2ff630e) },
+  { ULL(0xbbb77203731fdd56), ULL(0x154fdd7f73bf3bd1) }, { ULL(0x2aa54e844fe7d4ac), ULL(0x1aa3d4df50af0ac6) },
+  { ULL(0xdaa75112b1f0e4eb), ULL(0x10a6650b926d66bb) }, { ULL(0xd15125575e6d1e26), ULL(0x14cffe4e7708c06a) },
+  { ULL(0x85a56ead360865b0), ULL(0x1a03fde214caf085) }, { ULL(0x7387652c41c53f8e), ULL(0x10427ead4cfed653) },
+  { ULL(0x50693e7752368f71), ULL(0x14531e58a03e8be8) }, { ULL(0x64838e1526c4334e), ULL(0x1967e5eec84e2ee2) },
+  { ULL(0xfda4719a70754022), ULL(0x1fc1df6a7a61ba9a) }, { ULL(0xde86c70086494815), ULL(0x13d92ba28c7d14a0) },
+  { ULL(0x162878c0a7db9a1a), ULL(0x18cf768b2f9c59c9) }, { ULL(0x5bb296f0d1d280a1), ULL(0x1f03542dfb83703b) },
+  { ULL(0x194f9e5683239064), ULL(0x1362149cbd322625) }, { ULL(0x5fa385ec23ec747e), ULL(0x183a99c3ec7eafae) },
+  { ULL(0xf78c67672ce7919d), ULL(0x1e494034e79e5b99) }, { ULL(0x3ab7c0a07c10bb02), ULL(0x12edc82110c2f940) },
+  { ULL(0x4965b0c89b14e9c3), ULL(0x17a93a2954f3b790) }, { ULL(0x5bbf1cfac1da2433), ULL(0x1d9388b3aa30a574) },
+  { ULL(0xb957721cb92856a0), ULL(0x127c35704a5e6768) }, { ULL(0xe7ad4ea3e7726c48), ULL(0x171b42cc5cf60142) },
+  { ULL(0xa198a24ce14f075a), ULL(0x1ce2137f74338193) }, { ULL(0x44ff65700cd16498), ULL(0x120d4c2fa8a030fc) },
+  { ULL(0x563f3ecc1005bdbe), ULL(0x16909f3b92c83d3b) }, { ULL(0x2bcf0e7f14072d2e), ULL(0x1c34c70a777a4c8a) },
+  { ULL(0x5b61690f6c847c3d), ULL(0x11a0fc668aac6fd6) }, { ULL(0xf239c35347a59b4c), ULL(0x16093b802d578bcb) },
+  { ULL(0xeec83428198f021f), ULL(0x1b8b8a6038ad6ebe) }, { ULL(0x553d20990ff96153), ULL(0x1137367c236c6537) },
+  { ULL(0x2a8c68bf53f7b9a8), ULL(0x1585041b2c477e85) }, { ULL(0x752f82ef28f5a812), ULL(0x1ae64521f7595e26) },
+  { ULL(0x093db1d57999890b), ULL(0x10cfeb353a97dad8) }, { ULL(0x0b8d1e4ad7ffeb4e), ULL(0x1503e602893dd18e) },
+  { ULL(0x8e7065dd8dffe622), ULL(0x1a44df832b8d45f1) }, { ULL(0xf9063faa78bfefd5), ULL(0x106b0bb1fb384bb6) },
+  { ULL(0xb747cf9516efebca), ULL(0x1485ce9e7a065ea4) }, { ULL(0xe519c37a5cabe6bd), ULL(0x19a742461887f64d) },
+  { ULL(0xaf301a2c79eb7036), ULL(0x1008896bcf54f9f0) }, { ULL(0xdafc20b798664c43), ULL(0x140aabc6c32a386c) },
+  { ULL(0x11bb28e57e7fdf54), ULL(0x190d56b873f4c688) }, { ULL(0x1629f31ede1fd72a), ULL(0x1f50ac6690f1f82a) },
+  { ULL(0x4dda37f34ad3e67a), ULL(0x13926bc01a973b1a) }, { ULL(0xe150c5f01d88e019), ULL(0x187706b0213d09e0) },
+  { ULL(0x19a4f76c24eb181f), ULL(0x1e94c85c298c4c59) }, { ULL(0xb0071aa39712ef13), ULL(0x131cfd3999f7afb7) },
+  { ULL(0x9c08e14c7cd7aad8), ULL(0x17e43c8800759ba5) }, { ULL(0x030b199f9c0d958e), ULL(0x1ddd4baa0093028f) },
+  { ULL(0x61e6f003c1887d79), ULL(0x12aa4f4a405be199) }, { ULL(0xba60ac04b1ea9cd7), ULL(0x1754e31cd072d9ff) },
+  { ULL(0xa8f8d705de65440d), ULL(0x1d2a1be4048f907f) }, { ULL(0xc99b8663aaff4a88), ULL(0x123a516e82d9ba4f) },
+  { ULL(0xbc0267fc95bf1d2a), ULL(0x16c8e5ca239028e3) }, { ULL(0xab0301fbbb2ee474), ULL(0x1c7b1f3cac74331c) },
+  { ULL(0xeae1e13d54fd4ec9), ULL(0x11ccf385ebc89ff1) }, { ULL(0x659a598caa3ca27b), ULL(0x1640306766bac7ee) },
+  { ULL(0xff00efefd4cbcb1a), ULL(0x1bd03c81406979e9) }, { ULL(0x3f6095f5e4ff5ef0), ULL(0x116225d0c841ec32) },
+  { ULL(0xcf38bb735e3f36ac), ULL(0x15baaf44fa52673e) }, { ULL(0x8306ea5035cf0457), ULL(0x1b295b1638e7010e) },
+  { ULL(0x11e4527221a162b6), ULL(0x10f9d8ede39060a9) }, { ULL(0x565d670eaa09bb64), ULL(0x15384f295c7478d3) },
+  { ULL(0x2bf4c0d2548c2a3d), ULL(0x1a8662f3b3919708) }, { ULL(0x1b78f88374d79a66), ULL(0x1093fdd8503afe65) },
+  { ULL(0x625736a4520d8100), ULL(0x14b8fd4e6449bdfe) }, { ULL(0xfaed044d6690e140), ULL(0x19e73ca1fd5c2d7d) },
+  { ULL(0xbcd422b0601a8cc8), ULL(0x103085e53e599c6e) }, { ULL(0x6c092b5c78212ffa), ULL(0x143ca75e8df0038a) },
+  { ULL(0x070b763396297bf8), ULL(0x194bd136316c046d) }, { ULL(0x48ce53c07bb3daf6), ULL(0x1f9ec583bdc70588) },
+  { ULL(0x2d80f4584d5068da), ULL(0x13c33b72569c6375) }, { ULL(0x78e1316e60a48310), ULL(0x18b40a4eec437c52) }
+};
+
+// Upper 64 bits of the 128-bit product.
+static inline uint64 _Stl_umulh(uint64 __a, uint64 __b) {
+#if defined (__SIZEOF_INT128__)
+  return (uint64)(((unsigned __int128)__a * __b) >> 64);
+#else
+  const uint64 __low_mask = ULL(0xffffffff);
+  uint64 __a0 = __a & __low_mask, __a1 = __a >> 32;
+  uint64 __b0 = __b & __low_mask, __b1 = __b >> 32;
+  uint64 __mid = (__a0 * __b0 >> 32) + __a1 * __b0;
+  uint64 __mid2 = (__mid & __low_mask) + __a0 * __b1;
+  return __a1 * __b1 + (__mid >> 32) + (__mid2 >> 32);
+#endif
+}
+
+// Divisions by constants that do not need a library call on 32-bit targets.
+static inline uint64 _Stl_div10(uint64 __x)
+{ return _Stl_umulh(__x, ULL(0xcccccccccccccccd)) >> 3; }
+static inline uint64 _Stl_div100(uint64 __x)
+{ return _Stl_umulh(__x >> 2, ULL(0x28f5c28f5c28f5c3)) >> 2; }
+static inline uint64 _Stl_div1e8(uint64 __x)
+{ return _Stl_umulh(__x, ULL(0xabcc77118461cefd)) >> 26; }
+
+static inline int _Stl_pow5bits(int __e)
+{ return ((__e * 1217359) >> 19) + 1; }
+static inline int _Stl_log10_pow2(int __e)
+{ return (__e * 78913) >> 18; }
+static inline int _Stl_log10_pow5(int __e)
+{ return (__e * 732923) >> 20; }
+
+static inline bool _Stl_multiple_of_pow5(uint64 __x, int __p) {
+  int __count = 0;
+  for (;;) {
+    uint64 __q = _Stl_umulh(__x, ULL(0xcccccccccccccccd)) >> 2;
+    if (__x != 5 * __q)
+      break;
+    __x = __q;
+    ++__count;
+  }
+  return __count >= __p;
+}
+
+static inline bool _Stl_multiple_of_pow2(uint64 __x, int __p)
+{ return (__x & ((ULL(1) << __p) - 1)) == 0; }
+
+// (__m * __mul) >> __j where 64 < __j < 128 and __m has at most 55 bits.
+static inline uint64 _Stl_mul_shift(uint64 __m, const uint64* __mul, int __j) {
+  uint64 __high1 = _Stl_umulh(__m, __mul[1]);
+  uint64 __low1 = __m * __mul[1];
+  uint64 __high0 = _Stl_umulh(__m, __mul[0]);
+  uint64 __sum = __high0 + __low1;
+  if (__sum < __high0)
+    ++__high1;
+  __j -= 64;
+  return (__high1 << (64 - __j)) | (__sum >> __j);
+}
+
+// Shortest decimal __output * 10^__exp that reads back as m2 * 2^e2, where
+// __mantissa and __exponent are the fields of a finite nonzero double.
+static void _Stl_shortest(uint64 __mantissa, int __exponent,
+                          uint64& __output, int& __exp) {
+  int __e2;
+  uint64 __m2;
+  if (__exponent == 0) {
+    __e2 = 1 - 1023 - 52 - 2;
+    __m2 = __mantissa;
+  } else {
+    __e2 = __exponent - 1023 - 52 - 2;
+    __m2 = (ULL(1) << 52) | __mantissa;
+  }
+  const bool __accept_bounds = (__m2 & 1) == 0;
+
+  // The halfway points to the neighbouring doubles are mv - 1 - mm_shift and
+  // mv + 2, all scaled by 4.
+  const uint64 __mv = 4 * __m2;
+  const int __mm_shift = __mantissa != 0 || __exponent <= 1;
+
+  uint64 __vr, __vp, __vm;
+  int __e10;
+  bool __vm_trailing_zeros = false;
+  bool __vr_trailing_zeros = false;
+  if (__e2 >= 0) {
+    const int __q = _Stl_log10_pow2(__e2) - (__e2 > 3);
+    __e10 = __q;
+    const int __i = -__e2 + __q + 125 + _Stl_pow5bits(__q) - 1;
+    __vr = _Stl_mul_shift(__mv, _Stl_pow5_inv_split[__q], __i);
+    __vp = _Stl_mul_shift(__mv + 2, _Stl_pow5_inv_split[__q], __i);
+    __vm = _Stl_mul_shift(__mv - 1 - __mm_shift, _Stl_pow5_inv_split[__q], __i);
+    if (__q <= 21) {
+      // At most one of mv, mp and mm is a multiple of 5.
+      if (__mv % 5 == 0)
+        __vr_trailing_zeros = _Stl_multiple_of_pow5(__mv, __q);
+      else if (__accept_bounds)
+        __vm_trailing_zeros = _Stl_multiple_of_pow5(__mv - 1 - __mm_shift, __q);
+      else
+        __vp -= _Stl_multiple_of_pow5(__mv + 2, __q);
+    }
+  } else {
+    const int __q = _Stl_log10_pow5(-__e2) - (-__e2 > 1);
+    __e10 = __q + __e2;
+    const int __i = -__e2 - __q;
+    const int __j = __q - (_Stl_pow5bits(__i) - 125);
+    __vr = _Stl_mul_shift(__mv, _Stl_pow5_split[__i], __j);
+    __vp = _Stl_mul_shift(__mv + 2, _Stl_pow5_split[__i], __j);
+    __vm = _Stl_mul_shift(__mv - 1 - __mm_shift, _Stl_pow5_split[__i], __j);
+    if (__q <= 1) {
+      // mv always has two trailing zero bits, mm has one when mm_shift is 1
+      // and mp always has one.
+      __vr_trailing_zeros = true;
+      if (__accept_bounds)
+        __vm_trailing_zeros = __mm_shift == 1;
+      else
+        --__vp;
+    } else if (__q < 63) {
+      __vr_trailing_zeros = _Stl_multiple_of_pow2(__mv, __q);
+    }
+  }
+
+  // Drop digits while the interval still holds a shorter number.
+  int __removed = 0;
+  if (__vm_trailing_zeros || __vr_trailing_zeros) {
+    int __last_removed = 0;
+    for (;;) {
+      uint64 __vp_div10 = _Stl_div10(__vp);
+      uint64 __vm_div10 = _Stl_div10(__vm);
+      if (__vp_div10 <= __vm_div10)
+        break;
+      uint64 __vr_div10 = _Stl_div10(__vr);
+      __vm_trailing_zeros &= __vm - 10 * __vm_div10 == 0;
+      __vr_trailing_zeros &= __last_removed == 0;
+      __last_removed = (int)(__vr - 10 * __vr_div10);
+      __vr = __vr_div10;
+      __vp = __vp_div10;
+      __vm = __vm_div10;
+      ++__removed;
+    }
+    if (__vm_trailing_zeros) {
+      for (;;) {
+        uint64 __vm_div10 = _Stl_div10(__vm);
+        if (__vm != 10 * __vm_div10)
+          break;
+        uint64 __vr_div10 = _Stl_div10(__vr);
+        __vr_trailing_zeros &= __last_removed == 0;
+        __last_removed = (int)(__vr - 10 * __vr_div10);
+        __vr = __vr_div10;
+        __vp = _Stl_div10(__vp);
+        __vm = __vm_div10;
+        ++__removed;
+      }
+    }
+    // Exactly halfway: round to even.
+    if (__vr_trailing_zeros && __last_removed == 5 && __vr % 2 == 0)
+      __last_removed = 4;
+    __output = __vr + ((__vr == __vm && (!__accept_bounds || !__vm_trailing_zeros)) ||
+                       __last_removed >= 5);
+  } else {
+    bool __round_up = false;
+    uint64 __vp_div100 = _Stl_div100(__vp);
+    uint64 __vm_div100 = _Stl_div100(__vm);
+    if (__vp_div100 > __vm_div100) {
+      uint64 __vr_div100 = _Stl_div100(__vr);
+      __round_up = __vr - 100 * __vr_div100 >= 50;
+      __vr = __vr_div100;
+      __vp = __vp_div100;
+      __vm = __vm_div100;
+      __removed += 2;
+    }
+    for (;;) {
+      uint64 __vp_div10 = _Stl_div10(__vp);
+      uint64 __vm_div10 = _Stl_div10(__vm);
+      if (__vp_div10 <= __vm_div10)
+        break;
+      uint64 __vr_div10 = _Stl_div10(__vr);
+      __round_up = __vr - 10 * __vr_div10 >= 5;
+      __vr = __vr_div10;
+      __vp = __vp_div10;
+      __vm = __vm_div10;
+      ++__removed;
+    }
+    __output = __vr + (__vr == __vm || __round_up);
+  }
+  __exp = __e10 + __removed;
+}
+
+// Writes the __count low decimal digits of __v before __end.
+static inline void _Stl_put_digits(uint32 __v, char* __end, int __count) {
+  while (__count-- > 0) {
+    uint32 __q = __v / 10;
+    *--__end = (char)('0' + (__v - 10 * __q));
+    __v = __q;
+  }
+}
+
+// Writes the decimal digits of __v, at most 17 of them, to __buf and returns
+// their number.
+static int _Stl_put_uint64(uint64 __v, char* __buf) {
+  char __tmp[20];
+  char* __end = __tmp + sizeof(__tmp);
+  char* __p = __end;
+  while ((__v >> 32) != 0) {
+    uint64 __q = _Stl_div1e8(__v);
+    __p -= 8;
+    _Stl_put_digits((uint32)(__v - 100000000 * __q), __p + 8, 8);
+    __v = __q;
+  }
+  for (uint32 __w = (uint32)__v; __w != 0; __w /= 10)
+    *--__p = (char)('0' + __w % 10);
+  int __len = (int)(__end - __p);
+  memcpy(__buf, __p, __len);
+  return __len;
+}
+
+// The exact expansion of a double has at most 767 significant digits, to
+// which _Stl_exact_digits may add the rest of a 9-digit chunk.
+#define _STLP_DTOA_BUFSIZE 800
+
+/* Rounds the __len digits in __buf to __need digits, half to even, __sticky
+ * telling whether nonzero digits follow __buf. Returns the new length, which
+ * __need + 1 when __fixed and rounding carried into a new leading digit
+ * (__decpt is then incremented).
+ */
+static int _Stl_round_digits(char* __buf, int __len, int __need, bool __sticky,
+                             int& __decpt, bool __fixed) {
+  if (__need < 0)
+    return 0;
+  if (__len <= __need)
+    return __len;
+  char __r = __buf[__need];
+  for (int __i = __need + 1; !__sticky && __i < __len; ++__i)
+    __sticky = __buf[__i] != '0';
+  bool __up = __r > '5' ||
+              (__r == '5' && (__sticky || (__need > 0 && ((__buf[__need - 1] - '0') & 1))));
+  if (!__up)
+    return __need;
+  int __i = __need - 1;
+  while (__i >= 0 && __buf[__i] == '9')
+    __buf[__i--] = '0';
+  if (__i >= 0) {
+    ++__buf[__i];
+    return __need;
+  }
+  // All nines: 10^__need
+  __buf[0] = '1';
+  if (__need > 0)
+    __buf[__need] = '0';
+  ++__decpt;
+  return __fixed ? __need + 1 : __need;
 }
 
+/* Digits of m * 2^e, from the first significant one on, rounded to __n
+ * significant digits or, when __fixed, to __n places after the decimal
+ * point. Used when the shortest digits do not tell the rounding.
+ */
+static int _Stl_exact_digits(uint64 __m, int __e, bool __fixed, int __n,
+                             char* __buf, int& __decpt) {
+  uint32 __big[36];
+  int __len = 0;
+  __decpt = 0;
+  if (__e >= 0) {
+    // An integer of at most 1024 bits: take its digits 9 at a time from the
+    // bottom, then write them out from the top.
+    const int __w = __e / 32, __b = __e % 32;
+    for (int __k = 0; __k < __w; ++__k)
+      __big[__k] = 0;
+    const uint64 __lo = __m << __b;
+    __big[__w] = (uint32)__lo;
+    __big[__w + 1] = (uint32)(__lo >> 32);
+    __big[__w + 2] = __b != 0 ? (uint32)(__m >> (64 - __b)) : 0;
+    int __size = __w + 3;
+    while (__big[__size - 1] == 0)
+      --__size;
+    uint32 __chunks[36];
+    int __nchunks = 0;
+    while (__size > 0) {
+      uint64 __rem = 0;
+      for (int __k = __size - 1; __k >= 0; --__k) {
+        uint64 __cur = (__rem << 32) | __big[__k];
+        __big[__k] = (uint32)(__cur / 1000000000);
+        __rem = __cur - (uint64)__big[__k] * 1000000000;
+      }
+      __chunks[__nchunks++] = (uint32)__rem;
+      while (__size > 0 && __big[__size - 1] == 0)
+        --__size;
+    }
+    __len = _Stl_put_uint64(__chunks[--__nchunks], __buf);
+    while (__nchunks > 0) {
+      _Stl_put_digits(__chunks[--__nchunks], __buf + __len + 9, 9);
+      __len += 9;
+    }
+    __decpt = __len;
+    return _Stl_round_digits(__buf, __len, __fixed ? __decpt + __n : __n, false, __decpt, __fixed);
+  }
+
+  // The integer part fits in 53 bits; the fraction F / 2^s gives 9 more
+  // digits each time it is multiplied by 10^9.
+  const int __s = -__e;
+  if (__s < 64 && (__m >> __s) != 0) {
+    __len = _Stl_put_uint64(__m >> __s, __buf);
+    __decpt = __len;
+    __m &= (ULL(1) << __s) - 1;
+  }
+  const int __w = __s / 32, __b = __s % 32;
+  for (int __k = 0; __k <= __w + 1; ++__k)
+    __big[__k] = 0;
+  __big[0] = (uint32)__m;
+  __big[1] = (uint32)(__m >> 32);
+  int __low = 0;  // limbs below it are zero
+  int __pos = 0;  // digits after the decimal point produced so far
+  for (;;) {
+    while (__low <= __w && __big[__low] == 0)
+      ++__low;
+    if (__low > __w)
+      break;
+    if (__len > 0 ? __len > (__fixed ? __decpt + __n : __n) : __fixed && __pos > __n)
+      break;
+    uint64 __carry = 0;
+    for (int __k = __low; __k <= __w + 1; ++__k) {
+      uint64 __cur = (uint64)__big[__k] * 1000000000 + __carry;
+      __big[__k] = (uint32)__cur;
+      __carry = __cur >> 32;
+    }
+    uint32 __chunk = (__big[__w] >> __b) | (__b != 0 ? __big[__w + 1] << (32 - __b) : 0);
+    __big[__w] &= (uint32)((ULL(1) << __b) - 1);
+    __big[__w + 1] = 0;
+    __pos += 9;
+    if (__len > 0) {
+      _Stl_put_digits(__chunk, __buf + __len + 9, 9);
+      __len += 9;
+    } else if (__chunk == 0) {
+      __decpt -= 9;
+    } else {
+      char __tmp[9];
+      _Stl_put_digits(__chunk, __tmp + 9, 9);
+      int __zeros = 0;
+      while (__tmp[__zeros] == '0')
+        ++__zeros;
+      __decpt -= __zeros;
+      __len = 9 - __zeros;
+      memcpy(__buf, __tmp + __zeros, __len);
+    }
+  }
+  return _Stl_round_digits(__buf, __len, __fixed ? __decpt + __n : __n,
+                           __low <= __w, __decpt, __fixed);
+}
+
+/* Digits of the finite nonzero __x, as _Stl_exact_digits gives them but
+ * possibly without trailing zeros. The shortest digits are the answer when
+ * they are no more than asked for and a double cannot lie between two
+ * numbers of that many digits (up to 15 digits for normal values), or when
+ * they are more and not exactly halfway between two such numbers: a number
+ * of fewer digits in between would have been the shortest one.
+ */
+static int _Stl_dtoa(double __x, bool __fixed, int __n, char* __buf, int& __decpt) {
+  uint64 __bits;
+  memcpy(&__bits, &__x, sizeof(__bits));
+  const uint64 __mantissa = __bits & ((ULL(1) << 52) - 1);
+  const int __exponent = (int)(__bits >> 52) & 0x7ff;
+
+  uint64 __output;
+  int __exp;
+  _Stl_shortest(__mantissa, __exponent, __output, __exp);
+  int __len = _Stl_put_uint64(__output, __buf);
+  __decpt = __len + __exp;
+  const int __need = __fixed ? __decpt + __n : __n;
+  if (__need >= __len) {
+    if (__need <= 15 && __exponent != 0)
+      return __len;
+  } else if (__need >= 0) {
+    int __i = __need + 1;
+    if (__buf[__need] == '5')
+      while (__i < __len && __buf[__i] == '0')
+        ++__i;
+    if (__i < __len || __buf[__need] != '5')
+      return _Stl_round_digits(__buf, __len, __need, false, __decpt, __fixed);
+  }
+  if (__exponent == 0)
+    return _Stl_exact_digits(__mantissa, -1074, __fixed, __n, __buf, __decpt);
+  return _Stl_exact_digits(__mantissa | (ULL(1) << 52), __exponent - 1075, __fixed, __n,
+                           __buf, __decpt);
+}
+
+// %f of the __len digits in __digits, padded with zeros, with __frac digits
+// after the decimal point.
+static size_t __put_fixed(__iostring &buf, const char *__digits, int __len, int __decpt,
+                          int __frac, bool __point) {
+  if (__decpt <= 0)
+    buf += '0';
+  else {
+    int __k = (min) (__len, __decpt);
+    buf.append(__digits, __digits + __k);
+    buf.append(__decpt - __k, '0');
+  }
+  size_t __group_pos = buf.size();
+  if (__frac > 0 || __point)
+    buf += '.';
+  if (__frac > 0) {
+    int __lead = __decpt < 0 ? (min) (-__decpt, __frac) : 0;
+    buf.append(__lead, '0');
+    int __from = (max) (__decpt, 0);
+    int __avail = (max) ((min) (__len - __from, __frac - __lead), 0);
+    buf.append(__digits + __from, __digits + __from + __avail);
+    buf.append(__frac - __lead - __avail, '0');
+  }
+  return __group_pos;
+}
+
+// %e of the same.
+static size_t __put_scientific(__iostring &buf, const char *__digits, int __len, int __decpt,
+                               int __frac, bool __point, bool __upper) {
+  buf += __len > 0 ? __digits[0] : '0';
+  size_t __group_pos = buf.size();
+  if (__frac > 0 || __point)
+    buf += '.';
+  int __avail = (max) ((min) (__len - 1, __frac), 0);
+  buf.append(__digits + 1, __digits + 1 + __avail);
+  buf.append(__frac - __avail, '0');
+
+  int __exp = __len > 0 ? __decpt - 1 : 0;
+  char __suffix[6];
+  char *__p = __suffix + sizeof(__suffix);
+  *--__p = 0;
+  unsigned __abs_exp = __exp < 0 ? -__exp : __exp;
+  do {
+    *--__p = (char)('0' + __abs_exp % 10);
+    __abs_exp /= 10;
+  } while (__abs_exp != 0);
+  if (__p == __suffix + 4)
+    *--__p = '0';
+  *--__p = __exp < 0 ? '-' : '+';
+  *--__p = __upper ? 'E' : 'e';
+  buf += __p;
+  return __group_pos;
+}
+
+static size_t __format_double(__iostring &buf, ios_base::fmtflags flags,
+                              int precision, double x) {
+  uint64 __bits;
+  memcpy(&__bits, &x, sizeof(__bits));
+  if ((__bits >> 63) != 0)
+    buf += '-';
+  else if (flags & ios_base::showpos)
+    buf += '+';
+
+  const bool __upper = (flags & ios_base::uppercase) != 0;
+  if ((~__bits & (ULL(0x7ff) << 52)) == 0) {
+    size_t __pos = buf.size();
+    if ((__bits & ((ULL(1) << 52) - 1)) != 0)
+      buf += __upper ? "NAN" : "nan";
+    else
+      buf += __upper ? "INF" : "inf";
+    return __pos;
+  }
+
+  const bool __point = (flags & ios_base::showpoint) != 0;
+  const bool __zero = (__bits << 1) == 0;
+  if (precision < 0)
+    precision = 6;
+  char __digits[_STLP_DTOA_BUFSIZE];
+  int __len = 0, __decpt = 1;
+
+  switch (flags & ios_base::floatfield) {
+  case ios_base::fixed:
+    if (!__zero)
+      __len = _Stl_dtoa(x, true, precision, __digits, __decpt);
+    return __put_fixed(buf, __digits, __len, __decpt, precision, __point);
+  case ios_base::scientific:
+    if (!__zero)
+      __len = _Stl_dtoa(x, false, precision + 1, __digits, __decpt);
+    return __put_scientific(buf, __digits, __len, __decpt, precision, __point, __upper);
+  default: { // g format
+    if (precision == 0)
+      precision = 1;
+    if (!__zero)
+      __len = _Stl_dtoa(x, false, precision, __digits, __decpt);
+    if (__len == 0)
+      __decpt = 1;
+    if (!__point)
+      while (__len > 0 && __digits[__len - 1] == '0')
+        --__len;
+    int __exp = __decpt - 1;
+    if (__exp < -4 || __exp >= precision)
+      return __put_scientific(buf, __digits, __len, __decpt,
+                              __point ? precision - 1 : (max) (__len - 1, 0),
+                              __point, __upper);
+    return __put_fixed(buf, __digits, __len, __decpt,
+                       __point ? precision - 1 - __exp : (max) (__len - __decpt, 0),
+                       __point);
+  }
+  }
+}
+
+size_t  _STLP_CALL
+__write_float(__iostring &buf, ios_base::fmtflags flags, int precision,
+              double x)
+{ return __format_double(buf, flags, precision, x); }
+
 #if !defined (_STLP_NO_LONG_DOUBLE)
 size_t _STLP_CALL
 __write_float(__iostring &buf, ios_base::fmtflags flags, int precision,
@@ -0,0 +1,142 @@
+/*
+ * This material is provided "as is", with absolutely no warranty expressed
+ * or implied. Any use is at your own risk.
+ *
+ * Permission to use or copy this software for any purpose is hereby granted
+ * without fee, provided the above notices are retained on all copies.
+ * Permission to modify the code and to distribute modified code is granted,
+ * provided the above notices are retained, and a notice that the code was
+ * modified is included with the above copyright notice.
+ *
+ */
+
+#include "stlport_prefix.h"
+
+#include <algorithm>
+
+#if !defined (_STLP_NO_EXTENSIONS)
+
+#  if defined (_STLP_PTHREADS) && !defined (_STLP_NO_THREADS)
+#    include <pthread.h>
+#    include <unistd.h>
+#    define _STLP_SORT_POOL_THREADS
+#  endif
+
+_STLP_BEGIN_NAMESPACE
+_STLP_MOVE_TO_PRIV_NAMESPACE
+
+#  if defined (_STLP_SORT_POOL_THREADS)
+
+/* The pool runs one job at a time. Its workers are started by the first job
+ * and then sleep on __pool_wake until the next one. The tasks of a job are
+ * handed out one by one under __pool_lock; parallel_sort makes them large
+ * enough for the lock to be of no consequence.
+ */
+static pthread_mutex_t __pool_busy = PTHREAD_MUTEX_INITIALIZER;  // held by the caller of a job
+static pthread_mutex_t __pool_lock = PTHREAD_MUTEX_INITIALIZER;  // guards everything below
+static pthread_cond_t __pool_wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t __pool_done = PTHREAD_COND_INITIALIZER;
+static bool __pool_started = false;
+static unsigned long __pool_generation = 0;
+static _Sort_pool::_Task __pool_task = 0;
+static void* __pool_arg = 0;
+static size_t __pool_size = 0;
+static size_t __pool_next = 0;
+static size_t __pool_finished = 0;
+
+/* Runs the tasks of the current job until none is left. Called and returns
+ * with __pool_lock held.
+ */
+static void __pool_work() {
+  while (__pool_next < __pool_size) {
+    size_t __i = __pool_next++;
+    _Sort_pool::_Task __task = __pool_task;
+    void* __arg = __pool_arg;
+    pthread_mutex_unlock(&__pool_lock);
+    __task(__arg, __i);
+    pthread_mutex_lock(&__pool_lock);
+    if (++__pool_finished == __pool_size)
+      pthread_cond_signal(&__pool_done);
+  }
+}
+
+extern "C" {
+static void* __pool_worker(void*) {
+  unsigned long __seen = 0;
+  pthread_mutex_lock(&__pool_lock);
+  for (;;) {
+    while (__seen == __pool_generation)
+      pthread_cond_wait(&__pool_wake, &__pool_lock);
+    __seen = __pool_generation;
+    __pool_work();
+  }
+  return 0;
+}
+}
+
+/* Called with __pool_lock held. A worker that cannot be created only makes
+ * the pool smaller.
+ */
+static void __start_workers() {
+  __pool_started = true;
+  pthread_attr_t __attr;
+  if (pthread_attr_init(&__attr) != 0)
+    return;
+  pthread_attr_setdetachstate(&__attr, PTHREAD_CREATE_DETACHED);
+  for (size_t __n = _Sort_pool::_S_concurrency(); __n > 1; --__n) {
+    pthread_t __worker;
+    if (pthread_create(&__worker, &__attr, __pool_worker, 0) != 0)
+      break;
+  }
+  pthread_attr_destroy(&__attr);
+}
+
+size_t _STLP_CALL _Sort_pool::_S_concurrency() {
+  static size_t __n = 0;
+  if (__n == 0) {
+    long __cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    __n = __cpus > 1 ? (size_t)__cpus : 1;
+  }
+  return __n;
+}
+
+void _STLP_CALL _Sort_pool::_S_run(_Task __task, void* __arg, size_t __n) {
+  // A job already running, possibly the one calling us, keeps the pool.
+  if (__n > 1 && _S_concurrency() > 1 && pthread_mutex_trylock(&__pool_busy) == 0) {
+    pthread_mutex_lock(&__pool_lock);
+    if (!__pool_started)
+      __start_workers();
+    __pool_task = __task;
+    __pool_arg = __arg;
+    __pool_size = __n;
+    __pool_next = 0;
+    __pool_finished = 0;
+    ++__pool_generation;
+    pthread_cond_broadcast(&__pool_wake);
+    __pool_work();
+    while (__pool_finished != __pool_size)
+      pthread_cond_wait(&__pool_done, &__pool_lock);
+    pthread_mutex_unlock(&__pool_lock);
+    pthread_mutex_unlock(&__pool_busy);
+    return;
+  }
+  for (size_t __i = 0; __i < __n; ++__i)
+    __task(__arg, __i);
+}
+
+#  else
+
+size_t _STLP_CALL _Sort_pool::_S_concurrency()
+{ return 1; }
+
+void _STLP_CALL _Sort_pool::_S_run(_Task __task, void* __arg, size_t __n) {
+  for (size_t __i = 0; __i < __n; ++__i)
+    __task(__arg, __i);
+}
+
+#  endif /* _STLP_SORT_POOL_THREADS */
+
+_STLP_MOVE_TO_STD_NAMESPACE
+_STLP_END_NAMESPACE
+
+#endif /* _STLP_NO_EXTENSIONS */
@@ -0,0 +1,540 @@
+/*
+ * This material is provided "as is", with absolutely no warranty expressed
+ * or implied. Any use is at your own risk.
+ *
+ * Permission to use or copy this software for any purpose is hereby granted
+ * without fee, provided the above notices are retained on all copies.
+ * Permission to modify the code and to distribute modified code is granted,
+ * provided the above notices are retained, and a notice that the code was
+ * modified is included with the above copyright notice.
+ *
+ */
+
+#include "stlport_prefix.h"
+
+#include <string>
+
+#if defined (__SSE2__)
+#  include <emmintrin.h>
+#elif defined (__aarch64__)
+#  include <arm_neon.h>
+#endif
+
+_STLP_BEGIN_NAMESPACE
+_STLP_MOVE_TO_PRIV_NAMESPACE
+
+/* Searches look at the text a block at a time, a block being as many
+ * characters as fit in a SIMD register (16 with SSE2 or NEON) or in a long
+ * otherwise. Comparing a block with a character gives a mask with one bit,
+ * or with NEON a nibble, per matching character. ARMv7 keeps to integer
+ * registers, moving NEON results to them being slow there.
+ */
+struct _Char_block {
+#if defined (__SSE2__)
+  enum { _S_width = 16, _S_shift = 0, _S_max_set = 16 };
+  typedef unsigned int _Mask;
+  typedef __m128i _Splat;
+
+  explicit _Char_block(const char* __p)
+    : _M_chars(_mm_loadu_si128(__REINTERPRET_CAST(const __m128i*, __p))) {}
+
+  static _Splat _S_splat(char __c)
+  { return _mm_set1_epi8(__c); }
+  static _Mask _S_all()
+  { return 0xffff; }
+  _Mask _M_match(_Splat __c) const
+  { return _mm_movemask_epi8(_mm_cmpeq_epi8(_M_chars, __c)); }
+
+  __m128i _M_chars;
+#elif defined (__aarch64__)
+  enum { _S_width = 16, _S_shift = 2, _S_max_set = 16 };
+  typedef unsigned long _Mask;
+  typedef uint8x16_t _Splat;
+
+  explicit _Char_block(const char* __p)
+    : _M_chars(vld1q_u8(__REINTERPRET_CAST(const uint8_t*, __p))) {}
+
+  static _Splat _S_splat(char __c)
+  { return vdupq_n_u8((unsigned char)__c); }
+  static _Mask _S_all()
+  { return 0x8888888888888888UL; }
+  // Narrowing the comparison leaves a nibble per character
+  _Mask _M_match(_Splat __c) const {
+    uint8x8_t __eq = vshrn_n_u16(vreinterpretq_u16_u8(vceqq_u8(_M_chars, __c)), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(__eq), 0) & _S_all();
+  }
+
+  uint8x16_t _M_chars;
+#else
+  // Matches are reported in the high bit of each byte of the mask
+  enum { _S_width = sizeof(unsigned long), _S_shift = 3, _S_max_set = 2 };
+  typedef unsigned long _Mask;
+  typedef unsigned long _Splat;
+
+  explicit _Char_block(const char* __p)
+  { memcpy(&_M_chars, __p, sizeof(_M_chars)); }
+
+  static _Splat _S_splat(char __c)
+  { return (~0UL / 0xff) * (unsigned char)__c; }
+  static _Mask _S_all()
+  { return (~0UL / 0xff) * 0x80; }
+  // Exact, unlike the usual test for a zero byte which may also report the
+  // byte following one
+  _Mask _M_match(_Splat __c) const {
+    _Mask __x = _M_chars ^ __c;
+    _Mask __low = ~_S_all();
+    return ~(((__x & __low) + __low) | __x | __low);
+  }
+
+  unsigned long _M_chars;
+#endif
+
+#if defined (__SSE2__) || defined (__aarch64__) || \
+    !defined (__BYTE_ORDER__) || (__BYTE_ORDER__ != __ORDER_BIG_ENDIAN__)
+  // Offsets of the first and last matching characters of a non-zero mask
+  static size_t _S_first(_Mask __m)
+  { return _S_lowest_bit(__m) >> _S_shift; }
+  static size_t _S_last(_Mask __m)
+  { return _S_highest_bit(__m) >> _S_shift; }
+  static _Mask _S_drop_first(_Mask __m)
+  { return __m & (__m - 1); }
+  static _Mask _S_drop_last(_Mask __m)
+  { return __m ^ ((_Mask)1 << _S_highest_bit(__m)); }
+  // The matches from the __k-th character on, and before it, 0 < __k < _S_width
+  static _Mask _S_skip_first(_Mask __m, size_t __k)
+  { return __m >> (__k << _S_shift); }
+  static _Mask _S_keep_first(_Mask __m, size_t __k)
+  { return __m & (((_Mask)1 << (__k << _S_shift)) - 1); }
+#else
+  // The first character is the most significant byte of the long
+  static size_t _S_first(_Mask __m)
+  { return (_S_width - 1) - (_S_highest_bit(__m) >> _S_shift); }
+  static size_t _S_last(_Mask __m)
+  { return (_S_width - 1) - (_S_lowest_bit(__m) >> _S_shift); }
+  static _Mask _S_drop_first(_Mask __m)
+  { return __m ^ ((_Mask)1 << _S_highest_bit(__m)); }
+  static _Mask _S_drop_last(_Mask __m)
+  { return __m & (__m - 1); }
+  static _Mask _S_skip_first(_Mask __m, size_t __k)
+  { return __m << (__k << _S_shift); }
+  static _Mask _S_keep_first(_Mask __m, size_t __k)
+  { return __m & ~(~(_Mask)0 >> (__k << _S_shift)); }
+#endif
+
+  static size_t _S_lowest_bit(_Mask __m) {
+#if defined (__GNUC__)
+    return sizeof(_Mask) > sizeof(unsigned int) ? __builtin_ctzl(__m) : __builtin_ctz((unsigned int)__m);
+#else
+    size_t __i = 0;
+    for (; (__m & 1) == 0; __m >>= 1, ++__i);
+    return __i;
+#endif
+  }
+
+  static size_t _S_highest_bit(_Mask __m) {
+#if defined (__GNUC__)
+    return sizeof(_Mask) > sizeof(unsigned int) ? sizeof(_Mask) * 8 - 1 - __builtin_clzl(__m)
+                                                : sizeof(unsigned int) * 8 - 1 - __builtin_clz((unsigned int)__m);
+#else
+    size_t __i = 0;
+    for (; __m >>= 1; ++__i);
+    return __i;
+#endif
+  }
+};
+
+/* The block searches for a substring look for its first and last
+ * characters, and compare the rest only where both are. Texts where that
+ * keeps failing are left, as soon as they have cost more than a few
+ * comparisons per character, to the Two-Way algorithm of Crochemore and
+ * Perrin, which is linear whatever the text and the substring.
+ */
+static const size_t __no_match = (size_t)-1;
+
+struct _Forward {
+  explicit _Forward(const char* __p) : _M_p(__REINTERPRET_CAST(const unsigned char*, __p)) {}
+  unsigned char operator[](size_t __i) const { return _M_p[__i]; }
+  const unsigned char* _M_p;
+};
+
+// The characters before __p, last one first, to search backwards
+struct _Backward {
+  explicit _Backward(const char* __p) : _M_p(__REINTERPRET_CAST(const unsigned char*, __p)) {}
+  unsigned char operator[](size_t __i) const { return *(_M_p - 1 - __i); }
+  const unsigned char* _M_p;
+};
+
+/* Splits the substring in two, __s[0, __suffix) and __s[__suffix, __n),
+ * where the period of the substring is also the local period, and returns
+ * __suffix. __period is set to the period of the second part.
+ */
+template <class _Chars>
+static size_t __critical_factorization(const _Chars& __s, size_t __n, size_t& __period) {
+  if (__n < 3) {
+    __period = 1;
+    return __n - 1;
+  }
+
+  // Maximal suffix for the order of characters, then for the reverse order
+  size_t __max_suffix = __no_match, __j = 0, __k = 1, __p = 1;
+  while (__j + __k < __n) {
+    unsigned char __a = __s[__j + __k], __b = __s[__max_suffix + __k];
+    if (__a < __b) {
+      __j += __k;
+      __k = 1;
+      __p = __j - __max_suffix;
+    } else if (__a == __b) {
+      if (__k != __p)
+        ++__k;
+      else {
+        __j += __p;
+        __k = 1;
+      }
+    } else {
+      __max_suffix = __j++;
+      __k = __p = 1;
+    }
+  }
+  __period = __p;
+
+  size_t __max_suffix_rev = __no_match;
+  __j = 0;
+  __k = __p = 1;
+  while (__j + __k < __n) {
+    unsigned char __a = __s[__j + __k], __b = __s[__max_suffix_rev + __k];
+    if (__b < __a) {
+      __j += __k;
+      __k = 1;
+      __p = __j - __max_suffix_rev;
+    } else if (__a == __b) {
+      if (__k != __p)
+        ++__k;
+      else {
+        __j += __p;
+        __k = 1;
+      }
+    } else {
+      __max_suffix_rev = __j++;
+      __k = __p = 1;
+    }
+  }
+
+  if (__max_suffix_rev + 1 < __max_suffix + 1)
+    return __max_suffix + 1;
+  __period = __p;
+  return __max_suffix_rev + 1;
+}
+
+// Offset of the first occurrence of __s[0, __n) in __t[0, __len), 2 <= __n
+template <class _Chars>
+static size_t __two_way(const _Chars& __t, size_t __len, const _Chars& __s, size_t __n) {
+  if (__len < __n)
+    return __no_match;
+  size_t __period;
+  size_t __suffix = __critical_factorization(__s, __n, __period);
+  size_t __i, __j = 0;
+
+  for (__i = 0; __i < __suffix && __s[__i] == __s[__i + __period]; ++__i);
+  if (__i == __suffix) {
+    // Periodic substring: the part known to match after a shift by the
+    // period is not compared again
+    size_t __memory = 0;
+    while (__j <= __len - __n) {
+      __i = (max)(__suffix, __memory);
+      while (__i < __n && __s[__i] == __t[__i + __j])
+        ++__i;
+      if (__n <= __i) {
+        __i = __suffix - 1;
+        while (__memory < __i + 1 && __s[__i] == __t[__i + __j])
+          --__i;
+        if (__i + 1 < __memory + 1)
+          return __j;
+        __j += __period;
+        __memory = __n - __period;
+      } else {
+        __j += __i - __suffix + 1;
+        __memory = 0;
+      }
+    }
+  } else {
+    __period = (max)(__suffix, __n - __suffix) + 1;
+    while (__j <= __len - __n) {
+      __i = __suffix;
+      while (__i < __n && __s[__i] == __t[__i + __j])
+        ++__i;
+      if (__n <= __i) {
+        __i = __suffix - 1;
+        while (__i != __no_match && __s[__i] == __t[__i + __j])
+          --__i;
+        if (__i == __no_match)
+          return __j;
+        __j += __period;
+      } else
+        __j += __i - __suffix + 1;
+    }
+  }
+  return __no_match;
+}
+
+// Comparisons the block search may make before leaving the text to Two-Way
+static size_t __search_budget(size_t __scanned)
+{ return 8 * __scanned + 4096; }
+
+// Occurrences starting at the characters of __m, a mask of candidates at __p
+static const char* __first_occurrence(const char* __p, _Char_block::_Mask __m,
+                                      const char* __s, size_t __n, size_t& __work) {
+  for (; __m != 0; __m = _Char_block::_S_drop_first(__m)) {
+    const char* __cand = __p + _Char_block::_S_first(__m);
+    if (memcmp(__cand + 1, __s + 1, __n - 2) == 0)
+      return __cand;
+    __work += __n;
+  }
+  return 0;
+}
+
+static const char* __last_occurrence(const char* __p, _Char_block::_Mask __m,
+                                     const char* __s, size_t __n, size_t& __work) {
+  for (; __m != 0; __m = _Char_block::_S_drop_last(__m)) {
+    const char* __cand = __p + _Char_block::_S_last(__m);
+    if (memcmp(__cand + 1, __s + 1, __n - 2) == 0)
+      return __cand;
+    __work += __n;
+  }
+  return 0;
+}
+
+const char* _STLP_CALL
+_Char_search::_S_find(const char* __first, const char* __last, const char* __s, size_t __n) {
+  if (__n == 0)
+    return __first;
+  if ((size_t)(__last - __first) < __n)
+    return __last;
+  if (__n == 1) {
+    const void* __p = memchr(__first, (unsigned char)*__s, __last - __first);
+    return __p != 0 ? __STATIC_CAST(const char*, __p) : __last;
+  }
+
+  // Occurrences start in [__first, __end)
+  const char* __end = __last - (__n - 1);
+  const char* __p = __first;
+  if (__end - __first < _Char_block::_S_width) {
+    for (; __p != __end; ++__p) {
+      if (*__p == __s[0] && __p[__n - 1] == __s[__n - 1] &&
+          memcmp(__p + 1, __s + 1, __n - 2) == 0)
+        return __p;
+    }
+    return __last;
+  }
+
+  _Char_block::_Splat __head = _Char_block::_S_splat(__s[0]);
+  _Char_block::_Splat __tail = _Char_block::_S_splat(__s[__n - 1]);
+  size_t __work = 0;
+  const char* __result;
+  for (; __end - __p >= _Char_block::_S_width; __p += _Char_block::_S_width) {
+    if (__work > __search_budget(__p - __first)) {
+      size_t __j = __two_way(_Forward(__p), __last - __p, _Forward(__s), __n);
+      return __j != __no_match ? __p + __j : __last;
+    }
+    _Char_block::_Mask __m = _Char_block(__p)._M_match(__head) &
+                             _Char_block(__p + __n - 1)._M_match(__tail);
+    if ((__result = __first_occurrence(__p, __m, __s, __n, __work)) != 0)
+      return __result;
+  }
+  if (__p != __end) {
+    // The last block overlaps candidates already looked at
+    const char* __q = __end - _Char_block::_S_width;
+    _Char_block::_Mask __m = _Char_block(__q)._M_match(__head) &
+                             _Char_block(__q + __n - 1)._M_match(__tail);
+    if ((__result = __first_occurrence(__p, _Char_block::_S_skip_first(__m, __p - __q),
+                                       __s, __n, __work)) != 0)
+      return __result;
+  }
+  return __last;
+}
+
+const char* _STLP_CALL
+_Char_search::_S_rfind(const char* __first, const char* __last, const char* __s, size_t __n) {
+  if (__n == 0 || (size_t)(__last - __first) < __n)
+    return __last;
+  if (__n == 1)
+    return _S_rfind_char(__first, __last, *__s);
+
+  // Occurrences start in [__first, __end), the ones from __p on are done
+  const char* __end = __last - (__n - 1);
+  const char* __p = __end;
+  if (__end - __first < _Char_block::_S_width) {
+    while (__p != __first) {
+      --__p;
+      if (*__p == __s[0] && __p[__n - 1] == __s[__n - 1] &&
+          memcmp(__p + 1, __s + 1, __n - 2) == 0)
+        return __p;
+    }
+    return __last;
+  }
+
+  _Char_block::_Splat __head = _Char_block::_S_splat(__s[0]);
+  _Char_block::_Splat __tail = _Char_block::_S_splat(__s[__n - 1]);
+  size_t __work = 0;
+  const char* __result;
+  for (; __p - __first >= _Char_block::_S_width; __p -= _Char_block::_S_width) {
+    if (__work > __search_budget(__end - __p)) {
+      // The text before __p + __n - 1 read backwards, for the substring
+      // read backwards
+      const char* __t = __p + __n - 1;
+      size_t __j = __two_way(_Backward(__t), __t - __first, _Backward(__s + __n), __n);
+      return __j != __no_match ? __t - __j - __n : __last;
+    }
+    const char* __q = __p - _Char_block::_S_width;
+    _Char_block::_Mask __m = _Char_block(__q)._M_match(__head) &
+                             _Char_block(__q + __n - 1)._M_match(__tail);
+    if ((__result = __last_occurrence(__q, __m, __s, __n, __work)) != 0)
+      return __result;
+  }
+  if (__p != __first) {
+    // The first block overlaps candidates already looked at
+    _Char_block::_Mask __m = _Char_block(__first)._M_match(__head) &
+                             _Char_block(__first + __n - 1)._M_match(__tail);
+    if ((__result = __last_occurrence(__first, _Char_block::_S_keep_first(__m, __p - __first),
+                                      __s, __n, __work)) != 0)
+      return __result;
+  }
+  return __last;
+}
+
+const char* _STLP_CALL
+_Char_search::_S_rfind_char(const char* __first, const char* __last, char __c) {
+  const char* __p = __last;
+  if (__last - __first < _Char_block::_S_width) {
+    while (__p != __first) {
+      if (*--__p == __c)
+        return __p;
+    }
+    return __last;
+  }
+
+  _Char_block::_Splat __splat = _Char_block::_S_splat(__c);
+  _Char_block::_Mask __m;
+  for (; __p - __first >= _Char_block::_S_width; __p -= _Char_block::_S_width) {
+    if ((__m = _Char_block(__p - _Char_block::_S_width)._M_match(__splat)) != 0)
+      return __p - _Char_block::_S_width + _Char_block::_S_last(__m);
+  }
+  if (__p != __first &&
+      (__m = _Char_block::_S_keep_first(_Char_block(__first)._M_match(__splat), __p - __first)) != 0)
+    return __first + _Char_block::_S_last(__m);
+  return __last;
+}
+
+/* Sets of characters small enough are compared a block at a time with each
+ * of their characters, larger ones are looked up in a bitmap.
+ */
+struct _Char_set {
+  _Char_set(const char* __s, size_t __n) {
+    memset(_M_bits, 0, sizeof(_M_bits));
+    for (size_t __i = 0; __i < __n; ++__i) {
+      unsigned char __c = __s[__i];
+      _M_bits[__c / 32] |= 1U << (__c % 32);
+    }
+  }
+  bool _M_contains(char __c) const {
+    unsigned char __uc = __c;
+    return (_M_bits[__uc / 32] & (1U << (__uc % 32))) != 0;
+  }
+  unsigned int _M_bits[256 / 32];
+};
+
+struct _Char_block_set {
+  _Char_block_set(const char* __s, size_t __n, bool __in)
+    : _M_size(__n), _M_in(__in) {
+    for (size_t __i = 0; __i < __n; ++__i)
+      _M_chars[__i] = _Char_block::_S_splat(__s[__i]);
+  }
+  // Characters of the block that are, or are not, in the set
+  _Char_block::_Mask _M_match(const char* __p) const {
+    _Char_block __block(__p);
+    _Char_block::_Mask __m = 0;
+    for (size_t __i = 0; __i < _M_size; ++__i)
+      __m |= __block._M_match(_M_chars[__i]);
+    return _M_in ? __m : ~__m & _Char_block::_S_all();
+  }
+  _Char_block::_Splat _M_chars[_Char_block::_S_max_set];
+  size_t _M_size;
+  bool _M_in;
+};
+
+// For texts shorter than a block
+static bool __small_set_contains(const char* __s, size_t __n, char __c) {
+  for (size_t __i = 0; __i < __n; ++__i) {
+    if (__s[__i] == __c)
+      return true;
+  }
+  return false;
+}
+
+const char* _STLP_CALL
+_Char_search::_S_find_of(const char* __first, const char* __last,
+                         const char* __s, size_t __n, bool __in) {
+  const char* __p = __first;
+  if (__n > _Char_block::_S_max_set) {
+    _Char_set __set(__s, __n);
+    for (; __p != __last; ++__p) {
+      if (__set._M_contains(*__p) == __in)
+        return __p;
+    }
+  } else if (__last - __first < _Char_block::_S_width) {
+    for (; __p != __last; ++__p) {
+      if (__small_set_contains(__s, __n, *__p) == __in)
+        return __p;
+    }
+  } else if (__small_set_contains(__s, __n, *__p) == __in) {
+    // Searches often stop at once, as when skipping blanks
+    return __p;
+  } else {
+    _Char_block_set __set(__s, __n, __in);
+    _Char_block::_Mask __m;
+    for (; __last - __p >= _Char_block::_S_width; __p += _Char_block::_S_width) {
+      if ((__m = __set._M_match(__p)) != 0)
+        return __p + _Char_block::_S_first(__m);
+    }
+    // The last block overlaps characters already looked at
+    const char* __q = __last - _Char_block::_S_width;
+    if (__p != __last &&
+        (__m = _Char_block::_S_skip_first(__set._M_match(__q), __p - __q)) != 0)
+      return __p + _Char_block::_S_first(__m);
+  }
+  return __last;
+}
+
+const char* _STLP_CALL
+_Char_search::_S_rfind_of(const char* __first, const char* __last,
+                          const char* __s, size_t __n, bool __in) {
+  const char* __p = __last;
+  if (__n > _Char_block::_S_max_set) {
+    _Char_set __set(__s, __n);
+    while (__p != __first) {
+      if (__set._M_contains(*--__p) == __in)
+        return __p;
+    }
+  } else if (__last - __first < _Char_block::_S_width) {
+    while (__p != __first) {
+      if (__small_set_contains(__s, __n, *--__p) == __in)
+        return __p;
+    }
+  } else if (__small_set_contains(__s, __n, __p[-1]) == __in) {
+    return __p - 1;
+  } else {
+    _Char_block_set __set(__s, __n, __in);
+    _Char_block::_Mask __m;
+    for (; __p - __first >= _Char_block::_S_width; __p -= _Char_block::_S_width) {
+      if ((__m = __set._M_match(__p - _Char_block::_S_width)) != 0)
+        return __p - _Char_block::_S_width + _Char_block::_S_last(__m);
+    }
+    // The first block overlaps characters already looked at
+    if (__p != __first &&
+        (__m = _Char_block::_S_keep_first(__set._M_match(__first), __p - __first)) != 0)
+      return __first + _Char_block::_S_last(__m);
+  }
+  return __last;
+}
+
+_STLP_MOVE_TO_STD_NAMESPACE
+_STLP_END_NAMESPACE
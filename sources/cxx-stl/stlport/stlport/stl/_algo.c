@@ -900,8 +900,12 @@ _RandomAccessIter __unguarded_partition(_RandomAccessIter __first,
   }
 }
 
-// sort() and its auxiliary functions.
-#define __stl_threshold  16
+// sort() and its auxiliary functions: pattern-defeating quicksort.
+#define __stl_threshold  24
+
+const int __stl_ninther_threshold = 128;
+const int __stl_partial_insertion_limit = 8;
+const int __stl_partition_block = 64;
 
 template <class _RandomAccessIter, class _Tp, class _Compare>
 void __unguarded_linear_insert(_RandomAccessIter __last, _Tp __val,
@@ -955,50 +959,337 @@ inline void __unguarded_insertion_sort(_RandomAccessIter __first,
   __unguarded_insertion_sort_aux(__first, __last, _STLP_VALUE_TYPE(__first, _RandomAccessIter), __comp);
 }
 
+// Insertion sort that gives up once more than __stl_partial_insertion_limit
+// elements have been moved; returns whether the range ended up sorted.
+template <class _RandomAccessIter, class _Tp, class _Compare>
+bool __partial_insertion_sort(_RandomAccessIter __first,
+                              _RandomAccessIter __last,
+                              _Tp*, _Compare __comp) {
+  if (__first == __last) return true;
+  size_t __moves = 0;
+  for (_RandomAccessIter __i = __first + 1; __i != __last; ++__i) {
+    _RandomAccessIter __sift = __i;
+    _RandomAccessIter __prev = __i - 1;
+    if (__comp(*__sift, *__prev)) {
+      _Tp __val = *__sift;
+      do {
+        *__sift = *__prev;
+        --__sift;
+      } while (__sift != __first && __comp(__val, *--__prev));
+      *__sift = __val;
+      __moves += __i - __sift;
+      if (__moves > (size_t)__stl_partial_insertion_limit)
+        return false;
+    }
+  }
+  return true;
+}
+
+template <class _RandomAccessIter, class _Compare>
+inline void __sort2(_RandomAccessIter __a, _RandomAccessIter __b, _Compare __comp) {
+  if (__comp(*__b, *__a))
+    iter_swap(__a, __b);
+}
+
 template <class _RandomAccessIter, class _Compare>
-void __final_insertion_sort(_RandomAccessIter __first,
-                            _RandomAccessIter __last, _Compare __comp) {
-  if (__last - __first > __stl_threshold) {
-    __insertion_sort(__first, __first + __stl_threshold, _STLP_VALUE_TYPE(__first,_RandomAccessIter), __comp);
-    __unguarded_insertion_sort(__first + __stl_threshold, __last, __comp);
+inline void __sort3(_RandomAccessIter __a, _RandomAccessIter __b,
+                    _RandomAccessIter __c, _Compare __comp) {
+  __sort2(__a, __b, __comp);
+  __sort2(__b, __c, __comp);
+  __sort2(__a, __b, __comp);
+}
+
+// Puts the elements equal to the pivot *__first on its left. Only used when
+// the pivot equals the element before __first, so that the left part needs
+// no further sorting. Returns the final pivot position.
+template <class _RandomAccessIter, class _Tp, class _Compare>
+_RandomAccessIter __partition_left(_RandomAccessIter __first,
+                                   _RandomAccessIter __last,
+                                   _Tp*, _Compare __comp) {
+  _Tp __pivot = *__first;
+  _RandomAccessIter __begin = __first;
+  _RandomAccessIter __end = __last;
+
+  while (__comp(__pivot, *--__last));
+  if (__last + 1 == __end)
+    while (__first < __last && !__comp(__pivot, *++__first));
+  else
+    while (!__comp(__pivot, *++__first));
+
+  while (__first < __last) {
+    iter_swap(__first, __last);
+    while (__comp(__pivot, *--__last));
+    while (!__comp(__pivot, *++__first));
   }
+
+  *__begin = *__last;
+  *__last = __pivot;
+  return __last;
+}
+
+// Puts the elements less than the pivot *__first on its left and the others
+// on its right. The second member of the result tells whether the range
+// was already partitioned, i.e. no element had to be swapped.
+template <class _RandomAccessIter, class _Tp, class _Compare>
+pair<_RandomAccessIter, bool>
+__partition_right(_RandomAccessIter __first, _RandomAccessIter __last,
+                  _Tp*, _Compare __comp, const __false_type& /*_Branchless*/) {
+  _Tp __pivot = *__first;
+  _RandomAccessIter __begin = __first;
+
+  // The median selection left an element not less than the pivot at the end,
+  // so the first scan needs no bound check.
+  while (__comp(*++__first, __pivot));
+  if (__first - 1 == __begin)
+    while (__first < __last && !__comp(*--__last, __pivot));
   else
-    __insertion_sort(__first, __last, _STLP_VALUE_TYPE(__first,_RandomAccessIter), __comp);
+    while (!__comp(*--__last, __pivot));
+
+  bool __already_partitioned = !(__first < __last);
+  while (__first < __last) {
+    iter_swap(__first, __last);
+    while (__comp(*++__first, __pivot));
+    while (!__comp(*--__last, __pivot));
+  }
+
+  _RandomAccessIter __pivot_pos = __first - 1;
+  *__begin = *__pivot_pos;
+  *__pivot_pos = __pivot;
+  return pair<_RandomAccessIter, bool>(__pivot_pos, __already_partitioned);
+}
+
+// Swaps the misplaced elements found by the block partition. When both
+// blocks hold the same number of them a cycle of moves is not possible, so
+// plain swaps are used.
+template <class _RandomAccessIter, class _Tp>
+inline void __swap_offsets(_RandomAccessIter __first, _RandomAccessIter __last,
+                           unsigned char* __offsets_l, unsigned char* __offsets_r,
+                           size_t __num, bool __use_swaps, _Tp*) {
+  if (__use_swaps) {
+    for (size_t __i = 0; __i < __num; ++__i)
+      iter_swap(__first + __offsets_l[__i], __last - __offsets_r[__i]);
+  }
+  else if (__num > 0) {
+    _RandomAccessIter __l = __first + __offsets_l[0];
+    _RandomAccessIter __r = __last - __offsets_r[0];
+    _Tp __tmp = *__l;
+    *__l = *__r;
+    for (size_t __i = 1; __i < __num; ++__i) {
+      __l = __first + __offsets_l[__i];
+      *__r = *__l;
+      __r = __last - __offsets_r[__i];
+      *__l = *__r;
+    }
+    *__r = __tmp;
+  }
+}
+
+// Same as above for cheap comparisons of arithmetic keys: the elements of a
+// block are compared first, recording the offsets of the misplaced ones
+// without branching on the result, and are swapped afterwards. This avoids
+// the branch mispredictions of the classic Hoare loop on random input.
+template <class _RandomAccessIter, class _Tp, class _Compare>
+pair<_RandomAccessIter, bool>
+__partition_right(_RandomAccessIter __first, _RandomAccessIter __last,
+                  _Tp*, _Compare __comp, const __true_type& /*_Branchless*/) {
+  _Tp __pivot = *__first;
+  _RandomAccessIter __begin = __first;
+
+  while (__comp(*++__first, __pivot));
+  if (__first - 1 == __begin)
+    while (__first < __last && !__comp(*--__last, __pivot));
+  else
+    while (!__comp(*--__last, __pivot));
+
+  bool __already_partitioned = !(__first < __last);
+  if (!__already_partitioned) {
+    iter_swap(__first, __last);
+    ++__first;
+
+    unsigned char __offsets_l[__stl_partition_block];
+    unsigned char __offsets_r[__stl_partition_block];
+    _RandomAccessIter __base_l = __first;
+    _RandomAccessIter __base_r = __last;
+    size_t __num_l = 0, __num_r = 0, __start_l = 0, __start_r = 0;
+
+    while (__first < __last) {
+      // Only refill the blocks that were emptied by the previous round.
+      size_t __unknown = __last - __first;
+      size_t __split_l = __num_l == 0 ? (__num_r == 0 ? __unknown / 2 : __unknown) : 0;
+      size_t __split_r = __num_r == 0 ? (__unknown - __split_l) : 0;
+      if (__split_l > (size_t)__stl_partition_block)
+        __split_l = __stl_partition_block;
+      if (__split_r > (size_t)__stl_partition_block)
+        __split_r = __stl_partition_block;
+
+      for (size_t __i = 0; __i < __split_l; ++__i) {
+        __offsets_l[__num_l] = (unsigned char)__i;
+        __num_l += !__comp(*__first, __pivot);
+        ++__first;
+      }
+      for (size_t __i = 0; __i < __split_r; ) {
+        __offsets_r[__num_r] = (unsigned char)++__i;
+        __num_r += __comp(*--__last, __pivot);
+      }
+
+      size_t __num = (min) (__num_l, __num_r);
+      __swap_offsets(__base_l, __base_r, __offsets_l + __start_l, __offsets_r + __start_r,
+                     __num, __num_l == __num_r, (_Tp*)0);
+      __num_l -= __num; __num_r -= __num;
+      __start_l += __num; __start_r += __num;
+      if (__num_l == 0) {
+        __start_l = 0;
+        __base_l = __first;
+      }
+      if (__num_r == 0) {
+        __start_r = 0;
+        __base_r = __last;
+      }
+    }
+
+    // One of the blocks may still hold misplaced elements: move them next to
+    // the boundary.
+    if (__num_l != 0) {
+      while (__num_l--)
+        iter_swap(__base_l + __offsets_l[__start_l + __num_l], --__last);
+      __first = __last;
+    }
+    if (__num_r != 0) {
+      while (__num_r--) {
+        iter_swap(__base_r - __offsets_r[__start_r + __num_r], __first);
+        ++__first;
+      }
+      __last = __first;
+    }
+  }
+
+  _RandomAccessIter __pivot_pos = __first - 1;
+  *__begin = *__pivot_pos;
+  *__pivot_pos = __pivot;
+  return pair<_RandomAccessIter, bool>(__pivot_pos, __already_partitioned);
 }
 
-template <class _RandomAccessIter, class _Tp, class _Size, class _Compare>
-void __introsort_loop(_RandomAccessIter __first,
-                      _RandomAccessIter __last, _Tp*,
-                      _Size __depth_limit, _Compare __comp) {
-  while (__last - __first > __stl_threshold) {
-    if (__depth_limit == 0) {
-      partial_sort(__first, __last, __last, __comp);
+// Block partitioning only pays off when comparing is a single instruction.
+template <class _Tp, class _Compare>
+struct _UseBranchlessPartition
+{ typedef __false_type _Ret; };
+
+#if defined (_STLP_CLASS_PARTIAL_SPECIALIZATION)
+template <class _Tp>
+struct _UseBranchlessPartition<_Tp, less<_Tp> > {
+  typedef typename _Lor2<typename _IsIntegral<_Tp>::_Ret,
+                         typename _IsRational<_Tp>::_Ret>::_Ret _Ret;
+};
+#endif
+
+template <class _RandomAccessIter, class _Tp, class _Compare, class _Branchless>
+void __pdqsort_loop(_RandomAccessIter __first, _RandomAccessIter __last, _Tp*,
+                    int __bad_allowed, bool __leftmost, _Compare __comp,
+                    const _Branchless& __branchless) {
+  for (;;) {
+    size_t __size = __last - __first;
+    if (__size < (size_t)__stl_threshold) {
+      // Unless the range is leftmost, the element before it is not greater
+      // than any of its elements and stops the insertion loop.
+      if (__leftmost)
+        __insertion_sort(__first, __last, (_Tp*)0, __comp);
+      else
+        __unguarded_insertion_sort(__first, __last, __comp);
       return;
     }
-    --__depth_limit;
-    _RandomAccessIter __cut =
-      __unguarded_partition(__first, __last,
-                            _Tp(__median(*__first,
-                                         *(__first + (__last - __first)/2),
-                                         *(__last - 1), __comp)),
-       __comp);
-    __introsort_loop(__cut, __last, (_Tp*) 0, __depth_limit, __comp);
-    __last = __cut;
+
+    // Median of three, or Tukey's ninther on large ranges, moved to *__first.
+    size_t __half = __size / 2;
+    if (__size > (size_t)__stl_ninther_threshold) {
+      __sort3(__first, __first + __half, __last - 1, __comp);
+      __sort3(__first + 1, __first + (__half - 1), __last - 2, __comp);
+      __sort3(__first + 2, __first + (__half + 1), __last - 3, __comp);
+      __sort3(__first + (__half - 1), __first + __half, __first + (__half + 1), __comp);
+      iter_swap(__first, __first + __half);
+    }
+    else
+      __sort3(__first + __half, __first, __last - 1, __comp);
+
+    // A pivot equal to the element before the range is the smallest value of
+    // the range: group its duplicates on the left, they need no more sorting.
+    if (!__leftmost && !__comp(*(__first - 1), *__first)) {
+      __first = __partition_left(__first, __last, (_Tp*)0, __comp) + 1;
+      continue;
+    }
+
+    pair<_RandomAccessIter, bool> __part =
+      __partition_right(__first, __last, (_Tp*)0, __comp, __branchless);
+    _RandomAccessIter __pivot = __part.first;
+    size_t __l_size = __pivot - __first;
+    size_t __r_size = __last - (__pivot + 1);
+
+    if (__l_size < __size / 8 || __r_size < __size / 8) {
+      // Too many unbalanced partitions: the input defeats the pivot choice,
+      // finish with heapsort to stay O(N log N).
+      if (--__bad_allowed == 0) {
+        make_heap(__first, __last, __comp);
+        sort_heap(__first, __last, __comp);
+        return;
+      }
+
+      // Otherwise shuffle a few elements to break the pattern.
+      if (__l_size >= (size_t)__stl_threshold) {
+        iter_swap(__first, __first + __l_size / 4);
+        iter_swap(__pivot - 1, __pivot - __l_size / 4);
+        if (__l_size > (size_t)__stl_ninther_threshold) {
+          iter_swap(__first + 1, __first + (__l_size / 4 + 1));
+          iter_swap(__first + 2, __first + (__l_size / 4 + 2));
+          iter_swap(__pivot - 2, __pivot - (__l_size / 4 + 1));
+          iter_swap(__pivot - 3, __pivot - (__l_size / 4 + 2));
+        }
+      }
+      if (__r_size >= (size_t)__stl_threshold) {
+        iter_swap(__pivot + 1, __pivot + (1 + __r_size / 4));
+        iter_swap(__last - 1, __last - __r_size / 4);
+        if (__r_size > (size_t)__stl_ninther_threshold) {
+          iter_swap(__pivot + 2, __pivot + (2 + __r_size / 4));
+          iter_swap(__pivot + 3, __pivot + (3 + __r_size / 4));
+          iter_swap(__last - 2, __last - (1 + __r_size / 4));
+          iter_swap(__last - 3, __last - (2 + __r_size / 4));
+        }
+      }
+    }
+    else if (__part.second &&
+             __partial_insertion_sort(__first, __pivot, (_Tp*)0, __comp) &&
+             __partial_insertion_sort(__pivot + 1, __last, (_Tp*)0, __comp))
+      // Nothing moved while partitioning and both sides were nearly sorted:
+      // sorted and almost sorted input takes linear time.
+      return;
+
+    // Recurse into the smaller side to bound the stack depth.
+    if (__l_size < __r_size) {
+      __pdqsort_loop(__first, __pivot, (_Tp*)0, __bad_allowed, __leftmost, __comp, __branchless);
+      __first = __pivot + 1;
+      __leftmost = false;
+    }
+    else {
+      __pdqsort_loop(__pivot + 1, __last, (_Tp*)0, __bad_allowed, false, __comp, __branchless);
+      __last = __pivot;
+    }
   }
 }
 
+template <class _RandomAccessIter, class _Tp, class _Compare>
+inline void __pdqsort(_RandomAccessIter __first, _RandomAccessIter __last,
+                      _Tp*, _Compare __comp) {
+  typedef typename _UseBranchlessPartition<_Tp, _Compare>::_Ret _Branchless;
+  __pdqsort_loop(__first, __last, (_Tp*)0, (int)__lg(__last - __first), true,
+                 __comp, _Branchless());
+}
+
 _STLP_MOVE_TO_STD_NAMESPACE
 
 template <class _RandomAccessIter>
 void sort(_RandomAccessIter __first, _RandomAccessIter __last) {
   _STLP_DEBUG_CHECK(_STLP_PRIV __check_range(__first, __last))
   if (__first != __last) {
-    _STLP_PRIV __introsort_loop(__first, __last,
-                                _STLP_VALUE_TYPE(__first, _RandomAccessIter),
-                                _STLP_PRIV __lg(__last - __first) * 2,
-                                _STLP_PRIV __less(_STLP_VALUE_TYPE(__first, _RandomAccessIter)));
-    _STLP_PRIV __final_insertion_sort(__first, __last,
-                                      _STLP_PRIV __less(_STLP_VALUE_TYPE(__first, _RandomAccessIter)));
+    _STLP_PRIV __pdqsort(__first, __last, _STLP_VALUE_TYPE(__first, _RandomAccessIter),
+                         _STLP_PRIV __less(_STLP_VALUE_TYPE(__first, _RandomAccessIter)));
   }
 }
 
@@ -1006,16 +1297,33 @@ template <class _RandomAccessIter, class _Compare>
 void sort(_RandomAccessIter __first, _RandomAccessIter __last, _Compare __comp) {
   _STLP_DEBUG_CHECK(_STLP_PRIV __check_range(__first, __last))
   if (__first != __last) {
-    _STLP_PRIV __introsort_loop(__first, __last,
-                                _STLP_VALUE_TYPE(__first, _RandomAccessIter),
-                                _STLP_PRIV __lg(__last - __first) * 2, __comp);
-    _STLP_PRIV __final_insertion_sort(__first, __last, __comp);
+    _STLP_PRIV __pdqsort(__first, __last, _STLP_VALUE_TYPE(__first, _RandomAccessIter), __comp);
   }
 }
 
 // stable_sort() and its auxiliary functions.
 _STLP_MOVE_TO_PRIV_NAMESPACE
 
+// Returns true if [__first, __last) was a single run and is now sorted: a
+// nondescending run is left alone and a strictly descending one, which has
+// no equal elements to keep in order, is reversed.
+template <class _RandomAccessIter, class _Compare>
+bool __sort_single_run(_RandomAccessIter __first,
+                       _RandomAccessIter __last, _Compare __comp) {
+  if (__last - __first < 2)
+    return true;
+  _RandomAccessIter __next = __first + 1;
+  if (__comp(*__next, *__first)) {
+    while (++__next != __last && __comp(*__next, *(__next - 1)));
+    if (__next != __last)
+      return false;
+    _STLP_PRIV __reverse(__first, __last, random_access_iterator_tag());
+    return true;
+  }
+  while (++__next != __last && !__comp(*__next, *(__next - 1)));
+  return __next == __last;
+}
+
 template <class _RandomAccessIter, class _Compare>
 void __inplace_stable_sort(_RandomAccessIter __first,
                            _RandomAccessIter __last, _Compare __comp) {
@@ -1023,6 +1331,8 @@ void __inplace_stable_sort(_RandomAccessIter __first,
     __insertion_sort(__first, __last, _STLP_VALUE_TYPE(__first,_RandomAccessIter), __comp);
     return;
   }
+  if (__sort_single_run(__first, __last, __comp))
+    return;
   _RandomAccessIter __middle = __first + (__last - __first) / 2;
   __inplace_stable_sort(__first, __middle, __comp);
   __inplace_stable_sort(__middle, __last, __comp);
@@ -1118,6 +1428,12 @@ void __merge_adaptive(_BidirectionalIter __first,
                       _Distance __len1, _Distance __len2,
                       _Pointer __buffer, _Distance __buffer_size,
                       _Compare __comp) {
+  if (__len1 == 0 || __len2 == 0)
+    return;
+  // Nothing to do when the two runs are already in order.
+  _BidirectionalIter __before_middle = __middle;
+  if (!__comp(*__middle, *--__before_middle))
+    return;
   if (__len1 <= __len2 && __len1 <= __buffer_size) {
     _Pointer __buffer_end = _STLP_STD::copy(__first, __middle, __buffer);
     _STLP_STD::merge(__buffer, __buffer_end, __middle, __last, __first, __comp);
@@ -1159,6 +1475,8 @@ template <class _RandomAccessIter, class _Pointer, class _Distance,
 void __stable_sort_adaptive(_RandomAccessIter __first,
                             _RandomAccessIter __last, _Pointer __buffer,
                             _Distance __buffer_size, _Compare __comp) {
+  if (__sort_single_run(__first, __last, __comp))
+    return;
   _Distance __len = (__last - __first + 1) / 2;
   _RandomAccessIter __middle = __first + __len;
   if (__len > __buffer_size) {
@@ -1182,6 +1500,9 @@ template <class _RandomAccessIter, class _Tp, class _Distance, class _Compare>
 void __stable_sort_aux(_RandomAccessIter __first,
                        _RandomAccessIter __last, _Tp*, _Distance*,
                        _Compare __comp) {
+  // Sorted and reversed input need neither the buffer nor a merge pass.
+  if (__sort_single_run(__first, __last, __comp))
+    return;
   _Temporary_buffer<_RandomAccessIter, _Tp> buf(__first, __last);
   if (buf.begin() == 0)
     __inplace_stable_sort(__first, __last, __comp);
@@ -1213,6 +1534,160 @@ void stable_sort(_RandomAccessIter __first,
                                __comp);
 }
 
+#if !defined (_STLP_NO_EXTENSIONS)
+// parallel_sort() and its auxiliary functions.
+_STLP_MOVE_TO_PRIV_NAMESPACE
+
+// Ranges shorter than this are not worth waking the pool for.
+const int __stl_parallel_sort_threshold = 1 << 15;
+
+// Start of the __i-th of __parts nearly equal slices of __len elements.
+template <class _Distance>
+inline _Distance __slice_bound(_Distance __len, size_t __i, size_t __parts) {
+  size_t __n = __len;
+  return _Distance(__n / __parts * __i + __n % __parts * __i / __parts);
+}
+
+// Number of elements of the first run among the first __k elements of the
+// stable merge of [__first1, __first1 + __len1) and [__first2, __first2 + __len2).
+template <class _RandomAccessIter, class _Distance, class _Compare>
+_Distance __merge_split(_RandomAccessIter __first1, _Distance __len1,
+                        _RandomAccessIter __first2, _Distance __len2,
+                        _Distance __k, _Compare __comp) {
+  _Distance __lo = __k > __len2 ? __k - __len2 : 0;
+  _Distance __hi = __k < __len1 ? __k : __len1;
+  while (__lo < __hi) {
+    _Distance __i = __lo + (__hi - __lo) / 2;
+    if (__comp(*(__first2 + (__k - __i - 1)), *(__first1 + __i)))
+      __hi = __i;
+    else
+      __lo = __i + 1;
+  }
+  return __lo;
+}
+
+// Merges [__lo, __mid) and [__mid, __hi) of __src into the same positions
+// of __dst; only writes the __piece-th of __pieces slices of the output.
+template <class _RandomAccessIter1, class _RandomAccessIter2, class _Distance,
+          class _Compare>
+void __merge_slice(_RandomAccessIter1 __src, _RandomAccessIter2 __dst,
+                   _Distance __lo, _Distance __mid, _Distance __hi,
+                   size_t __piece, size_t __pieces, _Compare __comp) {
+  _Distance __begin = __slice_bound(_Distance(__hi - __lo), __piece, __pieces);
+  _Distance __end = __slice_bound(_Distance(__hi - __lo), __piece + 1, __pieces);
+  _Distance __len1 = __mid - __lo, __len2 = __hi - __mid;
+  _Distance __split_begin = __merge_split(__src + __lo, __len1, __src + __mid, __len2, __begin, __comp);
+  _Distance __split_end = __merge_split(__src + __lo, __len1, __src + __mid, __len2, __end, __comp);
+  merge(__src + (__lo + __split_begin), __src + (__lo + __split_end),
+        __src + (__mid + (__begin - __split_begin)), __src + (__mid + (__end - __split_end)),
+        __dst + (__lo + __begin), __comp);
+}
+
+// The range is cut in a power of two of chunks that are sorted concurrently,
+// then merged pairwise, back and forth between the range and a buffer. Every
+// merge is split in enough slices to keep all the threads busy.
+template <class _RandomAccessIter, class _Tp, class _Distance, class _Compare>
+struct _Parallel_sort {
+  typedef _Parallel_sort<_RandomAccessIter, _Tp, _Distance, _Compare> _Self;
+
+  _RandomAccessIter _M_first;
+  _Tp* _M_buffer;
+  _Distance _M_len;
+  size_t _M_chunks;
+  size_t _M_width;      // chunks per sorted run
+  size_t _M_pieces;     // slices of each merge of two runs
+  bool _M_in_buffer;    // sorted runs are in the buffer
+  _Compare _M_comp;
+
+  _Parallel_sort(_RandomAccessIter __first, _Tp* __buffer, _Distance __len,
+                 size_t __chunks, _Compare __comp)
+    : _M_first(__first), _M_buffer(__buffer), _M_len(__len), _M_chunks(__chunks),
+      _M_width(1), _M_pieces(1), _M_in_buffer(false), _M_comp(__comp) {}
+
+  _Distance _M_bound(size_t __chunk) const
+  { return __slice_bound(_M_len, __chunk, _M_chunks); }
+
+  static void _S_sort_chunk(void* __arg, size_t __i) {
+    _Self* __self = (_Self*)__arg;
+    sort(__self->_M_first + __self->_M_bound(__i),
+         __self->_M_first + __self->_M_bound(__i + 1), __self->_M_comp);
+  }
+
+  static void _S_merge_slice(void* __arg, size_t __i) {
+    _Self* __self = (_Self*)__arg;
+    size_t __pair = __i / __self->_M_pieces;
+    size_t __lo = __pair * 2 * __self->_M_width;
+    _Distance __lo_pos = __self->_M_bound(__lo);
+    _Distance __mid_pos = __self->_M_bound(__lo + __self->_M_width);
+    _Distance __hi_pos = __self->_M_bound(__lo + 2 * __self->_M_width);
+    if (__self->_M_in_buffer)
+      __merge_slice(__self->_M_buffer, __self->_M_first, __lo_pos, __mid_pos, __hi_pos,
+                    __i % __self->_M_pieces, __self->_M_pieces, __self->_M_comp);
+    else
+      __merge_slice(__self->_M_first, __self->_M_buffer, __lo_pos, __mid_pos, __hi_pos,
+                    __i % __self->_M_pieces, __self->_M_pieces, __self->_M_comp);
+  }
+
+  static void _S_copy_back(void* __arg, size_t __i) {
+    _Self* __self = (_Self*)__arg;
+    copy(__self->_M_buffer + __self->_M_bound(__i), __self->_M_buffer + __self->_M_bound(__i + 1),
+         __self->_M_first + __self->_M_bound(__i));
+  }
+};
+
+template <class _RandomAccessIter, class _Tp, class _Distance, class _Compare>
+void __parallel_sort(_RandomAccessIter __first, _RandomAccessIter __last,
+                     _Tp*, _Distance*, _Compare __comp) {
+  size_t __threads = _Sort_pool::_S_concurrency();
+  _Distance __len = __last - __first;
+  if (__threads < 2 || __len < __stl_parallel_sort_threshold) {
+    sort(__first, __last, __comp);
+    return;
+  }
+  _Temporary_buffer<_RandomAccessIter, _Tp> __buf(__first, __last);
+  if (_Distance(__buf.size()) != __len) {
+    sort(__first, __last, __comp);
+    return;
+  }
+
+  size_t __chunks = 2;
+  while (__chunks < __threads && __len / _Distance(2 * __chunks) >= __stl_parallel_sort_threshold / 8)
+    __chunks *= 2;
+
+  typedef _Parallel_sort<_RandomAccessIter, _Tp, _Distance, _Compare> _Job;
+  _Job __job(__first, __buf.begin(), __len, __chunks, __comp);
+  _Sort_pool::_S_run(&_Job::_S_sort_chunk, &__job, __chunks);
+  for (; __job._M_width < __chunks; __job._M_width *= 2) {
+    size_t __pairs = __chunks / (2 * __job._M_width);
+    __job._M_pieces = (__threads + __pairs - 1) / __pairs;
+    _Sort_pool::_S_run(&_Job::_S_merge_slice, &__job, __pairs * __job._M_pieces);
+    __job._M_in_buffer = !__job._M_in_buffer;
+  }
+  if (__job._M_in_buffer)
+    _Sort_pool::_S_run(&_Job::_S_copy_back, &__job, __chunks);
+}
+
+_STLP_MOVE_TO_STD_NAMESPACE
+
+template <class _RandomAccessIter>
+void parallel_sort(_RandomAccessIter __first, _RandomAccessIter __last) {
+  _STLP_DEBUG_CHECK(_STLP_PRIV __check_range(__first, __last))
+  _STLP_PRIV __parallel_sort(__first, __last,
+                             _STLP_VALUE_TYPE(__first, _RandomAccessIter),
+                             _STLP_DISTANCE_TYPE(__first, _RandomAccessIter),
+                             _STLP_PRIV __less(_STLP_VALUE_TYPE(__first, _RandomAccessIter)));
+}
+
+template <class _RandomAccessIter, class _Compare>
+void parallel_sort(_RandomAccessIter __first, _RandomAccessIter __last, _Compare __comp) {
+  _STLP_DEBUG_CHECK(_STLP_PRIV __check_range(__first, __last))
+  _STLP_PRIV __parallel_sort(__first, __last,
+                             _STLP_VALUE_TYPE(__first, _RandomAccessIter),
+                             _STLP_DISTANCE_TYPE(__first, _RandomAccessIter),
+                             __comp);
+}
+#endif /* _STLP_NO_EXTENSIONS */
+
 // partial_sort, partial_sort_copy, and auxiliary functions.
 _STLP_MOVE_TO_PRIV_NAMESPACE
 
@@ -419,6 +419,31 @@ void sort(_RandomAccessIter __first, _RandomAccessIter __last);
 template <class _RandomAccessIter, class _Compare>
 void sort(_RandomAccessIter __first, _RandomAccessIter __last, _Compare __comp);
 
+#if !defined (_STLP_NO_EXTENSIONS)
+// parallel_sort, an extension: sort() for large ranges, split between the
+// threads of a pool. The comparator is called from several threads at once
+// and, like the copy of an element, must not throw.
+_STLP_MOVE_TO_PRIV_NAMESPACE
+
+class _STLP_CLASS_DECLSPEC _Sort_pool {
+public:
+  typedef void (*_Task)(void*, size_t);
+  // Number of threads, the caller included, that _S_run may use.
+  static size_t _STLP_CALL _S_concurrency();
+  // Calls __task(__arg, __i) for every __i in [0, __n) and returns when they
+  // have all completed. While the pool is busy with another caller the
+  // calls are all made by the calling thread.
+  static void _STLP_CALL _S_run(_Task __task, void* __arg, size_t __n);
+};
+
+_STLP_MOVE_TO_STD_NAMESPACE
+
+template <class _RandomAccessIter>
+void parallel_sort(_RandomAccessIter __first, _RandomAccessIter __last);
+template <class _RandomAccessIter, class _Compare>
+void parallel_sort(_RandomAccessIter __first, _RandomAccessIter __last, _Compare __comp);
+#endif /* _STLP_NO_EXTENSIONS */
+
 // stable_sort() and its auxiliary functions.
 template <class _RandomAccessIter>
 void stable_sort(_RandomAccessIter __first,
@@ -141,6 +141,13 @@ enum { _MAX_BYTES = 256 };
 enum { _MAX_BYTES = 32 * sizeof(void*) };
 #  endif
 
+#  if defined (_STLP_USE_THREAD_CACHING_NODE_ALLOC)
+// Largest request served by the node allocator
+enum { _MAX_NODE_BYTES = 2048 };
+#  else
+enum { _MAX_NODE_BYTES = _MAX_BYTES };
+#  endif
+
 #if !defined (_STLP_USE_NO_IOSTREAMS)
 // Default node allocator.
 // With a reasonable compiler, this should be roughly as fast as the
@@ -155,10 +162,16 @@ public:
   typedef char value_type;
   /* __n must be > 0      */
   static void* _STLP_CALL allocate(size_t& __n)
-  { return (__n > (size_t)_MAX_BYTES) ? __stl_new(__n) : _M_allocate(__n); }
+  { return (__n > (size_t)_MAX_NODE_BYTES) ? __stl_new(__n) : _M_allocate(__n); }
   /* __p may not be 0 */
   static void _STLP_CALL deallocate(void *__p, size_t __n)
-  { if (__n > (size_t)_MAX_BYTES) __stl_delete(__p); else _M_deallocate(__p, __n); }
+  { if (__n > (size_t)_MAX_NODE_BYTES) __stl_delete(__p); else _M_deallocate(__p, __n); }
+#  if defined (_STLP_USE_THREAD_CACHING_NODE_ALLOC)
+  /* Gives back to the system the memory of free nodes, as far as possible.
+   * Meant to be called when the application is asked to reduce its memory
+   * footprint. */
+  static void _STLP_CALL release_free_memory();
+#  endif
 };
 
 #  if defined (_STLP_USE_TEMPLATE_EXPORT)
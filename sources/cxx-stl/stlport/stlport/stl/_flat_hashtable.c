@@ -0,0 +1,273 @@
+/*
+ * This material is provided "as is", with absolutely no warranty expressed
+ * or implied. Any use is at your own risk.
+ *
+ * Permission to use or copy this software for any purpose is hereby granted
+ * without fee, provided the above notices are retained on all copies.
+ * Permission to modify the code and to distribute modified code is granted,
+ * provided the above notices are retained, and a notice that the code was
+ * modified is included with the above copyright notice.
+ *
+ */
+#ifndef _STLP_FLAT_HASHTABLE_C
+#define _STLP_FLAT_HASHTABLE_C
+
+#ifndef _STLP_INTERNAL_FLAT_HASHTABLE_H
+#  include <stl/_flat_hashtable.h>
+#endif
+
+_STLP_BEGIN_NAMESPACE
+
+_STLP_MOVE_TO_PRIV_NAMESPACE
+
+// fbp: these defines are for outline methods definitions.
+// needed to definitions to be portable. Should not be used in method bodies.
+
+#if defined ( _STLP_NESTED_TYPE_PARAM_BUG )
+#  define __size_type__       size_t
+#  define size_type           size_t
+#  define value_type          _Val
+#  define key_type            _Key
+#  define __iterator__        _Flat_ht_iterator<_Val, _STLP_HEADER_TYPENAME _Traits::_NonConstTraits>
+#else
+#  define __size_type__       _STLP_TYPENAME_ON_RETURN_TYPE _Flat_hashtable<_Val, _Key, _HF, _Traits, _ExK, _EqK, _All>::size_type
+#  define __iterator__        _STLP_TYPENAME_ON_RETURN_TYPE _Flat_hashtable<_Val, _Key, _HF, _Traits, _ExK, _EqK, _All>::iterator
+#endif
+
+template <class _Val, class _Key, class _HF,
+          class _Traits, class _ExK, class _EqK, class _All>
+__size_type__
+_Flat_hashtable<_Val,_Key,_HF,_Traits,_ExK,_EqK,_All>
+  ::_S_capacity_for(size_type __n) {
+  size_type __capacity = _Group::_S_width;
+  while (_S_max_load(__capacity) < __n)
+    __capacity *= 2;
+  return __capacity;
+}
+
+template <class _Val, class _Key, class _HF,
+          class _Traits, class _ExK, class _EqK, class _All>
+__iterator__
+_Flat_hashtable<_Val,_Key,_HF,_Traits,_ExK,_EqK,_All>
+  ::_M_insert_new(size_type __h, const value_type& __obj) {
+  size_type __pos = _M_capacity != 0 ? _S_find_free(_M_ctrl._M_data, _M_capacity, __h) : 0;
+  if (_M_growth_left == 0 &&
+      (_M_capacity == 0 || _M_ctrl._M_data[__pos] == _Group::_S_empty)) {
+    // No empty slot left: drop the deleted ones if they take at least half
+    // of the room, grow otherwise.
+    size_type __capacity = _M_capacity * 2;
+    if (__capacity == 0)
+      __capacity = _Group::_S_width;
+    else if (_M_num_elements < _S_max_load(_M_capacity) / 2)
+      __capacity = _M_capacity;
+    _M_rehash(__capacity);
+    __pos = _S_find_free(_M_ctrl._M_data, _M_capacity, __h);
+  }
+  _STLP_STD::_Copy_Construct(_M_slots._M_data + __pos, __obj);
+  if (_M_ctrl._M_data[__pos] == _Group::_S_empty)
+    --_M_growth_left;
+  _M_ctrl._M_data[__pos] = (signed char)(__h & 0x7f);
+  ++_M_num_elements;
+  return _M_iterator(__pos);
+}
+
+template <class _Val, class _Key, class _HF,
+          class _Traits, class _ExK, class _EqK, class _All>
+void _Flat_hashtable<_Val,_Key,_HF,_Traits,_ExK,_EqK,_All>
+  ::_M_erase(size_type __slot) {
+  _STLP_STD::_Destroy(_M_slots._M_data + __slot);
+  --_M_num_elements;
+  // A group with an empty slot ends every probe sequence going through it,
+  // so the slot can be made empty again. Otherwise an element stored further
+  // on a probe sequence could not be found anymore.
+  signed char* __ctrl = _M_ctrl._M_data;
+  if (_Group(__ctrl + (__slot & ~(size_type)(_Group::_S_width - 1)))._M_match_empty() != 0) {
+    __ctrl[__slot] = _Group::_S_empty;
+    ++_M_growth_left;
+  }
+  else
+    __ctrl[__slot] = _Group::_S_deleted;
+}
+
+template <class _Val, class _Key, class _HF,
+          class _Traits, class _ExK, class _EqK, class _All>
+void _Flat_hashtable<_Val,_Key,_HF,_Traits,_ExK,_EqK,_All>
+  ::_M_rehash(size_type __capacity) {
+#if !defined (_STLP_NO_MOVE_SEMANTIC)
+  typedef typename __move_traits<_Val>::implemented _Movable;
+#else
+  typedef __false_type _Movable;
+#endif
+  signed char* __ctrl = _M_ctrl.allocate(__capacity + 1);
+  _Val* __slots = 0;
+  _STLP_TRY {
+    __slots = _M_slots.allocate(__capacity);
+  }
+  _STLP_UNWIND(_M_ctrl.deallocate(__ctrl, __capacity + 1))
+  memset(__ctrl, _Group::_S_empty, __capacity);
+  __ctrl[__capacity] = _Group::_S_end;
+
+  _STLP_TRY {
+    _M_transfer(__ctrl, __slots, __capacity, _Movable());
+  }
+  _STLP_UNWIND((_M_slots.deallocate(__slots, __capacity), _M_ctrl.deallocate(__ctrl, __capacity + 1)))
+
+  if (_M_capacity != 0) {
+    _M_slots.deallocate(_M_slots._M_data, _M_capacity);
+    _M_ctrl.deallocate(_M_ctrl._M_data, _M_capacity + 1);
+  }
+  _M_ctrl._M_data = __ctrl;
+  _M_slots._M_data = __slots;
+  _M_capacity = __capacity;
+  _M_growth_left = _S_max_load(__capacity) - _M_num_elements;
+}
+
+template <class _Val, class _Key, class _HF,
+          class _Traits, class _ExK, class _EqK, class _All>
+void _Flat_hashtable<_Val,_Key,_HF,_Traits,_ExK,_EqK,_All>
+  ::_M_transfer(signed char* __ctrl, _Val* __slots, size_type __capacity,
+                const __true_type& /*_Movable*/) {
+  signed char* __old_ctrl = _M_ctrl._M_data;
+  _Val* __old_slots = _M_slots._M_data;
+  _STLP_TRY {
+    for (size_type __i = 0; __i < _M_capacity; ++__i) {
+      if (__old_ctrl[__i] < 0)
+        continue;
+      const size_type __h = _M_hash_key(_M_get_key(__old_slots[__i]));
+      const size_type __pos = _S_find_free(__ctrl, __capacity, __h);
+      _S_transfer(__slots + __pos, __old_slots[__i], __true_type());
+      __ctrl[__pos] = (signed char)(__h & 0x7f);
+      // Keeps the table consistent if the hasher throws
+      __old_ctrl[__i] = _Group::_S_deleted;
+    }
+  }
+  _STLP_UNWIND(_M_num_elements -= _S_destroy(__ctrl, __slots, __capacity))
+}
+
+template <class _Val, class _Key, class _HF,
+          class _Traits, class _ExK, class _EqK, class _All>
+void _Flat_hashtable<_Val,_Key,_HF,_Traits,_ExK,_EqK,_All>
+  ::_M_transfer(signed char* __ctrl, _Val* __slots, size_type __capacity,
+                const __false_type& /*_Movable*/) {
+  const signed char* __old_ctrl = _M_ctrl._M_data;
+  _Val* __old_slots = _M_slots._M_data;
+  _STLP_TRY {
+    for (size_type __i = 0; __i < _M_capacity; ++__i) {
+      if (__old_ctrl[__i] < 0)
+        continue;
+      const size_type __h = _M_hash_key(_M_get_key(__old_slots[__i]));
+      const size_type __pos = _S_find_free(__ctrl, __capacity, __h);
+      _S_transfer(__slots + __pos, __old_slots[__i], __false_type());
+      __ctrl[__pos] = (signed char)(__h & 0x7f);
+    }
+  }
+  _STLP_UNWIND(_S_destroy(__ctrl, __slots, __capacity))
+  _S_destroy(__old_ctrl, __old_slots, _M_capacity);
+}
+
+template <class _Val, class _Key, class _HF,
+          class _Traits, class _ExK, class _EqK, class _All>
+__size_type__
+_Flat_hashtable<_Val,_Key,_HF,_Traits,_ExK,_EqK,_All>
+  ::_S_destroy(const signed char* __ctrl, _Val* __slots, size_type __capacity) {
+  size_type __n = 0;
+  for (size_type __i = 0; __i < __capacity; ++__i) {
+    if (__ctrl[__i] >= 0) {
+      _STLP_STD::_Destroy(__slots + __i);
+      ++__n;
+    }
+  }
+  return __n;
+}
+
+template <class _Val, class _Key, class _HF,
+          class _Traits, class _ExK, class _EqK, class _All>
+void _Flat_hashtable<_Val,_Key,_HF,_Traits,_ExK,_EqK,_All>
+  ::_M_deallocate() {
+  if (_M_capacity != 0) {
+    if (_M_num_elements != 0)
+      _S_destroy(_M_ctrl._M_data, _M_slots._M_data, _M_capacity);
+    _M_slots.deallocate(_M_slots._M_data, _M_capacity);
+    _M_ctrl.deallocate(_M_ctrl._M_data, _M_capacity + 1);
+  }
+}
+
+template <class _Val, class _Key, class _HF,
+          class _Traits, class _ExK, class _EqK, class _All>
+void _Flat_hashtable<_Val,_Key,_HF,_Traits,_ExK,_EqK,_All>
+  ::clear() {
+  if (_M_num_elements != 0)
+    _S_destroy(_M_ctrl._M_data, _M_slots._M_data, _M_capacity);
+  if (_M_capacity != 0)
+    memset(_M_ctrl._M_data, _Group::_S_empty, _M_capacity);
+  _M_num_elements = 0;
+  _M_growth_left = _S_max_load(_M_capacity);
+}
+
+template <class _Val, class _Key, class _HF,
+          class _Traits, class _ExK, class _EqK, class _All>
+void _Flat_hashtable<_Val,_Key,_HF,_Traits,_ExK,_EqK,_All>
+  ::rehash(size_type __n) {
+  if (__n < _M_num_elements)
+    __n = _M_num_elements;
+  if (__n == 0) {
+    _M_deallocate();
+    _M_slots._M_data = 0;
+    _M_ctrl._M_data = 0;
+    _M_capacity = _M_growth_left = 0;
+    return;
+  }
+  _M_rehash(_S_capacity_for(__n));
+}
+
+template <class _Val, class _Key, class _HF,
+          class _Traits, class _ExK, class _EqK, class _All>
+void _Flat_hashtable<_Val,_Key,_HF,_Traits,_ExK,_EqK,_All>
+  ::_M_copy_from(const _Self& __ht) {
+  if (__ht._M_num_elements == 0)
+    return;
+  // Same layout as __ht, the elements do not need to be hashed again
+  const size_type __capacity = __ht._M_capacity;
+  signed char* __ctrl = _M_ctrl.allocate(__capacity + 1);
+  _Val* __slots = 0;
+  _STLP_TRY {
+    __slots = _M_slots.allocate(__capacity);
+  }
+  _STLP_UNWIND(_M_ctrl.deallocate(__ctrl, __capacity + 1))
+  memset(__ctrl, _Group::_S_empty, __capacity);
+  __ctrl[__capacity] = _Group::_S_end;
+
+  _STLP_TRY {
+    for (size_type __i = 0; __i < __capacity; ++__i) {
+      if (__ht._M_ctrl._M_data[__i] >= 0) {
+        _STLP_STD::_Copy_Construct(__slots + __i, __ht._M_slots._M_data[__i]);
+        __ctrl[__i] = __ht._M_ctrl._M_data[__i];
+      }
+    }
+  }
+  _STLP_UNWIND((_S_destroy(__ctrl, __slots, __capacity),
+                _M_slots.deallocate(__slots, __capacity),
+                _M_ctrl.deallocate(__ctrl, __capacity + 1)))
+  // Deleted slots are not copied, the copy can use them
+  _M_ctrl._M_data = __ctrl;
+  _M_slots._M_data = __slots;
+  _M_capacity = __capacity;
+  _M_num_elements = __ht._M_num_elements;
+  _M_growth_left = _S_max_load(__capacity) - _M_num_elements;
+}
+
+#undef __iterator__
+#undef __size_type__
+#undef size_type
+#undef value_type
+#undef key_type
+
+_STLP_MOVE_TO_STD_NAMESPACE
+
+_STLP_END_NAMESPACE
+
+#endif /*  _STLP_FLAT_HASHTABLE_C */
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,524 @@
+/*
+ * This material is provided "as is", with absolutely no warranty expressed
+ * or implied. Any use is at your own risk.
+ *
+ * Permission to use or copy this software for any purpose is hereby granted
+ * without fee, provided the above notices are retained on all copies.
+ * Permission to modify the code and to distribute modified code is granted,
+ * provided the above notices are retained, and a notice that the code was
+ * modified is included with the above copyright notice.
+ *
+ */
+
+/* NOTE: This is an internal header file, included by other STL headers.
+ *   You should not attempt to use it directly.
+ */
+
+#ifndef _STLP_INTERNAL_FLAT_HASHTABLE_H
+#define _STLP_INTERNAL_FLAT_HASHTABLE_H
+
+#ifndef _STLP_INTERNAL_ALLOC_H
+#  include <stl/_alloc.h>
+#endif
+
+#ifndef _STLP_INTERNAL_CONSTRUCT_H
+#  include <stl/_construct.h>
+#endif
+
+#ifndef _STLP_INTERNAL_ITERATOR_H
+#  include <stl/_iterator.h>
+#endif
+
+#ifndef _STLP_INTERNAL_FUNCTION_BASE_H
+#  include <stl/_function_base.h>
+#endif
+
+#ifndef _STLP_INTERNAL_ALGOBASE_H
+#  include <stl/_algobase.h>
+#endif
+
+#ifndef _STLP_HASH_FUN_H
+#  include <stl/_hash_fun.h>
+#endif
+
+#ifndef _STLP_INTERNAL_CSTRING
+#  include <stl/_cstring.h>
+#endif
+
+#if defined (__SSE2__)
+#  include <emmintrin.h>
+#elif defined (__aarch64__)
+#  include <arm_neon.h>
+#endif
+
+/*
+ * Open addressing hashtable, used to implement flat_hash_map and
+ * flat_hash_set.
+ *
+ * Elements are stored in one array of slots. A second array holds one
+ * control byte per slot: empty, deleted, or the 7 low bits of the hash of
+ * the element for a full slot. Slots are probed a group at a time, a group
+ * being as many control bytes as fit in a SIMD register (16 with SSE2,
+ * 8 otherwise), compared all at once with the 7 bits of the hash looked for.
+ * Only slots of matching control bytes have their key compared. Groups are
+ * aligned and visited in quadratic order, the number of slots is a power of
+ * two, and the table grows when 7/8th of the slots are used.
+ *
+ * Inserting may rehash the table, which invalidates all iterators and
+ * references to elements. Erasing only invalidates the erased element.
+ */
+
+_STLP_BEGIN_NAMESPACE
+
+_STLP_MOVE_TO_PRIV_NAMESPACE
+
+struct _Flat_group {
+  // Control bytes of slots that are not full, full ones are in [0, 127]
+  enum { _S_empty = -128, _S_deleted = -2, _S_end = -1 };
+
+#if defined (__SSE2__)
+  enum { _S_width = 16, _S_shift = 0 };
+  typedef unsigned int _Mask;
+
+  explicit _Flat_group(const signed char* __ctrl)
+    : _M_ctrl(_mm_loadu_si128(__REINTERPRET_CAST(const __m128i*, __ctrl))) {}
+
+  _Mask _M_match(signed char __h2) const
+  { return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(__h2), _M_ctrl)); }
+  _Mask _M_match_empty() const
+  { return _M_match(_S_empty); }
+  // Empty or deleted slots
+  _Mask _M_match_free() const
+  { return _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(_S_end), _M_ctrl)); }
+
+  __m128i _M_ctrl;
+#else
+  // Matches are reported in the high bit of each byte of the mask
+  enum { _S_width = 8, _S_shift = 3 };
+  typedef unsigned _STLP_LONG_LONG _Mask;
+
+  explicit _Flat_group(const signed char* __ctrl) {
+    memcpy(&_M_ctrl, __ctrl, sizeof(_M_ctrl));
+#  if defined (__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    _M_ctrl = __builtin_bswap64(_M_ctrl);
+#  endif
+  }
+
+  static _Mask _S_lsbs() { return (_Mask)0x0101010101010101ULL; }
+  static _Mask _S_msbs() { return (_Mask)0x8080808080808080ULL; }
+
+  _Mask _M_match(signed char __h2) const {
+#  if defined (__aarch64__)
+    uint8x8_t __eq = vceq_u8(vcreate_u8(_M_ctrl), vdup_n_u8((unsigned char)__h2));
+    return vget_lane_u64(vreinterpret_u64_u8(__eq), 0) & _S_msbs();
+#  else
+    // May also report a full slot following a match, whose key is then
+    // compared for nothing.
+    _Mask __x = _M_ctrl ^ (_S_lsbs() * (unsigned char)__h2);
+    return (__x - _S_lsbs()) & ~__x & _S_msbs();
+#  endif
+  }
+  _Mask _M_match_empty() const
+  { return _M_ctrl & ~(_M_ctrl << 6) & _S_msbs(); }
+  _Mask _M_match_free() const
+  { return _M_ctrl & ~(_M_ctrl << 7) & _S_msbs(); }
+
+  _Mask _M_ctrl;
+#endif
+
+  static size_t _S_lowest(_Mask __m) {
+#if defined (__GNUC__)
+    return (sizeof(_Mask) > sizeof(unsigned int) ? __builtin_ctzll(__m) : __builtin_ctz((unsigned int)__m)) >> _S_shift;
+#else
+    size_t __i = 0;
+    for (; (__m & 1) == 0; __m >>= 1, ++__i);
+    return __i >> _S_shift;
+#endif
+  }
+};
+
+// Spreads the bits of the hash code, functors like hash<int> returning the
+// key itself would otherwise only fill the first groups.
+inline size_t __flat_hash_mix(size_t __h) {
+#if defined (__LP64__) || defined (_WIN64)
+  __h *= (size_t)0x9E3779B97F4A7C15ULL;
+  return __h ^ (__h >> 32);
+#else
+  __h *= (size_t)0x9E3779B9UL;
+  return __h ^ (__h >> 16);
+#endif
+}
+
+template <class _Val, class _Traits>
+struct _Flat_ht_iterator {
+  typedef typename _Traits::_ConstTraits _ConstTraits;
+  typedef typename _Traits::_NonConstTraits _NonConstTraits;
+
+  typedef _Flat_ht_iterator<_Val, _Traits> _Self;
+
+  typedef typename _Traits::value_type value_type;
+  typedef typename _Traits::pointer pointer;
+  typedef typename _Traits::reference reference;
+  typedef forward_iterator_tag iterator_category;
+  typedef ptrdiff_t difference_type;
+  typedef size_t size_type;
+
+  typedef _Flat_ht_iterator<_Val, _NonConstTraits> iterator;
+  typedef _Flat_ht_iterator<_Val, _ConstTraits> const_iterator;
+
+  _Flat_ht_iterator() {}
+  //copy constructor for iterator and constructor from iterator for const_iterator
+  _Flat_ht_iterator(const iterator& __it) : _M_ctrl(__it._M_ctrl), _M_slot(__it._M_slot) {}
+  _Flat_ht_iterator(const signed char* __ctrl, _Val* __slot) : _M_ctrl(__ctrl), _M_slot(__slot) {}
+
+  reference operator*() const {
+    return *_M_slot;
+  }
+  _STLP_DEFINE_ARROW_OPERATOR
+
+  _Self& operator++() {
+    ++_M_ctrl;
+    ++_M_slot;
+    _M_skip_free();
+    return *this;
+  }
+  _Self operator++(int) {
+    _Self __tmp = *this;
+    ++*this;
+    return __tmp;
+  }
+
+  bool operator == (const_iterator __rhs) const {
+    return _M_ctrl == __rhs._M_ctrl;
+  }
+  bool operator != (const_iterator __rhs) const {
+    return _M_ctrl != __rhs._M_ctrl;
+  }
+
+  // Stops on the next full slot or on the end marker
+  void _M_skip_free() {
+    while (*_M_ctrl < _Flat_group::_S_end) {
+      ++_M_ctrl;
+      ++_M_slot;
+    }
+  }
+
+  const signed char* _M_ctrl;
+  _Val* _M_slot;
+};
+
+_STLP_MOVE_TO_STD_NAMESPACE
+
+#if defined (_STLP_CLASS_PARTIAL_SPECIALIZATION)
+template <class _Val, class _Traits>
+struct __type_traits<_STLP_PRIV _Flat_ht_iterator<_Val, _Traits> > {
+  typedef __false_type   has_trivial_default_constructor;
+  typedef __true_type    has_trivial_copy_constructor;
+  typedef __true_type    has_trivial_assignment_operator;
+  typedef __true_type    has_trivial_destructor;
+  typedef __false_type   is_POD_type;
+};
+#endif /* _STLP_CLASS_PARTIAL_SPECIALIZATION */
+
+_STLP_MOVE_TO_PRIV_NAMESPACE
+
+template <class _Val, class _Key, class _HF,
+          class _Traits, class _ExK, class _EqK, class _All>
+class _Flat_hashtable {
+  typedef _Flat_hashtable<_Val, _Key, _HF, _Traits, _ExK, _EqK, _All> _Self;
+  typedef typename _Traits::_NonConstTraits _NonConstTraits;
+  typedef typename _Traits::_ConstTraits _ConstTraits;
+  typedef _Flat_group _Group;
+
+public:
+  typedef _Key key_type;
+  typedef _Val value_type;
+  typedef _HF hasher;
+  typedef _EqK key_equal;
+
+  typedef size_t            size_type;
+  typedef ptrdiff_t         difference_type;
+  typedef typename _NonConstTraits::pointer pointer;
+  typedef const value_type* const_pointer;
+  typedef typename _NonConstTraits::reference reference;
+  typedef const value_type& const_reference;
+  typedef forward_iterator_tag _Iterator_category;
+
+  typedef _Flat_ht_iterator<_Val, _NonConstTraits> iterator;
+  typedef _Flat_ht_iterator<_Val, _ConstTraits> const_iterator;
+
+  hasher hash_funct() const { return _M_hash; }
+  key_equal key_eq() const { return _M_equals; }
+
+private:
+  _STLP_FORCE_ALLOCATORS(_Val, _All)
+  typedef typename _Alloc_traits<signed char, _All>::allocator_type _CtrlAllocType;
+  typedef _STLP_alloc_proxy<_Val*, _Val, _All> _SlotsProxy;
+  typedef _STLP_alloc_proxy<signed char*, signed char, _CtrlAllocType> _CtrlProxy;
+
+  hasher                _M_hash;
+  key_equal             _M_equals;
+  _SlotsProxy           _M_slots;
+  _CtrlProxy            _M_ctrl;
+  size_type             _M_capacity;
+  size_type             _M_num_elements;
+  // Empty slots that can still be used before the table has to grow
+  size_type             _M_growth_left;
+  _STLP_KEY_TYPE_FOR_CONT_EXT(key_type)
+
+  static const key_type& _M_get_key(const value_type& __val) {
+    _ExK k;
+    return k(__val);
+  }
+
+public:
+  typedef _All allocator_type;
+  allocator_type get_allocator() const
+  { return _STLP_CONVERT_ALLOCATOR((const allocator_type&)_M_slots, _Val); }
+
+  _Flat_hashtable(size_type __n, const _HF& __hf, const _EqK& __eql,
+                  const allocator_type& __a)
+    : _M_hash(__hf),
+      _M_equals(__eql),
+      _M_slots(__a, 0),
+      _M_ctrl(_STLP_CONVERT_ALLOCATOR(__a, signed char), 0),
+      _M_capacity(0),
+      _M_num_elements(0),
+      _M_growth_left(0)
+  { if (__n != 0) _M_rehash(_S_capacity_for(__n)); }
+
+  _Flat_hashtable(const _Self& __ht)
+    : _M_hash(__ht._M_hash),
+      _M_equals(__ht._M_equals),
+      _M_slots(__ht.get_allocator(), 0),
+      _M_ctrl(_STLP_CONVERT_ALLOCATOR(__ht.get_allocator(), signed char), 0),
+      _M_capacity(0),
+      _M_num_elements(0),
+      _M_growth_left(0)
+  { _M_copy_from(__ht); }
+
+#if !defined (_STLP_NO_MOVE_SEMANTIC)
+  _Flat_hashtable(__move_source<_Self> src)
+    : _M_hash(_STLP_PRIV _AsMoveSource(src.get()._M_hash)),
+      _M_equals(_STLP_PRIV _AsMoveSource(src.get()._M_equals)),
+      _M_slots(__move_source<_SlotsProxy>(src.get()._M_slots)),
+      _M_ctrl(__move_source<_CtrlProxy>(src.get()._M_ctrl)),
+      _M_capacity(src.get()._M_capacity),
+      _M_num_elements(src.get()._M_num_elements),
+      _M_growth_left(src.get()._M_growth_left) {
+    src.get()._M_slots._M_data = 0;
+    src.get()._M_ctrl._M_data = 0;
+    src.get()._M_capacity = src.get()._M_num_elements = src.get()._M_growth_left = 0;
+  }
+#endif
+
+  _Self& operator= (const _Self& __ht) {
+    if (&__ht != this) {
+      _Self __tmp(__ht);
+      swap(__tmp);
+    }
+    return *this;
+  }
+
+  ~_Flat_hashtable() { _M_deallocate(); }
+
+  size_type size() const { return _M_num_elements; }
+  size_type max_size() const { return size_type(-1) / (sizeof(value_type) + 1); }
+  bool empty() const { return size() == 0; }
+
+  void swap(_Self& __ht) {
+    _STLP_STD::swap(_M_hash, __ht._M_hash);
+    _STLP_STD::swap(_M_equals, __ht._M_equals);
+    _M_slots.swap(__ht._M_slots);
+    _M_ctrl.swap(__ht._M_ctrl);
+    _STLP_STD::swap(_M_capacity, __ht._M_capacity);
+    _STLP_STD::swap(_M_num_elements, __ht._M_num_elements);
+    _STLP_STD::swap(_M_growth_left, __ht._M_growth_left);
+  }
+
+  iterator begin() {
+    if (_M_num_elements == 0)
+      return end();
+    iterator __it(_M_ctrl._M_data, _M_slots._M_data);
+    __it._M_skip_free();
+    return __it;
+  }
+  iterator end() { return iterator(_M_ctrl._M_data + _M_capacity, _M_slots._M_data + _M_capacity); }
+  const_iterator begin() const { return __CONST_CAST(_Self*, this)->begin(); }
+  const_iterator end() const { return __CONST_CAST(_Self*, this)->end(); }
+
+  size_type capacity() const { return _M_capacity; }
+  float load_factor() const
+  { return _M_capacity != 0 ? (float)size() / (float)_M_capacity : 0.0f; }
+  float max_load_factor() const { return 0.875f; }
+
+  _STLP_TEMPLATE_FOR_CONT_EXT
+  size_type _M_hash_key(const _KT& __key) const
+  { return _STLP_PRIV __flat_hash_mix(_M_hash(__key)); }
+
+  // Slot holding __key, or _M_capacity
+  _STLP_TEMPLATE_FOR_CONT_EXT
+  size_type _M_find(const _KT& __key, size_type __h) const {
+    if (_M_num_elements == 0)
+      return _M_capacity;
+    const signed char __h2 = (signed char)(__h & 0x7f);
+    const size_type __groups_mask = (_M_capacity / _Group::_S_width) - 1;
+    size_type __g = (__h >> 7) & __groups_mask;
+    for (size_type __i = 1; ; ++__i) {
+      const size_type __pos = __g * _Group::_S_width;
+      _Group __grp(_M_ctrl._M_data + __pos);
+      for (typename _Group::_Mask __m = __grp._M_match(__h2); __m != 0; __m &= __m - 1) {
+        const size_type __slot = __pos + _Group::_S_lowest(__m);
+        if (_M_equals(_M_get_key(_M_slots._M_data[__slot]), __key))
+          return __slot;
+      }
+      if (__grp._M_match_empty() != 0)
+        return _M_capacity;
+      __g = (__g + __i) & __groups_mask;
+    }
+  }
+
+  iterator _M_iterator(size_type __slot)
+  { return iterator(_M_ctrl._M_data + __slot, _M_slots._M_data + __slot); }
+
+  // Stores __obj which key, of hash __h, is not in the table yet
+  iterator _M_insert_new(size_type __h, const value_type& __obj);
+
+  pair<iterator, bool> insert_unique(const value_type& __obj) {
+    const size_type __h = _M_hash_key(_M_get_key(__obj));
+    const size_type __slot = _M_find(_M_get_key(__obj), __h);
+    if (__slot != _M_capacity)
+      return pair<iterator, bool>(_M_iterator(__slot), false);
+    return pair<iterator, bool>(_M_insert_new(__h, __obj), true);
+  }
+
+#if defined (_STLP_MEMBER_TEMPLATES)
+  template <class _InputIterator>
+  void insert_unique(_InputIterator __f, _InputIterator __l) {
+    for ( ; __f != __l; ++__f)
+      insert_unique(*__f);
+  }
+#else /* _STLP_MEMBER_TEMPLATES */
+  void insert_unique(const value_type* __f, const value_type* __l) {
+    for ( ; __f != __l; ++__f)
+      insert_unique(*__f);
+  }
+
+  void insert_unique(const_iterator __f, const_iterator __l) {
+    for ( ; __f != __l; ++__f)
+      insert_unique(*__f);
+  }
+#endif /*_STLP_MEMBER_TEMPLATES */
+
+  _STLP_TEMPLATE_FOR_CONT_EXT
+  iterator find(const _KT& __key)
+  { return _M_iterator(_M_find(__key, _M_hash_key(__key))); }
+  _STLP_TEMPLATE_FOR_CONT_EXT
+  const_iterator find(const _KT& __key) const
+  { return __CONST_CAST(_Self*, this)->_M_iterator(_M_find(__key, _M_hash_key(__key))); }
+
+  _STLP_TEMPLATE_FOR_CONT_EXT
+  size_type count(const _KT& __key) const
+  { return _M_find(__key, _M_hash_key(__key)) != _M_capacity ? 1 : 0; }
+
+  _STLP_TEMPLATE_FOR_CONT_EXT
+  pair<iterator, iterator> equal_range(const _KT& __key) {
+    iterator __first = find(__key);
+    iterator __last = __first;
+    if (__first != end())
+      ++__last;
+    return pair<iterator, iterator>(__first, __last);
+  }
+  _STLP_TEMPLATE_FOR_CONT_EXT
+  pair<const_iterator, const_iterator> equal_range(const _KT& __key) const {
+    const_iterator __first = find(__key);
+    const_iterator __last = __first;
+    if (__first != end())
+      ++__last;
+    return pair<const_iterator, const_iterator>(__first, __last);
+  }
+
+  size_type erase(const key_type& __key) {
+    const size_type __slot = _M_find(__key, _M_hash_key(__key));
+    if (__slot == _M_capacity)
+      return 0;
+    _M_erase(__slot);
+    return 1;
+  }
+  void erase(const_iterator __it)
+  { _M_erase(__it._M_ctrl - _M_ctrl._M_data); }
+  void erase(const_iterator __first, const_iterator __last) {
+    for (; __first != __last; ++__first)
+      _M_erase(__first._M_ctrl - _M_ctrl._M_data);
+  }
+
+  void clear();
+  void rehash(size_type __n);
+  void reserve(size_type __n) {
+    if (__n > _M_num_elements + _M_growth_left)
+      _M_rehash(_S_capacity_for(__n));
+  }
+
+private:
+  static size_type _S_max_load(size_type __capacity)
+  { return __capacity - __capacity / 8; }
+  static size_type _S_capacity_for(size_type __n);
+
+  // First empty or deleted slot on the probe sequence of hash __h
+  static size_type _S_find_free(const signed char* __ctrl, size_type __capacity, size_type __h) {
+    const size_type __groups_mask = (__capacity / _Group::_S_width) - 1;
+    size_type __g = (__h >> 7) & __groups_mask;
+    for (size_type __i = 1; ; ++__i) {
+      const size_type __pos = __g * _Group::_S_width;
+      typename _Group::_Mask __m = _Group(__ctrl + __pos)._M_match_free();
+      if (__m != 0)
+        return __pos + _Group::_S_lowest(__m);
+      __g = (__g + __i) & __groups_mask;
+    }
+  }
+
+  static void _S_transfer(_Val* __dst, _Val& __src, const __true_type& /*_Movable*/) {
+    _STLP_STD::_Move_Construct(__dst, __src);
+    _STLP_STD::_Destroy_Moved(&__src);
+  }
+  static void _S_transfer(_Val* __dst, _Val& __src, const __false_type& /*_Movable*/)
+  { _STLP_STD::_Copy_Construct(__dst, __src); }
+
+  static size_type _S_destroy(const signed char* __ctrl, _Val* __slots, size_type __capacity);
+
+  void _M_erase(size_type __slot);
+  void _M_rehash(size_type __capacity);
+  void _M_transfer(signed char* __ctrl, _Val* __slots, size_type __capacity, const __true_type& /*_Movable*/);
+  void _M_transfer(signed char* __ctrl, _Val* __slots, size_type __capacity, const __false_type& /*_Movable*/);
+  void _M_deallocate();
+  void _M_copy_from(const _Self& __ht);
+};
+
+_STLP_MOVE_TO_STD_NAMESPACE
+
+_STLP_END_NAMESPACE
+
+#if !defined (_STLP_LINK_TIME_INSTANTIATION)
+#  include <stl/_flat_hashtable.c>
+#endif
+
+#if defined (_STLP_CLASS_PARTIAL_SPECIALIZATION) && !defined (_STLP_NO_MOVE_SEMANTIC)
+_STLP_BEGIN_NAMESPACE
+
+template <class _Val, class _Key, class _HF, class _Traits, class _ExK, class _EqK, class _All>
+struct __move_traits<_STLP_PRIV _Flat_hashtable<_Val, _Key, _HF, _Traits, _ExK, _EqK, _All> > {
+  //Flat hashtables are movable:
+  typedef __true_type implemented;
+
+  //Completeness depends on many template parameters, for the moment we consider it not complete:
+  typedef __false_type complete;
+};
+
+_STLP_END_NAMESPACE
+#endif
+
+#endif /* _STLP_INTERNAL_FLAT_HASHTABLE_H */
+
+// Local Variables:
+// mode:C++
+// End:
@@ -144,6 +144,51 @@ streamsize basic_filebuf<_CharT, _Traits>::showmanyc() {
     return 0;
 }
 
+// When characters need no conversion, a read that would refill the buffer
+// at least once goes straight from the file into __s.  The last system
+// call also refills the buffer, so that the reads that follow find
+// characters waiting.
+template <class _CharT, class _Traits>
+streamsize basic_filebuf<_CharT, _Traits>::xsgetn(char_type* __s, streamsize __n) {
+  if (!_M_always_noconv || _M_in_putback_mode ||
+      (!_M_in_input_mode && !_M_switch_to_input_mode()))
+    return _Base::xsgetn(__s, __n);
+
+  streamsize __avail = this->egptr() - this->gptr();
+  ptrdiff_t __bufsize = _M_ext_buf_EOS - _M_ext_buf;
+  if (__n - __avail < __bufsize)
+    return _Base::xsgetn(__s, __n);
+
+  _Traits::copy(__s, this->gptr(), __STATIC_CAST(size_t, __avail));
+  streamsize __result = __avail;
+
+  // The file pointer is at the end of the mapped range, which we have
+  // just used up.
+  if (_M_mmap_base != 0) {
+    _M_base._M_unmap(_M_mmap_base, _M_mmap_len);
+    _M_mmap_base = 0;
+    _M_mmap_len = 0;
+  }
+
+  ptrdiff_t __extra = 0;
+  while (__result < __n) {
+    ptrdiff_t __request = __STATIC_CAST(ptrdiff_t, (min) (__STATIC_CAST(streamsize, (numeric_limits<ptrdiff_t>::max)()), __n - __result));
+    ptrdiff_t __got = _M_base._M_readv((char*)(__s + __result), __request,
+                                       _M_ext_buf, __bufsize);
+    if (__got <= 0)
+      break;
+    if (__got > __request) {
+      __extra = __got - __request;
+      __got = __request;
+    }
+    __result += __got;
+  }
+
+  _M_ext_buf_end = _M_ext_buf_converted = _M_ext_buf + __extra;
+  this->setg((char_type*)_M_ext_buf, (char_type*)_M_ext_buf, (char_type*)_M_ext_buf_end);
+  return __result;
+}
+
 
 // Make a putback position available, if necessary, by switching to a
 // special internal buffer used only for putback.  The buffer is
@@ -255,6 +300,27 @@ basic_filebuf<_CharT, _Traits>::overflow(int_type __c) {
   return traits_type::not_eof(__c);
 }
 
+// When characters need no conversion, a write that does not fit in the put
+// area goes to the file together with the buffered characters, in a single
+// system call, instead of being copied through the buffer.
+template <class _CharT, class _Traits>
+streamsize basic_filebuf<_CharT, _Traits>::xsputn(const char_type* __s, streamsize __n) {
+  if (!_M_always_noconv ||
+      (!_M_in_output_mode && !_M_switch_to_output_mode()) ||
+      __n <= this->epptr() - this->pptr() ||
+      __n > __STATIC_CAST(streamsize, (numeric_limits<ptrdiff_t>::max)()))
+    return _Base::xsputn(__s, __n);
+
+  ptrdiff_t __buffered = this->pptr() - this->pbase();
+  this->setp(_M_int_buf, _M_int_buf_EOS - 1);
+  if (!_M_base._M_writev((const char*)_M_int_buf, __buffered,
+                         (const char*)__s, __STATIC_CAST(ptrdiff_t, __n))) {
+    _M_output_error();
+    return 0;
+  }
+  return __n;
+}
+
 // This member function must be called before any I/O has been
 // performed on the stream, otherwise it has no effect.
 //
@@ -70,6 +70,10 @@ public:                      // Low-level I/O, like Unix read/write
   streamoff _M_file_size();
   bool _M_write(char* __buf,  ptrdiff_t __n);
 
+public:                      // Scatter/gather I/O, like Unix readv/writev
+  ptrdiff_t _M_readv(char* __buf1, ptrdiff_t __n1, char* __buf2, ptrdiff_t __n2);
+  bool _M_writev(const char* __buf1, ptrdiff_t __n1, const char* __buf2, ptrdiff_t __n2);
+
 public:                      // Memory-mapped I/O.
   void* _M_mmap(streamoff __offset, streamoff __len);
   void _M_unmap(void* __mmap_base, streamoff __len);
@@ -199,6 +203,8 @@ public:                         // Opening and closing files.
 protected:                      // Virtual functions from basic_streambuf.
   virtual streamsize showmanyc();
   virtual int_type underflow();
+  virtual streamsize xsgetn(char_type* __s, streamsize __n);
+  virtual streamsize xsputn(const char_type* __s, streamsize __n);
 
   virtual int_type pbackfail(int_type = traits_type::eof());
   virtual int_type overflow(int_type = traits_type::eof());
@@ -785,18 +785,25 @@ basic_istream<_CharT, _Traits>::read(char_type* __s, streamsize __n) {
   this->_M_gcount = 0;
 
   if (__sentry && !this->eof()) {
-    basic_streambuf<_CharT, _Traits>*__buf = this->rdbuf();
-    if (__buf->gptr() != __buf->egptr())
-      _M_gcount
-        = _STLP_PRIV __read_buffered(this,  __buf, __n, __s,
-                                     _STLP_PRIV _Constant_unary_fun<bool, int_type>(false),
-                                     _STLP_PRIV _Project2nd<const _CharT*, const _CharT*>(),
-                                     false, false, false);
-    else
-      _M_gcount
-        = _STLP_PRIV __read_unbuffered(this,  __buf, __n, __s,
-                                       _STLP_PRIV _Constant_unary_fun<bool, int_type>(false),
-                                       false, false, false);
+    basic_streambuf<_CharT, _Traits>* __buf = this->rdbuf();
+    if (__n >= 0 && __buf->_M_egptr() - __buf->_M_gptr() >= __n) {
+      _Traits::copy(__s, __buf->_M_gptr(), __STATIC_CAST(size_t, __n));
+      __buf->_M_gbump(__STATIC_CAST(int, __n));
+      _M_gcount = __n;
+      return *this;
+    }
+
+    // Let the streambuf move the characters in bulk; filebuf, for one,
+    // reads large requests straight into __s.
+    _STLP_TRY {
+      _M_gcount = __buf->sgetn(__s, __n);
+    }
+    _STLP_CATCH_ALL {
+      this->_M_handle_exception(ios_base::badbit);
+      return *this;
+    }
+    if (_M_gcount != __n)
+      this->setstate(ios_base::eofbit);
   }
   else
     this->setstate(ios_base::failbit);
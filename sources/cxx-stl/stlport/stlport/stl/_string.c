@@ -143,6 +143,77 @@ inline _InputIter __str_find_first_not_of(_InputIter __first1, _InputIter __last
   return __str_find_first_not_of_aux1(__first1, __last1, __first2, __last2, __traits, _STLportTraits());
 }
 
+template <class _CharT, class _Traits>
+inline const _CharT* __str_search(const _CharT* __first1, const _CharT* __last1,
+                                  const _CharT* __first2, const _CharT* __last2,
+                                  _Traits*)
+{ return _STLP_STD::search(__first1, __last1, __first2, __last2, _STLP_PRIV _Eq_traits<_Traits>()); }
+
+template <class _CharT, class _Traits>
+inline const _CharT* __str_find_end(const _CharT* __first1, const _CharT* __last1,
+                                    const _CharT* __first2, const _CharT* __last2,
+                                    _Traits*)
+{ return _STLP_STD::find_end(__first1, __last1, __first2, __last2, _STLP_PRIV _Eq_traits<_Traits>()); }
+
+template <class _CharT, class _Traits>
+inline const _CharT* __str_rfind_char(const _CharT* __first, const _CharT* __last,
+                                      _CharT __c, _Traits*) {
+  const _CharT* __result = __last;
+  while (__result != __first) {
+    if (_Traits::eq(*--__result, __c))
+      return __result;
+  }
+  return __last;
+}
+
+#if !defined (_STLP_USE_NO_IOSTREAMS)
+// Strings of char are searched by the library
+inline const char* __str_search(const char* __first1, const char* __last1,
+                                const char* __first2, const char* __last2,
+                                char_traits<char>*)
+{ return _Char_search::_S_find(__first1, __last1, __first2, __last2 - __first2); }
+
+inline const char* __str_find_end(const char* __first1, const char* __last1,
+                                  const char* __first2, const char* __last2,
+                                  char_traits<char>*)
+{ return _Char_search::_S_rfind(__first1, __last1, __first2, __last2 - __first2); }
+
+inline const char* __str_rfind_char(const char* __first, const char* __last,
+                                    char __c, char_traits<char>*)
+{ return _Char_search::_S_rfind_char(__first, __last, __c); }
+
+inline const char* __str_find_first_of(const char* __first1, const char* __last1,
+                                       const char* __first2, const char* __last2,
+                                       char_traits<char>*)
+{ return _Char_search::_S_find_of(__first1, __last1, __first2, __last2 - __first2, true); }
+
+inline const char* __str_find_first_not_of(const char* __first1, const char* __last1,
+                                           const char* __first2, const char* __last2,
+                                           char_traits<char>*)
+{ return _Char_search::_S_find_of(__first1, __last1, __first2, __last2 - __first2, false); }
+
+// Reverse iterators over [__first, __last) of the last matching character
+inline reverse_iterator<const char*>
+__str_rfind_of(reverse_iterator<const char*> __rfirst, reverse_iterator<const char*> __rlast,
+               const char* __first2, const char* __last2, bool __in) {
+  const char* __result = _Char_search::_S_rfind_of(__rlast.base(), __rfirst.base(),
+                                                   __first2, __last2 - __first2, __in);
+  return __result != __rfirst.base() ? reverse_iterator<const char*>(__result + 1) : __rlast;
+}
+
+inline reverse_iterator<const char*>
+__str_find_first_of(reverse_iterator<const char*> __rfirst, reverse_iterator<const char*> __rlast,
+                    const char* __first2, const char* __last2,
+                    char_traits<char>*)
+{ return __str_rfind_of(__rfirst, __rlast, __first2, __last2, true); }
+
+inline reverse_iterator<const char*>
+__str_find_first_not_of(reverse_iterator<const char*> __rfirst, reverse_iterator<const char*> __rlast,
+                        const char* __first2, const char* __last2,
+                        char_traits<char>*)
+{ return __str_rfind_of(__rfirst, __rlast, __first2, __last2, false); }
+#endif
+
 // ------------------------------------------------------------
 // Non-inline declarations.
 
@@ -429,8 +500,8 @@ __size_type__ basic_string<_CharT,_Traits,_Alloc>::find( const _CharT* __s, size
   }
 
   const_pointer __result =
-    _STLP_STD::search(this->_M_Start() + __pos, this->_M_Finish(),
-                      __s, __s + __n, _STLP_PRIV _Eq_traits<_Traits>());
+    _STLP_PRIV __str_search(this->_M_Start() + __pos, this->_M_Finish(),
+                            __s, __s + __n, __STATIC_CAST(_Traits*, 0));
   return __result != this->_M_Finish() ? __result - this->_M_Start() : npos;
 }
 
@@ -441,10 +512,8 @@ __size_type__ basic_string<_CharT,_Traits,_Alloc>::find(_CharT __c, size_type __
     return npos;
   }
 
-  const_pointer __result =
-    _STLP_STD::find_if(this->_M_Start() + __pos, this->_M_Finish(),
-                       _STLP_PRIV _Eq_char_bound<_Traits>(__c));
-  return __result != this->_M_Finish() ? __result - this->_M_Start() : npos;
+  const_pointer __result = _Traits::find(this->_M_Start() + __pos, size() - __pos, __c);
+  return __result != 0 ? __result - this->_M_Start() : npos;
 }
 
 template <class _CharT, class _Traits, class _Alloc>
@@ -459,8 +528,8 @@ __size_type__ basic_string<_CharT,_Traits,_Alloc>::rfind(const _CharT* __s, size
   if ( __n == 0 ) { // marginal case
     return __last - this->_M_Start();
   }
-  const_pointer __result = _STLP_STD::find_end(this->_M_Start(), __last,
-                                               __s, __s + __n, _STLP_PRIV _Eq_traits<_Traits>());
+  const_pointer __result = _STLP_PRIV __str_find_end(this->_M_Start(), __last,
+                                                     __s, __s + __n, __STATIC_CAST(_Traits*, 0));
   return __result != __last ? __result - this->_M_Start() : npos;
 }
 
@@ -471,11 +540,10 @@ __size_type__ basic_string<_CharT,_Traits,_Alloc>::rfind(_CharT __c, size_type _
   if ( __len < 1 ) {
     return npos;
   }
-  const_iterator __last = begin() + (min)(__len - 1, __pos) + 1;
-  const_reverse_iterator __rresult =
-    _STLP_STD::find_if(const_reverse_iterator(__last), rend(),
-                       _STLP_PRIV _Eq_char_bound<_Traits>(__c));
-  return __rresult != rend() ? (__rresult.base() - 1) - begin() : npos;
+  const_pointer __last = this->_M_Start() + (min)(__len - 1, __pos) + 1;
+  const_pointer __result = _STLP_PRIV __str_rfind_char(this->_M_Start(), __last,
+                                                       __c, __STATIC_CAST(_Traits*, 0));
+  return __result != __last ? __result - this->_M_Start() : npos;
 }
 
 template <class _CharT, class _Traits, class _Alloc> __size_type__
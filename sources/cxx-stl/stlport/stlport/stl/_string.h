@@ -97,6 +97,27 @@ _STLP_BEGIN_NAMESPACE
 
 _STLP_MOVE_TO_PRIV_NAMESPACE
 struct _String_reserve_t {};
+
+#if !defined (_STLP_USE_NO_IOSTREAMS)
+// Searches in strings of char, with SIMD instructions where the target has
+// them. Every function returns __last when it finds nothing.
+class _STLP_CLASS_DECLSPEC _Char_search {
+public:
+  // First and last occurrences of [__s, __s + __n) in [__first, __last)
+  static const char* _STLP_CALL _S_find(const char* __first, const char* __last,
+                                        const char* __s, size_t __n);
+  static const char* _STLP_CALL _S_rfind(const char* __first, const char* __last,
+                                         const char* __s, size_t __n);
+  static const char* _STLP_CALL _S_rfind_char(const char* __first, const char* __last, char __c);
+  // First and last characters that are in [__s, __s + __n) if __in is true,
+  // that are not otherwise
+  static const char* _STLP_CALL _S_find_of(const char* __first, const char* __last,
+                                           const char* __s, size_t __n, bool __in);
+  static const char* _STLP_CALL _S_rfind_of(const char* __first, const char* __last,
+                                            const char* __s, size_t __n, bool __in);
+};
+#endif
+
 _STLP_MOVE_TO_STD_NAMESPACE
 
 #if defined (_STLP_USE_MSVC6_MEM_T_BUG_WORKAROUND)
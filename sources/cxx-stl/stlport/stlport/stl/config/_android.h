@@ -43,8 +43,8 @@
 // No need to define our own namespace
 #define _STLP_NO_OWN_NAMESPACE 1
 
-// Use __new_alloc instead of __node_alloc, so we don't need static functions.
-#define _STLP_USE_SIMPLE_NODE_ALLOC 1
+// Use the thread caching engine of __node_alloc, see src/allocators.cpp.
+#define _STLP_USE_THREAD_CACHING_NODE_ALLOC 1
 
 // Don't use extern versions of range errors, so we don't need to
 // compile as a library.
@@ -23,6 +23,7 @@ LOCAL_SRC_FILES += \
     is_subpath.cpp \
     absolutize.cpp \
     path.cpp \
+    stat-bench.cpp \
     is_absolute.cpp \
     normalize.cpp \
     is_normalized.cpp \
@@ -21,6 +21,7 @@ int test_relpath();
 int test_basename();
 int test_dirname();
 int test_path();
+int test_stat_bench();
 int test_list();
 int test_open_self();
 
@@ -17,6 +17,7 @@ int main()
     DO_TEST(basename);
     DO_TEST(dirname);
     DO_TEST(path);
+    DO_TEST(stat_bench);
 #endif
     DO_TEST(list);
     DO_TEST(open_self);
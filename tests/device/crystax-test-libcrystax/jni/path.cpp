@@ -3,6 +3,8 @@
 
 using ::crystax::fileio::path_t;
 using ::crystax::fileio::abspath_t;
+using ::crystax::fileio::path_view_t;
+using ::crystax::fileio::abspath_view_t;
 
 int test_path()
 {
@@ -13,6 +15,13 @@ int test_path()
 #undef TEST_ABSPATH
 #endif
 
+#ifdef TEST_PATH_VIEW
+#undef TEST_PATH_VIEW
+#endif
+#ifdef TEST_ABSPATH_VIEW
+#undef TEST_ABSPATH_VIEW
+#endif
+
 #define TEST_PATH(a, b) \
     { \
         path_t p(a); \
@@ -41,6 +50,23 @@ int test_path()
         ::printf("ok %d - abspath\n", __LINE__ - start); \
     }
 
+#define TEST_VIEW(type, a, b) \
+    { \
+        char buf[PATH_MAX + 1]; \
+        type p(a, buf, sizeof(buf)); \
+        bool ok = !b ? !p : p && ::strcmp(p.c_str(), b) == 0 && p.length() == ::strlen(b); \
+        if (!ok) \
+        { \
+            ::fprintf(stderr, \
+                "FAIL at %s:%d: view is \"%s\", but expected \"%s\"\n", \
+                __FILE__, __LINE__, p.c_str(), b); \
+            return 1; \
+        } \
+        ::printf("ok %d - " #type "\n", __LINE__ - start); \
+    }
+#define TEST_PATH_VIEW(a, b) TEST_VIEW(path_view_t, a, b)
+#define TEST_ABSPATH_VIEW(a, b) TEST_VIEW(abspath_view_t, a, b)
+
     int start = __LINE__;
     TEST_PATH(NULL, NULL);
     TEST_PATH("", "");
@@ -72,6 +98,31 @@ int test_path()
     TEST_ABSPATH("/../../../../a/../../b/c/d/../../../../../..", "/");
     TEST_ABSPATH("..////./././../../aaa/bb/./..////", "/aaa");
     TEST_ABSPATH("././//./../..../......//a/b/c/../d//", "/..../....../a/b/d");
+    TEST_PATH_VIEW(NULL, NULL);
+    TEST_PATH_VIEW("", "");
+    TEST_PATH_VIEW("a/b/c", "a/b/c");
+    TEST_PATH_VIEW("a////////b//////c/////////", "a/b/c");
+    TEST_PATH_VIEW("..////./././../../aaa/bb/./..////", "../../../aaa");
+    TEST_ABSPATH_VIEW(NULL, NULL);
+    TEST_ABSPATH_VIEW("", NULL);
+    TEST_ABSPATH_VIEW("/a/b/c", "/a/b/c");
+    TEST_ABSPATH_VIEW("a/", "/a");
+    TEST_ABSPATH_VIEW("/../../../../a/../../b/c/d/../../../../../..", "/");
+    TEST_ABSPATH_VIEW("././//./../..../......//a/b/c/../d//", "/..../....../a/b/d");
+
+    {
+        // Already normalized absolute path must be referred, not copied
+        const char *s = "/a/b/c";
+        char buf[PATH_MAX + 1];
+        abspath_view_t p(s, buf, sizeof(buf));
+        if (p.c_str() != s || !p.subpath(abspath_view_t("/a/b", 4)) ||
+            p.subpath(abspath_view_t("/a/bc", 5)) || !p.subpath(abspath_view_t("/", 1)))
+        {
+            ::fprintf(stderr, "FAIL at %s:%d: abspath_view_t\n", __FILE__, __LINE__);
+            return 1;
+        }
+        ::printf("ok %d - abspath_view_t\n", __LINE__ - start);
+    }
 
 #if 0
     TEST_NORMALIZE("/../../../../a/../../b/c/d/../../../../../..", "/");
@@ -81,6 +132,9 @@ int test_path()
 
 #undef TEST_PATH
 #undef TEST_ABSPATH
+#undef TEST_VIEW
+#undef TEST_PATH_VIEW
+#undef TEST_ABSPATH_VIEW
 
     ::printf("ok\n");
 
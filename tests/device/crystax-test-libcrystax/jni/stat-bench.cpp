@@ -0,0 +1,57 @@
+#include "common.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+
+static double now()
+{
+    struct timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int test_stat_bench()
+{
+    const char *s = "test-libcrystax-stat-bench.tmp";
+    const int N = 100000;
+
+    int fd = ::open(s, O_WRONLY|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR);
+    if (fd < 0)
+    {
+        ::fprintf(stderr, "FAIL at %s:%d: can't create \"%s\"\n", __FILE__, __LINE__, s);
+        return 1;
+    }
+    ::close(fd);
+
+    double start = now();
+    for (int i = 0; i != N; ++i)
+    {
+        struct stat st;
+        if (::stat(s, &st) != 0)
+        {
+            ::fprintf(stderr, "FAIL at %s:%d: stat(\"%s\") failed\n", __FILE__, __LINE__, s);
+            return 1;
+        }
+    }
+    double elapsed = now() - start;
+    ::printf("ok - stat: %.0f calls/s\n", N / elapsed);
+
+    start = now();
+    for (int i = 0; i != N; ++i)
+    {
+        fd = ::open(s, O_RDONLY);
+        if (fd < 0)
+        {
+            ::fprintf(stderr, "FAIL at %s:%d: open(\"%s\") failed\n", __FILE__, __LINE__, s);
+            return 1;
+        }
+        ::close(fd);
+    }
+    elapsed = now() - start;
+    ::printf("ok - open/close: %.0f calls/s\n", N / elapsed);
+
+    ::unlink(s);
+    return 0;
+}
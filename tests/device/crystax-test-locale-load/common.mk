@@ -0,0 +1,2 @@
+SRCFILES := main.c
+CFLAGS   := -Wall -Wextra -Werror -O2
@@ -0,0 +1,9 @@
+LOCAL_PATH := $(call my-dir)
+include $(LOCAL_PATH)/../common.mk
+
+include $(CLEAR_VARS)
+LOCAL_MODULE     := test-locale-load
+LOCAL_SRC_FILES  := $(SRCFILES)
+LOCAL_C_INCLUDES := $(NDK_ROOT)/sources/crystax/src/crystax/locale $(NDK_ROOT)/sources/crystax/src/include
+LOCAL_CFLAGS     := $(CFLAGS) -DCRYSTAX_LOCALE_BZIP2=0
+include $(BUILD_EXECUTABLE)
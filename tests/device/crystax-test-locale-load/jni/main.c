@@ -0,0 +1,223 @@
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+#include <errno.h>
+#include <locale.h>
+#include <pthread.h>
+
+/* glibc has no _LC_LAST; any bound above its LC_* values will do */
+#ifndef _LC_LAST
+#define _LC_LAST 16
+#endif
+
+/*
+ * Locale loader is built right into the test, so what's measured is decoding of
+ * locale data itself, not setlocale() machinery around it.
+ */
+#include "locale.c"
+#include "localeinit.c"
+
+enum
+{
+    THREADS = 8,
+    DECODE_ROUNDS = 20
+};
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const char *codec_name(unsigned codec)
+{
+    switch (codec)
+    {
+    case __CRYSTAX_LOCALE_STORED: return "stored";
+    case __CRYSTAX_LOCALE_BZIP2:  return "bzip2";
+    case __CRYSTAX_LOCALE_LZ4:    return "lz4";
+    default:                      return "unknown";
+    }
+}
+
+/* Load every category of every locale; return total size of data */
+static size_t load_all()
+{
+    const __crystax_locale_table_t *t = __crystax_locale_table();
+    size_t i, total = 0;
+    int type;
+
+    for (i = 0; i != t->size; ++i)
+    {
+        for (type = 0; type != _LC_LAST; ++type)
+        {
+            void *buf;
+            size_t size;
+            if (__crystax_locale_load(t->names + t->data[i].name, type, &buf, &size) != 0)
+            {
+                fprintf(stderr, "can't load %s/%d: %s\n", t->names + t->data[i].name, type, strerror(errno));
+                abort();
+            }
+            assert(size == 0 || buf != NULL);
+            total += size;
+        }
+    }
+
+    return total;
+}
+
+static void forget_all()
+{
+    size_t i;
+    for (i = 0; i != sizeof(__crystax_locale_cache)/sizeof(__crystax_locale_cache[0]); ++i)
+    {
+        free(__crystax_locale_cache[i]);
+        __crystax_locale_cache[i] = NULL;
+    }
+}
+
+static int test_semantics()
+{
+    const __crystax_locale_table_t *t = __crystax_locale_table();
+    size_t i;
+    void *buf;
+    size_t size;
+
+    /* Every name must be found by perfect hash */
+    for (i = 0; i != t->size; ++i)
+        assert(lookup(t, t->names + t->data[i].name) == &t->data[i]);
+
+    assert(__crystax_locale_load("xx_XX.UTF-8", LC_CTYPE, &buf, &size) == -1 && errno == ENOENT);
+    assert(__crystax_locale_load("", LC_CTYPE, &buf, &size) == -1 && errno == ENOENT);
+    assert(__crystax_locale_load(NULL, LC_CTYPE, &buf, &size) == -1 && errno == ENOENT);
+    assert(__crystax_locale_load("UTF-8", _LC_LAST, &buf, &size) == -1 && errno == EINVAL);
+    assert(__crystax_locale_loads("UTF-8", "LC_CTYPE", &buf, &size) == 0 && size > 0);
+
+    /* Broken LZ4 input must be rejected, not overrun buffers */
+    {
+        static const uint8_t literals[] = {0x40, 'a', 'b', 'c', 'd'};
+        static const uint8_t zero_offset[] = {0x14, 'a', 0x00, 0x00, 0x00};
+        static const uint8_t far_offset[] = {0x14, 'a', 0x02, 0x00, 0x00};
+        static const uint8_t overlap[] = {0x11, 'a', 0x01, 0x00, 0x00};
+        uint8_t out[16];
+
+        assert(lz4_decode(literals, sizeof(literals), out, 4) == 0 && memcmp(out, "abcd", 4) == 0);
+        assert(lz4_decode(literals, sizeof(literals), out, 3) == -1);
+        assert(lz4_decode(literals, sizeof(literals) - 1, out, 4) == -1);
+        assert(lz4_decode(zero_offset, sizeof(zero_offset), out, sizeof(out)) == -1);
+        assert(lz4_decode(far_offset, sizeof(far_offset), out, sizeof(out)) == -1);
+        assert(lz4_decode(overlap, sizeof(overlap), out, 6) == 0 && memcmp(out, "aaaaaa", 6) == 0);
+    }
+
+    printf("ok - semantics\n");
+    return 0;
+}
+
+static void *loader(void *arg)
+{
+    (void)arg;
+    load_all();
+    return NULL;
+}
+
+static int test_concurrency()
+{
+    const __crystax_locale_table_t *t = __crystax_locale_table();
+    pthread_t threads[THREADS];
+    void *first[sizeof(__crystax_locale_cache)/sizeof(__crystax_locale_cache[0])];
+    size_t i;
+
+    forget_all();
+    for (i = 0; i != THREADS; ++i)
+        pthread_create(&threads[i], NULL, &loader, NULL);
+    for (i = 0; i != THREADS; ++i)
+        pthread_join(threads[i], NULL);
+
+    /* Once published, blob must stay the same */
+    memcpy(first, __crystax_locale_cache, sizeof(first));
+    load_all();
+    for (i = 0; i != t->nblobs; ++i)
+        assert(__crystax_locale_cache[i] == first[i]);
+
+    printf("ok - concurrency\n");
+    return 0;
+}
+
+static void bench()
+{
+    const __crystax_locale_table_t *t = __crystax_locale_table();
+    size_t raw[3] = {0, 0, 0}, enc[3] = {0, 0, 0}, count[3] = {0, 0, 0};
+    double start, cold, warm, elapsed;
+    size_t total, i;
+    unsigned c;
+    int r;
+
+    forget_all();
+    start = now();
+    total = load_all();
+    cold = now() - start;
+
+    start = now();
+    load_all();
+    warm = now() - start;
+
+    printf("load all %lu locales x %d categories (%lu bytes): cold %.2f ms, warm %.3f ms\n",
+        (unsigned long)t->size, _LC_LAST, (unsigned long)total, cold * 1e3, warm * 1e3);
+
+    for (i = 0; i != t->nblobs; ++i)
+    {
+        c = t->blob[i].codec < 3 ? t->blob[i].codec : 0;
+        raw[c] += t->blob[i].usize;
+        enc[c] += t->blob[i].size;
+        ++count[c];
+    }
+
+    for (c = 0; c != 3; ++c)
+    {
+        if (count[c] == 0)
+            continue;
+
+        printf("%s: %lu blobs, %lu -> %lu bytes", codec_name(c), (unsigned long)count[c],
+            (unsigned long)raw[c], (unsigned long)enc[c]);
+        if (c == __CRYSTAX_LOCALE_STORED)
+        {
+            printf("\n");
+            continue;
+        }
+
+        start = now();
+        for (r = 0; r != DECODE_ROUNDS; ++r)
+        {
+            for (i = 0; i != t->nblobs; ++i)
+            {
+                if (t->blob[i].codec != c)
+                    continue;
+                void *p = decode(t, &t->blob[i]);
+                assert(p != NULL);
+                free(p);
+            }
+        }
+        elapsed = now() - start;
+        printf(", decoded at %.1f MB/s\n", raw[c] * DECODE_ROUNDS / elapsed / 1e6);
+    }
+}
+
+int main()
+{
+    if (test_semantics() != 0)
+        return 1;
+    if (test_concurrency() != 0)
+        return 1;
+
+    bench();
+
+    printf("OK\n");
+    return 0;
+}
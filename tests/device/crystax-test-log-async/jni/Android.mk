@@ -0,0 +1,8 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE     := test-log-async
+LOCAL_SRC_FILES  := main.c
+LOCAL_C_INCLUDES := $(NDK_ROOT)/sources/crystax/src/crystax $(NDK_ROOT)/sources/crystax/src/include
+LOCAL_CFLAGS     := -Wall -Wextra -Werror -O2
+include $(BUILD_EXECUTABLE)
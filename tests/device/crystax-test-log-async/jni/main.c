@@ -0,0 +1,232 @@
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/wait.h>
+
+/*
+ * Asynchronous sink is built right into the test, with small ring and rate, so
+ * that both kinds of drops are easy to provoke. Its entry points are renamed not
+ * to clash with the ones of libcrystax.
+ */
+#define CRYSTAX_LOG_SINK CRYSTAX_LOG_SINK_ASYNC
+#define CRYSTAX_LOG_RING_SIZE 64
+#define CRYSTAX_LOG_RATE 1000
+#define CRYSTAX_LOG_BURST 100
+#define __crystax_log test_log
+#define __crystax_log_short_file test_log_short_file
+#include "log.c"
+
+enum
+{
+    THREADS = 8,
+    RECORDS = 2000
+};
+
+static FILE *out_file;
+static FILE *err_file;
+/* Original stdout, for test's own messages */
+static FILE *console;
+
+/* Send stdout and stderr to temporary files, which are read back by checks */
+static void capture()
+{
+    console = fdopen(dup(STDOUT_FILENO), "w");
+    assert(console);
+    out_file = tmpfile();
+    err_file = tmpfile();
+    assert(out_file && err_file);
+    fflush(stdout);
+    fflush(stderr);
+    assert(dup2(fileno(out_file), STDOUT_FILENO) >= 0);
+    assert(dup2(fileno(err_file), STDERR_FILENO) >= 0);
+}
+
+/* Wait until writer has nothing left to write */
+static void settle()
+{
+    while (__atomic_load_n(&log_head, __ATOMIC_ACQUIRE) != __atomic_load_n(&log_tail, __ATOMIC_ACQUIRE) ||
+           !__atomic_load_n(&log_writer_sleeping, __ATOMIC_ACQUIRE))
+        usleep(1000);
+}
+
+static void report(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(console, fmt, ap);
+    va_end(ap);
+    fflush(console);
+}
+
+static void *producer(void *arg)
+{
+    int id = (int)(long)arg;
+    char tag[16];
+    int i;
+
+    snprintf(tag, sizeof(tag), "t%d", id);
+    for (i = 0; i < RECORDS; ++i)
+    {
+        test_log(CRYSTAX_LOGLEVEL_WARN, tag, "%d", i);
+        if (i % 16 == 0)
+            sched_yield();
+    }
+    return NULL;
+}
+
+/*
+ * Count records of every thread in 'f', checking that each thread's records come in
+ * the order they were logged; return total count.
+ */
+static long check_order(FILE *f)
+{
+    char line[256];
+    int last[THREADS];
+    long total = 0;
+    int id, seq;
+
+    for (id = 0; id < THREADS; ++id)
+        last[id] = -1;
+
+    rewind(f);
+    while (fgets(line, sizeof(line), f))
+    {
+        if (sscanf(line, "t%d: %d", &id, &seq) != 2)
+            continue;
+        assert(id >= 0 && id < THREADS);
+        assert(seq > last[id]);
+        last[id] = seq;
+        ++total;
+    }
+    return total;
+}
+
+static int contains(FILE *f, const char *text)
+{
+    char line[256];
+    rewind(f);
+    while (fgets(line, sizeof(line), f))
+        if (strstr(line, text))
+            return 1;
+    return 0;
+}
+
+/* Records of many threads come out in order, and each is either written or counted */
+static void test_order()
+{
+    pthread_t threads[THREADS];
+    long written, dropped;
+    int i;
+
+    for (i = 0; i < THREADS; ++i)
+        assert(pthread_create(&threads[i], NULL, &producer, (void *)(long)i) == 0);
+    for (i = 0; i < THREADS; ++i)
+        assert(pthread_join(threads[i], NULL) == 0);
+    settle();
+
+    written = check_order(err_file);
+    dropped = (long)__atomic_load_n(&log_dropped_full, __ATOMIC_RELAXED);
+    report("order: %ld written, %ld dropped\n", written, dropped);
+    assert(written + dropped == (long)THREADS * RECORDS);
+    assert(__atomic_load_n(&log_dropped_rate, __ATOMIC_RELAXED) == 0);
+}
+
+/* With writer stuck, records which don't fit into ring are counted and reported */
+static void test_ring_full()
+{
+    unsigned long before = __atomic_load_n(&log_dropped_full, __ATOMIC_RELAXED);
+    unsigned long dropped;
+    int i;
+
+    /* Writer blocks on stderr lock, so nothing leaves the ring */
+    flockfile(stderr);
+    for (i = 0; i < 3 * CRYSTAX_LOG_RING_SIZE; ++i)
+        test_log(CRYSTAX_LOGLEVEL_WARN, "full", "%d", i);
+    dropped = __atomic_load_n(&log_dropped_full, __ATOMIC_RELAXED) - before;
+    funlockfile(stderr);
+    settle();
+
+    report("ring full: %lu dropped\n", dropped);
+    assert(dropped >= 2 * CRYSTAX_LOG_RING_SIZE - 1);
+    assert(contains(err_file, "(ring full)"));
+}
+
+/* Burst of informational records above rate is cut, warnings aren't */
+static void test_rate()
+{
+    unsigned long before = __atomic_load_n(&log_dropped_rate, __ATOMIC_RELAXED);
+    unsigned long dropped;
+    int i;
+
+    /* Let the whole burst become available again */
+    usleep(2 * 1000 * CRYSTAX_LOG_BURST * 1000 / CRYSTAX_LOG_RATE);
+    for (i = 0; i < 10 * CRYSTAX_LOG_BURST; ++i)
+    {
+        test_log(CRYSTAX_LOGLEVEL_INFO, "rate", "%d", i);
+        /* Don't let ring overflow, that's not what is checked here */
+        if (i % (CRYSTAX_LOG_RING_SIZE / 2) == 0)
+            settle();
+    }
+    settle();
+    dropped = __atomic_load_n(&log_dropped_rate, __ATOMIC_RELAXED) - before;
+
+    report("rate: %lu dropped\n", dropped);
+    assert(dropped > 0 && dropped <= 10 * CRYSTAX_LOG_BURST - CRYSTAX_LOG_BURST);
+    assert(contains(err_file, "(rate limit)"));
+    assert(contains(out_file, "rate: 0\n"));
+}
+
+/* Child logs through writer of its own */
+static void test_fork()
+{
+    pid_t pid;
+    int status;
+
+    /* Leave record half-pushed, as if some thread was in the middle of it at fork */
+    __atomic_add_fetch(&log_tail, 1, __ATOMIC_RELAXED);
+    pid = fork();
+    assert(pid >= 0);
+    if (pid == 0)
+    {
+        test_log(CRYSTAX_LOGLEVEL_WARN, "child", "hello");
+        log_stop_writer();
+        _exit(0);
+    }
+    __atomic_sub_fetch(&log_tail, 1, __ATOMIC_RELAXED);
+
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    assert(contains(err_file, "child: hello\n"));
+}
+
+/* After writer is stopped, records are written right away */
+static void test_stopped()
+{
+    log_stop_writer();
+    assert(__atomic_load_n(&log_writer_state, __ATOMIC_ACQUIRE) == 3);
+
+    test_log(CRYSTAX_LOGLEVEL_INFO, "sync", "info");
+    test_log(CRYSTAX_LOGLEVEL_WARN, "sync", "warn");
+    assert(contains(out_file, "sync: info\n"));
+    assert(contains(err_file, "sync: warn\n"));
+}
+
+int main()
+{
+    capture();
+    test_order();
+    test_ring_full();
+    test_rate();
+    test_fork();
+    test_stopped();
+    report("OK\n");
+    return 0;
+}
@@ -0,0 +1,23 @@
+LOCAL_PATH := $(call my-dir)
+
+define dso-index-module
+include $(CLEAR_VARS)
+LOCAL_MODULE       := dsoindex$(1)
+LOCAL_SRC_FILES    := dso.cpp
+LOCAL_CFLAGS       := -Wall -Wextra -Werror -O2 -DDSO_ID=$(1) $(2)
+LOCAL_CPP_FEATURES := exceptions
+include $(BUILD_SHARED_LIBRARY)
+endef
+
+$(eval $(call dso-index-module,1))
+$(eval $(call dso-index-module,2))
+$(eval $(call dso-index-module,3))
+# Loaded in place of unloaded dsoindex2, with functions laid out differently
+$(eval $(call dso-index-module,4,-DDSO_SHUFFLE))
+
+include $(CLEAR_VARS)
+LOCAL_MODULE       := test-unwind-dso-index
+LOCAL_SRC_FILES    := main.cpp
+LOCAL_CFLAGS       := -Wall -Wextra -Werror -O2
+LOCAL_CPP_FEATURES := exceptions
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,2 @@
+APP_ABI := all
+APP_STL := c++_shared
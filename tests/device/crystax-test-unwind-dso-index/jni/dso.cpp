@@ -0,0 +1,83 @@
+/*
+ * Each library is built from this file with its own DSO_ID. Frames of its
+ * functions are unwound only if unwinder finds FDE (or EXIDX entry) of this
+ * library, and cleanups and handlers run only if it finds the right LSDA.
+ */
+
+typedef void (*callback_t)(int);
+
+struct cleanup_t
+{
+    int *count;
+    ~cleanup_t() {++*count;}
+};
+
+#ifndef DSO_SHUFFLE
+
+/* Call back, so that exception is thrown from main executable through this frame */
+extern "C" __attribute__((noinline))
+void dso_call(callback_t callback, int *cleanups)
+{
+    cleanup_t cleanup = {cleanups};
+    callback(DSO_ID);
+}
+
+/* Throw right from this library */
+extern "C" __attribute__((noinline))
+void dso_throw(int *cleanups)
+{
+    cleanup_t cleanup = {cleanups};
+    throw DSO_ID;
+}
+
+/* Catch exception thrown by callback */
+extern "C" __attribute__((noinline))
+int dso_catch(callback_t callback)
+{
+    try
+    {
+        callback(DSO_ID);
+    }
+    catch (int id)
+    {
+        return id * 100 + DSO_ID;
+    }
+    return -1;
+}
+
+#else /* DSO_SHUFFLE */
+
+/*
+ * Same functions in other order and aligned differently, so they don't start
+ * where functions of replaced library did, while library keeps about the same
+ * size and could be loaded in its place.
+ */
+extern "C" __attribute__((noinline, aligned(256)))
+int dso_catch(callback_t callback)
+{
+    try
+    {
+        callback(DSO_ID);
+    }
+    catch (int id)
+    {
+        return id * 100 + DSO_ID;
+    }
+    return -1;
+}
+
+extern "C" __attribute__((noinline, aligned(256)))
+void dso_throw(int *cleanups)
+{
+    cleanup_t cleanup = {cleanups};
+    throw DSO_ID;
+}
+
+extern "C" __attribute__((noinline, aligned(256)))
+void dso_call(callback_t callback, int *cleanups)
+{
+    cleanup_t cleanup = {cleanups};
+    callback(DSO_ID);
+}
+
+#endif /* DSO_SHUFFLE */
@@ -0,0 +1,130 @@
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <assert.h>
+
+/*
+ * Unwinder keeps index of loaded objects and their unwind sections, and takes it
+ * again when loader reports that something was loaded or unloaded. Throw through
+ * several libraries, then unload one of them and load another one, likely at the
+ * same address, and check that frames of all of them are still unwound right.
+ */
+
+typedef void (*callback_t)(int);
+typedef void (*dso_call_t)(callback_t, int *);
+typedef void (*dso_throw_t)(int *);
+typedef int (*dso_catch_t)(callback_t);
+
+struct dso_t
+{
+    int id;
+    void *handle;
+    dso_call_t call;
+    dso_throw_t throw_;
+    dso_catch_t catch_;
+};
+
+static void thrower(int id)
+{
+    throw id;
+}
+
+static void open_dso(dso_t *dso, int id)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "libdsoindex%d.so", id);
+
+    dso->id = id;
+    dso->handle = dlopen(name, RTLD_NOW);
+    if (!dso->handle)
+        fprintf(stderr, "%s\n", dlerror());
+    assert(dso->handle != NULL);
+    dso->call = (dso_call_t)dlsym(dso->handle, "dso_call");
+    dso->throw_ = (dso_throw_t)dlsym(dso->handle, "dso_throw");
+    dso->catch_ = (dso_catch_t)dlsym(dso->handle, "dso_catch");
+    assert(dso->call != NULL && dso->throw_ != NULL && dso->catch_ != NULL);
+}
+
+static void *base_of(dso_t const *dso)
+{
+    Dl_info info;
+    assert(dladdr((void *)dso->call, &info) != 0);
+    return info.dli_fbase;
+}
+
+static void check_dso(dso_t const *dso)
+{
+    int cleanups = 0;
+
+    try
+    {
+        dso->call(&thrower, &cleanups);
+        assert(0);
+    }
+    catch (int id)
+    {
+        assert(id == dso->id);
+    }
+    assert(cleanups == 1);
+
+    try
+    {
+        dso->throw_(&cleanups);
+        assert(0);
+    }
+    catch (int id)
+    {
+        assert(id == dso->id);
+    }
+    assert(cleanups == 2);
+
+    assert(dso->catch_(&thrower) == dso->id * 101);
+}
+
+static void check_all(dso_t const *dsos, int count, const char *when)
+{
+    for (int i = 0; i != count; ++i)
+        check_dso(&dsos[i]);
+    printf("ok - unwinding through %d libraries %s\n", count, when);
+}
+
+int main()
+{
+    dso_t dsos[3];
+    for (int i = 0; i != 3; ++i)
+    {
+        open_dso(&dsos[i], i + 1);
+        check_dso(&dsos[i]);
+    }
+    check_all(dsos, 3, "after loading them one by one");
+
+    void *old_base = base_of(&dsos[1]);
+    assert(dlclose(dsos[1].handle) == 0);
+    dsos[1] = dsos[2];
+    check_all(dsos, 2, "after unloading one");
+
+    open_dso(&dsos[2], 4);
+    if (base_of(&dsos[2]) == old_base)
+        printf("ok - library loaded at address of unloaded one\n");
+    else
+        printf("ok - # SKIP library loaded at other address than unloaded one\n");
+    check_all(dsos, 3, "after loading another one");
+
+    for (int i = 0; i != 3; ++i)
+        assert(dlclose(dsos[i].handle) == 0);
+    try
+    {
+        thrower(0);
+        assert(0);
+    }
+    catch (int id)
+    {
+        assert(id == 0);
+    }
+    printf("ok - unwinding after unloading all libraries\n");
+
+    return 0;
+}
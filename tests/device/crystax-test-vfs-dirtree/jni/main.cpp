@@ -0,0 +1,175 @@
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+#include "fileio/dirtree.hpp"
+
+using crystax::fileio::dir_tree_t;
+using crystax::fileio::dir_stream_t;
+
+typedef dir_tree_t::node_t node_t;
+
+static double now()
+{
+    struct timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool add(dir_tree_t::builder_t &b, const char *path, unsigned char type = DT_REG, uint64_t size = 0)
+{
+    return b.add(path, ::strlen(path), type, type == DT_REG, size, size * 2, size + 1);
+}
+
+static int names_only(const struct dirent *e)
+{
+    return e->d_name[0] != '.';
+}
+
+static int reverse(const struct dirent **a, const struct dirent **b)
+{
+    return ::strcmp((*b)->d_name, (*a)->d_name);
+}
+
+static int test_semantics()
+{
+    dir_tree_t::builder_t b;
+    assert(add(b, "sounds/b.ogg", DT_REG, 10));
+    assert(add(b, "a.txt", DT_REG, 1));
+    assert(add(b, "sounds/a.ogg", DT_REG, 20));
+    assert(add(b, "sounds-hd/x.ogg", DT_REG, 30));
+    assert(add(b, "/levels//1/map.bin", DT_REG, 40));
+    assert(add(b, "levels/1/", DT_DIR));
+    assert(add(b, "empty/", DT_DIR));
+    assert(add(b, "sounds/a.ogg", DT_REG, 20));
+    assert(add(b, "../evil", DT_REG, 50));
+    assert(b.add("lazy.dat", 8, DT_REG));
+
+    dir_tree_t *t = b.build();
+    assert(t);
+
+    // root, a.txt, empty, lazy.dat, levels, levels/1, levels/1/map.bin, sounds, sounds/a.ogg,
+    // sounds/b.ogg, sounds-hd, sounds-hd/x.ogg
+    assert(t->count() == 12);
+
+    node_t const &root = t->root();
+    assert(root.type == DT_DIR && root.count == 6);
+    static const char *top[] = {"a.txt", "empty", "lazy.dat", "levels", "sounds", "sounds-hd"};
+    for (size_t i = 0; i != root.count; ++i)
+        assert(::strcmp(t->node(root.first + i).name, top[i]) == 0);
+
+    node_t const *n = t->lookup("sounds/a.ogg");
+    uint64_t size;
+    assert(n && n->type == DT_REG && t->size(*n, &size) && size == 20 && n->offset == 40 && n->tag == 21);
+    assert(t->lookup("/levels/./1//map.bin/") == t->lookup("levels/1/map.bin"));
+    assert(t->lookup("levels/1")->type == DT_DIR);
+    assert(t->lookup("") == &root && t->lookup("/") == &root);
+    assert(t->lookup("sounds/c.ogg") == NULL);
+    assert(t->lookup("a.txt/x") == NULL);
+    assert(t->lookup("evil") == NULL);
+    assert(t->lookup("empty")->count == 0);
+    assert(&t->node(t->lookup("sounds/b.ogg")->parent) == t->lookup("sounds"));
+
+    n = t->lookup("lazy.dat");
+    assert(n && !t->size(*n, &size));
+    t->set_size(*n, 123);
+    assert(t->size(*n, &size) && size == 123);
+
+    dir_stream_t s(*t, *t->lookup("sounds"));
+    static const char *sounds[] = {".", "..", "a.ogg", "b.ogg"};
+    for (int pass = 0; pass != 2; ++pass)
+    {
+        for (size_t i = 0; i != sizeof(sounds)/sizeof(sounds[0]); ++i)
+        {
+            struct dirent *e = s.read();
+            assert(e && ::strcmp(e->d_name, sounds[i]) == 0);
+            assert(e->d_type == DT_DIR || i >= 2);
+        }
+        assert(s.read() == NULL);
+        s.rewind();
+    }
+    s.seek(3);
+    assert(::strcmp(s.read()->d_name, "b.ogg") == 0 && s.tell() == 4);
+
+    struct dirent ent, *res;
+    s.seek(2);
+    assert(s.read_r(&ent, &res) == 0 && res == &ent && ::strcmp(ent.d_name, "a.ogg") == 0);
+    s.seek(4);
+    assert(s.read_r(&ent, &res) == 0 && res == NULL);
+
+    struct dirent **list;
+    int count = t->scandir(root, &list, &names_only, &reverse);
+    assert(count == 6);
+    for (int i = 0; i != count; ++i)
+    {
+        assert(::strcmp(list[i]->d_name, top[5 - i]) == 0);
+        ::free(list[i]);
+    }
+    ::free(list);
+
+    count = t->scandir(*t->lookup("empty"), &list, NULL, NULL);
+    assert(count == 2 && ::strcmp(list[1]->d_name, "..") == 0);
+    ::free(list[0]);
+    ::free(list[1]);
+    ::free(list);
+
+    delete t;
+
+    ::printf("ok - semantics\n");
+    return 0;
+}
+
+/*
+ * Typical game: few thousands of assets in a couple of levels of directories.
+ */
+static int test_performance()
+{
+    enum {DIRS = 64, FILES = 128, LOOKUPS = 1000000};
+
+    char path[64];
+    double start = now();
+    dir_tree_t::builder_t b;
+    for (int i = FILES - 1; i >= 0; --i)
+        for (int d = 0; d != DIRS; ++d)
+        {
+            ::snprintf(path, sizeof(path), "data/dir%03d/file%04d.bin", d, i);
+            assert(add(b, path, DT_REG, i));
+        }
+    dir_tree_t *t = b.build();
+    double build = now() - start;
+    assert(t && t->count() == DIRS * FILES + DIRS + 2);
+
+    unsigned seed = 1;
+    start = now();
+    for (int i = 0; i != LOOKUPS; ++i)
+    {
+        int d = ::rand_r(&seed) % DIRS, f = ::rand_r(&seed) % FILES;
+        ::snprintf(path, sizeof(path), "data/dir%03d/file%04d.bin", d, f);
+        node_t const *n = t->lookup(path);
+        if (!n || n->size != (uint64_t)f)
+            ::abort();
+    }
+    double lookup = now() - start;
+    delete t;
+
+    ::printf("%d entries: build %.2f ms, %.0f ns/lookup (including snprintf)\n",
+        DIRS * FILES, build * 1e3, lookup * 1e9 / LOOKUPS);
+    return 0;
+}
+
+int main()
+{
+    if (test_semantics() != 0)
+        return 1;
+    if (test_performance() != 0)
+        return 1;
+
+    ::printf("OK\n");
+    return 0;
+}
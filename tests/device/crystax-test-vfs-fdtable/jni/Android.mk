@@ -0,0 +1,9 @@
+LOCAL_PATH := $(call my-dir)
+include $(LOCAL_PATH)/../common.mk
+
+include $(CLEAR_VARS)
+LOCAL_MODULE     := test-vfs-fdtable
+LOCAL_SRC_FILES  := $(SRCFILES)
+LOCAL_C_INCLUDES := $(NDK_ROOT)/sources/crystax/vfs
+LOCAL_CFLAGS     := $(CFLAGS)
+include $(BUILD_EXECUTABLE)
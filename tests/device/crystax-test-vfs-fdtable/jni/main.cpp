@@ -0,0 +1,265 @@
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "fileio/fdtable.hpp"
+
+using crystax::fileio::driver_t;
+using crystax::fileio::fd_record_t;
+using crystax::fileio::fd_table_t;
+
+enum
+{
+    STABLE_FDS = 64,
+    LOOKUPS = 1000000
+};
+
+static driver_t *const DRIVER = reinterpret_cast<driver_t *>(0x1000);
+
+/*
+ * Copy of the table used by crystax VFS before: one recursive mutex, linear allocation
+ * and linear DIR* lookup.
+ */
+class legacy_table_t
+{
+public:
+    legacy_table_t()
+    {
+        pthread_mutexattr_t attr;
+        ::pthread_mutexattr_init(&attr);
+        ::pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+        ::pthread_mutex_init(&mtx, &attr);
+        ::pthread_mutexattr_destroy(&attr);
+        for (size_t fd = 0; fd != fd_table_t::SIZE; ++fd)
+        {
+            table[fd].dirp = NULL;
+            table[fd].extfd = -1;
+            table[fd].extdirp = NULL;
+            table[fd].driver = NULL;
+        }
+    }
+
+    int alloc(int extfd, DIR *extdirp, driver_t *driver, const char *path, bool dir = false)
+    {
+        ::free((void*)path);
+        ::pthread_mutex_lock(&mtx);
+        for (size_t fd = 0; fd != fd_table_t::SIZE; ++fd)
+        {
+            fd_record_t &r = table[fd];
+            if (r.driver != NULL)
+                continue;
+            r.dirp = dir ? fd_table_t::fd2dirp(fd) : NULL;
+            r.extfd = extfd;
+            r.extdirp = extdirp;
+            r.driver = driver;
+            ::pthread_mutex_unlock(&mtx);
+            return fd;
+        }
+        ::pthread_mutex_unlock(&mtx);
+        return -1;
+    }
+
+    bool release(int fd)
+    {
+        ::pthread_mutex_lock(&mtx);
+        table[fd].dirp = NULL;
+        table[fd].extfd = -1;
+        table[fd].extdirp = NULL;
+        table[fd].driver = NULL;
+        ::pthread_mutex_unlock(&mtx);
+        return true;
+    }
+
+    bool lookup(int fd, fd_record_t *r) const
+    {
+        ::pthread_mutex_lock(&mtx);
+        *r = table[fd];
+        ::pthread_mutex_unlock(&mtx);
+        return r->driver != NULL;
+    }
+
+    bool lookup(DIR *dirp, int *fd, fd_record_t *r) const
+    {
+        ::pthread_mutex_lock(&mtx);
+        for (size_t i = 0; i != fd_table_t::SIZE; ++i)
+        {
+            if (table[i].dirp != dirp)
+                continue;
+            *fd = i;
+            *r = table[i];
+            ::pthread_mutex_unlock(&mtx);
+            return true;
+        }
+        ::pthread_mutex_unlock(&mtx);
+        return false;
+    }
+
+private:
+    fd_record_t table[fd_table_t::SIZE];
+    mutable pthread_mutex_t mtx;
+};
+
+static const char *copy_path(const char *path)
+{
+    return ::strdup(path);
+}
+
+static double now()
+{
+    struct timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+template <typename Table>
+struct context_t
+{
+    Table *table;
+    DIR *dirps[STABLE_FDS];
+    volatile bool stop;
+};
+
+template <typename Table>
+static void *reader(void *arg)
+{
+    context_t<Table> *ctx = reinterpret_cast<context_t<Table> *>(arg);
+    unsigned seed = (unsigned)(size_t)&seed;
+    for (int i = 0; i != LOOKUPS; ++i)
+    {
+        int fd;
+        fd_record_t r;
+        int n = ::rand_r(&seed) % STABLE_FDS;
+        if (i % 8 == 0)
+        {
+            if (!ctx->table->lookup(ctx->dirps[n], &fd, &r))
+                ::abort();
+        }
+        else
+        {
+            fd = n * 2;
+            if (!ctx->table->lookup(fd, &r))
+                ::abort();
+        }
+        if (r.extfd != fd + 1000 || r.driver != DRIVER)
+            ::abort();
+    }
+    return NULL;
+}
+
+template <typename Table>
+static void *churner(void *arg)
+{
+    context_t<Table> *ctx = reinterpret_cast<context_t<Table> *>(arg);
+    while (!ctx->stop)
+    {
+        int fd = ctx->table->alloc(-1, NULL, DRIVER, ::strdup("/churn"));
+        if (fd < 0)
+            ::abort();
+        ctx->table->release(fd);
+    }
+    return NULL;
+}
+
+template <typename Table>
+static double run(int nthreads)
+{
+    Table *table = new Table;
+    context_t<Table> ctx;
+    ctx.table = table;
+    ctx.stop = false;
+
+    // Even descriptors stay open, odd ones are reused by churner
+    for (int i = 0; i != STABLE_FDS * 2; ++i)
+    {
+        int fd = table->alloc(i + 1000, NULL, DRIVER, ::strdup("/stable"), true);
+        assert(fd == i);
+    }
+    for (int i = 0; i != STABLE_FDS; ++i)
+    {
+        table->release(i * 2 + 1);
+        ctx.dirps[i] = fd_table_t::fd2dirp(i * 2);
+    }
+
+    pthread_t churn;
+    pthread_t threads[64];
+    ::pthread_create(&churn, NULL, &churner<Table>, &ctx);
+
+    double start = now();
+    for (int i = 0; i != nthreads; ++i)
+        ::pthread_create(&threads[i], NULL, &reader<Table>, &ctx);
+    for (int i = 0; i != nthreads; ++i)
+        ::pthread_join(threads[i], NULL);
+    double elapsed = now() - start;
+
+    ctx.stop = true;
+    ::pthread_join(churn, NULL);
+    delete table;
+
+    return (double)LOOKUPS * nthreads / elapsed;
+}
+
+static int test_semantics()
+{
+    fd_table_t *table = new fd_table_t;
+
+    assert(table->alloc(10, NULL, DRIVER, NULL) == 0);
+    assert(table->alloc(11, NULL, DRIVER, NULL) == 1);
+    assert(table->install(5, 15, DRIVER, NULL));
+    assert(!table->install(5, 16, DRIVER, NULL));
+    assert(table->alloc(12, NULL, DRIVER, NULL) == 2);
+
+    // Lowest free descriptor must be returned first
+    assert(table->release(1));
+    assert(!table->release(1));
+    assert(table->alloc(13, NULL, DRIVER, NULL) == 1);
+
+    int fd = table->alloc(14, (DIR*)0x2000, DRIVER, ::strdup("/a/b"), true);
+    assert(fd == 3);
+
+    fd_record_t r;
+    int n;
+    assert(table->lookup(fd_table_t::fd2dirp(fd), &n, &r));
+    assert(n == fd && r.extfd == 14 && r.extdirp == (DIR*)0x2000);
+    assert(!table->lookup(fd_table_t::fd2dirp(4), &n, &r));
+    assert(!table->lookup(-1, &r));
+    assert(!table->lookup((int)fd_table_t::SIZE, &r));
+
+    const char *p = table->path(fd, &copy_path);
+    assert(p && ::strcmp(p, "/a/b") == 0);
+    ::free((void*)p);
+
+    assert(table->release(fd_table_t::fd2dirp(fd)));
+    assert(!table->lookup(fd, &r));
+    assert(table->path(fd, &copy_path) == NULL);
+
+    delete table;
+
+    ::printf("ok - semantics\n");
+    return 0;
+}
+
+int main()
+{
+    if (test_semantics() != 0)
+        return 1;
+
+    static const int nthreads[] = {1, 2, 4, 8};
+    for (size_t i = 0; i != sizeof(nthreads)/sizeof(nthreads[0]); ++i)
+    {
+        int n = nthreads[i];
+        double legacy = run<legacy_table_t>(n);
+        double lockfree = run<fd_table_t>(n);
+        ::printf("threads=%d: legacy %.2f Mlookups/s, lock-free %.2f Mlookups/s (x%.1f)\n",
+            n, legacy / 1e6, lockfree / 1e6, lockfree / legacy);
+    }
+
+    ::printf("OK\n");
+    return 0;
+}
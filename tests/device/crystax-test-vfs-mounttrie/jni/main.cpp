@@ -0,0 +1,248 @@
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "fileio/mounttrie.hpp"
+#include "fileio/rcu.hpp"
+
+using crystax::fileio::driver_t;
+using crystax::fileio::mount_trie_t;
+using crystax::fileio::rcu_ptr_t;
+
+enum
+{
+    MAX_MOUNTS = 256,
+    LOOKUPS = 1000000
+};
+
+static driver_t *D(size_t n) {return reinterpret_cast<driver_t *>(0x1000 + n * 0x10);}
+
+static mount_trie_t::entry_t E(const char *root, driver_t *driver)
+{
+    mount_trie_t::entry_t e;
+    e.root = root;
+    e.length = ::strlen(root);
+    e.driver = driver;
+    return e;
+}
+
+static driver_t *lookup(mount_trie_t const *trie, const char *path)
+{
+    return trie->lookup(path, ::strlen(path));
+}
+
+/*
+ * Copy of the lookup used by crystax VFS before: reverse scan of mount table
+ * comparing prefixes of each root.
+ */
+static driver_t *legacy_lookup(mount_trie_t::entry_t const *entries, size_t count, const char *path, size_t length)
+{
+    for (size_t i = count; i > 0; --i)
+    {
+        mount_trie_t::entry_t const &e = entries[i - 1];
+        if (e.length > length || ::strncmp(path, e.root, e.length) != 0)
+            continue;
+        if (e.length == length || path[e.length] == '/' || e.length == 1)
+            return e.driver;
+    }
+    return NULL;
+}
+
+static double now()
+{
+    struct timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static char fillers[mount_trie_t::LINEAR_MAX][32];
+
+/*
+ * Build from 'entries'; if 'pad' is true, unrelated mounts are prepended to make
+ * their number big enough for real trie to be built.
+ */
+static mount_trie_t *build(mount_trie_t::entry_t const *entries, size_t count, bool pad)
+{
+    mount_trie_t::entry_t all[mount_trie_t::LINEAR_MAX + 8];
+    size_t n = 0;
+    for (; pad && n != mount_trie_t::LINEAR_MAX; ++n)
+    {
+        ::snprintf(fillers[n], sizeof(fillers[n]), "/filler/%u", (unsigned)n);
+        all[n] = E(fillers[n], D(100 + n));
+    }
+    for (size_t i = 0; i != count; ++i)
+        all[n++] = entries[i];
+    return mount_trie_t::build(all, n);
+}
+
+static int test_semantics(bool pad)
+{
+    mount_trie_t::entry_t entries[] = {
+        E("/data/app", D(1)),
+        E("/data/app/assets", D(2)),
+        E("/sdcard", D(3)),
+        E("/data/app/lib", D(4)),
+    };
+
+    mount_trie_t *trie = build(entries, 4, pad);
+    assert(trie && !trie->empty());
+
+    assert(lookup(trie, "/data/app") == D(1));
+    assert(lookup(trie, "/data/app/x/y") == D(1));
+    assert(lookup(trie, "/data/app/assets") == D(2));
+    assert(lookup(trie, "/data/app/assets/a/b.png") == D(2));
+    assert(lookup(trie, "/data/app/assetsx") == D(1));
+    assert(lookup(trie, "/data/application") == NULL);
+    assert(lookup(trie, "/data") == NULL);
+    assert(lookup(trie, "/sdcard/DCIM") == D(3));
+    assert(lookup(trie, "/data/app/lib/libfoo.so") == D(4));
+    delete trie;
+
+    // Later mount over ancestor hides earlier ones beneath it
+    mount_trie_t::entry_t shadow[] = {
+        E("/a/b/c", D(1)),
+        E("/a", D(2)),
+        E("/a/b/c/d", D(3)),
+    };
+    trie = build(shadow, 3, pad);
+    assert(lookup(trie, "/a/b/c/x") == D(2));
+    assert(lookup(trie, "/a/b/c/d/x") == D(3));
+    delete trie;
+
+    // Mount over root catches everything
+    mount_trie_t::entry_t root[] = {E("/", D(7))};
+    trie = build(root, 1, pad);
+    assert(lookup(trie, "/any/thing") == D(7));
+    assert(lookup(trie, "/") == D(7));
+    delete trie;
+
+    trie = build(NULL, 0, pad);
+    assert(trie->empty() == !pad);
+    assert(lookup(trie, "/x") == NULL);
+    delete trie;
+
+    ::printf("ok - semantics (%s)\n", pad ? "trie" : "linear");
+    return 0;
+}
+
+static char roots[MAX_MOUNTS][64];
+static char paths[MAX_MOUNTS][128];
+
+static void bench(size_t count)
+{
+    mount_trie_t::entry_t entries[MAX_MOUNTS];
+    ::memset(entries, 0, sizeof(entries));
+    for (size_t i = 0; i != count; ++i)
+    {
+        ::snprintf(roots[i], sizeof(roots[i]), "/data/data/com.example.app%u/files", (unsigned)i);
+        ::snprintf(paths[i], sizeof(paths[i]), "%s/textures/level%u/tile.png", roots[i], (unsigned)i);
+        entries[i] = E(roots[i], D(i));
+    }
+
+    mount_trie_t *trie = mount_trie_t::build(entries, count);
+    assert(trie);
+
+    size_t lengths[MAX_MOUNTS];
+    for (size_t i = 0; i != count; ++i)
+        lengths[i] = ::strlen(paths[i]);
+
+    size_t hits = 0;
+    double start = now();
+    for (size_t i = 0; i != LOOKUPS; ++i)
+    {
+        size_t n = i % count;
+        hits += legacy_lookup(entries, count, paths[n], lengths[n]) == D(n);
+    }
+    double legacy = now() - start;
+    assert(hits == LOOKUPS);
+
+    hits = 0;
+    start = now();
+    for (size_t i = 0; i != LOOKUPS; ++i)
+    {
+        size_t n = i % count;
+        hits += trie->lookup(paths[n], lengths[n]) == D(n);
+    }
+    double radix = now() - start;
+    assert(hits == LOOKUPS);
+
+    ::printf("mounts=%u: linear %.1f ns/lookup, trie %.1f ns/lookup (x%.1f)\n",
+        (unsigned)count, legacy * 1e9 / LOOKUPS, radix * 1e9 / LOOKUPS, legacy / radix);
+
+    delete trie;
+}
+
+struct context_t
+{
+    rcu_ptr_t<mount_trie_t> trie;
+    volatile bool stop;
+};
+
+static void *reader(void *arg)
+{
+    context_t *ctx = reinterpret_cast<context_t *>(arg);
+    for (size_t i = 0; i != LOOKUPS; ++i)
+    {
+        rcu_ptr_t<mount_trie_t>::reader_t trie(ctx->trie);
+        // "/data/app" is mounted all the time, "/data/app/assets" comes and goes
+        driver_t *d = lookup(trie.get(), "/data/app/assets/a.png");
+        if (d != D(1) && d != D(2))
+            ::abort();
+    }
+    return NULL;
+}
+
+static int test_concurrent()
+{
+    context_t ctx;
+    ctx.stop = false;
+
+    mount_trie_t::entry_t entries[] = {
+        E("/data/app", D(1)),
+        E("/data/app/assets", D(2)),
+    };
+    delete ctx.trie.exchange(mount_trie_t::build(entries, 1));
+
+    pthread_t threads[4];
+    for (size_t i = 0; i != sizeof(threads)/sizeof(threads[0]); ++i)
+        ::pthread_create(&threads[i], NULL, &reader, &ctx);
+
+    size_t updates = 0;
+    for (size_t i = 0; i != 1000; ++i, ++updates)
+    {
+        mount_trie_t *trie = mount_trie_t::build(entries, 1 + i % 2);
+        assert(trie);
+        // Nobody can see previous trie anymore, so it's safe to free it
+        delete ctx.trie.exchange(trie);
+    }
+
+    for (size_t i = 0; i != sizeof(threads)/sizeof(threads[0]); ++i)
+        ::pthread_join(threads[i], NULL);
+
+    delete ctx.trie.exchange(NULL);
+
+    ::printf("ok - concurrent (%u updates)\n", (unsigned)updates);
+    return 0;
+}
+
+int main()
+{
+    if (test_semantics(false) != 0 || test_semantics(true) != 0)
+        return 1;
+    if (test_concurrent() != 0)
+        return 1;
+
+    static const size_t counts[] = {1, 4, 16, 64, 256};
+    for (size_t i = 0; i != sizeof(counts)/sizeof(counts[0]); ++i)
+        bench(counts[i]);
+
+    ::printf("OK\n");
+    return 0;
+}
@@ -0,0 +1 @@
+APP_ABI := all
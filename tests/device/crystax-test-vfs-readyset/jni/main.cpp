@@ -0,0 +1,127 @@
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "fileio/readyset.hpp"
+
+using crystax::fileio::ready_set_t;
+
+static struct epoll_event event(uint32_t events, int data)
+{
+    struct epoll_event ev;
+    ::memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = data;
+    return ev;
+}
+
+static int test_semantics()
+{
+    ready_set_t set;
+    struct epoll_event out[8];
+
+    assert(set.empty());
+    assert(set.collect(out, 8) == 0);
+
+    assert(set.add(3, event(EPOLLIN, 103)) == 0);
+    assert(set.add(3, event(EPOLLIN, 103)) == -1 && errno == EEXIST);
+    assert(set.modify(4, event(EPOLLIN, 104)) == -1 && errno == ENOENT);
+    assert(set.remove(4) == -1 && errno == ENOENT);
+
+    // Level-triggered entry is reported every time, with requested events only
+    assert(set.collect(out, 8) == 1);
+    assert(out[0].events == EPOLLIN && out[0].data.fd == 103);
+    assert(set.collect(out, 8) == 1);
+
+    // Edge-triggered one is reported once, until modified
+    assert(set.add(4, event(EPOLLOUT | EPOLLET, 104)) == 0);
+    assert(set.collect(out, 8) == 2);
+    assert(set.collect(out, 8) == 1 && out[0].data.fd == 103);
+    assert(set.modify(4, event(EPOLLIN | EPOLLOUT | EPOLLONESHOT, 204)) == 0);
+    assert(set.collect(out, 8) == 2);
+    assert(set.collect(out, 8) == 1);
+
+    // Memory-backed descriptors never have urgent data
+    assert(set.add(5, event(EPOLLPRI, 105)) == 0);
+    assert(set.collect(out, 8) == 1);
+
+    assert(set.remove(3) == 0);
+    assert(!set.contains(3));
+    assert(set.collect(out, 8) == 0);
+    assert(set.size() == 2);
+
+    ::printf("ok - semantics\n");
+    return 0;
+}
+
+static int test_rotation()
+{
+    enum {N = 10};
+
+    ready_set_t set;
+    for (int fd = 0; fd != N; ++fd)
+        assert(set.add(fd, event(EPOLLIN, fd)) == 0);
+
+    // Each entry must get its turn even if caller takes events one by one
+    int seen[N] = {0};
+    struct epoll_event out;
+    for (int i = 0; i != N * 3; ++i)
+    {
+        assert(set.collect(&out, 1) == 1);
+        ++seen[out.data.fd];
+    }
+    for (int fd = 0; fd != N; ++fd)
+        assert(seen[fd] == 3);
+
+    ::printf("ok - rotation\n");
+    return 0;
+}
+
+static int test_index()
+{
+    ready_set_t set;
+    struct epoll_event out[8];
+
+    // Entries are found whatever order they were added in
+    static const int fds[] = {7, 2, 9, 4, 0, 5};
+    for (size_t i = 0; i != sizeof(fds) / sizeof(fds[0]); ++i)
+        assert(set.add(fds[i], event(EPOLLIN | EPOLLET, fds[i])) == 0);
+    for (size_t i = 0; i != sizeof(fds) / sizeof(fds[0]); ++i)
+        assert(set.contains(fds[i]));
+    assert(!set.contains(1) && !set.contains(8) && !set.contains(10));
+    for (size_t i = 1; i != set.size(); ++i)
+        assert(set.fd_at(i - 1) < set.fd_at(i));
+
+    // ready() tells whether collect() has anything to report
+    assert(set.ready());
+    assert(set.collect(out, 4) == 4);
+    assert(set.ready());
+    assert(set.collect(out, 8) == 2);
+    assert(!set.ready());
+    assert(set.modify(4, event(EPOLLIN, 4)) == 0);
+    assert(set.ready());
+    assert(set.remove(4) == 0);
+    assert(!set.ready());
+    assert(set.add(3, event(EPOLLPRI, 3)) == 0);
+    assert(!set.ready());
+
+    ::printf("ok - index\n");
+    return 0;
+}
+
+int main()
+{
+    if (test_semantics() != 0)
+        return 1;
+    if (test_rotation() != 0)
+        return 1;
+    if (test_index() != 0)
+        return 1;
+
+    ::printf("OK\n");
+    return 0;
+}
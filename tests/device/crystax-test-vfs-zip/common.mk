@@ -0,0 +1,2 @@
+SRCFILES := main.cpp seek.cpp
+CFLAGS   := -Wall -Wextra -Werror -O2
@@ -0,0 +1,10 @@
+LOCAL_PATH := $(call my-dir)
+include $(LOCAL_PATH)/../common.mk
+
+include $(CLEAR_VARS)
+LOCAL_MODULE     := test-vfs-zip
+LOCAL_SRC_FILES  := $(SRCFILES)
+LOCAL_C_INCLUDES := $(NDK_ROOT)/sources/crystax/vfs
+LOCAL_CFLAGS     := $(CFLAGS)
+LOCAL_LDLIBS     := -lz
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,151 @@
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "zip/archive.hpp"
+#include "writer.h"
+
+using crystax::fileio::zip::archive_t;
+using crystax::fileio::zip::entry_t;
+using crystax::fileio::zip::reader_t;
+
+enum
+{
+    BIG_SIZE = 3 * 1024 * 1024 + 17
+};
+
+static entry_t const &find(archive_t const *a, const char *name)
+{
+    entry_t const *e = a->find(name, ::strlen(name));
+    assert(e);
+    return *e;
+}
+
+static void check_read(archive_t const *a, const char *name, const uint8_t *expected, size_t size)
+{
+    reader_t r(*a, find(a, name));
+    assert(r.valid());
+    assert(r.size() == size);
+
+    // Sequential pass by odd-sized chunks
+    uint8_t *buf = (uint8_t *)::malloc(size + 1);
+    size_t pos = 0;
+    for (;;)
+    {
+        ssize_t n = r.pread(buf + pos, 7777, pos);
+        assert(n >= 0);
+        if (n == 0)
+            break;
+        pos += n;
+    }
+    assert(pos == size);
+    assert(::memcmp(buf, expected, size) == 0);
+
+    // Random access, backwards and forwards
+    unsigned seed = 1;
+    for (int i = 0; i != 50; ++i)
+    {
+        size_t off = size ? ::rand_r(&seed) % size : 0;
+        size_t len = ::rand_r(&seed) % 5000;
+        ssize_t n = r.pread(buf, len, off);
+        size_t want = off + len > size ? size - off : len;
+        assert(n == (ssize_t)want);
+        assert(::memcmp(buf, expected + off, want) == 0);
+    }
+
+    assert(r.pread(buf, 10, size) == 0);
+    assert(r.pread(buf, 10, size + 100) == 0);
+
+    ::free(buf);
+}
+
+int test_seek();
+
+int main()
+{
+    static const char small[] = "Hello, zip!\n";
+    uint8_t *big = make_content(BIG_SIZE);
+
+    writer_t w;
+    w.add("assets/hello.txt", small, sizeof(small) - 1, false);
+    w.add("assets/dir/big.bin", big, BIG_SIZE, true);
+    w.add("assets/dir/", "", 0, false);
+    w.add("assets/dir-x", small, sizeof(small) - 1, true);
+    w.add("assets/dir/sub/stored.bin", big, 100000, false);
+    w.add("assets/empty", "", 0, false);
+    w.add("AndroidManifest.xml", small, sizeof(small) - 1, true);
+
+    size_t size;
+    const uint8_t *zip = w.finish(&size);
+
+    archive_t *a = archive_t::open(zip, size);
+    assert(a);
+    assert(a->count() == 7);
+
+    // Lookup
+    assert(a->find("assets/hello.txt", 16));
+    assert(!a->find("assets/hello.tx", 15));
+    assert(!a->find("assets/dir", 10));
+    assert(a->directory("assets/dir", 10));
+    assert(a->directory("assets/dir/sub", 14));
+    assert(a->directory("assets", 6));
+    assert(a->directory("", 0));
+    assert(!a->directory("assets/dir-x", 12));
+    assert(!a->directory("assets/di", 9));
+    assert(!a->directory("nothing", 7));
+
+    // Entries of directory are contiguous
+    size_t n = 0;
+    for (size_t i = a->first("assets/dir", 10); i < a->count() && archive_t::beneath(a->entry(i), "assets/dir", 10); ++i)
+        ++n;
+    assert(n == 3);
+
+    entry_t const &hello = find(a, "assets/hello.txt");
+    assert(hello.method == 0);
+    assert((hello.mode & 0777) == 0644);
+    struct tm tm;
+    time_t mtime = archive_t::mtime(hello);
+    ::localtime_r(&mtime, &tm);
+    assert(tm.tm_year == 117 && tm.tm_mon == 0 && tm.tm_mday == 1);
+
+    // Stored entries are served right from archive
+    {
+        reader_t r(*a, hello);
+        assert(r.valid());
+        assert(r.map() && ::memcmp(r.map(), small, sizeof(small) - 1) == 0);
+    }
+    {
+        reader_t r(*a, find(a, "assets/dir/big.bin"));
+        assert(r.valid());
+        assert(r.map() == NULL);
+    }
+
+    check_read(a, "assets/hello.txt", (const uint8_t *)small, sizeof(small) - 1);
+    check_read(a, "assets/dir-x", (const uint8_t *)small, sizeof(small) - 1);
+    check_read(a, "assets/dir/big.bin", big, BIG_SIZE);
+    check_read(a, "assets/dir/sub/stored.bin", big, 100000);
+    check_read(a, "assets/empty", NULL, 0);
+
+    delete a;
+
+    // Broken archives must be rejected
+    assert(archive_t::open(zip, 10) == NULL);
+    uint8_t *broken = (uint8_t *)::malloc(size);
+    ::memcpy(broken, zip, size);
+    broken[size - 7 - 22 + 16] ^= 0xff; // Central directory offset
+    assert(archive_t::open(broken, size) == NULL);
+    ::free(broken);
+
+    ::free(big);
+
+    if (test_seek() != 0)
+        return 1;
+
+    ::printf("OK\n");
+    return 0;
+}
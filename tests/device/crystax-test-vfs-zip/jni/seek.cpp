@@ -0,0 +1,124 @@
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+#include "zip/archive.hpp"
+#include "writer.h"
+
+using crystax::fileio::zip::archive_t;
+using crystax::fileio::zip::entry_t;
+using crystax::fileio::zip::index_t;
+using crystax::fileio::zip::reader_t;
+
+enum
+{
+    SEEKS = 20,
+    CHUNK = 4096,
+    SPACING = 256 * 1024
+};
+
+static double now()
+{
+    struct timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Return average latency (in ms) of random 4K reads, checking their content
+static double random_reads(reader_t &r, const uint8_t *expected, size_t size)
+{
+    uint8_t buf[CHUNK];
+    unsigned seed = 42;
+    double start = now();
+    for (int i = 0; i != SEEKS; ++i)
+    {
+        size_t off = ::rand_r(&seed) % (size - CHUNK);
+        ssize_t n = r.pread(buf, CHUNK, off);
+        assert(n == CHUNK);
+        assert(::memcmp(buf, expected + off, CHUNK) == 0);
+    }
+    return (now() - start) * 1000 / SEEKS;
+}
+
+static void sequential_pass(reader_t &r, size_t size)
+{
+    static uint8_t buf[64 * 1024];
+    for (size_t pos = 0; pos < size;)
+    {
+        ssize_t n = r.pread(buf, sizeof(buf), pos);
+        assert(n > 0);
+        pos += n;
+    }
+}
+
+static void bench(size_t size)
+{
+    uint8_t *content = make_content(size);
+
+    writer_t w;
+    w.add("data.bin", content, size, true);
+    size_t zipsize;
+    const uint8_t *zip = w.finish(&zipsize);
+
+    archive_t *a = archive_t::open(zip, zipsize);
+    assert(a);
+    entry_t const &e = *a->find("data.bin", 8);
+
+    // No index: every backward seek restarts inflate
+    double restart;
+    {
+        reader_t r(*a, e);
+        restart = random_reads(r, content, size);
+    }
+
+    // Index built lazily by first sequential pass
+    index_t *idx = new index_t(SPACING);
+    double lazy;
+    {
+        reader_t r(*a, e, idx);
+        sequential_pass(r, size);
+        lazy = random_reads(r, content, size);
+    }
+#if CRYSTAX_ZIP_SEEKINDEX_BUILD
+    // Checkpoints are taken at deflate block boundaries, so they could be sparser than SPACING
+    assert(idx->count() >= size / SPACING / 2);
+#endif
+
+    // Same index saved to sidecar and loaded back by another reader
+    size_t sidecar = idx->serialized_size();
+    uint8_t *buf = (uint8_t *)::malloc(sidecar);
+    assert(idx->serialize(buf, sidecar, e.usize, e.crc) == sidecar);
+    assert(index_t::deserialize(buf, sidecar, e.usize + 1, e.crc) == NULL);
+    index_t *loaded = index_t::deserialize(buf, sidecar, e.usize, e.crc);
+    assert(loaded && loaded->count() == idx->count());
+    double preloaded;
+    {
+        reader_t r(*a, e, loaded);
+        preloaded = random_reads(r, content, size);
+    }
+
+    ::printf("size=%3u MiB: restart %7.2f ms/seek, lazy index %5.2f ms/seek, sidecar %5.2f ms/seek (%u points, %u KiB)\n",
+        (unsigned)(size >> 20), restart, lazy, preloaded, (unsigned)idx->count(), (unsigned)(sidecar >> 10));
+
+    ::free(buf);
+    delete loaded;
+    delete idx;
+    delete a;
+    ::free(content);
+}
+
+int test_seek()
+{
+    static const size_t sizes[] = {1, 4, 16, 64};
+    for (size_t i = 0; i != sizeof(sizes)/sizeof(sizes[0]); ++i)
+        bench(sizes[i] << 20);
+
+    ::printf("ok - seek\n");
+    return 0;
+}
@@ -0,0 +1,150 @@
+#ifndef TEST_VFS_ZIP_WRITER_H
+#define TEST_VFS_ZIP_WRITER_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <zlib.h>
+
+/*
+ * Minimal zip writer, so test doesn't depend on any files or external tools.
+ */
+class writer_t
+{
+public:
+    writer_t()
+        :data(NULL), size(0), capacity(0), cd(NULL), cdsize(0), cdcapacity(0), count(0)
+    {}
+
+    ~writer_t()
+    {
+        ::free(data);
+        ::free(cd);
+    }
+
+    void add(const char *name, const void *content, size_t length, bool deflate)
+    {
+        const uint8_t *body = (const uint8_t *)content;
+        uLongf csize = length;
+        uint8_t *packed = NULL;
+        if (deflate)
+        {
+            z_stream zs;
+            ::memset(&zs, 0, sizeof(zs));
+            assert(::deflateInit2(&zs, Z_BEST_SPEED, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+            csize = ::deflateBound(&zs, length);
+            packed = (uint8_t *)::malloc(csize);
+            zs.next_in = (Bytef *)content;
+            zs.avail_in = length;
+            zs.next_out = packed;
+            zs.avail_out = csize;
+            assert(::deflate(&zs, Z_FINISH) == Z_STREAM_END);
+            csize = zs.total_out;
+            ::deflateEnd(&zs);
+            body = packed;
+        }
+
+        uint32_t crc = ::crc32(0, (const Bytef *)content, length);
+        size_t namelen = ::strlen(name);
+        uint32_t offset = size;
+        unsigned method = deflate ? 8 : 0;
+
+        put32(&data, &size, &capacity, 0x04034b50);
+        put16(&data, &size, &capacity, 20);
+        put16(&data, &size, &capacity, 0);
+        put16(&data, &size, &capacity, method);
+        put32(&data, &size, &capacity, 0x4a210000); // 2017-01-01 00:00:00
+        put32(&data, &size, &capacity, crc);
+        put32(&data, &size, &capacity, csize);
+        put32(&data, &size, &capacity, length);
+        put16(&data, &size, &capacity, namelen);
+        put16(&data, &size, &capacity, 0);
+        put(&data, &size, &capacity, name, namelen);
+        put(&data, &size, &capacity, body, csize);
+
+        put32(&cd, &cdsize, &cdcapacity, 0x02014b50);
+        put16(&cd, &cdsize, &cdcapacity, 0x0314);  // made by Unix
+        put16(&cd, &cdsize, &cdcapacity, 20);
+        put16(&cd, &cdsize, &cdcapacity, 0);
+        put16(&cd, &cdsize, &cdcapacity, method);
+        put32(&cd, &cdsize, &cdcapacity, 0x4a210000);
+        put32(&cd, &cdsize, &cdcapacity, crc);
+        put32(&cd, &cdsize, &cdcapacity, csize);
+        put32(&cd, &cdsize, &cdcapacity, length);
+        put16(&cd, &cdsize, &cdcapacity, namelen);
+        put16(&cd, &cdsize, &cdcapacity, 0);
+        put16(&cd, &cdsize, &cdcapacity, 0);
+        put16(&cd, &cdsize, &cdcapacity, 0);
+        put16(&cd, &cdsize, &cdcapacity, 0);
+        put32(&cd, &cdsize, &cdcapacity, 0100644u << 16);
+        put32(&cd, &cdsize, &cdcapacity, offset);
+        put(&cd, &cdsize, &cdcapacity, name, namelen);
+
+        ++count;
+        ::free(packed);
+    }
+
+    const uint8_t *finish(size_t *length)
+    {
+        uint32_t cdoff = size;
+        put(&data, &size, &capacity, cd, cdsize);
+        put32(&data, &size, &capacity, 0x06054b50);
+        put16(&data, &size, &capacity, 0);
+        put16(&data, &size, &capacity, 0);
+        put16(&data, &size, &capacity, count);
+        put16(&data, &size, &capacity, count);
+        put32(&data, &size, &capacity, cdsize);
+        put32(&data, &size, &capacity, cdoff);
+        put16(&data, &size, &capacity, 7);
+        put(&data, &size, &capacity, "comment", 7);
+        *length = size;
+        return data;
+    }
+
+private:
+    static void put(uint8_t **buf, size_t *size, size_t *capacity, const void *p, size_t n)
+    {
+        if (*size + n > *capacity)
+        {
+            *capacity = (*size + n) * 2;
+            *buf = (uint8_t *)::realloc(*buf, *capacity);
+            assert(*buf);
+        }
+        ::memcpy(*buf + *size, p, n);
+        *size += n;
+    }
+
+    static void put16(uint8_t **buf, size_t *size, size_t *capacity, unsigned v)
+    {
+        uint8_t b[2] = {(uint8_t)v, (uint8_t)(v >> 8)};
+        put(buf, size, capacity, b, sizeof(b));
+    }
+
+    static void put32(uint8_t **buf, size_t *size, size_t *capacity, uint32_t v)
+    {
+        put16(buf, size, capacity, v & 0xffff);
+        put16(buf, size, capacity, v >> 16);
+    }
+
+    uint8_t *data;
+    size_t size, capacity;
+    uint8_t *cd;
+    size_t cdsize, cdcapacity;
+    unsigned count;
+};
+
+inline uint8_t *make_content(size_t size)
+{
+    // Compressible but not trivial
+    uint8_t *p = (uint8_t *)::malloc(size);
+    uint32_t x = 12345;
+    for (size_t i = 0; i != size; ++i)
+    {
+        x = x * 1103515245 + 12345;
+        p[i] = (uint8_t)('a' + ((x >> 16) % 16));
+    }
+    return p;
+}
+
+#endif /* TEST_VFS_ZIP_WRITER_H */
@@ -0,0 +1,6 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := test_stlport_filebuf
+LOCAL_SRC_FILES := filebuf.cpp
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,252 @@
+// Checks that filebuf reads and writes the right bytes whatever the mix of
+// small and large transfers, seeks and buffer sizes, then prints file
+// throughput for reads and writes done in pieces of various sizes.
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <unistd.h>
+
+#if __APPLE__ || __gnu_linux__
+#define FNAME "/tmp/stlport-filebuf-test.bin"
+#elif __ANDROID__
+#define FNAME "/data/local/tmp/stlport-filebuf-test.bin"
+#else
+#error "Unknown platform"
+#endif
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+static std::vector<char> make_data(size_t n)
+{
+    std::vector<char> v(n);
+    unsigned seed = 7;
+    for (size_t i = 0; i < n; ++i)
+        v[i] = (char)rand_r(&seed);
+    return v;
+}
+
+static std::vector<char> read_file()
+{
+    std::vector<char> v;
+    FILE* f = fopen(FNAME, "rb");
+    if (f == NULL)
+        return v;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        v.insert(v.end(), buf, buf + n);
+    fclose(f);
+    return v;
+}
+
+static void write_file(const std::vector<char>& data)
+{
+    FILE* f = fopen(FNAME, "wb");
+    fwrite(&data[0], 1, data.size(), f);
+    fclose(f);
+}
+
+// Sizes of successive transfers, from single characters to several buffers
+static size_t piece(unsigned& seed)
+{
+    static const size_t sizes[] = { 1, 7, 100, 4095, 4096, 4097, 10000, 70000 };
+    return sizes[rand_r(&seed) % (sizeof(sizes) / sizeof(sizes[0]))];
+}
+
+static void check_write(const std::vector<char>& data, bool unbuffered)
+{
+    std::ofstream out;
+    if (unbuffered)
+        out.rdbuf()->pubsetbuf(0, 0);
+    out.open(FNAME, std::ios::binary);
+    unsigned seed = 1;
+    for (size_t pos = 0; pos < data.size(); ) {
+        size_t n = std::min(piece(seed), data.size() - pos);
+        if (n == 1)
+            out.put(data[pos]);
+        else
+            out.write(&data[pos], n);
+        pos += n;
+        CHECK((size_t)out.tellp() == pos);
+    }
+    out.close();
+    CHECK(!out.fail());
+    CHECK(read_file() == data);
+
+    // Appending a large block keeps what was there
+    out.open(FNAME, std::ios::binary | std::ios::app);
+    out.write("abc", 3);
+    out.write(&data[0], 100000);
+    out.close();
+    std::vector<char> expected(data);
+    expected.insert(expected.end(), "abc", "abc" + 3);
+    expected.insert(expected.end(), data.begin(), data.begin() + 100000);
+    CHECK(read_file() == expected);
+}
+
+static void check_read(const std::vector<char>& data, bool unbuffered)
+{
+    write_file(data);
+    std::ifstream in;
+    if (unbuffered)
+        in.rdbuf()->pubsetbuf(0, 0);
+    in.open(FNAME, std::ios::binary);
+    std::vector<char> buf(100000);
+    unsigned seed = 2;
+    size_t pos = 0;
+    while (pos < data.size()) {
+        size_t n = piece(seed);
+        size_t expect = std::min(n, data.size() - pos);
+        switch (rand_r(&seed) % 4) {
+        case 0:
+            CHECK(in.peek() == (unsigned char)data[pos]);
+            CHECK(in.get() == (unsigned char)data[pos]);
+            ++pos;
+            break;
+        case 1:
+            // Seeking moves the position, wherever the characters came from
+            CHECK((size_t)in.tellg() == pos);
+            pos = pos > n ? pos - n : 0;
+            in.seekg(pos);
+            break;
+        default:
+            in.read(&buf[0], n);
+            CHECK((size_t)in.gcount() == expect);
+            CHECK(std::equal(buf.begin(), buf.begin() + expect, data.begin() + pos));
+            pos += expect;
+            break;
+        }
+        CHECK(in.good() || pos == data.size());
+    }
+    in.read(&buf[0], 10);
+    CHECK(in.gcount() == 0 && in.eof());
+
+    // The whole file in one go, then through the get area
+    in.clear();
+    in.seekg(0);
+    std::vector<char> all(data.size() + 10);
+    in.read(&all[0], all.size());
+    CHECK((size_t)in.gcount() == data.size() && in.eof());
+    CHECK(std::equal(data.begin(), data.end(), all.begin()));
+    in.clear();
+    in.seekg(0);
+    std::string s((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    CHECK(s.size() == data.size() && std::equal(data.begin(), data.end(), s.begin()));
+}
+
+// A file that is read and written through the same filebuf
+static void check_update(const std::vector<char>& data)
+{
+    write_file(data);
+    std::fstream f(FNAME, std::ios::in | std::ios::out | std::ios::binary);
+    std::vector<char> buf(50000);
+    f.read(&buf[0], 20000);
+    CHECK(std::equal(buf.begin(), buf.begin() + 20000, data.begin()));
+    f.seekp(10);
+    std::vector<char> patch(30000, 'x');
+    f.write(&patch[0], patch.size());
+    f.seekg(0);
+    f.read(&buf[0], buf.size());
+    CHECK(f.gcount() == 50000);
+    CHECK(std::equal(buf.begin(), buf.begin() + 10, data.begin()));
+    CHECK(std::count(buf.begin() + 10, buf.begin() + 30010, 'x') == 30000);
+    CHECK(std::equal(buf.begin() + 30010, buf.end(), data.begin() + 30010));
+}
+
+// A pipe can be neither mapped nor seeked
+static void check_pipe(const std::vector<char>& data)
+{
+    int fds[2];
+    CHECK(pipe(fds) == 0);
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        for (size_t pos = 0; pos < data.size(); pos += 1000)
+            write(fds[1], &data[pos], std::min((size_t)1000, data.size() - pos));
+        _exit(0);
+    }
+    close(fds[1]);
+    std::filebuf fb;
+    fb.open(fds[0], std::ios::in);
+    std::vector<char> buf(data.size() + 100);
+    CHECK(fb.sgetn(&buf[0], 5) == 5);
+    CHECK(fb.sgetn(&buf[5], 200000) == 200000);
+    CHECK(fb.sgetn(&buf[200005], buf.size() - 200005) == (std::streamsize)data.size() - 200005);
+    CHECK(std::equal(data.begin(), data.end(), buf.begin()));
+    fb.close();
+    close(fds[0]);
+}
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double mb_per_s(size_t bytes, double seconds)
+{
+    return bytes / seconds / (1024 * 1024);
+}
+
+int main()
+{
+    std::vector<char> data = make_data(1000003);
+    check_write(data, false);
+    check_write(data, true);
+    check_read(data, false);
+    check_read(data, true);
+    check_update(data);
+    check_pipe(data);
+    unlink(FNAME);
+    if (failures != 0)
+        return 1;
+
+    const size_t size = 64 * 1024 * 1024;
+    std::vector<char> big = make_data(size);
+    printf("%-10s %12s %12s\n", "64 MB in", "write MB/s", "read MB/s");
+    static const size_t pieces[] = { 16, 256, 4096, 65536, 1048576 };
+    for (size_t i = 0; i < sizeof(pieces) / sizeof(pieces[0]); ++i) {
+        double start = now();
+        std::ofstream out(FNAME, std::ios::binary);
+        for (size_t pos = 0; pos < size; pos += pieces[i])
+            out.write(&big[pos], pieces[i]);
+        out.close();
+        double written = now();
+        std::ifstream in(FNAME, std::ios::binary);
+        std::vector<char> buf(pieces[i]);
+        size_t total = 0;
+        while (in.read(&buf[0], buf.size()))
+            total += in.gcount();
+        double end = now();
+        CHECK(total == size);
+        printf("%7d B   %12.0f %12.0f\n", (int)pieces[i],
+               mb_per_s(size, written - start), mb_per_s(size, end - written));
+    }
+
+    double start = now();
+    std::ifstream in(FNAME, std::ios::binary);
+    long sum = 0;
+    for (std::istreambuf_iterator<char> it(in), end; it != end; ++it)
+        sum += *it;
+    printf("%-10s %25.0f (sum %ld)\n", "by char", mb_per_s(size, now() - start), sum);
+    unlink(FNAME);
+    return failures != 0;
+}
@@ -0,0 +1,6 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := test_stlport_flat_hash
+LOCAL_SRC_FILES := flat_hash.cpp
+include $(BUILD_EXECUTABLE)
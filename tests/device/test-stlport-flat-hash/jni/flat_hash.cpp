@@ -0,0 +1,167 @@
+// Checks flat_hash_map and flat_hash_set against map and set on random
+// inserts, lookups and erases, then compares lookup and insert times of
+// flat_hash_map with those of unordered_map.
+
+#include <flat_hash_map>
+#include <flat_hash_set>
+#include <unordered_map>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+// Sends every key to the same few groups
+struct bad_hash
+{
+    size_t operator()(int key) const { return key & 3; }
+};
+
+template <class FlatMap>
+static void check_same(const FlatMap& f, const std::map<int, int>& m)
+{
+    CHECK(f.size() == m.size());
+    size_t n = 0;
+    for (typename FlatMap::const_iterator it = f.begin(); it != f.end(); ++it, ++n) {
+        std::map<int, int>::const_iterator ref = m.find(it->first);
+        CHECK(ref != m.end() && ref->second == it->second);
+    }
+    CHECK(n == m.size());
+}
+
+template <class FlatMap>
+static void test_random_map(int range, int ops)
+{
+    FlatMap f;
+    std::map<int, int> m;
+    unsigned seed = 1;
+    for (int i = 0; i < ops; ++i) {
+        int key = rand_r(&seed) % range;
+        switch (rand_r(&seed) % 5) {
+        case 0:
+        case 1: {
+            bool inserted = f.insert(std::make_pair(key, i)).second;
+            CHECK(inserted == m.insert(std::make_pair(key, i)).second);
+            break;
+        }
+        case 2:
+            f[key] += i;
+            m[key] += i;
+            break;
+        case 3:
+            CHECK(f.erase(key) == m.erase(key));
+            break;
+        default: {
+            typename FlatMap::iterator it = f.find(key);
+            std::map<int, int>::iterator ref = m.find(key);
+            CHECK((it == f.end()) == (ref == m.end()));
+            if (it != f.end() && ref != m.end())
+                CHECK(it->second == ref->second);
+            CHECK(f.count(key) == m.count(key));
+            break;
+        }
+        }
+        if (i % 10000 == 0)
+            check_same(f, m);
+    }
+    check_same(f, m);
+
+    FlatMap copy(f);
+    check_same(copy, m);
+    copy.rehash(0);
+    check_same(copy, m);
+
+    // Erasing while iterating leaves the other elements in place
+    for (typename FlatMap::iterator it = f.begin(); it != f.end(); ) {
+        typename FlatMap::iterator cur = it++;
+        if (cur->first % 2 == 0) {
+            m.erase(cur->first);
+            f.erase(cur);
+        }
+    }
+    check_same(f, m);
+
+    f.swap(copy);
+    CHECK(copy.size() == m.size());
+    f.clear();
+    CHECK(f.empty() && f.begin() == f.end());
+    f = copy;
+    check_same(f, m);
+}
+
+static void test_strings()
+{
+    std::flat_hash_set<std::string> s;
+    std::set<std::string> ref;
+    char buf[32];
+    for (int i = 0; i < 20000; ++i) {
+        sprintf(buf, "key-%d", i * 7919 % 5000);
+        CHECK(s.insert(buf).second == ref.insert(buf).second);
+        if (i % 3 == 0) {
+            sprintf(buf, "key-%d", i % 5000);
+            CHECK(s.erase(buf) == ref.erase(buf));
+        }
+    }
+    CHECK(s.size() == ref.size());
+    for (std::set<std::string>::const_iterator it = ref.begin(); it != ref.end(); ++it)
+        CHECK(s.count(*it) == 1);
+    s.reserve(100000);
+    CHECK(s.size() == ref.size() && s.count("key-1") == ref.count("key-1"));
+}
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+template <class Map>
+static void bench(const char* name, const std::vector<int>& keys, int lookups)
+{
+    double start = now();
+    Map m;
+    for (size_t i = 0; i < keys.size(); ++i)
+        m[keys[i]] = (int)i;
+    double inserted = now();
+    long found = 0;
+    for (int i = 0; i < lookups; ++i)
+        found += m.count(keys[i % keys.size()] + (i & 1));
+    double end = now();
+    printf("%-14s %7d keys: insert %6.1f ns, lookup %6.1f ns (%ld found)\n", name,
+           (int)keys.size(), (inserted - start) * 1e9 / keys.size(),
+           (end - inserted) * 1e9 / lookups, found);
+}
+
+int main()
+{
+    test_random_map<std::flat_hash_map<int, int> >(1000, 200000);
+    test_random_map<std::flat_hash_map<int, int> >(100000, 200000);
+    test_random_map<std::flat_hash_map<int, int, bad_hash> >(300, 20000);
+    test_strings();
+    if (failures != 0)
+        return 1;
+
+    for (int n = 1000; n <= 1000000; n *= 10) {
+        std::vector<int> keys;
+        unsigned seed = 2;
+        for (int i = 0; i < n; ++i)
+            keys.push_back((rand_r(&seed) & 0x3fffffff) * 2);
+        bench<std::flat_hash_map<int, int> >("flat_hash_map", keys, 4000000);
+        bench<std::tr1::unordered_map<int, int> >("unordered_map", keys, 4000000);
+    }
+    return 0;
+}
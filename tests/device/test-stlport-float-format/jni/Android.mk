@@ -0,0 +1,6 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := test_stlport_float_format
+LOCAL_SRC_FILES := float_format.cpp
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,196 @@
+// Checks that doubles written to a stream read back to the same value with
+// precision 17 and come out as printf writes them in every float format,
+// then compares the time taken by the stream with that of snprintf.
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+static unsigned long long state = 88172645463325252ULL;
+
+static unsigned long long next_random()
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Any finite double, all bit patterns equally likely
+static double random_double()
+{
+    for (;;) {
+        unsigned long long bits = next_random();
+        double x;
+        memcpy(&x, &bits, sizeof(x));
+        if (x - x == 0)
+            return x;
+    }
+}
+
+static std::string format(double x, std::ios_base::fmtflags flags, int precision)
+{
+    std::ostringstream os;
+    os.flags(flags);
+    os.precision(precision);
+    os << x;
+    return os.str();
+}
+
+static std::string printf_format(std::ios_base::fmtflags flags)
+{
+    std::string fmt = "%";
+    if (flags & std::ios_base::showpos)
+        fmt += '+';
+    if (flags & std::ios_base::showpoint)
+        fmt += '#';
+    fmt += ".*";
+    bool upper = (flags & std::ios_base::uppercase) != 0;
+    switch (flags & std::ios_base::floatfield) {
+    case std::ios_base::fixed:      fmt += upper ? 'F' : 'f'; break;
+    case std::ios_base::scientific: fmt += upper ? 'E' : 'e'; break;
+    default:                        fmt += upper ? 'G' : 'g'; break;
+    }
+    return fmt;
+}
+
+static std::string format_printf(double x, std::ios_base::fmtflags flags, int precision)
+{
+    static char buf[2048];
+    snprintf(buf, sizeof(buf), printf_format(flags).c_str(), precision, x);
+    return buf;
+}
+
+static void check_like_printf(double x, int max_precision)
+{
+    static const std::ios_base::fmtflags fields[] = {
+        std::ios_base::fmtflags(0), std::ios_base::fixed, std::ios_base::scientific
+    };
+    for (int f = 0; f < 3; ++f) {
+        for (int extra = 0; extra < 8; ++extra) {
+            std::ios_base::fmtflags flags = fields[f];
+            if (extra & 1)
+                flags |= std::ios_base::showpoint;
+            if (extra & 2)
+                flags |= std::ios_base::showpos;
+            if (extra & 4)
+                flags |= std::ios_base::uppercase;
+            for (int precision = 0; precision <= max_precision; ++precision) {
+                if (flags & std::ios_base::fixed && fabs(x) > 1e30 && precision > 4)
+                    break;
+                std::string got = format(x, flags, precision);
+                std::string want = format_printf(x, flags, precision);
+                if (got != want) {
+                    fprintf(stderr, "%a with precision %d: got %s, printf gives %s\n",
+                            x, precision, got.c_str(), want.c_str());
+                    ++failures;
+                }
+            }
+        }
+    }
+}
+
+static void check_round_trip(double x)
+{
+    std::string s = format(x, std::ios_base::fmtflags(0), 17);
+    CHECK(strtod(s.c_str(), 0) == x);
+}
+
+static void check_values()
+{
+    CHECK(format(0.1, std::ios_base::fmtflags(0), 6) == "0.1");
+    CHECK(format(0.1, std::ios_base::fmtflags(0), 17) == "0.10000000000000001");
+    CHECK(format(2.5, std::ios_base::fixed, 0) == "2");
+    CHECK(format(3.5, std::ios_base::fixed, 0) == "4");
+    CHECK(format(-0.0, std::ios_base::fmtflags(0), 6) == "-0");
+    CHECK(format(1e23, std::ios_base::fmtflags(0), 17) == "9.9999999999999992e+22");
+    CHECK(format(5e-324, std::ios_base::scientific, 3) == "4.941e-324");
+    CHECK(format(1.7976931348623157e308, std::ios_base::fixed, 0).size() == 309);
+    CHECK(format(999.9996, std::ios_base::showpoint, 3) == "1.00e+03");
+    CHECK(format(HUGE_VAL, std::ios_base::fmtflags(0), 6) == "inf");
+    CHECK(format(-HUGE_VAL, std::ios_base::uppercase, 6) == "-INF");
+    CHECK(format(NAN, std::ios_base::fixed, 6) == "nan");
+
+    static const double values[] = {
+        0.0, 1.0, 0.5, 0.125, 9.5, 0.05, 0.15, 1.0 / 3, 123.456, 12.375, 0.9999996,
+        1e15, 1e16, 1e21, 1e22, 1e23, 1e-5, 1e-10, 6e-7, 4503599627370496.5,
+        5e-324, 2.2250738585072014e-308, 1.7976931348623157e308
+    };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        check_like_printf(values[i], 40);
+        check_like_printf(-values[i], 20);
+    }
+    for (int e = -1074; e <= 1023; e += 7)
+        check_like_printf(ldexp(1.0, e), 20);
+    for (int i = 0; i < 2000; ++i) {
+        double x = random_double();
+        check_like_printf(x, 18);
+        check_like_printf((double)(next_random() % 1000000) / 100, 18);
+    }
+    for (int i = 0; i < 1000000; ++i)
+        check_round_trip(random_double());
+}
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench(const char* name, const std::vector<double>& values,
+                  std::ios_base::fmtflags flags, int precision)
+{
+    std::ostringstream os;
+    os.flags(flags);
+    os.precision(precision);
+    double start = now();
+    for (size_t i = 0; i < values.size(); ++i) {
+        os.str(std::string());
+        os << values[i];
+    }
+    double middle = now();
+    std::string fmt = printf_format(flags);
+    char buf[512];
+    for (size_t i = 0; i < values.size(); ++i)
+        snprintf(buf, sizeof(buf), fmt.c_str(), precision, values[i]);
+    double end = now();
+    printf("%-22s stream %7.1f ns, snprintf %7.1f ns\n", name,
+           (middle - start) * 1e9 / values.size(), (end - middle) * 1e9 / values.size());
+}
+
+int main()
+{
+    check_values();
+    if (failures != 0)
+        return 1;
+
+    std::vector<double> random, money;
+    for (int i = 0; i < 200000; ++i) {
+        random.push_back(random_double());
+        money.push_back((double)(next_random() % 1000000) / 100);
+    }
+    bench("random, default", random, std::ios_base::fmtflags(0), 6);
+    bench("random, precision 17", random, std::ios_base::fmtflags(0), 17);
+    bench("random, scientific", random, std::ios_base::scientific, 6);
+    bench("x.yy, default", money, std::ios_base::fmtflags(0), 6);
+    bench("x.yy, fixed 2", money, std::ios_base::fixed, 2);
+    return 0;
+}
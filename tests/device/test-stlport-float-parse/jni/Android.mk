@@ -0,0 +1,6 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := test_stlport_float_parse
+LOCAL_SRC_FILES := float_parse.cpp
+include $(BUILD_EXECUTABLE)
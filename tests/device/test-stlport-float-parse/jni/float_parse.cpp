@@ -0,0 +1,158 @@
+// Checks that doubles read from a stream are the ones strtod gives for
+// decimals of up to 19 significant digits, then compares the rate at which
+// a stream and strtod read comma-separated numbers.
+
+#include <sstream>
+#include <string>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+static unsigned long long state = 88172645463325252ULL;
+
+static unsigned long long next_random()
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Any finite double, all bit patterns equally likely
+static double random_double()
+{
+    for (;;) {
+        unsigned long long bits = next_random();
+        double x;
+        memcpy(&x, &bits, sizeof(x));
+        if (x - x == 0)
+            return x;
+    }
+}
+
+static double parse(const char* s)
+{
+    std::istringstream is(s);
+    double x = 42;
+    is >> x;
+    CHECK(!is.fail());
+    return x;
+}
+
+static bool same(double a, double b)
+{
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+static void check_like_strtod(const char* s)
+{
+    double got = parse(s);
+    double want = strtod(s, 0);
+    if (!same(got, want)) {
+        fprintf(stderr, "%s: got %a, strtod gives %a\n", s, got, want);
+        ++failures;
+    }
+}
+
+static void check_values()
+{
+    CHECK(same(parse("0.1"), 0.1));
+    CHECK(same(parse("-0"), -0.0));
+    CHECK(same(parse("1e400"), HUGE_VAL));
+    CHECK(same(parse("-1e-400"), -0.0));
+    CHECK(same(parse("9007199254740993"), 9007199254740992.0));
+    CHECK(same(parse("4.9406564584124654e-324"), 5e-324));
+    CHECK(same(parse("2.2250738585072011e-308"), 2.225073858507201e-308));
+    CHECK(same(parse("1.7976931348623157e308"), 1.7976931348623157e308));
+
+    static const char* const values[] = {
+        "0", "0.000", "1", ".5", "5.", "1e22", "1e23", "4503599627370496.5",
+        "4503599627370497.5", "9999999999999999999", "1234567890123456789e-300",
+        "2.4703282292062328e-324", "1.7976931348623158e308", "000000000000000000000000001",
+        "123.456e-2", "1e-342", "1e-343", "1e308", "1e309"
+    };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+        check_like_strtod(values[i]);
+
+    char buf[64];
+    for (int i = 0; i < 1000000; ++i) {
+        double x = random_double();
+        sprintf(buf, "%.17g", x);
+        CHECK(same(parse(buf), x));
+        sprintf(buf, "%.*g", (int)(next_random() % 19) + 1, x);
+        check_like_strtod(buf);
+        sprintf(buf, "%llu.%llue%d", next_random() % 1000000, next_random() % 1000,
+                (int)(next_random() % 40) - 20);
+        check_like_strtod(buf);
+    }
+}
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench(const char* name, const char* format, bool full_range)
+{
+    const int count = 200000;
+    std::string csv;
+    char buf[64];
+    for (int i = 0; i < count; ++i) {
+        double x = full_range ? fabs(random_double()) : (double)(next_random() % 100000000) / 1000;
+        sprintf(buf, format, x);
+        csv += buf;
+        csv += i % 8 == 7 ? '\n' : ',';
+    }
+
+    double sum = 0, strtod_sum = 0;
+    double start = now();
+    std::istringstream is(csv);
+    double x;
+    char sep;
+    while (is >> x) {
+        sum += x;
+        is.get(sep);
+    }
+    double middle = now();
+    const char* p = csv.c_str();
+    for (;;) {
+        char* end;
+        x = strtod(p, &end);
+        if (end == p)
+            break;
+        strtod_sum += x;
+        p = end + 1;
+    }
+    double end = now();
+    CHECK(sum == strtod_sum);
+    printf("%-14s stream %6.1f MB/s, strtod %6.1f MB/s\n", name,
+           csv.size() / (middle - start) / 1e6, csv.size() / (end - middle) / 1e6);
+}
+
+int main()
+{
+    check_values();
+    if (failures != 0)
+        return 1;
+
+    bench("%.3f", "%.3f", false);
+    bench("%.6g", "%.6g", false);
+    bench("%.17g", "%.17g", true);
+    bench("%.6e", "%.6e", true);
+    return failures != 0;
+}
@@ -0,0 +1,6 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := test_stlport_node_alloc_churn
+LOCAL_SRC_FILES := node_alloc_churn.cpp
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,249 @@
+// Checks the node allocator of STLport, and compares its throughput on
+// map/list/set churn by 1..16 threads at once with that of malloc, and of
+// free lists shared by all threads under a single lock, which is how the
+// node allocator used to work.
+
+#include <map>
+#include <list>
+#include <set>
+#include <memory>
+#include <new>
+
+#include <pthread.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <time.h>
+
+#define MAX_THREADS 16
+#define ROUNDS      20
+#define KEYS        2000
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+template <class T>
+struct malloc_allocator
+{
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+    template <class U> struct rebind { typedef malloc_allocator<U> other; };
+
+    malloc_allocator() {}
+    template <class U> malloc_allocator(const malloc_allocator<U>&) {}
+
+    T* allocate(size_t n, const void* = 0) { return static_cast<T*>(malloc(n * sizeof(T))); }
+    void deallocate(T* p, size_t) { free(p); }
+    size_t max_size() const { return size_t(-1) / sizeof(T); }
+    void construct(T* p, const T& v) { new (p) T(v); }
+    void destroy(T* p) { p->~T(); }
+    bool operator==(const malloc_allocator&) const { return true; }
+    bool operator!=(const malloc_allocator&) const { return false; }
+};
+
+// Free lists per multiple of 16 bytes under one mutex, carved from chunks
+struct locked_pool
+{
+    enum { ALIGN = 16, NLISTS = 16, CHUNK = 20 };
+    struct obj { obj* next; };
+    static pthread_mutex_t lock;
+    static obj* lists[NLISTS];
+
+    static void* allocate(size_t n)
+    {
+        if (n > ALIGN * NLISTS)
+            return malloc(n);
+        size_t i = (n - 1) / ALIGN;
+        pthread_mutex_lock(&lock);
+        obj* r = lists[i];
+        if (r == 0) {
+            size_t size = (i + 1) * ALIGN;
+            char* chunk = static_cast<char*>(malloc(size * CHUNK));
+            for (int k = 1; k < CHUNK; ++k) {
+                obj* o = reinterpret_cast<obj*>(chunk + k * size);
+                o->next = lists[i];
+                lists[i] = o;
+            }
+            r = reinterpret_cast<obj*>(chunk);
+        }
+        else
+            lists[i] = r->next;
+        pthread_mutex_unlock(&lock);
+        return r;
+    }
+
+    static void deallocate(void* p, size_t n)
+    {
+        if (n > ALIGN * NLISTS) {
+            free(p);
+            return;
+        }
+        size_t i = (n - 1) / ALIGN;
+        pthread_mutex_lock(&lock);
+        static_cast<obj*>(p)->next = lists[i];
+        lists[i] = static_cast<obj*>(p);
+        pthread_mutex_unlock(&lock);
+    }
+};
+
+pthread_mutex_t locked_pool::lock = PTHREAD_MUTEX_INITIALIZER;
+locked_pool::obj* locked_pool::lists[locked_pool::NLISTS];
+
+template <class T>
+struct locked_allocator : malloc_allocator<T>
+{
+    template <class U> struct rebind { typedef locked_allocator<U> other; };
+
+    locked_allocator() {}
+    template <class U> locked_allocator(const locked_allocator<U>&) {}
+
+    T* allocate(size_t n, const void* = 0) { return static_cast<T*>(locked_pool::allocate(n * sizeof(T))); }
+    void deallocate(T* p, size_t n) { locked_pool::deallocate(p, n * sizeof(T)); }
+};
+
+template <template <class> class Alloc>
+struct churn
+{
+    typedef std::map<int, int, std::less<int>, Alloc<std::pair<const int, int> > > map_type;
+    typedef std::set<int, std::less<int>, Alloc<int> > set_type;
+    typedef std::list<int, Alloc<int> > list_type;
+
+    static void* run(void* arg)
+    {
+        unsigned seed = (unsigned)(size_t)arg;
+        long* ops = static_cast<long*>(arg);
+        *ops = 0;
+        for (int r = 0; r < ROUNDS; ++r) {
+            map_type m;
+            set_type s;
+            list_type l;
+            for (int i = 0; i < KEYS; ++i) {
+                int key = rand_r(&seed) % (KEYS * 4);
+                m[key] = i;
+                s.insert(key);
+                l.push_back(key);
+            }
+            for (int i = 0; i < KEYS; ++i) {
+                int key = rand_r(&seed) % (KEYS * 4);
+                m.erase(key);
+                s.erase(key);
+                l.pop_front();
+                l.push_back(key);
+            }
+            *ops += 7 * KEYS;
+        }
+        return 0;
+    }
+};
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench(const char* name, void* (*worker)(void*), int nthreads)
+{
+    pthread_t threads[MAX_THREADS];
+    long ops[MAX_THREADS];
+    double start = now();
+    for (int i = 0; i < nthreads; ++i)
+        pthread_create(&threads[i], 0, worker, &ops[i]);
+    long total = 0;
+    for (int i = 0; i < nthreads; ++i) {
+        pthread_join(threads[i], 0);
+        total += ops[i];
+    }
+    double elapsed = now() - start;
+    printf("%-12s %2d threads: %ld ops/s\n", name, nthreads, (long)(total / elapsed));
+}
+
+// Every size up to twice the largest node comes back at least as large as
+// asked for, aligned, and may be freed with either size.
+static void test_sizes()
+{
+    for (size_t n = 1; n <= 4096; ++n) {
+        size_t rounded = n;
+        void* p = std::__node_alloc::allocate(rounded);
+        CHECK(p != 0);
+        CHECK(rounded >= n);
+        CHECK(((size_t)p & (2 * sizeof(void*) - 1)) == 0);
+        memset(p, 0x5a, rounded);
+        if (n <= (size_t)std::_MAX_NODE_BYTES) {
+            // Same class for every size between the two
+            size_t again = rounded;
+            void* q = std::__node_alloc::allocate(again);
+            CHECK(again == rounded);
+            std::__node_alloc::deallocate(q, rounded);
+        }
+        std::__node_alloc::deallocate(p, n);
+    }
+}
+
+// Nodes allocated by one thread and freed by another.
+struct handoff
+{
+    std::list<int>* lists[64];
+};
+
+static void* free_lists(void* arg)
+{
+    handoff* h = static_cast<handoff*>(arg);
+    for (int i = 0; i < 64; ++i)
+        delete h->lists[i];
+    return 0;
+}
+
+static void test_cross_thread()
+{
+    handoff h;
+    for (int round = 0; round < 8; ++round) {
+        for (int i = 0; i < 64; ++i) {
+            h.lists[i] = new std::list<int>;
+            for (int k = 0; k < 1000; ++k)
+                h.lists[i]->push_back(k);
+        }
+        pthread_t t;
+        pthread_create(&t, 0, free_lists, &h);
+        pthread_join(t, 0);
+    }
+    std::list<int> l;
+    for (int k = 0; k < 100000; ++k)
+        l.push_back(k);
+    long sum = 0;
+    for (std::list<int>::iterator it = l.begin(); it != l.end(); ++it)
+        sum += *it;
+    CHECK(sum == 100000L * 99999 / 2);
+}
+
+int main()
+{
+    test_sizes();
+    test_cross_thread();
+#if defined (_STLP_USE_THREAD_CACHING_NODE_ALLOC)
+    std::__node_alloc::release_free_memory();
+    test_cross_thread();
+#endif
+    if (failures != 0)
+        return 1;
+
+    for (int n = 1; n <= MAX_THREADS; n *= 2) {
+        bench("node_alloc", churn<std::allocator>::run, n);
+        bench("locked pool", churn<locked_allocator>::run, n);
+        bench("malloc", churn<malloc_allocator>::run, n);
+    }
+    return 0;
+}
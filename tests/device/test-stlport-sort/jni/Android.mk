@@ -0,0 +1,6 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := test_stlport_sort
+LOCAL_SRC_FILES := sort.cpp
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,158 @@
+// Checks sort, stable_sort and parallel_sort on random, sorted, reversed,
+// organ-pipe and many-duplicates inputs, then prints how long each takes
+// on them.
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+enum pattern { RANDOM, SORTED, REVERSED, ORGAN_PIPE, DUPLICATES, NUM_PATTERNS };
+
+static const char* const pattern_names[NUM_PATTERNS] = {
+    "random", "sorted", "reversed", "organ-pipe", "duplicates"
+};
+
+static std::vector<int> make_input(pattern p, int n, unsigned seed)
+{
+    std::vector<int> v(n);
+    for (int i = 0; i < n; ++i) {
+        switch (p) {
+        case RANDOM:     v[i] = rand_r(&seed); break;
+        case SORTED:     v[i] = i; break;
+        case REVERSED:   v[i] = n - i; break;
+        case ORGAN_PIPE: v[i] = i < n / 2 ? i : n - i; break;
+        default:         v[i] = rand_r(&seed) % 16; break;
+        }
+    }
+    return v;
+}
+
+// Orders by key only, so that stable_sort has equal elements to keep in order
+struct item
+{
+    int key;
+    int pos;
+};
+
+struct by_key
+{
+    bool operator()(const item& a, const item& b) const { return a.key < b.key; }
+};
+
+static void check_sorts(pattern p, int n)
+{
+    std::vector<int> input = make_input(p, n, n + 1);
+    std::vector<int> expected(input);
+    std::make_heap(expected.begin(), expected.end());
+    std::sort_heap(expected.begin(), expected.end());
+
+    std::vector<int> v(input);
+    std::sort(v.begin(), v.end());
+    CHECK(v == expected);
+
+    v = input;
+    std::sort(v.begin(), v.end(), std::greater<int>());
+    CHECK(std::equal(v.begin(), v.end(), expected.rbegin()));
+
+    v = input;
+    std::parallel_sort(v.begin(), v.end());
+    CHECK(v == expected);
+
+    std::vector<double> d(input.begin(), input.end());
+    std::sort(d.begin(), d.end());
+    CHECK(std::equal(d.begin(), d.end(), expected.begin()));
+
+    std::vector<item> items(n);
+    for (int i = 0; i < n; ++i) {
+        items[i].key = input[i] % 64;
+        items[i].pos = i;
+    }
+    std::stable_sort(items.begin(), items.end(), by_key());
+    for (int i = 1; i < n; ++i) {
+        CHECK(items[i - 1].key <= items[i].key);
+        if (items[i - 1].key == items[i].key)
+            CHECK(items[i - 1].pos < items[i].pos);
+    }
+
+    v = input;
+    std::stable_sort(v.begin(), v.end());
+    CHECK(v == expected);
+}
+
+static void check_strings()
+{
+    std::vector<std::string> v;
+    char buf[16];
+    unsigned seed = 3;
+    for (int i = 0; i < 100000; ++i) {
+        sprintf(buf, "%d", rand_r(&seed) % 50000);
+        v.push_back(buf);
+    }
+    std::vector<std::string> p(v);
+    std::sort(v.begin(), v.end());
+    CHECK(std::is_sorted(v.begin(), v.end()));
+    std::parallel_sort(p.begin(), p.end());
+    CHECK(p == v);
+}
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+enum algorithm { SORT, STABLE_SORT, PARALLEL_SORT };
+
+static double time_sort(algorithm a, const std::vector<int>& input)
+{
+    double best = 1e9;
+    for (int run = 0; run < 3; ++run) {
+        std::vector<int> v(input);
+        double start = now();
+        switch (a) {
+        case SORT:        std::sort(v.begin(), v.end()); break;
+        case STABLE_SORT: std::stable_sort(v.begin(), v.end()); break;
+        default:          std::parallel_sort(v.begin(), v.end()); break;
+        }
+        double t = now() - start;
+        if (t < best)
+            best = t;
+    }
+    return best * 1e3;
+}
+
+int main()
+{
+    static const int sizes[] = { 0, 1, 2, 3, 10, 23, 24, 25, 100, 129, 1000, 5000, 100000, 1000000 };
+    for (int p = 0; p < NUM_PATTERNS; ++p)
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+            check_sorts(pattern(p), sizes[i]);
+    check_strings();
+    if (failures != 0)
+        return 1;
+
+    printf("%-12s %10s %12s %14s\n", "1M ints", "sort ms", "stable ms", "parallel ms");
+    for (int p = 0; p < NUM_PATTERNS; ++p) {
+        std::vector<int> input = make_input(pattern(p), 1000000, 1);
+        printf("%-12s %10.1f %12.1f %14.1f\n", pattern_names[p],
+               time_sort(SORT, input), time_sort(STABLE_SORT, input),
+               time_sort(PARALLEL_SORT, input));
+    }
+    return 0;
+}
@@ -0,0 +1,6 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := test_stlport_string_search
+LOCAL_SRC_FILES := string_search.cpp
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,344 @@
+// Checks the find functions of std::string against naive searches, on random
+// texts, periodic ones and ones that defeat the fast searches, then prints
+// how fast they go through a log compared to the generic algorithms.
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+static const size_t npos = std::string::npos;
+
+static bool matches_at(const std::string& t, size_t i, const std::string& s)
+{
+    return t.compare(i, s.size(), s) == 0;
+}
+
+static size_t naive_find(const std::string& t, const std::string& s, size_t pos)
+{
+    for (size_t i = pos; i <= t.size() && t.size() - i >= s.size(); ++i)
+        if (matches_at(t, i, s))
+            return i;
+    return npos;
+}
+
+static size_t naive_rfind(const std::string& t, const std::string& s, size_t pos)
+{
+    if (t.size() < s.size())
+        return npos;
+    for (size_t i = std::min(pos, t.size() - s.size()) + 1; i-- > 0; )
+        if (matches_at(t, i, s))
+            return i;
+    return npos;
+}
+
+static size_t naive_find_of(const std::string& t, const std::string& s, size_t pos, bool in)
+{
+    for (size_t i = pos; i < t.size(); ++i)
+        if ((s.find(t[i]) != npos) == in)
+            return i;
+    return npos;
+}
+
+static size_t naive_rfind_of(const std::string& t, const std::string& s, size_t pos, bool in)
+{
+    if (t.empty())
+        return npos;
+    for (size_t i = std::min(pos, t.size() - 1) + 1; i-- > 0; )
+        if ((s.find(t[i]) != npos) == in)
+            return i;
+    return npos;
+}
+
+static void check_at(const std::string& t, const std::string& s, size_t pos)
+{
+    CHECK(t.find(s, pos) == naive_find(t, s, pos));
+    CHECK(t.rfind(s, pos) == naive_rfind(t, s, pos));
+    CHECK(t.find_first_of(s, pos) == naive_find_of(t, s, pos, true));
+    CHECK(t.find_last_of(s, pos) == naive_rfind_of(t, s, pos, true));
+    CHECK(t.find_first_not_of(s, pos) == naive_find_of(t, s, pos, false));
+    CHECK(t.find_last_not_of(s, pos) == naive_rfind_of(t, s, pos, false));
+    if (!s.empty()) {
+        std::string c(1, s[0]);
+        CHECK(t.find(s[0], pos) == naive_find(t, c, pos));
+        CHECK(t.rfind(s[0], pos) == naive_rfind(t, c, pos));
+    }
+}
+
+// Every position of a short text, and around the ends of a long one
+static void check(const std::string& t, const std::string& s)
+{
+    if (t.size() <= 300) {
+        for (size_t pos = 0; pos <= t.size() + 1; ++pos)
+            check_at(t, s, pos);
+    } else {
+        check_at(t, s, 0);
+        check_at(t, s, 17);
+        check_at(t, s, t.size() / 2);
+        check_at(t, s, t.size() - 20);
+    }
+    check_at(t, s, npos);
+}
+
+static std::string random_string(size_t n, const char* alphabet, unsigned& seed)
+{
+    std::string r(n, ' ');
+    size_t k = strlen(alphabet);
+    for (size_t i = 0; i < n; ++i)
+        r[i] = k != 0 ? alphabet[rand_r(&seed) % k] : (char)rand_r(&seed);
+    return r;
+}
+
+static void check_random()
+{
+    // An empty alphabet stands for all 256 characters, '\0' included
+    static const char* const alphabets[] = { "ab", "abc", "abcdefghijklmnopqrstuvwxyz \t\n", "" };
+    unsigned seed = 5;
+    for (int round = 0; round < 300; ++round) {
+        const char* alphabet = alphabets[round % 4];
+        std::string t = random_string(rand_r(&seed) % 200, alphabet, seed);
+        for (int i = 0; i < 6; ++i) {
+            size_t n = rand_r(&seed) % 20;
+            std::string s;
+            if (i % 2 == 0 && n <= t.size()) {
+                // A substring, so that there is something to find
+                s = t.substr(rand_r(&seed) % (t.size() - n + 1), n);
+            } else {
+                s = random_string(n, alphabet, seed);
+            }
+            check(t, s);
+        }
+    }
+}
+
+// Substrings whose first and last characters are everywhere in the text,
+// for the searches to give up on comparing them and switch to Two-Way
+static void check_pathological()
+{
+    std::string a(20000, 'a');
+    static const size_t lengths[] = { 2, 3, 17, 50, 300 };
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); ++i) {
+        size_t n = lengths[i];
+        std::string s(n, 'a');
+        const size_t places[] = { 0, 1, n / 2, n - 2, n - 1 };
+        for (size_t k = 0; k < sizeof(places) / sizeof(places[0]); ++k) {
+            size_t j = places[k];
+            s[j] = 'b';
+            check(a, s);
+            std::string t(a);
+            t[t.size() / 3] = 'b';
+            check(t, s);
+            t[t.size() / 3 * 2] = 'b';
+            check(t, s);
+            s[j] = 'a';
+        }
+    }
+
+    // Periodic substrings in a periodic text
+    unsigned seed = 9;
+    for (int round = 0; round < 40; ++round) {
+        std::string unit = random_string(1 + rand_r(&seed) % 5, "ab", seed);
+        std::string t;
+        while (t.size() < 20000)
+            t += unit;
+        std::string s;
+        while (s.size() < 40)
+            s += unit;
+        s[rand_r(&seed) % s.size()] ^= 3;
+        check(t, s);
+        t.replace(t.size() / 2, s.size(), s);
+        check(t, s);
+    }
+}
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static std::string make_log(size_t size)
+{
+    static const char* const tags[] = { "ActivityManager", "PackageManager", "dalvikvm", "WindowManager", "art" };
+    static const char* const words[] = { "Start", "proc", "for", "activity", "pid", "uid", "gids",
+                                         "com.example.app", "GC_CONCURRENT", "freed", "paused", "ms" };
+    std::string log;
+    unsigned seed = 11;
+    char buf[256];
+    while (log.size() < size) {
+        int n = sprintf(buf, "10-18 12:%02d:%02d.%03d  %4d  %4d I %-16s:", rand_r(&seed) % 60,
+                        rand_r(&seed) % 60, rand_r(&seed) % 1000, rand_r(&seed) % 9999,
+                        rand_r(&seed) % 9999, tags[rand_r(&seed) % 5]);
+        log.append(buf, n);
+        for (int w = rand_r(&seed) % 12; w >= 0; --w) {
+            log += ' ';
+            log += words[rand_r(&seed) % 12];
+        }
+        log += '\n';
+    }
+    return log;
+}
+
+static double mb_per_s(size_t bytes, double seconds)
+{
+    return bytes / seconds / (1024 * 1024);
+}
+
+static volatile size_t sink;
+
+// Runs f over the text until it has been read 20 times. The text may have
+// changed as far as the compiler knows, so that inlined searches are redone.
+template <class F>
+static double time_scans(const std::string& text, F f)
+{
+    double start = now();
+    size_t sum = 0;
+    for (int i = 0; i < 20; ++i) {
+        __asm__ __volatile__("" : : "r"(&text) : "memory");
+        sum += f(text);
+    }
+    sink = sum;
+    return mb_per_s(20 * text.size(), now() - start);
+}
+
+struct find_new
+{
+    std::string needle;
+    size_t operator()(const std::string& t) const { return t.find(needle); }
+};
+
+struct find_generic
+{
+    std::string needle;
+    size_t operator()(const std::string& t) const
+    {
+        std::string::const_iterator r = std::search(t.begin(), t.end(), needle.begin(), needle.end(),
+                                                    std::equal_to<char>());
+        return r - t.begin();
+    }
+};
+
+struct rfind_new
+{
+    std::string needle;
+    size_t operator()(const std::string& t) const { return t.rfind(needle); }
+};
+
+struct rfind_generic
+{
+    std::string needle;
+    size_t operator()(const std::string& t) const
+    {
+        std::string::const_iterator r = std::find_end(t.begin(), t.end(), needle.begin(), needle.end(),
+                                                      std::equal_to<char>());
+        return r - t.begin();
+    }
+};
+
+struct first_of_new
+{
+    std::string set;
+    size_t operator()(const std::string& t) const { return t.find_first_of(set); }
+};
+
+struct first_of_generic
+{
+    std::string set;
+    size_t operator()(const std::string& t) const
+    {
+        return std::find_first_of(t.begin(), t.end(), set.begin(), set.end(), std::equal_to<char>()) - t.begin();
+    }
+};
+
+struct not_in
+{
+    const std::string* set;
+    bool operator()(char c) const { return std::find(set->begin(), set->end(), c) == set->end(); }
+};
+
+struct last_not_of_new
+{
+    std::string set;
+    size_t operator()(const std::string& t) const { return t.find_last_not_of(set); }
+};
+
+struct last_not_of_generic
+{
+    std::string set;
+    size_t operator()(const std::string& t) const
+    {
+        not_in pred = { &set };
+        return std::find_if(t.rbegin(), t.rend(), pred).base() - t.begin();
+    }
+};
+
+template <class New, class Generic>
+static void report(const char* what, const std::string& text, const New& n, const Generic& g)
+{
+    printf("%-28s %10.0f %12.0f\n", what, time_scans(text, n), time_scans(text, g));
+}
+
+int main()
+{
+    check_random();
+    check_pathological();
+    if (failures != 0)
+        return 1;
+
+    std::string log = make_log(4 * 1024 * 1024);
+    // Nothing below occurs in the log, so every search reads all of it
+    printf("%-28s %10s %12s\n", "4 MB log", "MB/s", "generic MB/s");
+    static const char* const needles[] = { "ERROR", "com.example.crash", "GC_CONCURRENT freed 1024K, 12% free",
+                                           "10-18 12:00:00.000  1234  1234 E AndroidRuntime: FATAL EXCEPTION" };
+    char what[64];
+    for (size_t i = 0; i < sizeof(needles) / sizeof(needles[0]); ++i) {
+        find_new fn = { needles[i] };
+        find_generic fg = { needles[i] };
+        sprintf(what, "find, %d chars", (int)strlen(needles[i]));
+        report(what, log, fn, fg);
+    }
+    for (size_t i = 0; i < sizeof(needles) / sizeof(needles[0]); i += 2) {
+        rfind_new rn = { needles[i] };
+        rfind_generic rg = { needles[i] };
+        sprintf(what, "rfind, %d chars", (int)strlen(needles[i]));
+        report(what, log, rn, rg);
+    }
+    first_of_new fon = { "#$%" };
+    first_of_generic fog = { "#$%" };
+    report("find_first_of, 3 chars", log, fon, fog);
+    first_of_new fon2 = { "!#$%&*;<>?@[]^`{|}~" };
+    first_of_generic fog2 = { "!#$%&*;<>?@[]^`{|}~" };
+    report("find_first_of, 19 chars", log, fon2, fog2);
+
+    // Trailing blanks, as trimmed off lines
+    std::string blanks = "x" + std::string(4 * 1024 * 1024, ' ');
+    for (size_t i = 1; i < blanks.size(); i += 7)
+        blanks[i] = "\t\r\n"[i % 3];
+    last_not_of_new lnn = { " \t\r\n" };
+    last_not_of_generic lng = { " \t\r\n" };
+    report("find_last_not_of, 4 chars", blanks, lnn, lng);
+
+    // Substrings that keep almost matching
+    std::string a(4 * 1024 * 1024, 'a');
+    std::string s = std::string(63, 'a') + "b";
+    find_new pn = { s };
+    find_generic pg = { s };
+    report("find, aa..ab in aa..a", a, pn, pg);
+    return 0;
+}